@@ -12,6 +12,13 @@
 #include "third_party/base/check.h"
 #include "third_party/base/check_op.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define FX_CRYPT_AES_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #define mulby2(x) (((x & 0x7F) << 1) ^ (x & 0x80 ? 0x1B : 0))
 #define PUT_32BIT_MSB_FIRST(cp, value) \
   do {                                 \
@@ -631,6 +638,127 @@ void aes_encrypt_cbc(unsigned char* dest,
   memcpy(ctx->iv, iv, sizeof(iv));
 }
 
+#if defined(FX_CRYPT_AES_NI)
+// Whether the CPU running the code has the instructions the functions below
+// use. Callers fall back to the table-driven code above when it does not.
+bool HasAesInstructions() {
+  static const bool has_aes = [] {
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    return __get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_AES) &&
+           (edx & bit_SSE2);
+  }();
+  return has_aes;
+}
+
+// Loads the round keys in `keysched`, held as big-endian words, in the byte
+// order the AES instructions use.
+__attribute__((target("aes,sse2"))) void LoadRoundKeys(
+    const unsigned int* keysched,
+    int Nr,
+    __m128i* round_keys) {
+  for (int i = 0; i <= Nr; i++) {
+    unsigned char bytes[16];
+    for (int j = 0; j < 4; j++)
+      PUT_32BIT_MSB_FIRST(bytes + 4 * j, keysched[4 * i + j]);
+    round_keys[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+  }
+}
+
+__attribute__((target("aes,sse2"))) __m128i LoadIV(
+    const CRYPT_aes_context* ctx) {
+  unsigned char bytes[16];
+  for (int i = 0; i < 4; i++)
+    PUT_32BIT_MSB_FIRST(bytes + 4 * i, ctx->iv[i]);
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+__attribute__((target("aes,sse2"))) void StoreIV(CRYPT_aes_context* ctx,
+                                                 __m128i iv) {
+  unsigned char bytes[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), iv);
+  for (int i = 0; i < 4; i++)
+    ctx->iv[i] = FXSYS_UINT32_GET_MSBFIRST(bytes + 4 * i);
+}
+
+// Same as aes_decrypt_cbc(). Blocks decrypt independently of each other, so
+// four get decrypted at a time to keep the AES unit busy.
+__attribute__((target("aes,sse2"))) void aes_decrypt_cbc_ni(
+    unsigned char* dest,
+    const unsigned char* src,
+    int len,
+    CRYPT_aes_context* ctx) {
+  DCHECK_EQ((len & 15), 0);
+  const int Nr = ctx->Nr;
+  __m128i keys[CRYPT_aes_context::kMaxNr + 1];
+  LoadRoundKeys(ctx->invkeysched, Nr, keys);
+  __m128i iv = LoadIV(ctx);
+  while (len >= 64) {
+    __m128i ct[4];
+    __m128i x[4];
+    for (int i = 0; i < 4; i++) {
+      ct[i] =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16 * i));
+      x[i] = _mm_xor_si128(ct[i], keys[0]);
+    }
+    for (int r = 1; r < Nr; r++) {
+      for (int i = 0; i < 4; i++)
+        x[i] = _mm_aesdec_si128(x[i], keys[r]);
+    }
+    for (int i = 0; i < 4; i++) {
+      x[i] = _mm_aesdeclast_si128(x[i], keys[Nr]);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 16 * i),
+                       _mm_xor_si128(x[i], iv));
+      iv = ct[i];
+    }
+    dest += 64;
+    src += 64;
+    len -= 64;
+  }
+  while (len > 0) {
+    __m128i ct = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+    __m128i x = _mm_xor_si128(ct, keys[0]);
+    for (int r = 1; r < Nr; r++)
+      x = _mm_aesdec_si128(x, keys[r]);
+    x = _mm_aesdeclast_si128(x, keys[Nr]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), _mm_xor_si128(x, iv));
+    iv = ct;
+    dest += 16;
+    src += 16;
+    len -= 16;
+  }
+  StoreIV(ctx, iv);
+}
+
+// Same as aes_encrypt_cbc().
+__attribute__((target("aes,sse2"))) void aes_encrypt_cbc_ni(
+    unsigned char* dest,
+    const unsigned char* src,
+    int len,
+    CRYPT_aes_context* ctx) {
+  DCHECK_EQ((len & 15), 0);
+  const int Nr = ctx->Nr;
+  __m128i keys[CRYPT_aes_context::kMaxNr + 1];
+  LoadRoundKeys(ctx->keysched, Nr, keys);
+  __m128i iv = LoadIV(ctx);
+  while (len > 0) {
+    iv = _mm_xor_si128(
+        iv, _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+    iv = _mm_xor_si128(iv, keys[0]);
+    for (int r = 1; r < Nr; r++)
+      iv = _mm_aesenc_si128(iv, keys[r]);
+    iv = _mm_aesenclast_si128(iv, keys[Nr]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), iv);
+    dest += 16;
+    src += 16;
+    len -= 16;
+  }
+  StoreIV(ctx, iv);
+}
+#endif  // defined(FX_CRYPT_AES_NI)
+
 }  // namespace
 
 void CRYPT_AESSetKey(CRYPT_aes_context* context,
@@ -648,6 +776,12 @@ void CRYPT_AESDecrypt(CRYPT_aes_context* context,
                       uint8_t* dest,
                       const uint8_t* src,
                       uint32_t size) {
+#if defined(FX_CRYPT_AES_NI)
+  if (HasAesInstructions()) {
+    aes_decrypt_cbc_ni(dest, src, size, context);
+    return;
+  }
+#endif
   aes_decrypt_cbc(dest, src, size, context);
 }
 
@@ -655,5 +789,11 @@ void CRYPT_AESEncrypt(CRYPT_aes_context* context,
                       uint8_t* dest,
                       const uint8_t* src,
                       uint32_t size) {
+#if defined(FX_CRYPT_AES_NI)
+  if (HasAesInstructions()) {
+    aes_encrypt_cbc_ni(dest, src, size, context);
+    return;
+  }
+#endif
   aes_encrypt_cbc(dest, src, size, context);
 }
@@ -8,6 +8,13 @@
 
 #include <string.h>
 
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define FX_CRYPT_SHA_NI
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
 #define SHA_GET_UINT32(n, b, i)                                         \
   {                                                                     \
     (n) = ((uint32_t)(b)[(i)] << 24) | ((uint32_t)(b)[(i) + 1] << 16) | \
@@ -244,6 +251,118 @@ void sha256_process(CRYPT_sha2_context* ctx, const uint8_t data[64]) {
   ctx->state[7] += H;
 }
 
+#if defined(FX_CRYPT_SHA_NI)
+const uint32_t kSha256Constants[64] = {
+    0x428A2F98, 0x71374491, 0xB5C0FBCF, 0xE9B5DBA5, 0x3956C25B, 0x59F111F1,
+    0x923F82A4, 0xAB1C5ED5, 0xD807AA98, 0x12835B01, 0x243185BE, 0x550C7DC3,
+    0x72BE5D74, 0x80DEB1FE, 0x9BDC06A7, 0xC19BF174, 0xE49B69C1, 0xEFBE4786,
+    0x0FC19DC6, 0x240CA1CC, 0x2DE92C6F, 0x4A7484AA, 0x5CB0A9DC, 0x76F988DA,
+    0x983E5152, 0xA831C66D, 0xB00327C8, 0xBF597FC7, 0xC6E00BF3, 0xD5A79147,
+    0x06CA6351, 0x14292967, 0x27B70A85, 0x2E1B2138, 0x4D2C6DFC, 0x53380D13,
+    0x650A7354, 0x766A0ABB, 0x81C2C92E, 0x92722C85, 0xA2BFE8A1, 0xA81A664B,
+    0xC24B8B70, 0xC76C51A3, 0xD192E819, 0xD6990624, 0xF40E3585, 0x106AA070,
+    0x19A4C116, 0x1E376C08, 0x2748774C, 0x34B0BCB5, 0x391C0CB3, 0x4ED8AA4A,
+    0x5B9CCA4F, 0x682E6FF3, 0x748F82EE, 0x78A5636F, 0x84C87814, 0x8CC70208,
+    0x90BEFFFA, 0xA4506CEB, 0xBEF9A3F7, 0xC67178F2,
+};
+
+// Whether the CPU running the code has the instructions
+// sha256_process_blocks_ni() uses. Callers fall back to sha256_process() when
+// it does not.
+bool HasShaInstructions() {
+  static const bool has_sha = [] {
+    unsigned int eax;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    if (__get_cpuid_max(0, nullptr) < 7 ||
+        !__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSSE3) ||
+        !(ecx & bit_SSE4_1)) {
+      return false;
+    }
+    __cpuid_count(7, 0, eax, ebx, ecx, edx);
+    return !!(ebx & bit_SHA);
+  }();
+  return has_sha;
+}
+
+// Same as calling sha256_process() on each of the `blocks` 64-byte blocks at
+// `data`.
+__attribute__((target("sha,sse4.1"))) void sha256_process_blocks_ni(
+    CRYPT_sha2_context* ctx,
+    const uint8_t* data,
+    size_t blocks) {
+  // Loads the message words, which are big-endian.
+  const __m128i kByteSwap =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+  // The instructions want the state as ABEF and CDGH.
+  __m128i abcd = _mm_set_epi32(static_cast<uint32_t>(ctx->state[0]),
+                               static_cast<uint32_t>(ctx->state[1]),
+                               static_cast<uint32_t>(ctx->state[2]),
+                               static_cast<uint32_t>(ctx->state[3]));
+  __m128i efgh = _mm_set_epi32(static_cast<uint32_t>(ctx->state[4]),
+                               static_cast<uint32_t>(ctx->state[5]),
+                               static_cast<uint32_t>(ctx->state[6]),
+                               static_cast<uint32_t>(ctx->state[7]));
+  __m128i abef = _mm_unpackhi_epi64(efgh, abcd);
+  __m128i cdgh = _mm_unpacklo_epi64(efgh, abcd);
+
+  for (; blocks; --blocks, data += 64) {
+    const __m128i abef_save = abef;
+    const __m128i cdgh_save = cdgh;
+    __m128i w[4];
+    for (int i = 0; i < 16; i++) {
+      if (i < 4) {
+        w[i] = _mm_shuffle_epi8(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)),
+            kByteSwap);
+      } else {
+        // See the R() macro, four words at a time.
+        __m128i next = _mm_sha256msg1_epu32(w[i & 3], w[(i + 1) & 3]);
+        next = _mm_add_epi32(
+            next, _mm_alignr_epi8(w[(i + 3) & 3], w[(i + 2) & 3], 4));
+        w[i & 3] = _mm_sha256msg2_epu32(next, w[(i + 3) & 3]);
+      }
+      __m128i msg = _mm_add_epi32(
+          w[i & 3], _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                        kSha256Constants + 4 * i)));
+      cdgh = _mm_sha256rnds2_epu32(cdgh, abef, msg);
+      abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(msg, 0x0E));
+    }
+    abef = _mm_add_epi32(abef, abef_save);
+    cdgh = _mm_add_epi32(cdgh, cdgh_save);
+  }
+
+  uint32_t state[8];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_unpackhi_epi64(cdgh, abef));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state + 4),
+                   _mm_unpacklo_epi64(cdgh, abef));
+  ctx->state[0] = state[3];
+  ctx->state[1] = state[2];
+  ctx->state[2] = state[1];
+  ctx->state[3] = state[0];
+  ctx->state[4] = state[7];
+  ctx->state[5] = state[6];
+  ctx->state[6] = state[5];
+  ctx->state[7] = state[4];
+}
+#endif  // defined(FX_CRYPT_SHA_NI)
+
+void sha256_process_blocks(CRYPT_sha2_context* ctx,
+                           const uint8_t* data,
+                           size_t blocks) {
+#if defined(FX_CRYPT_SHA_NI)
+  if (HasShaInstructions()) {
+    sha256_process_blocks_ni(ctx, data, blocks);
+    return;
+  }
+#endif
+  for (; blocks; --blocks, data += 64)
+    sha256_process(ctx, data);
+}
+
 const uint8_t sha256_padding[64] = {
     0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
     0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -451,16 +570,15 @@ void CRYPT_SHA256Update(CRYPT_sha2_context* context,
   context->total_bytes += size;
   if (left && size >= fill) {
     memcpy(context->buffer + left, data, fill);
-    sha256_process(context, context->buffer);
+    sha256_process_blocks(context, context->buffer, 1);
     size -= fill;
     data += fill;
     left = 0;
   }
-  while (size >= 64) {
-    sha256_process(context, data);
-    size -= 64;
-    data += 64;
-  }
+  const uint32_t blocks = size / 64;
+  sha256_process_blocks(context, data, blocks);
+  size -= blocks * 64;
+  data += blocks * 64;
   if (size)
     memcpy(context->buffer + left, data, size);
 }
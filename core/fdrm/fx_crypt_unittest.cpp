@@ -277,6 +277,28 @@ TEST(FXCRYPT, Sha256TestB2) {
     EXPECT_EQ(kExpected[i], actual[i]) << " at byte " << i;
 }
 
+TEST(FXCRYPT, Sha256TestB3) {
+  // Example B.3 from FIPS 180-2: long message, added in uneven pieces.
+  static const uint8_t kExpected[32] = {
+      0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7,
+      0xe2, 0x84, 0xd7, 0x3e, 0x67, 0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97,
+      0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0};
+  const std::vector<uint8_t> input(1000000, 'a');
+  CRYPT_sha2_context context;
+  CRYPT_SHA256Start(&context);
+  size_t offset = 0;
+  for (uint32_t piece = 1; offset < input.size(); piece = piece * 3 + 1) {
+    uint32_t size =
+        static_cast<uint32_t>(std::min<size_t>(piece, input.size() - offset));
+    CRYPT_SHA256Update(&context, input.data() + offset, size);
+    offset += size;
+  }
+  uint8_t actual[32];
+  CRYPT_SHA256Finish(&context, actual);
+  for (size_t i = 0; i < std::size(kExpected); ++i)
+    EXPECT_EQ(kExpected[i], actual[i]) << " at byte " << i;
+}
+
 TEST(FXCRYPT, CRYPT_ArcFourSetup) {
   {
     static const uint8_t
@@ -641,3 +663,78 @@ TEST(FXCRYPT, Sha512Pad112) {
   for (size_t i = 0; i < std::size(kExpected); ++i)
     EXPECT_EQ(kExpected[i], actual[i]) << " at byte " << i;
 }
+
+// Examples F.2.1 to F.2.6 from NIST SP 800-38A.
+TEST(FXCRYPT, AESCBC) {
+  static const uint8_t kKey128[16] = {0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae,
+                                      0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88,
+                                      0x09, 0xcf, 0x4f, 0x3c};
+  static const uint8_t kKey256[32] = {
+      0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae,
+      0xf0, 0x85, 0x7d, 0x77, 0x81, 0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61,
+      0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4};
+  static const uint8_t kIV[16] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05,
+                                  0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b,
+                                  0x0c, 0x0d, 0x0e, 0x0f};
+  static const uint8_t kPlain[64] = {
+      0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e,
+      0x11, 0x73, 0x93, 0x17, 0x2a, 0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03,
+      0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51, 0x30,
+      0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19,
+      0x1a, 0x0a, 0x52, 0xef, 0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b,
+      0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10};
+  static const uint8_t kCipher128[64] = {
+      0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46, 0xce, 0xe9, 0x8e,
+      0x9b, 0x12, 0xe9, 0x19, 0x7d, 0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72,
+      0x19, 0xee, 0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2, 0x73,
+      0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b, 0x71, 0x16, 0xe6, 0x9e,
+      0x22, 0x22, 0x95, 0x16, 0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac,
+      0x09, 0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7};
+  static const uint8_t kCipher256[64] = {
+      0xf5, 0x8c, 0x4c, 0x04, 0xd6, 0xe5, 0xf1, 0xba, 0x77, 0x9e, 0xab,
+      0xfb, 0x5f, 0x7b, 0xfb, 0xd6, 0x9c, 0xfc, 0x4e, 0x96, 0x7e, 0xdb,
+      0x80, 0x8d, 0x67, 0x9f, 0x77, 0x7b, 0xc6, 0x70, 0x2c, 0x7d, 0x39,
+      0xf2, 0x33, 0x69, 0xa9, 0xd9, 0xba, 0xcf, 0xa5, 0x30, 0xe2, 0x63,
+      0x04, 0x23, 0x14, 0x61, 0xb2, 0xeb, 0x05, 0xe2, 0xc3, 0x9b, 0xe9,
+      0xfc, 0xda, 0x6c, 0x19, 0x07, 0x8c, 0x6a, 0x9d, 0x1b};
+  struct {
+    const uint8_t* key;
+    uint32_t key_size;
+    const uint8_t* cipher;
+  } const kTests[] = {{kKey128, sizeof(kKey128), kCipher128},
+                      {kKey256, sizeof(kKey256), kCipher256}};
+  for (const auto& test : kTests) {
+    CRYPT_aes_context context;
+    CRYPT_AESSetKey(&context, test.key, test.key_size);
+    uint8_t actual[64];
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESEncrypt(&context, actual, kPlain, sizeof(kPlain));
+    for (size_t i = 0; i < sizeof(actual); ++i)
+      EXPECT_EQ(test.cipher[i], actual[i]) << " at byte " << i;
+
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESDecrypt(&context, actual, test.cipher, sizeof(actual));
+    for (size_t i = 0; i < sizeof(actual); ++i)
+      EXPECT_EQ(kPlain[i], actual[i]) << " at byte " << i;
+
+    // The context carries the chaining value from one call to the next.
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESEncrypt(&context, actual, kPlain, 16);
+    CRYPT_AESEncrypt(&context, actual + 16, kPlain + 16, 48);
+    for (size_t i = 0; i < sizeof(actual); ++i)
+      EXPECT_EQ(test.cipher[i], actual[i]) << " at byte " << i;
+
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESDecrypt(&context, actual, test.cipher, 48);
+    CRYPT_AESDecrypt(&context, actual + 48, test.cipher + 48, 16);
+    for (size_t i = 0; i < sizeof(actual); ++i)
+      EXPECT_EQ(kPlain[i], actual[i]) << " at byte " << i;
+
+    // Decrypting in place.
+    memcpy(actual, test.cipher, sizeof(actual));
+    CRYPT_AESSetIV(&context, kIV);
+    CRYPT_AESDecrypt(&context, actual, actual, sizeof(actual));
+    for (size_t i = 0; i < sizeof(actual); ++i)
+      EXPECT_EQ(kPlain[i], actual[i]) << " at byte " << i;
+  }
+}
@@ -9,19 +9,32 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <set>
+#include <thread>
 #include <utility>
 
+#include "constants/page_object.h"
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
+#include "core/fpdfapi/edit/cpdf_stringarchivestream.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_crypto_handler.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_encryptor.h"
 #include "core/fpdfapi/parser/cpdf_flateencoder.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_object_walker.h"
 #include "core/fpdfapi/parser/cpdf_parser.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_security_handler.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
 #include "core/fpdfapi/parser/cpdf_syntax_parser.h"
+#include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "core/fpdfapi/parser/fpdf_parser_utility.h"
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_extension.h"
@@ -30,7 +43,10 @@
 #include "core/fxcrt/span_util.h"
 #include "core/fxcrt/stl_util.h"
 #include "third_party/base/check.h"
+#include "third_party/base/check_op.h"
 #include "third_party/base/containers/contains.h"
+#include "third_party/base/cxx17_backports.h"
+#include "third_party/base/numerics/safe_conversions.h"
 
 namespace {
 
@@ -122,8 +138,214 @@ bool OutputIndex(IFX_ArchiveStream* archive, FX_FILESIZE offset) {
          archive->WriteByte(0);
 }
 
+// Returns how many bytes it takes to store `value` big-endian.
+int ByteWidth(uint64_t value) {
+  int width = 1;
+  while (value >>= 8)
+    ++width;
+  return width;
+}
+
+void AppendBigEndian(uint64_t value, int width, DataVector<uint8_t>* data) {
+  for (int i = width - 1; i >= 0; --i)
+    data->push_back(static_cast<uint8_t>(value >> (8 * i)));
+}
+
+// Caps how much gets loaded ahead of the writer when compressing streams on
+// other threads.
+constexpr size_t kMaxBatchObjects = 1024;
+constexpr size_t kMaxBatchStreamBytes = 16 * 1024 * 1024;
+
+// Page attributes a page may inherit from the page tree. Linearized files
+// copy them into the page objects, so each page's section has everything the
+// page needs.
+const char* const kInheritablePageAttributes[] = {
+    pdfium::page_object::kResources, pdfium::page_object::kMediaBox,
+    pdfium::page_object::kCropBox, pdfium::page_object::kRotate};
+
+// Offsets in the linearization dictionary and the first page trailer are
+// padded to this many characters, so they take the same space whatever the
+// offsets turn out to be.
+constexpr size_t kPaddedNumberLength = 10;
+
+// Trailer entries the creator writes itself rather than copying them from the
+// original trailer.
+bool IsRewrittenTrailerKey(const ByteString& key) {
+  return key == "Encrypt" || key == "Size" || key == "Filter" ||
+         key == "Index" || key == "Length" || key == "Prev" || key == "W" ||
+         key == "XRefStm" || key == "ID" || key == "DecodeParms" ||
+         key == "Type";
+}
+
+ByteString PaddedNumber(FX_FILESIZE value) {
+  char buf[21] = {};
+  ByteString result(FXSYS_i64toa(value, buf, 10));
+  while (result.GetLength() < kPaddedNumberLength)
+    result += ' ';
+  return result;
+}
+
+ByteString XRefEntry(FX_FILESIZE offset) {
+  char buf[21] = {};
+  ByteString result(FXSYS_i64toa(offset, buf, 10));
+  while (result.GetLength() < 10)
+    result.InsertAtFront('0');
+  return result + " 00000 n\r\n";
+}
+
+// Points the references within `pObj` at the objects' new numbers. References
+// to objects that do not get written point at object 0, which is null. The
+// references are only good for writing afterwards.
+void RenumberReferences(CPDF_Object* pObj,
+                        CPDF_IndirectObjectHolder* pHolder,
+                        const std::map<uint32_t, uint32_t>& new_objnums) {
+  CPDF_NonConstObjectWalker walker(pObj);
+  while (CPDF_Object* pSub = walker.GetNext()) {
+    CPDF_Reference* pRef = pSub->AsReference();
+    if (!pRef)
+      continue;
+    auto it = new_objnums.find(pRef->GetRefObjNum());
+    pRef->SetRef(pHolder, it != new_objnums.end() ? it->second : 0);
+  }
+}
+
+// Returns how many bits it takes to store `value`, and at least 1.
+uint32_t BitWidth(uint32_t value) {
+  uint32_t width = 1;
+  while (value >>= 1)
+    ++width;
+  return width;
+}
+
+// Writes the bit fields of hint tables, most significant bit first.
+class HintTableWriter {
+ public:
+  void WriteBits(uint32_t value, uint32_t bits) {
+    for (uint32_t i = bits; i > 0; --i) {
+      if (m_BitPos == 0)
+        m_Data.push_back(0);
+      if ((value >> (i - 1)) & 1)
+        m_Data.back() |= 0x80 >> m_BitPos;
+      m_BitPos = (m_BitPos + 1) % 8;
+    }
+  }
+
+  void ByteAlign() { m_BitPos = 0; }
+
+  size_t size() const { return m_Data.size(); }
+  pdfium::span<const uint8_t> data() const { return m_Data; }
+
+ private:
+  DataVector<uint8_t> m_Data;
+  uint32_t m_BitPos = 0;
+};
+
 }  // namespace
 
+// Objects to write, whose streams get compressed on worker threads in the
+// meantime.
+class CPDF_Creator::ObjectBatch {
+ public:
+  struct Object {
+    uint32_t objnum;
+    RetainPtr<CPDF_Object> pObj;
+    // Whether the object got parsed just to be written.
+    bool bDeleteAfterWrite;
+  };
+
+  ObjectBatch() = default;
+  ~ObjectBatch() { WaitForCompression(); }
+
+  void AddObject(uint32_t objnum, CPDF_Object* pObj, bool bDeleteAfterWrite) {
+    m_Objects.push_back({objnum, pdfium::WrapRetain(pObj), bDeleteAfterWrite});
+  }
+
+  void AddStream(const CPDF_Stream* pStream,
+                 std::unique_ptr<CPDF_FlateEncoder> encoder) {
+    if (encoder->NeedsCompression())
+      m_PendingEncoders.push_back(encoder.get());
+    m_Encoders[pStream] = std::move(encoder);
+  }
+
+  void StartCompression(int thread_count) {
+    const size_t count = std::min<size_t>(std::max(thread_count, 1),
+                                          m_PendingEncoders.size());
+    for (size_t i = 0; i < count; ++i) {
+      m_Workers.emplace_back([this] {
+        for (size_t j = m_NextEncoder++; j < m_PendingEncoders.size();
+             j = m_NextEncoder++) {
+          if (!m_PendingEncoders[j]->Compress())
+            m_bCompressionFailed = true;
+        }
+      });
+    }
+  }
+
+  // Returns false if any of the batch's streams failed to compress.
+  bool WaitForCompression() {
+    for (std::thread& worker : m_Workers)
+      worker.join();
+    m_Workers.clear();
+    return !m_bCompressionFailed;
+  }
+
+  const std::vector<Object>& objects() const { return m_Objects; }
+
+  std::map<const CPDF_Stream*, std::unique_ptr<CPDF_FlateEncoder>>
+  TakeEncoders() {
+    DCHECK(m_Workers.empty());
+    return std::move(m_Encoders);
+  }
+
+ private:
+  std::vector<Object> m_Objects;
+  std::map<const CPDF_Stream*, std::unique_ptr<CPDF_FlateEncoder>> m_Encoders;
+  std::vector<CPDF_FlateEncoder*> m_PendingEncoders;
+  std::atomic<size_t> m_NextEncoder{0};
+  std::atomic<bool> m_bCompressionFailed{false};
+  std::vector<std::thread> m_Workers;
+};
+
+// Where each object of a linearized file goes, and what its hint tables say.
+// See ISO 32000-1:2008, annex F.
+struct CPDF_Creator::LinearizedPlan {
+  LinearizedPlan();
+  ~LinearizedPlan();
+
+  // The objects to write, by their current numbers.
+  std::map<uint32_t, const CPDF_Object*> objects;
+  // Objects that got parsed just to be written.
+  std::vector<uint32_t> parsed_objnums;
+  uint32_t catalog_objnum = 0;
+  // The first page section holds the catalog and the encryption dictionary,
+  // then the first page's page object and the objects it uses.
+  std::vector<uint32_t> first_page_objnums;
+  // The rest of the file holds the other pages' page objects and the objects
+  // only they use, page by page, then the objects several of them use, then
+  // the objects no page uses.
+  std::vector<uint32_t> other_objnums;
+  size_t shared_begin = 0;
+  size_t shared_end = 0;
+  // Per page, how many objects its section holds, and the shared object
+  // groups it uses. Each group is one object: the groups number the first
+  // page section's objects and then the shared objects.
+  std::vector<uint32_t> page_object_counts;
+  std::vector<std::vector<uint32_t>> page_shared_groups;
+  // Page tree attributes to copy into page objects, by page object number.
+  std::map<uint32_t,
+           std::vector<std::pair<ByteString, RetainPtr<const CPDF_Object>>>>
+      inherited_attributes;
+  // New object numbers, by current object number.
+  std::map<uint32_t, uint32_t> new_objnums;
+  uint32_t linearization_objnum = 0;
+  uint32_t hint_objnum = 0;
+  uint32_t size = 0;
+};
+
+CPDF_Creator::LinearizedPlan::LinearizedPlan() = default;
+
+CPDF_Creator::LinearizedPlan::~LinearizedPlan() = default;
+
 CPDF_Creator::CPDF_Creator(CPDF_Document* pDoc,
                            RetainPtr<IFX_RetainableWriteStream> archive)
     : m_pDocument(pDoc),
@@ -143,25 +365,43 @@ bool CPDF_Creator::WriteIndirectObj(uint32_t objnum, const CPDF_Object* pObj) {
   if (GetCryptoHandler() && pObj != m_pEncryptDict)
     encryptor = std::make_unique<CPDF_Encryptor>(GetCryptoHandler(), objnum);
 
-  if (!pObj->WriteTo(m_Archive.get(), encryptor.get()))
+  const CPDF_Stream* pStream = pObj->AsStream();
+  if (pStream ? !WriteStream(pStream, encryptor.get())
+              : !pObj->WriteTo(m_Archive.get(), encryptor.get())) {
     return false;
+  }
 
   return m_Archive->WriteString("\r\nendobj\r\n");
 }
 
+bool CPDF_Creator::WriteStream(const CPDF_Stream* pStream,
+                               const CPDF_Encryptor* pEncryptor) {
+  std::unique_ptr<CPDF_FlateEncoder> encoder;
+  auto it = m_CompressedStreams.find(pStream);
+  if (it != m_CompressedStreams.end()) {
+    encoder = std::move(it->second);
+    m_CompressedStreams.erase(it);
+  } else {
+    encoder = pStream->CreateEncoder(m_CompressionOptions);
+    if (!encoder->Compress())
+      return false;
+  }
+  if (RefersToDuplicate(pStream->GetDict())) {
+    encoder->CloneDict();
+    RedirectReferences(encoder->GetClonedDict());
+  }
+  return pStream->WriteEncodedTo(m_Archive.get(), pEncryptor, encoder.get());
+}
+
 bool CPDF_Creator::WriteOldIndirectObject(uint32_t objnum) {
   if (m_pParser->IsObjectFreeOrNull(objnum))
     return true;
 
-  m_ObjectOffsets[objnum] = m_Archive->CurrentOffset();
-
   bool bExistInMap = !!m_pDocument->GetIndirectObject(objnum);
   CPDF_Object* pObj = m_pDocument->GetOrParseIndirectObject(objnum);
-  if (!pObj) {
-    m_ObjectOffsets.erase(objnum);
+  if (!pObj)
     return true;
-  }
-  if (!WriteIndirectObj(pObj->GetObjNum(), pObj))
+  if (!WriteOrPackIndirectObj(pObj->GetObjNum(), pObj))
     return false;
   if (!bExistInMap)
     m_pDocument->DeleteIndirectObject(objnum);
@@ -173,6 +413,13 @@ bool CPDF_Creator::WriteOldObjs() {
   if (!m_pParser->IsValidObjectNumber(nLastObjNum))
     return true;
 
+  if (m_ThreadCount > 1) {
+    std::vector<uint32_t> objnums;
+    for (uint32_t objnum = m_CurObjNum; objnum <= nLastObjNum; ++objnum)
+      objnums.push_back(objnum);
+    return WriteObjsPipelined(objnums, /*bOld=*/true);
+  }
+
   for (uint32_t objnum = m_CurObjNum; objnum <= nLastObjNum; ++objnum) {
     if (!WriteOldIndirectObject(objnum))
       return false;
@@ -181,28 +428,265 @@ bool CPDF_Creator::WriteOldObjs() {
 }
 
 bool CPDF_Creator::WriteNewObjs() {
+  if (m_ThreadCount > 1) {
+    return WriteObjsPipelined(
+        pdfium::make_span(m_NewObjNumArray).subspan(m_CurObjNum),
+        /*bOld=*/false);
+  }
+
   for (size_t i = m_CurObjNum; i < m_NewObjNumArray.size(); ++i) {
     uint32_t objnum = m_NewObjNumArray[i];
     CPDF_Object* pObj = m_pDocument->GetIndirectObject(objnum);
     if (!pObj)
       continue;
 
-    m_ObjectOffsets[objnum] = m_Archive->CurrentOffset();
-    if (!WriteIndirectObj(pObj->GetObjNum(), pObj))
+    if (!WriteOrPackIndirectObj(pObj->GetObjNum(), pObj))
+      return false;
+  }
+  return true;
+}
+
+bool CPDF_Creator::WriteObjsPipelined(pdfium::span<const uint32_t> objnums,
+                                      bool bOld) {
+  std::unique_ptr<ObjectBatch> batch = StartObjectBatch(&objnums, bOld);
+  while (batch) {
+    std::unique_ptr<ObjectBatch> next_batch =
+        objnums.empty() ? nullptr : StartObjectBatch(&objnums, bOld);
+    if (!FinishObjectBatch(batch.get()))
+      return false;
+    batch = std::move(next_batch);
+  }
+  return true;
+}
+
+std::unique_ptr<CPDF_Creator::ObjectBatch> CPDF_Creator::StartObjectBatch(
+    pdfium::span<const uint32_t>* objnums,
+    bool bOld) {
+  auto batch = std::make_unique<ObjectBatch>();
+  size_t stream_bytes = 0;
+  size_t i = 0;
+  for (; i < objnums->size() && batch->objects().size() < kMaxBatchObjects &&
+         stream_bytes < kMaxBatchStreamBytes;
+       ++i) {
+    const uint32_t objnum = (*objnums)[i];
+    CPDF_Object* pObj;
+    bool bDeleteAfterWrite = false;
+    if (bOld) {
+      if (m_pParser->IsObjectFreeOrNull(objnum))
+        continue;
+      bDeleteAfterWrite = !m_pDocument->GetIndirectObject(objnum);
+      pObj = m_pDocument->GetOrParseIndirectObject(objnum);
+    } else {
+      pObj = m_pDocument->GetIndirectObject(objnum);
+    }
+    if (!pObj)
+      continue;
+
+    batch->AddObject(objnum, pObj, bDeleteAfterWrite);
+    const CPDF_Stream* pStream = pObj->AsStream();
+    if (pStream) {
+      // Loads the stream's data here, as only compression is thread-safe.
+      batch->AddStream(pStream, pStream->CreateEncoder(m_CompressionOptions));
+      stream_bytes += pStream->GetRawSize();
+    }
+  }
+  *objnums = objnums->subspan(i);
+  // The calling thread writes the previous batch meanwhile.
+  batch->StartCompression(m_ThreadCount - 1);
+  return batch;
+}
+
+bool CPDF_Creator::FinishObjectBatch(ObjectBatch* batch) {
+  if (!batch->WaitForCompression())
+    return false;
+
+  m_CompressedStreams = batch->TakeEncoders();
+  for (const ObjectBatch::Object& object : batch->objects()) {
+    if (!WriteOrPackIndirectObj(object.pObj->GetObjNum(), object.pObj.Get()))
       return false;
+    if (object.bDeleteAfterWrite)
+      m_pDocument->DeleteIndirectObject(object.objnum);
   }
+  m_CompressedStreams.clear();
   return true;
 }
 
+bool CPDF_Creator::WriteOrPackIndirectObj(uint32_t objnum,
+                                          const CPDF_Object* pObj) {
+  if (pdfium::Contains(m_DuplicateObjNums, objnum))
+    return true;
+
+  RetainPtr<CPDF_Object> pRedirected;
+  if (!pObj->IsStream() && pObj != m_pEncryptDict &&
+      RefersToDuplicate(pObj)) {
+    pRedirected = pObj->Clone();
+    RedirectReferences(pRedirected.Get());
+    pObj = pRedirected.Get();
+  }
+  if (CanPackObject(pObj))
+    return PackObject(objnum, pObj);
+
+  m_ObjectOffsets[objnum] = m_Archive->CurrentOffset();
+  return WriteIndirectObj(objnum, pObj);
+}
+
+bool CPDF_Creator::UseObjectStreams() const {
+  return m_ObjectsPerStream > 0 && !m_IsIncremental && !m_bLinearize;
+}
+
+bool CPDF_Creator::CanPackObject(const CPDF_Object* pObj) const {
+  // Streams cannot go in object streams, even when malformed files nest them
+  // in other objects. Neither can the encryption dictionary, whose strings
+  // must stay unencrypted.
+  if (!UseObjectStreams() || pObj == m_pEncryptDict)
+    return false;
+
+  CPDF_ObjectWalker walker(pObj);
+  while (const CPDF_Object* pSubObj = walker.GetNext()) {
+    if (pSubObj->IsStream())
+      return false;
+  }
+  return true;
+}
+
+bool CPDF_Creator::PackObject(uint32_t objnum, const CPDF_Object* pObj) {
+  // Objects in an object stream are encrypted along with the whole stream,
+  // not one by one.
+  m_PendingObjStmObjects.emplace_back(objnum, m_PendingObjStmData.tellp());
+  CPDF_StringArchiveStream archive(&m_PendingObjStmData);
+  if (!pObj->WriteTo(&archive, nullptr) || !archive.WriteString("\n"))
+    return false;
+
+  if (m_PendingObjStmObjects.size() < m_ObjectsPerStream)
+    return true;
+  return WriteObjectStream();
+}
+
+bool CPDF_Creator::WriteObjectStream() {
+  if (m_PendingObjStmObjects.empty())
+    return true;
+
+  const uint32_t stream_objnum = ++m_dwLastObjNum;
+  fxcrt::ostringstream header;
+  for (size_t i = 0; i < m_PendingObjStmObjects.size(); ++i) {
+    const auto& object = m_PendingObjStmObjects[i];
+    header << object.first << " " << object.second << " ";
+    m_PackedObjects[object.first] = {stream_objnum, static_cast<uint32_t>(i)};
+  }
+  header << "\n";
+  const size_t first = header.tellp();
+  header << m_PendingObjStmData.str();
+
+  auto pDict = pdfium::MakeRetain<CPDF_Dictionary>();
+  pDict->SetNewFor<CPDF_Name>("Type", "ObjStm");
+  pDict->SetNewFor<CPDF_Number>(
+      "N", static_cast<int>(m_PendingObjStmObjects.size()));
+  pDict->SetNewFor<CPDF_Number>("First", static_cast<int>(first));
+  auto pStream = pdfium::MakeRetain<CPDF_Stream>(
+      DataVector<uint8_t>(), std::move(pDict));
+  pStream->SetDataFromStringstream(&header);
+
+  m_PendingObjStmObjects.clear();
+  m_PendingObjStmData.str("");
+  m_ObjectOffsets[stream_objnum] = m_Archive->CurrentOffset();
+  return WriteIndirectObj(stream_objnum, pStream.Get());
+}
+
+void CPDF_Creator::GatherObjects(
+    std::map<uint32_t, const CPDF_Object*>* objects,
+    std::vector<uint32_t>* parsed_objnums) {
+  // Gather the objects a plain save would write, bar the original encryption
+  // dictionary, which gets written from `m_pEncryptDict` if at all.
+  const CPDF_Dictionary* pOldEncryptDict =
+      m_pParser ? m_pParser->GetEncryptDict() : nullptr;
+  const uint32_t old_encrypt_objnum =
+      pOldEncryptDict ? pOldEncryptDict->GetObjNum() : 0;
+  if (m_pParser && m_pParser->IsValidObjectNumber(m_pParser->GetLastObjNum())) {
+    for (uint32_t objnum = 1; objnum <= m_pParser->GetLastObjNum(); ++objnum) {
+      if (objnum == old_encrypt_objnum ||
+          m_pParser->IsObjectFreeOrNull(objnum)) {
+        continue;
+      }
+      bool bExistInMap = !!m_pDocument->GetIndirectObject(objnum);
+      const CPDF_Object* pObj = m_pDocument->GetOrParseIndirectObject(objnum);
+      if (!pObj)
+        continue;
+      if (!bExistInMap)
+        parsed_objnums->push_back(objnum);
+      (*objects)[objnum] = pObj;
+    }
+  }
+  for (uint32_t objnum : m_NewObjNumArray) {
+    const CPDF_Object* pObj = m_pDocument->GetIndirectObject(objnum);
+    if (pObj)
+      (*objects)[objnum] = pObj;
+  }
+}
+
+void CPDF_Creator::FindDuplicateObjects() {
+  std::map<uint32_t, const CPDF_Object*> objects;
+  std::vector<uint32_t> parsed_objnums;
+  GatherObjects(&objects, &parsed_objnums);
+
+  // The trailer gets written as is, so the objects it refers to stay.
+  if (m_pParser) {
+    RetainPtr<CPDF_Dictionary> pTrailer = m_pParser->GetCombinedTrailer();
+    CPDF_ObjectWalker walker(pTrailer.Get());
+    while (const CPDF_Object* pObj = walker.GetNext()) {
+      if (const CPDF_Reference* pRef = pObj->AsReference())
+        objects.erase(pRef->GetRefObjNum());
+    }
+  } else {
+    objects.erase(m_pDocument->GetRoot()->GetObjNum());
+    if (m_pDocument->GetInfo())
+      objects.erase(m_pDocument->GetInfo()->GetObjNum());
+  }
+
+  m_DuplicateObjNums = CPDF_ObjectDeduplicator::FindDuplicates(objects);
+  for (uint32_t objnum : parsed_objnums)
+    m_pDocument->DeleteIndirectObject(objnum);
+}
+
+uint32_t CPDF_Creator::GetWrittenObjNum(uint32_t objnum) const {
+  auto it = m_DuplicateObjNums.find(objnum);
+  return it != m_DuplicateObjNums.end() ? it->second : objnum;
+}
+
+bool CPDF_Creator::RefersToDuplicate(const CPDF_Object* pObj) const {
+  if (m_DuplicateObjNums.empty())
+    return false;
+
+  CPDF_ObjectWalker walker(pObj);
+  while (const CPDF_Object* pSubObj = walker.GetNext()) {
+    const CPDF_Reference* pRef = pSubObj->AsReference();
+    if (pRef && pdfium::Contains(m_DuplicateObjNums, pRef->GetRefObjNum()))
+      return true;
+  }
+  return false;
+}
+
+void CPDF_Creator::RedirectReferences(CPDF_Object* pObj) {
+  CPDF_NonConstObjectWalker walker(pObj);
+  while (CPDF_Object* pSubObj = walker.GetNext()) {
+    CPDF_Reference* pRef = pSubObj->AsReference();
+    if (pRef) {
+      pRef->SetRef(m_pDocument.Get(),
+                   GetWrittenObjNum(pRef->GetRefObjNum()));
+    }
+  }
+}
+
 void CPDF_Creator::InitNewObjNumOffsets() {
   for (const auto& pair : *m_pDocument) {
     const uint32_t objnum = pair.first;
-    if (m_IsIncremental ||
-        pair.second->GetObjNum() == CPDF_Object::kInvalidObjNum) {
+    if (pair.second->GetObjNum() == CPDF_Object::kInvalidObjNum)
       continue;
-    }
+    // Full saves write the objects from the file along with the others.
+    // Incremental saves write those that changed since they got parsed, which
+    // their objects keep track of. Only loaded objects can have changed.
     if (m_pParser && m_pParser->IsValidObjectNumber(objnum) &&
-        !m_pParser->IsObjectFree(objnum)) {
+        !m_pParser->IsObjectFree(objnum) &&
+        (!m_IsIncremental || !pair.second->IsModified())) {
       continue;
     }
     m_NewObjNumArray.insert(std::lower_bound(m_NewObjNumArray.begin(),
@@ -231,6 +715,9 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage1() {
         version = m_FileVersion;
       else if (m_pParser)
         version = m_pParser->GetFileVersion();
+      // Object streams and cross-reference streams need PDF 1.5.
+      if (UseObjectStreams() && version % 10 < 5)
+        version = 15;
 
       if (!m_Archive->WriteDWord(version % 10) ||
           !m_Archive->WriteString("\r\n%\xA1\xB3\xC5\xD7\r\n")) {
@@ -276,6 +763,21 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage1() {
 CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage2() {
   DCHECK(m_iStage >= Stage::kInitWriteObjs20 ||
          m_iStage < Stage::kInitWriteXRefs80);
+  if (m_iStage == Stage::kInitWriteObjs20 && m_bDeduplicate &&
+      !m_IsIncremental) {
+    FindDuplicateObjects();
+  }
+  if (m_iStage == Stage::kInitWriteObjs20 && m_bLinearize && !m_IsIncremental) {
+    LinearizedPlan plan;
+    const bool bPlanned = PlanLinearization(&plan);
+    const bool bWritten = bPlanned && WriteLinearized(plan);
+    for (uint32_t objnum : plan.parsed_objnums)
+      m_pDocument->DeleteIndirectObject(objnum);
+    if (bPlanned) {
+      m_iStage = bWritten ? Stage::kComplete100 : Stage::kInvalid;
+      return m_iStage;
+    }
+  }
   if (m_iStage == Stage::kInitWriteObjs20) {
     if (!m_IsIncremental && m_pParser) {
       m_CurObjNum = 0;
@@ -295,7 +797,7 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage2() {
     m_iStage = Stage::kWriteNewObjs26;
   }
   if (m_iStage == Stage::kWriteNewObjs26) {
-    if (!WriteNewObjs())
+    if (!WriteNewObjs() || !WriteObjectStream())
       return Stage::kInvalid;
 
     m_iStage = Stage::kWriteEncryptDict27;
@@ -303,6 +805,7 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage2() {
   if (m_iStage == Stage::kWriteEncryptDict27) {
     if (m_pEncryptDict && m_pEncryptDict->IsInline()) {
       m_dwLastObjNum += 1;
+      m_EncryptDictObjNum = m_dwLastObjNum;
       FX_FILESIZE saveOffset = m_Archive->CurrentOffset();
       if (!WriteIndirectObj(m_dwLastObjNum, m_pEncryptDict.Get()))
         return Stage::kInvalid;
@@ -323,7 +826,10 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage3() {
   uint32_t dwLastObjNum = m_dwLastObjNum;
   if (m_iStage == Stage::kInitWriteXRefs80) {
     m_XrefStart = m_Archive->CurrentOffset();
-    if (!m_IsIncremental || !m_pParser->IsXRefStream()) {
+    if (UseObjectStreams()) {
+      // Written along with the trailer, as a cross-reference stream.
+      m_iStage = Stage::kWriteTrailerAndFinish90;
+    } else if (!m_IsIncremental || !m_pParser->IsXRefStream()) {
       if (!m_IsIncremental || m_pParser->GetLastXRefOffset() == 0) {
         ByteString str;
         str = pdfium::Contains(m_ObjectOffsets, 1)
@@ -417,6 +923,9 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage3() {
 CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage4() {
   DCHECK(m_iStage >= Stage::kWriteTrailerAndFinish90);
 
+  if (UseObjectStreams())
+    return WriteXRefStream();
+
   bool bXRefStream = m_IsIncremental && m_pParser->IsXRefStream();
   if (!bXRefStream) {
     if (!m_Archive->WriteString("trailer\r\n<<"))
@@ -428,69 +937,8 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage4() {
     }
   }
 
-  if (m_pParser) {
-    RetainPtr<CPDF_Dictionary> p = m_pParser->GetCombinedTrailer();
-    CPDF_DictionaryLocker locker(p.Get());
-    for (const auto& it : locker) {
-      const ByteString& key = it.first;
-      CPDF_Object* pValue = it.second.Get();
-      if (key == "Encrypt" || key == "Size" || key == "Filter" ||
-          key == "Index" || key == "Length" || key == "Prev" || key == "W" ||
-          key == "XRefStm" || key == "ID" || key == "DecodeParms" ||
-          key == "Type") {
-        continue;
-      }
-      if (!m_Archive->WriteString(("/")) ||
-          !m_Archive->WriteString(PDF_NameEncode(key).AsStringView())) {
-        return Stage::kInvalid;
-      }
-      if (!pValue->WriteTo(m_Archive.get(), nullptr))
-        return Stage::kInvalid;
-    }
-  } else {
-    if (!m_Archive->WriteString("\r\n/Root ") ||
-        !m_Archive->WriteDWord(m_pDocument->GetRoot()->GetObjNum()) ||
-        !m_Archive->WriteString(" 0 R\r\n")) {
-      return Stage::kInvalid;
-    }
-    if (m_pDocument->GetInfo()) {
-      if (!m_Archive->WriteString("/Info ") ||
-          !m_Archive->WriteDWord(m_pDocument->GetInfo()->GetObjNum()) ||
-          !m_Archive->WriteString(" 0 R\r\n")) {
-        return Stage::kInvalid;
-      }
-    }
-  }
-  if (m_pEncryptDict) {
-    if (!m_Archive->WriteString("/Encrypt"))
-      return Stage::kInvalid;
-
-    uint32_t dwObjNum = m_pEncryptDict->GetObjNum();
-    if (dwObjNum == 0)
-      dwObjNum = m_pDocument->GetLastObjNum() + 1;
-    if (!m_Archive->WriteString(" ") || !m_Archive->WriteDWord(dwObjNum) ||
-        !m_Archive->WriteString(" 0 R ")) {
-      return Stage::kInvalid;
-    }
-  }
-
-  if (!m_Archive->WriteString("/Size ") ||
-      !m_Archive->WriteDWord(m_dwLastObjNum + (bXRefStream ? 2 : 1))) {
+  if (!WriteTrailerEntries(m_dwLastObjNum + (bXRefStream ? 2 : 1)))
     return Stage::kInvalid;
-  }
-  if (m_IsIncremental) {
-    FX_FILESIZE prev = m_pParser->GetLastXRefOffset();
-    if (prev) {
-      if (!m_Archive->WriteString("/Prev ") || !m_Archive->WriteFilesize(prev))
-        return Stage::kInvalid;
-    }
-  }
-  if (m_pIDArray) {
-    if (!m_Archive->WriteString(("/ID")) ||
-        !m_pIDArray->WriteTo(m_Archive.get(), nullptr)) {
-      return Stage::kInvalid;
-    }
-  }
   if (!bXRefStream) {
     if (!m_Archive->WriteString(">>"))
       return Stage::kInvalid;
@@ -550,6 +998,631 @@ CPDF_Creator::Stage CPDF_Creator::WriteDoc_Stage4() {
   return m_iStage;
 }
 
+bool CPDF_Creator::WriteTrailerEntries(uint32_t size) {
+  if (m_pParser) {
+    RetainPtr<CPDF_Dictionary> p = m_pParser->GetCombinedTrailer();
+    CPDF_DictionaryLocker locker(p.Get());
+    for (const auto& it : locker) {
+      const ByteString& key = it.first;
+      CPDF_Object* pValue = it.second.Get();
+      if (IsRewrittenTrailerKey(key))
+        continue;
+      if (!m_Archive->WriteString(("/")) ||
+          !m_Archive->WriteString(PDF_NameEncode(key).AsStringView())) {
+        return false;
+      }
+      if (!pValue->WriteTo(m_Archive.get(), nullptr))
+        return false;
+    }
+  } else {
+    if (!m_Archive->WriteString("\r\n/Root ") ||
+        !m_Archive->WriteDWord(m_pDocument->GetRoot()->GetObjNum()) ||
+        !m_Archive->WriteString(" 0 R\r\n")) {
+      return false;
+    }
+    if (m_pDocument->GetInfo()) {
+      if (!m_Archive->WriteString("/Info ") ||
+          !m_Archive->WriteDWord(m_pDocument->GetInfo()->GetObjNum()) ||
+          !m_Archive->WriteString(" 0 R\r\n")) {
+        return false;
+      }
+    }
+  }
+  if (m_pEncryptDict) {
+    if (!m_Archive->WriteString("/Encrypt"))
+      return false;
+
+    uint32_t dwObjNum = m_pEncryptDict->GetObjNum();
+    if (dwObjNum == 0)
+      dwObjNum = m_EncryptDictObjNum;
+    if (!m_Archive->WriteString(" ") || !m_Archive->WriteDWord(dwObjNum) ||
+        !m_Archive->WriteString(" 0 R ")) {
+      return false;
+    }
+  }
+
+  if (!m_Archive->WriteString("/Size ") || !m_Archive->WriteDWord(size))
+    return false;
+  if (m_IsIncremental) {
+    FX_FILESIZE prev = m_pParser->GetLastXRefOffset();
+    if (prev) {
+      if (!m_Archive->WriteString("/Prev ") || !m_Archive->WriteFilesize(prev))
+        return false;
+    }
+  }
+  if (m_pIDArray) {
+    if (!m_Archive->WriteString(("/ID")) ||
+        !m_pIDArray->WriteTo(m_Archive.get(), nullptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+CPDF_Creator::Stage CPDF_Creator::WriteXRefStream() {
+  const uint32_t xref_objnum = ++m_dwLastObjNum;
+  m_ObjectOffsets[xref_objnum] = m_XrefStart;
+
+  // Type 1 entries hold offsets and type 2 entries hold object stream numbers
+  // in the second field. The third field holds object stream indices, and
+  // the generation number of the free list head.
+  uint64_t max_field2 = m_dwLastObjNum;
+  if (!m_ObjectOffsets.empty()) {
+    max_field2 = std::max<uint64_t>(max_field2,
+                                    m_ObjectOffsets.rbegin()->second);
+  }
+  const int field2_width = ByteWidth(max_field2);
+  const int field3_width = ByteWidth(
+      std::max<uint32_t>(m_ObjectsPerStream - 1, 0xFFFF));
+
+  DataVector<uint8_t> entries;
+  entries.reserve((m_dwLastObjNum + 1) * (1 + field2_width + field3_width));
+  for (uint32_t objnum = 0; objnum <= m_dwLastObjNum; ++objnum) {
+    auto offset_it = m_ObjectOffsets.find(objnum);
+    if (offset_it != m_ObjectOffsets.end()) {
+      AppendBigEndian(1, 1, &entries);
+      AppendBigEndian(offset_it->second, field2_width, &entries);
+      AppendBigEndian(0, field3_width, &entries);
+      continue;
+    }
+    auto packed_it = m_PackedObjects.find(objnum);
+    if (packed_it != m_PackedObjects.end()) {
+      AppendBigEndian(2, 1, &entries);
+      AppendBigEndian(packed_it->second.first, field2_width, &entries);
+      AppendBigEndian(packed_it->second.second, field3_width, &entries);
+      continue;
+    }
+    AppendBigEndian(0, 1, &entries);
+    AppendBigEndian(0, field2_width, &entries);
+    AppendBigEndian(objnum == 0 ? 0xFFFF : 0, field3_width, &entries);
+  }
+
+  std::unique_ptr<uint8_t, FxFreeDeleter> compressed;
+  uint32_t compressed_size = 0;
+  if (!FlateEncode(entries, m_CompressionOptions, &compressed,
+                   &compressed_size)) {
+    return Stage::kInvalid;
+  }
+
+  if (!m_Archive->WriteDWord(xref_objnum) ||
+      !m_Archive->WriteString(" 0 obj\r\n<<") ||
+      !WriteTrailerEntries(m_dwLastObjNum + 1) ||
+      !m_Archive->WriteString("/Type/XRef/W[1 ") ||
+      !m_Archive->WriteDWord(field2_width) ||
+      !m_Archive->WriteString(" ") || !m_Archive->WriteDWord(field3_width) ||
+      !m_Archive->WriteString("]/Filter/FlateDecode/Length ") ||
+      !m_Archive->WriteDWord(compressed_size) ||
+      !m_Archive->WriteString(">>stream\r\n") ||
+      !m_Archive->WriteBlock(compressed.get(), compressed_size) ||
+      !m_Archive->WriteString("\r\nendstream\r\nendobj\r\n") ||
+      !m_Archive->WriteString("startxref\r\n") ||
+      !m_Archive->WriteFilesize(m_XrefStart) ||
+      !m_Archive->WriteString("\r\n%%EOF\r\n")) {
+    return Stage::kInvalid;
+  }
+
+  m_iStage = Stage::kComplete100;
+  return m_iStage;
+}
+
+bool CPDF_Creator::PlanLinearization(LinearizedPlan* plan) {
+  const CPDF_Dictionary* pRoot = m_pDocument->GetRoot();
+  const int page_count = m_pDocument->GetPageCount();
+  if (!pRoot || page_count <= 0)
+    return false;
+
+  GatherObjects(&plan->objects, &plan->parsed_objnums);
+  for (const auto& it : m_DuplicateObjNums)
+    plan->objects.erase(it.first);
+
+  plan->catalog_objnum = pRoot->GetObjNum();
+  if (!pdfium::Contains(plan->objects, plan->catalog_objnum))
+    return false;
+
+  // Pages and page tree nodes belong to no other page.
+  std::vector<const CPDF_Dictionary*> pages;
+  std::set<uint32_t> stop_objnums = {plan->catalog_objnum};
+  for (int i = 0; i < page_count; ++i) {
+    const CPDF_Dictionary* pPage = m_pDocument->GetPageDictionary(i);
+    if (!pPage || !pdfium::Contains(plan->objects, pPage->GetObjNum()) ||
+        !stop_objnums.insert(pPage->GetObjNum()).second) {
+      return false;
+    }
+    pages.push_back(pPage);
+  }
+  for (const CPDF_Dictionary* pPage : pages) {
+    auto& inherited = plan->inherited_attributes[pPage->GetObjNum()];
+    std::set<const CPDF_Dictionary*> visited = {pPage};
+    const CPDF_Dictionary* pNode =
+        pPage->GetDictFor(pdfium::page_object::kParent);
+    while (pNode && visited.insert(pNode).second) {
+      stop_objnums.insert(pNode->GetObjNum());
+      for (const char* key : kInheritablePageAttributes) {
+        if (pPage->KeyExist(key) || !pNode->KeyExist(key))
+          continue;
+        auto it = std::find_if(inherited.begin(), inherited.end(),
+                               [key](const auto& attribute) {
+                                 return attribute.first == key;
+                               });
+        if (it == inherited.end()) {
+          inherited.emplace_back(key,
+                                 pdfium::WrapRetain(pNode->GetObjectFor(key)));
+        }
+      }
+      pNode = pNode->GetDictFor(pdfium::page_object::kParent);
+    }
+  }
+
+  // Find the objects each page uses, in the order it reaches them.
+  std::vector<std::vector<uint32_t>> page_objnums(page_count);
+  for (int i = 0; i < page_count; ++i) {
+    std::vector<uint32_t>& reached = page_objnums[i];
+    std::set<uint32_t> seen = {pages[i]->GetObjNum()};
+    reached.push_back(pages[i]->GetObjNum());
+    auto walk = [&](const CPDF_Object* pObj) {
+      CPDF_ObjectWalker walker(pObj);
+      while (const CPDF_Object* pSub = walker.GetNext()) {
+        const CPDF_Reference* pRef = pSub->AsReference();
+        if (!pRef)
+          continue;
+        const uint32_t objnum = GetWrittenObjNum(pRef->GetRefObjNum());
+        if (pdfium::Contains(stop_objnums, objnum) ||
+            !pdfium::Contains(plan->objects, objnum) ||
+            !seen.insert(objnum).second) {
+          continue;
+        }
+        reached.push_back(objnum);
+      }
+    };
+    for (const auto& attribute :
+         plan->inherited_attributes[pages[i]->GetObjNum()]) {
+      walk(attribute.second.Get());
+    }
+    for (size_t j = 0; j < reached.size(); ++j)
+      walk(plan->objects[reached[j]]);
+  }
+
+  // The first page section holds everything the first page uses. Of the rest,
+  // objects one page uses go in that page's section, and objects several
+  // pages use go in the shared objects section.
+  plan->first_page_objnums = page_objnums[0];
+  std::map<uint32_t, uint32_t> groups;
+  for (size_t i = 0; i < plan->first_page_objnums.size(); ++i)
+    groups[plan->first_page_objnums[i]] = static_cast<uint32_t>(i);
+  const size_t first_page_group_count = groups.size();
+  std::map<uint32_t, int> users;
+  for (int i = 1; i < page_count; ++i) {
+    for (uint32_t objnum : page_objnums[i])
+      ++users[objnum];
+  }
+
+  plan->page_object_counts.resize(page_count);
+  plan->page_object_counts[0] =
+      fxcrt::CollectionSize<uint32_t>(plan->first_page_objnums);
+  for (int i = 1; i < page_count; ++i) {
+    const size_t page_begin = plan->other_objnums.size();
+    for (uint32_t objnum : page_objnums[i]) {
+      if (!pdfium::Contains(groups, objnum) && users[objnum] == 1)
+        plan->other_objnums.push_back(objnum);
+    }
+    plan->page_object_counts[i] = pdfium::base::checked_cast<uint32_t>(
+        plan->other_objnums.size() - page_begin);
+  }
+  plan->shared_begin = plan->other_objnums.size();
+  for (int i = 1; i < page_count; ++i) {
+    for (uint32_t objnum : page_objnums[i]) {
+      if (users[objnum] > 1 && !pdfium::Contains(groups, objnum)) {
+        groups[objnum] = static_cast<uint32_t>(
+            first_page_group_count + plan->other_objnums.size() -
+            plan->shared_begin);
+        plan->other_objnums.push_back(objnum);
+      }
+    }
+  }
+  plan->shared_end = plan->other_objnums.size();
+  for (const auto& it : plan->objects) {
+    if (it.first != plan->catalog_objnum &&
+        !pdfium::Contains(groups, it.first) &&
+        !pdfium::Contains(users, it.first)) {
+      plan->other_objnums.push_back(it.first);
+    }
+  }
+
+  plan->page_shared_groups.resize(page_count);
+  for (uint32_t objnum : plan->first_page_objnums) {
+    if (pdfium::Contains(users, objnum))
+      plan->page_shared_groups[0].push_back(groups[objnum]);
+  }
+  for (int i = 1; i < page_count; ++i) {
+    for (uint32_t objnum : page_objnums[i]) {
+      auto it = groups.find(objnum);
+      if (it != groups.end())
+        plan->page_shared_groups[i].push_back(it->second);
+    }
+  }
+
+  // Number the objects in the order they get written, the first page section
+  // last.
+  uint32_t next_objnum = 1;
+  for (uint32_t objnum : plan->other_objnums)
+    plan->new_objnums[objnum] = next_objnum++;
+  plan->linearization_objnum = next_objnum++;
+  plan->new_objnums[plan->catalog_objnum] = next_objnum++;
+  if (m_pEncryptDict)
+    m_EncryptDictObjNum = next_objnum++;
+  plan->hint_objnum = next_objnum++;
+  for (uint32_t objnum : plan->first_page_objnums)
+    plan->new_objnums[objnum] = next_objnum++;
+  for (const auto& it : m_DuplicateObjNums) {
+    auto new_it = plan->new_objnums.find(it.second);
+    if (new_it != plan->new_objnums.end())
+      plan->new_objnums[it.first] = new_it->second;
+  }
+  plan->size = next_objnum;
+  return true;
+}
+
+bool CPDF_Creator::SerializeLinearizedObject(const LinearizedPlan& plan,
+                                             uint32_t objnum,
+                                             const CPDF_Object* pObj,
+                                             fxcrt::string* result) {
+  fxcrt::ostringstream buffer;
+  CPDF_StringArchiveStream archive(&buffer);
+  if (!archive.WriteDWord(objnum) || !archive.WriteString(" 0 obj\r\n"))
+    return false;
+
+  std::unique_ptr<CPDF_Encryptor> encryptor;
+  if (GetCryptoHandler() && pObj != m_pEncryptDict)
+    encryptor = std::make_unique<CPDF_Encryptor>(GetCryptoHandler(), objnum);
+
+  const CPDF_Stream* pStream = pObj->AsStream();
+  if (pStream) {
+    std::unique_ptr<CPDF_FlateEncoder> encoder =
+        pStream->CreateEncoder(m_CompressionOptions);
+    if (!encoder->Compress())
+      return false;
+    encoder->CloneDict();
+    RenumberReferences(encoder->GetClonedDict(), m_pDocument.Get(),
+                       plan.new_objnums);
+    if (!pStream->WriteEncodedTo(&archive, encryptor.get(), encoder.get()))
+      return false;
+  } else {
+    RetainPtr<CPDF_Object> pClone = pObj->Clone();
+    auto it = plan.inherited_attributes.find(pObj->GetObjNum());
+    if (it != plan.inherited_attributes.end()) {
+      CPDF_Dictionary* pDict = pClone->AsDictionary();
+      for (const auto& attribute : it->second)
+        pDict->SetFor(attribute.first, attribute.second->Clone());
+    }
+    RenumberReferences(pClone.Get(), m_pDocument.Get(), plan.new_objnums);
+    if (!pClone->WriteTo(&archive, encryptor.get()))
+      return false;
+  }
+  if (!archive.WriteString("\r\nendobj\r\n"))
+    return false;
+
+  *result = buffer.str();
+  return true;
+}
+
+fxcrt::string CPDF_Creator::GetLinearizedTrailer(const LinearizedPlan& plan,
+                                                 FX_FILESIZE prev) {
+  auto pTrailer = pdfium::MakeRetain<CPDF_Dictionary>();
+  if (m_pParser) {
+    RetainPtr<CPDF_Dictionary> pOldTrailer = m_pParser->GetCombinedTrailer();
+    CPDF_DictionaryLocker locker(pOldTrailer.Get());
+    for (const auto& it : locker) {
+      if (!IsRewrittenTrailerKey(it.first))
+        pTrailer->SetFor(it.first, it.second->Clone());
+    }
+  } else {
+    pTrailer->SetNewFor<CPDF_Reference>("Root", m_pDocument.Get(),
+                                        plan.catalog_objnum);
+    if (m_pDocument->GetInfo()) {
+      pTrailer->SetNewFor<CPDF_Reference>("Info", m_pDocument.Get(),
+                                          m_pDocument->GetInfo()->GetObjNum());
+    }
+  }
+  RenumberReferences(pTrailer.Get(), m_pDocument.Get(), plan.new_objnums);
+
+  fxcrt::ostringstream buffer;
+  CPDF_StringArchiveStream archive(&buffer);
+  archive.WriteString("trailer\r\n<<");
+  CPDF_DictionaryLocker locker(pTrailer.Get());
+  for (const auto& it : locker) {
+    archive.WriteString("/");
+    archive.WriteString(PDF_NameEncode(it.first).AsStringView());
+    it.second->WriteTo(&archive, nullptr);
+  }
+  if (m_pEncryptDict) {
+    archive.WriteString("/Encrypt ");
+    archive.WriteDWord(m_EncryptDictObjNum);
+    archive.WriteString(" 0 R ");
+  }
+  archive.WriteString("/Size ");
+  archive.WriteDWord(plan.size);
+  if (m_pIDArray) {
+    archive.WriteString("/ID");
+    m_pIDArray->WriteTo(&archive, nullptr);
+  }
+  // Readers that do not know about linearization find the first page
+  // cross-reference table through the main trailer's startxref, and the main
+  // cross-reference table through /Prev. The startxref here goes unused.
+  archive.WriteString("/Prev ");
+  archive.WriteString(PaddedNumber(prev).AsStringView());
+  archive.WriteString(">>\r\nstartxref\r\n0\r\n%%EOF\r\n");
+  return buffer.str();
+}
+
+bool CPDF_Creator::WriteLinearized(const LinearizedPlan& plan) {
+  // Serialize everything up front, as where each object goes depends on the
+  // sizes of the objects before it.
+  std::map<uint32_t, fxcrt::string> serialized;
+  for (const auto& it : plan.objects) {
+    if (!SerializeLinearizedObject(plan, plan.new_objnums.at(it.first),
+                                   it.second, &serialized[it.first])) {
+      return false;
+    }
+  }
+  fxcrt::string encrypt_dict;
+  if (m_pEncryptDict &&
+      !SerializeLinearizedObject(plan, m_EncryptDictObjNum,
+                                 m_pEncryptDict.Get(), &encrypt_dict)) {
+    return false;
+  }
+
+  const size_t page_count = plan.page_object_counts.size();
+  const uint32_t first_page_objnum =
+      plan.new_objnums.at(plan.first_page_objnums[0]);
+  auto linearization_dict = [&](FX_FILESIZE file_size,
+                                FX_FILESIZE hint_offset,
+                                FX_FILESIZE hint_length,
+                                FX_FILESIZE first_page_end,
+                                FX_FILESIZE main_xref_entries) {
+    return ByteString::Format("%u 0 obj\r\n<</Linearized 1/L ",
+                              plan.linearization_objnum) +
+           PaddedNumber(file_size) + "/H[" + PaddedNumber(hint_offset) + " " +
+           PaddedNumber(hint_length) +
+           ByteString::Format("]/O %u/E ", first_page_objnum) +
+           PaddedNumber(first_page_end) +
+           ByteString::Format("/N %u/T ", static_cast<uint32_t>(page_count)) +
+           PaddedNumber(main_xref_entries) + ">>\r\nendobj\r\n";
+  };
+
+  // Lay out the first page section up to the hint stream. The numbers that
+  // depend on the layout are padded, so they do not change its size.
+  const uint32_t first_page_xref_count = plan.size - plan.linearization_objnum;
+  const ByteString first_page_xref_header =
+      ByteString::Format("xref\r\n%u %u\r\n", plan.linearization_objnum,
+                         first_page_xref_count);
+  const FX_FILESIZE linearization_offset = m_Archive->CurrentOffset();
+  const FX_FILESIZE first_page_xref_offset =
+      linearization_offset + linearization_dict(0, 0, 0, 0, 0).GetLength();
+  const FX_FILESIZE catalog_offset =
+      first_page_xref_offset + first_page_xref_header.GetLength() +
+      20 * first_page_xref_count + GetLinearizedTrailer(plan, 0).size();
+  const FX_FILESIZE encrypt_dict_offset =
+      catalog_offset + serialized[plan.catalog_objnum].size();
+  const FX_FILESIZE hint_offset = encrypt_dict_offset + encrypt_dict.size();
+
+  // The hint tables give offsets as if the hint stream were not there, so lay
+  // out the rest of the file that way first.
+  std::vector<FX_FILESIZE> first_page_offsets;
+  FX_FILESIZE offset = hint_offset;
+  for (uint32_t objnum : plan.first_page_objnums) {
+    first_page_offsets.push_back(offset);
+    offset += serialized[objnum].size();
+  }
+  const FX_FILESIZE first_page_end = offset;
+  std::vector<FX_FILESIZE> other_offsets;
+  for (uint32_t objnum : plan.other_objnums) {
+    other_offsets.push_back(offset);
+    offset += serialized[objnum].size();
+  }
+  const FX_FILESIZE main_xref_offset = offset;
+  if (main_xref_offset > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  // Page offset hint table, ISO 32000-1:2008 table F.3. Like other writers,
+  // give each page's content stream offset as 0 and its content stream length
+  // as the page's length.
+  std::vector<uint32_t> page_lengths(page_count);
+  page_lengths[0] = static_cast<uint32_t>(first_page_end - hint_offset);
+  size_t other_index = 0;
+  for (size_t i = 1; i < page_count; ++i) {
+    const size_t end_index = other_index + plan.page_object_counts[i];
+    const FX_FILESIZE page_end = end_index < other_offsets.size()
+                                     ? other_offsets[end_index]
+                                     : main_xref_offset;
+    page_lengths[i] =
+        static_cast<uint32_t>(page_end - other_offsets[other_index]);
+    other_index = end_index;
+  }
+  const auto object_counts = std::minmax_element(
+      plan.page_object_counts.begin(), plan.page_object_counts.end());
+  const auto lengths =
+      std::minmax_element(page_lengths.begin(), page_lengths.end());
+  const uint32_t object_bits = BitWidth(*object_counts.second -
+                                        *object_counts.first);
+  const uint32_t length_bits = BitWidth(*lengths.second - *lengths.first);
+  size_t max_shared_refs = 0;
+  for (const auto& groups : plan.page_shared_groups)
+    max_shared_refs = std::max(max_shared_refs, groups.size());
+  const uint32_t group_count = pdfium::base::checked_cast<uint32_t>(
+      plan.first_page_objnums.size() + plan.shared_end - plan.shared_begin);
+  const uint32_t shared_ref_bits =
+      BitWidth(static_cast<uint32_t>(max_shared_refs));
+  const uint32_t shared_id_bits = BitWidth(group_count - 1);
+
+  HintTableWriter hints;
+  hints.WriteBits(*object_counts.first, 32);
+  hints.WriteBits(static_cast<uint32_t>(hint_offset), 32);
+  hints.WriteBits(object_bits, 16);
+  hints.WriteBits(*lengths.first, 32);
+  hints.WriteBits(length_bits, 16);
+  hints.WriteBits(0, 32);
+  hints.WriteBits(0, 16);
+  hints.WriteBits(*lengths.first, 32);
+  hints.WriteBits(length_bits, 16);
+  hints.WriteBits(shared_ref_bits, 16);
+  hints.WriteBits(shared_id_bits, 16);
+  hints.WriteBits(0, 16);
+  hints.WriteBits(1, 16);
+  for (uint32_t count : plan.page_object_counts)
+    hints.WriteBits(count - *object_counts.first, object_bits);
+  hints.ByteAlign();
+  for (uint32_t length : page_lengths)
+    hints.WriteBits(length - *lengths.first, length_bits);
+  hints.ByteAlign();
+  for (const auto& groups : plan.page_shared_groups)
+    hints.WriteBits(static_cast<uint32_t>(groups.size()), shared_ref_bits);
+  hints.ByteAlign();
+  for (const auto& groups : plan.page_shared_groups) {
+    for (uint32_t group : groups)
+      hints.WriteBits(group, shared_id_bits);
+  }
+  hints.ByteAlign();
+  for (uint32_t length : page_lengths)
+    hints.WriteBits(length - *lengths.first, length_bits);
+  hints.ByteAlign();
+
+  // Shared object hint table, ISO 32000-1:2008 table F.5, with one object per
+  // group.
+  const size_t shared_table_offset = hints.size();
+  std::vector<uint32_t> group_lengths;
+  for (uint32_t objnum : plan.first_page_objnums)
+    group_lengths.push_back(
+        fxcrt::CollectionSize<uint32_t>(serialized[objnum]));
+  for (size_t i = plan.shared_begin; i < plan.shared_end; ++i) {
+    group_lengths.push_back(
+        fxcrt::CollectionSize<uint32_t>(serialized[plan.other_objnums[i]]));
+  }
+  const auto group_lengths_range =
+      std::minmax_element(group_lengths.begin(), group_lengths.end());
+  const uint32_t group_length_bits =
+      BitWidth(*group_lengths_range.second - *group_lengths_range.first);
+  const FX_FILESIZE shared_offset = plan.shared_begin < other_offsets.size()
+                                        ? other_offsets[plan.shared_begin]
+                                        : main_xref_offset;
+  hints.WriteBits(static_cast<uint32_t>(plan.shared_begin + 1), 32);
+  hints.WriteBits(static_cast<uint32_t>(shared_offset), 32);
+  hints.WriteBits(
+      fxcrt::CollectionSize<uint32_t>(plan.first_page_objnums), 32);
+  hints.WriteBits(group_count, 32);
+  hints.WriteBits(0, 16);
+  hints.WriteBits(*group_lengths_range.first, 32);
+  hints.WriteBits(group_length_bits, 16);
+  for (uint32_t length : group_lengths)
+    hints.WriteBits(length - *group_lengths_range.first, group_length_bits);
+  hints.ByteAlign();
+  for (size_t i = 0; i < group_lengths.size(); ++i)
+    hints.WriteBits(0, 1);
+  hints.ByteAlign();
+
+  // Hint streams get compressed and encrypted like other streams.
+  auto pHintStream = pdfium::MakeRetain<CPDF_Stream>();
+  pHintStream->SetData(hints.data());
+  pHintStream->GetMutableDict()->SetNewFor<CPDF_Number>(
+      "S", static_cast<int>(shared_table_offset));
+  fxcrt::string hint_stream;
+  if (!SerializeLinearizedObject(plan, plan.hint_objnum, pHintStream.Get(),
+                                 &hint_stream)) {
+    return false;
+  }
+
+  // Now the real layout, and the rest of the file.
+  const FX_FILESIZE hint_length = hint_stream.size();
+  const FX_FILESIZE main_xref_start = main_xref_offset + hint_length;
+  const ByteString main_xref_header = ByteString::Format(
+      "xref\r\n0 %u\r\n0000000000 65535 f\r\n", plan.linearization_objnum);
+  const ByteString main_trailer = ByteString::Format(
+      "trailer\r\n<</Size %u>>\r\nstartxref\r\n%u\r\n%%%%EOF\r\n",
+      plan.size, static_cast<uint32_t>(first_page_xref_offset));
+  const FX_FILESIZE file_size = main_xref_start +
+                                main_xref_header.GetLength() +
+                                20 * plan.other_objnums.size() +
+                                main_trailer.GetLength();
+  // The main cross-reference table's first entry is object 0's.
+  const FX_FILESIZE main_xref_entries =
+      main_xref_start + main_xref_header.GetLength() - 21;
+
+  if (!m_Archive->WriteString(
+          linearization_dict(file_size, hint_offset, hint_length,
+                             first_page_end + hint_length, main_xref_entries)
+              .AsStringView()) ||
+      !m_Archive->WriteString(first_page_xref_header.AsStringView()) ||
+      !m_Archive->WriteString(
+          XRefEntry(linearization_offset).AsStringView()) ||
+      !m_Archive->WriteString(XRefEntry(catalog_offset).AsStringView()) ||
+      (m_pEncryptDict && !m_Archive->WriteString(
+                             XRefEntry(encrypt_dict_offset).AsStringView())) ||
+      !m_Archive->WriteString(XRefEntry(hint_offset).AsStringView())) {
+    return false;
+  }
+  for (FX_FILESIZE first_page_offset : first_page_offsets) {
+    if (!m_Archive->WriteString(
+            XRefEntry(first_page_offset + hint_length).AsStringView())) {
+      return false;
+    }
+  }
+  const fxcrt::string first_page_trailer =
+      GetLinearizedTrailer(plan, main_xref_start);
+  const fxcrt::string& catalog = serialized[plan.catalog_objnum];
+  if (!m_Archive->WriteBlock(first_page_trailer.data(),
+                             first_page_trailer.size()) ||
+      !m_Archive->WriteBlock(catalog.data(), catalog.size()) ||
+      (!encrypt_dict.empty() &&
+       !m_Archive->WriteBlock(encrypt_dict.data(), encrypt_dict.size())) ||
+      !m_Archive->WriteBlock(hint_stream.data(), hint_stream.size())) {
+    return false;
+  }
+  for (uint32_t objnum : plan.first_page_objnums) {
+    const fxcrt::string& data = serialized[objnum];
+    if (!m_Archive->WriteBlock(data.data(), data.size()))
+      return false;
+  }
+  for (uint32_t objnum : plan.other_objnums) {
+    const fxcrt::string& data = serialized[objnum];
+    if (!m_Archive->WriteBlock(data.data(), data.size()))
+      return false;
+  }
+  DCHECK_EQ(main_xref_start, m_Archive->CurrentOffset());
+
+  if (!m_Archive->WriteString(main_xref_header.AsStringView()))
+    return false;
+  for (FX_FILESIZE other_offset : other_offsets) {
+    if (!m_Archive->WriteString(
+            XRefEntry(other_offset + hint_length).AsStringView())) {
+      return false;
+    }
+  }
+  if (!m_Archive->WriteString(main_trailer.AsStringView()))
+    return false;
+
+  DCHECK_EQ(file_size, m_Archive->CurrentOffset());
+  return true;
+}
+
 bool CPDF_Creator::Create(uint32_t flags) {
   m_IsIncremental = !!(flags & FPDFCREATE_INCREMENTAL);
   m_IsOriginal = !(flags & FPDFCREATE_NO_ORIGINAL);
@@ -558,6 +1631,8 @@ bool CPDF_Creator::Create(uint32_t flags) {
   m_dwLastObjNum = m_pDocument->GetLastObjNum();
   m_ObjectOffsets.clear();
   m_NewObjNumArray.clear();
+  m_PackedObjects.clear();
+  m_DuplicateObjNums.clear();
 
   InitID();
   return Continue();
@@ -632,6 +1707,33 @@ bool CPDF_Creator::Continue() {
   return m_iStage > Stage::kInvalid;
 }
 
+void CPDF_Creator::EnableObjectStreams(uint32_t objects_per_stream) {
+  DCHECK_GT(objects_per_stream, 0u);
+  m_ObjectsPerStream = objects_per_stream;
+}
+
+void CPDF_Creator::EnableLinearization() {
+  m_bLinearize = true;
+}
+
+void CPDF_Creator::EnableDeduplication() {
+  m_bDeduplicate = true;
+}
+
+void CPDF_Creator::SetCompressionOptions(
+    const FlateModule::EncodeOptions& options) {
+  m_CompressionOptions = options;
+}
+
+void CPDF_Creator::SetThreadCount(int thread_count) {
+  // Each batch starts its threads afresh, and threads beyond the number of
+  // cores would only add to that cost.
+  const int max_count = std::max(
+      pdfium::base::saturated_cast<int>(std::thread::hardware_concurrency()),
+      1);
+  m_ThreadCount = pdfium::clamp(thread_count, 1, max_count);
+}
+
 bool CPDF_Creator::SetFileVersion(int32_t fileVersion) {
   if (fileVersion < 10 || fileVersion > 17)
     return false;
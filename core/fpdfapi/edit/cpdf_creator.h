@@ -9,25 +9,36 @@
 
 #include <map>
 #include <memory>
+#include <sstream>
+#include <utility>
 #include <vector>
 
+#include "core/fxcodec/flate/flatemodule.h"
+#include "core/fxcrt/bytestring.h"
 #include "core/fxcrt/fx_stream.h"
+#include "core/fxcrt/fx_string_wrappers.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
+#include "third_party/base/span.h"
 
 class CPDF_Array;
 class CPDF_CryptoHandler;
 class CPDF_SecurityHandler;
 class CPDF_Dictionary;
 class CPDF_Document;
+class CPDF_Encryptor;
+class CPDF_FlateEncoder;
 class CPDF_Object;
 class CPDF_Parser;
+class CPDF_Stream;
 
 #define FPDFCREATE_INCREMENTAL 1
 #define FPDFCREATE_NO_ORIGINAL 2
 
 class CPDF_Creator {
  public:
+  static constexpr uint32_t kDefaultObjectsPerStream = 100;
+
   CPDF_Creator(CPDF_Document* pDoc,
                RetainPtr<IFX_RetainableWriteStream> archive);
   ~CPDF_Creator();
@@ -36,7 +47,35 @@ class CPDF_Creator {
   bool Create(uint32_t flags);
   bool SetFileVersion(int32_t fileVersion);
 
+  // Packs objects other than streams into object streams of at most
+  // `objects_per_stream` objects, and writes a cross-reference stream.
+  // Ignored for incremental saves.
+  void EnableObjectStreams(uint32_t objects_per_stream);
+
+  // Writes a linearized file, where the first page and everything it uses
+  // come first, followed by the other pages one after another, with hint
+  // tables saying where each page's objects are. Ignored for incremental
+  // saves and documents without pages. Takes precedence over object streams.
+  void EnableLinearization();
+
+  // Writes one copy of each set of objects with the same contents, with the
+  // references to the others pointing at it. Ignored for incremental saves.
+  void EnableDeduplication();
+
+  // Compresses the streams that get compressed, those without filters, with
+  // `options` rather than zlib's defaults.
+  void SetCompressionOptions(const FlateModule::EncodeOptions& options);
+
+  // Compresses streams on up to `thread_count` threads, counting the calling
+  // thread, which keeps writing objects in order while the other threads
+  // compress the streams of the objects that come next. The count is capped
+  // at the number of processor cores.
+  void SetThreadCount(int thread_count);
+
  private:
+  class ObjectBatch;
+  struct LinearizedPlan;
+
   enum class Stage {
     kInvalid = -1,
     kInit0 = 0,
@@ -69,6 +108,47 @@ class CPDF_Creator {
   bool WriteOldObjs();
   bool WriteNewObjs();
   bool WriteIndirectObj(uint32_t objnum, const CPDF_Object* pObj);
+  bool WriteStream(const CPDF_Stream* pStream,
+                   const CPDF_Encryptor* pEncryptor);
+
+  // Writes the objects numbered `objnums`, starting to compress the streams
+  // of each batch of them before writing the previous batch.
+  bool WriteObjsPipelined(pdfium::span<const uint32_t> objnums, bool bOld);
+  std::unique_ptr<ObjectBatch> StartObjectBatch(
+      pdfium::span<const uint32_t>* objnums,
+      bool bOld);
+  bool FinishObjectBatch(ObjectBatch* batch);
+
+  // Writes `pObj` as indirect object `objnum`, or adds it to the pending
+  // object stream when it can go in one.
+  bool WriteOrPackIndirectObj(uint32_t objnum, const CPDF_Object* pObj);
+  bool UseObjectStreams() const;
+  bool CanPackObject(const CPDF_Object* pObj) const;
+  bool PackObject(uint32_t objnum, const CPDF_Object* pObj);
+  bool WriteObjectStream();
+
+  // Gets the objects a full save writes, parsing those not loaded yet, whose
+  // numbers go in `parsed_objnums`.
+  void GatherObjects(std::map<uint32_t, const CPDF_Object*>* objects,
+                     std::vector<uint32_t>* parsed_objnums);
+  void FindDuplicateObjects();
+  uint32_t GetWrittenObjNum(uint32_t objnum) const;
+  bool RefersToDuplicate(const CPDF_Object* pObj) const;
+  void RedirectReferences(CPDF_Object* pObj);
+
+  // Decides where each object of a linearized file goes. Returns false when
+  // the document cannot be linearized.
+  bool PlanLinearization(LinearizedPlan* plan);
+  bool WriteLinearized(const LinearizedPlan& plan);
+  bool SerializeLinearizedObject(const LinearizedPlan& plan,
+                                 uint32_t objnum,
+                                 const CPDF_Object* pObj,
+                                 fxcrt::string* result);
+  fxcrt::string GetLinearizedTrailer(const LinearizedPlan& plan,
+                                     FX_FILESIZE prev);
+
+  bool WriteTrailerEntries(uint32_t size);
+  Stage WriteXRefStream();
 
   CPDF_CryptoHandler* GetCryptoHandler();
 
@@ -86,11 +166,30 @@ class CPDF_Creator {
   FX_FILESIZE m_XrefStart = 0;
   std::map<uint32_t, FX_FILESIZE> m_ObjectOffsets;
   std::vector<uint32_t> m_NewObjNumArray;  // Sorted, ascending.
+  // Object numbers of objects packed into object streams, mapped to the
+  // object stream's object number and their index within it.
+  std::map<uint32_t, std::pair<uint32_t, uint32_t>> m_PackedObjects;
+  // The object stream being filled: its objects' numbers and offsets, and
+  // their serialized data.
+  std::vector<std::pair<uint32_t, FX_FILESIZE>> m_PendingObjStmObjects;
+  fxcrt::ostringstream m_PendingObjStmData;
+  uint32_t m_ObjectsPerStream = 0;
+  uint32_t m_EncryptDictObjNum = 0;
+  FlateModule::EncodeOptions m_CompressionOptions;
+  int m_ThreadCount = 1;
+  // Streams compressed ahead of being written.
+  std::map<const CPDF_Stream*, std::unique_ptr<CPDF_FlateEncoder>>
+      m_CompressedStreams;
+  // Objects left out as they match other objects, mapped to the objects
+  // written in their place.
+  std::map<uint32_t, uint32_t> m_DuplicateObjNums;
   RetainPtr<CPDF_Array> m_pIDArray;
   int32_t m_FileVersion = 0;
   bool m_bSecurityChanged = false;
   bool m_IsIncremental = false;
   bool m_IsOriginal = false;
+  bool m_bLinearize = false;
+  bool m_bDeduplicate = false;
 };
 
 #endif  // CORE_FPDFAPI_EDIT_CPDF_CREATOR_H_
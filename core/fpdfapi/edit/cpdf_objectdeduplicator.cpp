@@ -0,0 +1,205 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
+
+#include <sstream>
+#include <utility>
+
+#include "core/fdrm/fx_crypt.h"
+#include "core/fpdfapi/edit/cpdf_stringarchivestream.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_object.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_stream_acc.h"
+#include "core/fpdfapi/parser/fpdf_parser_utility.h"
+#include "core/fxcrt/fx_string_wrappers.h"
+#include "third_party/base/containers/contains.h"
+
+namespace {
+
+// Writes objects out such that objects get written the same way exactly when
+// they match. Stream data gets written as its hash.
+class CanonicalFormWriter {
+ public:
+  // References to the keys of `duplicates` get written as references to the
+  // objects they map to.
+  explicit CanonicalFormWriter(const std::map<uint32_t, uint32_t>* duplicates)
+      : m_pDuplicates(duplicates) {}
+
+  ByteString GetCanonicalForm(const CPDF_Object* pObj) {
+    fxcrt::ostringstream buffer;
+    CPDF_StringArchiveStream archive(&buffer);
+    Write(pObj, &archive);
+    return ByteString(buffer);
+  }
+
+ private:
+  void Write(const CPDF_Object* pObj, IFX_ArchiveStream* archive) {
+    switch (pObj->GetType()) {
+      case CPDF_Object::kReference:
+        archive->WriteString(" R");
+        archive->WriteDWord(Resolve(pObj->AsReference()->GetRefObjNum()));
+        return;
+      case CPDF_Object::kArray: {
+        archive->WriteString("[");
+        CPDF_ArrayLocker locker(pObj->AsArray());
+        for (const auto& pElement : locker)
+          Write(pElement.Get(), archive);
+        archive->WriteString("]");
+        return;
+      }
+      case CPDF_Object::kDictionary: {
+        archive->WriteString("<<");
+        CPDF_DictionaryLocker locker(pObj->AsDictionary());
+        for (const auto& it : locker) {
+          archive->WriteString("/");
+          archive->WriteString(PDF_NameEncode(it.first).AsStringView());
+          Write(it.second.Get(), archive);
+        }
+        archive->WriteString(">>");
+        return;
+      }
+      case CPDF_Object::kStream: {
+        const CPDF_Stream* pStream = pObj->AsStream();
+        Write(pStream->GetDict(), archive);
+        archive->WriteString("stream");
+        archive->WriteString(GetDataDigest(pStream).AsStringView());
+        return;
+      }
+      default:
+        pObj->WriteTo(archive, nullptr);
+        return;
+    }
+  }
+
+  uint32_t Resolve(uint32_t objnum) const {
+    if (!m_pDuplicates)
+      return objnum;
+    for (auto it = m_pDuplicates->find(objnum); it != m_pDuplicates->end();
+         it = m_pDuplicates->find(objnum)) {
+      objnum = it->second;
+    }
+    return objnum;
+  }
+
+  // Streams get hashed once each, as their data does not depend on what
+  // other objects match.
+  const ByteString& GetDataDigest(const CPDF_Stream* pStream) {
+    auto it = m_DataDigests.find(pStream);
+    if (it != m_DataDigests.end())
+      return it->second;
+
+    auto pAcc = pdfium::MakeRetain<CPDF_StreamAcc>(pStream);
+    pAcc->LoadAllDataRaw();
+    pdfium::span<const uint8_t> data = pAcc->GetSpan();
+    uint8_t digest[32];
+    CRYPT_SHA256Generate(data.data(), pAcc->GetSize(), digest);
+    return m_DataDigests[pStream] = ByteString(digest, sizeof(digest));
+  }
+
+  const std::map<uint32_t, uint32_t>* const m_pDuplicates;
+  std::map<const CPDF_Stream*, ByteString> m_DataDigests;
+};
+
+}  // namespace
+
+// static
+bool CPDF_ObjectDeduplicator::CanMerge(const CPDF_Object* pObj) {
+  const CPDF_Dictionary* pDict = pObj->GetDict();
+  if (!pDict)
+    return true;
+
+  // Page tree nodes, outline items, form fields and the like get listed by
+  // their parents, which tell them apart by object number.
+  if (pDict->KeyExist("Parent") || pDict->KeyExist("FT"))
+    return false;
+
+  // Annotations may lack a /Type, but never a /Subtype and a /Rect.
+  if (pDict->KeyExist("Subtype") && pDict->KeyExist("Rect"))
+    return false;
+
+  // Signatures may lack a /Type, but never a /ByteRange.
+  if (pDict->KeyExist("ByteRange"))
+    return false;
+
+  // Optional content groups with the same name are still separate layers,
+  // listed by object number in /OCProperties. Structure elements list their
+  // parents as /P rather than /Parent.
+  const ByteString type = pDict->GetNameFor("Type");
+  return type != "Catalog" && type != "Pages" && type != "Page" &&
+         type != "Annot" && type != "OCG" && type != "OCMD" &&
+         type != "StructElem" && type != "Sig";
+}
+
+// static
+std::map<uint32_t, uint32_t> CPDF_ObjectDeduplicator::FindDuplicates(
+    const std::map<uint32_t, const CPDF_Object*>& objects) {
+  // Each pass merges the objects that match once the objects they refer to
+  // that matched in earlier passes count as the same.
+  std::map<uint32_t, uint32_t> duplicates;
+  CanonicalFormWriter writer(&duplicates);
+  bool bFound = true;
+  while (bFound) {
+    bFound = false;
+    std::map<ByteString, uint32_t> first_objnums;
+    for (const auto& it : objects) {
+      if (pdfium::Contains(duplicates, it.first) || !CanMerge(it.second))
+        continue;
+
+      auto result =
+          first_objnums.emplace(writer.GetCanonicalForm(it.second), it.first);
+      if (!result.second) {
+        duplicates[it.first] = result.first->second;
+        bFound = true;
+      }
+    }
+  }
+
+  // Objects that later passes merged may have had duplicates themselves.
+  for (auto& it : duplicates) {
+    while (pdfium::Contains(duplicates, it.second))
+      it.second = duplicates[it.second];
+  }
+  return duplicates;
+}
+
+CPDF_ObjectDeduplicator::CPDF_ObjectDeduplicator(CPDF_Document* pDoc)
+    : m_pDocument(pDoc) {}
+
+CPDF_ObjectDeduplicator::~CPDF_ObjectDeduplicator() = default;
+
+uint32_t CPDF_ObjectDeduplicator::FindOrAdd(const CPDF_Object* pObj) {
+  const uint32_t objnum = pObj->GetObjNum();
+  if (!CanMerge(pObj))
+    return objnum;
+
+  CanonicalFormWriter writer(nullptr);
+  ByteString form = writer.GetCanonicalForm(pObj);
+  auto written_it = m_WrittenIndex.find(form);
+  if (written_it != m_WrittenIndex.end())
+    return written_it->second;
+
+  auto it = m_Index.find(form);
+  if (it != m_Index.end() && it->second != objnum) {
+    // The object may have changed, or been replaced, since it got added.
+    const CPDF_Object* pIndexed = m_pDocument->GetIndirectObject(it->second);
+    if (pIndexed && CanMerge(pIndexed) &&
+        writer.GetCanonicalForm(pIndexed) == form) {
+      return it->second;
+    }
+  }
+  m_Index[std::move(form)] = objnum;
+  return objnum;
+}
+
+void CPDF_ObjectDeduplicator::AddWritten(const CPDF_Object* pObj) {
+  if (!CanMerge(pObj))
+    return;
+
+  CanonicalFormWriter writer(nullptr);
+  m_WrittenIndex.emplace(writer.GetCanonicalForm(pObj), pObj->GetObjNum());
+}
@@ -0,0 +1,57 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_EDIT_CPDF_OBJECTDEDUPLICATOR_H_
+#define CORE_FPDFAPI_EDIT_CPDF_OBJECTDEDUPLICATOR_H_
+
+#include <stdint.h>
+
+#include <map>
+
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fxcrt/bytestring.h"
+#include "core/fxcrt/unowned_ptr.h"
+
+class CPDF_Object;
+
+// Finds indirect objects with the same contents, so one copy can stand in for
+// all of them. Streams match when their dictionaries and raw data do.
+// Dictionaries and arrays match when their entries do, where references match
+// when they point at the same object or at objects that match.
+class CPDF_ObjectDeduplicator final : public CPDF_Document::ObjectIndexIface {
+ public:
+  // Returns whether `pObj` may stand in for an identical object, or be stood
+  // in for. Pages, page tree nodes, annotations, form fields, optional
+  // content groups, structure elements, signatures and other objects that
+  // get told apart by their object numbers may not.
+  static bool CanMerge(const CPDF_Object* pObj);
+
+  // Returns the numbers of the objects in `objects` that match an object with
+  // a smaller number, mapped to the smallest such number.
+  static std::map<uint32_t, uint32_t> FindDuplicates(
+      const std::map<uint32_t, const CPDF_Object*>& objects);
+
+  explicit CPDF_ObjectDeduplicator(CPDF_Document* pDoc);
+  ~CPDF_ObjectDeduplicator() override;
+
+  // Returns the number of an indirect object of the document that got added
+  // earlier and still matches `pObj`. Otherwise adds `pObj`, an indirect
+  // object of the document, and returns its own number.
+  uint32_t FindOrAdd(const CPDF_Object* pObj);
+
+  // Keeps `pObj`, an indirect object of the document that got written out and
+  // is about to be taken out of it, indexed once it is gone. Written objects
+  // cannot change, so FindOrAdd() returns their numbers without looking them
+  // up in the document.
+  void AddWritten(const CPDF_Object* pObj);
+
+ private:
+  UnownedPtr<CPDF_Document> const m_pDocument;
+  // Object numbers by their objects' canonical forms.
+  std::map<ByteString, uint32_t> m_Index;
+  // Like `m_Index`, but for objects written out already.
+  std::map<ByteString, uint32_t> m_WrittenIndex;
+};
+
+#endif  // CORE_FPDFAPI_EDIT_CPDF_OBJECTDEDUPLICATOR_H_
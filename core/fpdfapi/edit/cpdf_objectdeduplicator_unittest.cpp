@@ -0,0 +1,169 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
+
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+#include "core/fpdfapi/page/test_with_page_module.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
+#include "core/fpdfapi/parser/cpdf_name.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_test_document.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/span.h"
+
+namespace {
+
+CPDF_Stream* NewStream(CPDF_IndirectObjectHolder* holder,
+                       const char* data) {
+  CPDF_Stream* stream = holder->NewIndirect<CPDF_Stream>();
+  stream->SetData(pdfium::as_bytes(pdfium::make_span(data, strlen(data))));
+  return stream;
+}
+
+CPDF_Dictionary* NewFont(CPDF_IndirectObjectHolder* holder,
+                         const CPDF_Stream* font_file) {
+  CPDF_Dictionary* font = holder->NewIndirect<CPDF_Dictionary>();
+  font->SetNewFor<CPDF_Name>("Type", "Font");
+  font->SetNewFor<CPDF_Reference>("FontFile", holder, font_file->GetObjNum());
+  return font;
+}
+
+std::map<uint32_t, const CPDF_Object*> GetObjects(
+    const CPDF_IndirectObjectHolder& holder) {
+  std::map<uint32_t, const CPDF_Object*> objects;
+  for (const auto& it : holder)
+    objects[it.first] = it.second.Get();
+  return objects;
+}
+
+}  // namespace
+
+class CPDF_ObjectDeduplicatorTest : public TestWithPageModule {};
+
+TEST_F(CPDF_ObjectDeduplicatorTest, CanMerge) {
+  auto dict = pdfium::MakeRetain<CPDF_Dictionary>();
+  EXPECT_TRUE(CPDF_ObjectDeduplicator::CanMerge(dict.Get()));
+  dict->SetNewFor<CPDF_Name>("Type", "Page");
+  EXPECT_FALSE(CPDF_ObjectDeduplicator::CanMerge(dict.Get()));
+
+  auto annot = pdfium::MakeRetain<CPDF_Dictionary>();
+  annot->SetNewFor<CPDF_Name>("Subtype", "Link");
+  annot->SetNewFor<CPDF_Array>("Rect");
+  EXPECT_FALSE(CPDF_ObjectDeduplicator::CanMerge(annot.Get()));
+
+  auto node = pdfium::MakeRetain<CPDF_Dictionary>();
+  node->SetNewFor<CPDF_Number>("Parent", 1);
+  EXPECT_FALSE(CPDF_ObjectDeduplicator::CanMerge(node.Get()));
+
+  for (const char* type : {"OCG", "OCMD", "StructElem", "Sig"}) {
+    auto typed = pdfium::MakeRetain<CPDF_Dictionary>();
+    typed->SetNewFor<CPDF_Name>("Type", type);
+    EXPECT_FALSE(CPDF_ObjectDeduplicator::CanMerge(typed.Get())) << type;
+  }
+
+  auto signature = pdfium::MakeRetain<CPDF_Dictionary>();
+  signature->SetNewFor<CPDF_Array>("ByteRange");
+  EXPECT_FALSE(CPDF_ObjectDeduplicator::CanMerge(signature.Get()));
+
+  auto array = pdfium::MakeRetain<CPDF_Array>();
+  EXPECT_TRUE(CPDF_ObjectDeduplicator::CanMerge(array.Get()));
+}
+
+TEST_F(CPDF_ObjectDeduplicatorTest, FindDuplicates) {
+  CPDF_IndirectObjectHolder holder;
+  CPDF_Stream* file1 = NewStream(&holder, "font data");
+  CPDF_Stream* file2 = NewStream(&holder, "font data");
+  CPDF_Stream* file3 = NewStream(&holder, "other font data");
+  CPDF_Dictionary* font1 = NewFont(&holder, file1);
+  CPDF_Dictionary* font2 = NewFont(&holder, file2);
+  CPDF_Dictionary* font3 = NewFont(&holder, file3);
+
+  // Pages stay apart, however alike.
+  for (int i = 0; i < 2; ++i) {
+    CPDF_Dictionary* page = holder.NewIndirect<CPDF_Dictionary>();
+    page->SetNewFor<CPDF_Name>("Type", "Page");
+  }
+
+  std::map<uint32_t, uint32_t> duplicates =
+      CPDF_ObjectDeduplicator::FindDuplicates(GetObjects(holder));
+  std::map<uint32_t, uint32_t> expected = {
+      {file2->GetObjNum(), file1->GetObjNum()},
+      {font2->GetObjNum(), font1->GetObjNum()}};
+  EXPECT_EQ(expected, duplicates);
+  EXPECT_FALSE(duplicates.count(font3->GetObjNum()));
+}
+
+TEST_F(CPDF_ObjectDeduplicatorTest, FindDuplicatesChains) {
+  // Each array refers to the next, down to a number, so each pass finds one
+  // more level of duplicates.
+  CPDF_IndirectObjectHolder holder;
+  std::vector<uint32_t> chains[2];
+  for (std::vector<uint32_t>& chain : chains) {
+    chain.push_back(holder.NewIndirect<CPDF_Number>(7)->GetObjNum());
+    for (int i = 0; i < 3; ++i) {
+      CPDF_Array* array = holder.NewIndirect<CPDF_Array>();
+      array->AppendNew<CPDF_Reference>(&holder, chain.back());
+      chain.push_back(array->GetObjNum());
+    }
+  }
+  std::map<uint32_t, uint32_t> expected;
+  for (size_t i = 0; i < chains[0].size(); ++i)
+    expected[chains[1][i]] = chains[0][i];
+  EXPECT_EQ(expected,
+            CPDF_ObjectDeduplicator::FindDuplicates(GetObjects(holder)));
+}
+
+TEST_F(CPDF_ObjectDeduplicatorTest, FindOrAdd) {
+  CPDF_TestDocument doc;
+  CPDF_ObjectDeduplicator deduplicator(&doc);
+  CPDF_Stream* file1 = NewStream(&doc, "font data");
+  EXPECT_EQ(file1->GetObjNum(), deduplicator.FindOrAdd(file1));
+  EXPECT_EQ(file1->GetObjNum(), deduplicator.FindOrAdd(file1));
+
+  CPDF_Stream* file2 = NewStream(&doc, "font data");
+  EXPECT_EQ(file1->GetObjNum(), deduplicator.FindOrAdd(file2));
+
+  // Objects that changed since they got added no longer match.
+  const char kChanged[] = "changed";
+  file1->SetData(pdfium::as_bytes(pdfium::make_span(kChanged)));
+  EXPECT_EQ(file2->GetObjNum(), deduplicator.FindOrAdd(file2));
+  CPDF_Stream* file3 = NewStream(&doc, "font data");
+  EXPECT_EQ(file2->GetObjNum(), deduplicator.FindOrAdd(file3));
+
+  CPDF_Dictionary* page = doc.NewIndirect<CPDF_Dictionary>();
+  page->SetNewFor<CPDF_Name>("Type", "Page");
+  EXPECT_EQ(page->GetObjNum(), deduplicator.FindOrAdd(page));
+  CPDF_Dictionary* page2 = doc.NewIndirect<CPDF_Dictionary>();
+  page2->SetNewFor<CPDF_Name>("Type", "Page");
+  EXPECT_EQ(page2->GetObjNum(), deduplicator.FindOrAdd(page2));
+}
+
+TEST_F(CPDF_ObjectDeduplicatorTest, AddWritten) {
+  CPDF_TestDocument doc;
+  CPDF_ObjectDeduplicator deduplicator(&doc);
+  CPDF_Stream* file1 = NewStream(&doc, "font data");
+  const uint32_t objnum = file1->GetObjNum();
+  deduplicator.AddWritten(file1);
+  doc.DeleteIndirectObject(objnum);
+
+  // Written objects still match once they are gone from the document.
+  CPDF_Stream* file2 = NewStream(&doc, "font data");
+  EXPECT_EQ(objnum, deduplicator.FindOrAdd(file2));
+
+  CPDF_Dictionary* page = doc.NewIndirect<CPDF_Dictionary>();
+  page->SetNewFor<CPDF_Name>("Type", "Page");
+  deduplicator.AddWritten(page);
+  CPDF_Dictionary* page2 = doc.NewIndirect<CPDF_Dictionary>();
+  page2->SetNewFor<CPDF_Name>("Type", "Page");
+  EXPECT_EQ(page2->GetObjNum(), deduplicator.FindOrAdd(page2));
+}
@@ -0,0 +1,285 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_pagewriter.h"
+
+#include <memory>
+#include <utility>
+
+#include "constants/page_object.h"
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
+#include "core/fpdfapi/edit/cpdf_stringarchivestream.h"
+#include "core/fpdfapi/parser/cpdf_array.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/parser/cpdf_flateencoder.h"
+#include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_object.h"
+#include "core/fpdfapi/parser/cpdf_object_walker.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fxcrt/fx_extension.h"
+#include "third_party/base/containers/contains.h"
+#include "third_party/base/numerics/safe_conversions.h"
+
+namespace {
+
+// Output gets passed on to the file once it reaches this size.
+constexpr size_t kFlushSize = 32768;
+
+// Page attributes a page may inherit from the page tree. The page tree gets
+// rewritten with the pages directly under its root, so the pages get copies.
+const char* const kInheritablePageAttributes[] = {
+    pdfium::page_object::kResources, pdfium::page_object::kMediaBox,
+    pdfium::page_object::kCropBox, pdfium::page_object::kRotate};
+
+ByteString XRefEntry(FX_FILESIZE offset) {
+  if (!offset)
+    return "0000000000 65535 f\r\n";
+
+  char buf[21] = {};
+  ByteString result(FXSYS_i64toa(offset, buf, 10));
+  while (result.GetLength() < 10)
+    result.InsertAtFront('0');
+  return result + " 00000 n\r\n";
+}
+
+}  // namespace
+
+CPDF_PageWriter::CPDF_PageWriter(CPDF_Document* pDoc,
+                                 RetainPtr<IFX_RetainableWriteStream> file)
+    : m_pDocument(pDoc), m_pFile(std::move(file)) {}
+
+CPDF_PageWriter::~CPDF_PageWriter() = default;
+
+void CPDF_PageWriter::SetCompressionOptions(
+    const FlateModule::EncodeOptions& options) {
+  m_CompressionOptions = options;
+}
+
+bool CPDF_PageWriter::Start(int32_t file_version) {
+  if (m_bStarted || m_pDocument->GetParser() || !m_pDocument->GetRoot())
+    return false;
+
+  // Same range as CPDF_Creator::SetFileVersion().
+  if (file_version && (file_version < 10 || file_version > 17))
+    return false;
+
+  CPDF_StringArchiveStream archive(&m_Buffer);
+  if (!archive.WriteString("%PDF-1.") ||
+      !archive.WriteDWord(file_version ? file_version % 10 : 7) ||
+      !archive.WriteString("\r\n%\xA1\xB3\xC5\xD7\r\n")) {
+    return false;
+  }
+  m_bStarted = true;
+  return Flush();
+}
+
+bool CPDF_PageWriter::WritePages() {
+  if (!m_bStarted)
+    return false;
+
+  const CPDF_Dictionary* pRoot = m_pDocument->GetRoot();
+  const CPDF_Dictionary* pPages = pRoot->GetDictFor("Pages");
+  if (!pPages)
+    return false;
+
+  // Page objects get written as the pages they are, and other pages' objects
+  // and the page tree do not get written with a page.
+  std::set<uint32_t> stop_objnums = {pRoot->GetObjNum()};
+  if (const CPDF_Dictionary* pInfo = m_pDocument->GetInfo())
+    stop_objnums.insert(pInfo->GetObjNum());
+
+  const int page_count = m_pDocument->GetPageCount();
+  std::vector<RetainPtr<CPDF_Dictionary>> pages;
+  for (int i = 0; i < page_count; ++i) {
+    RetainPtr<CPDF_Dictionary> pPage =
+        m_pDocument->GetMutablePageDictionary(i);
+    if (!pPage || !pPage->GetObjNum())
+      return false;
+
+    RetainPtr<CPDF_Dictionary> pClone = ToDictionary(pPage->Clone());
+    std::set<const CPDF_Dictionary*> visited = {pPage.Get()};
+    const CPDF_Dictionary* pNode =
+        pPage->GetDictFor(pdfium::page_object::kParent);
+    while (pNode && visited.insert(pNode).second) {
+      stop_objnums.insert(pNode->GetObjNum());
+      for (const char* key : kInheritablePageAttributes) {
+        if (!pClone->KeyExist(key) && pNode->KeyExist(key))
+          pClone->SetFor(key, pNode->GetObjectFor(key)->Clone());
+      }
+      pNode = pNode->GetDictFor(pdfium::page_object::kParent);
+    }
+    pClone->SetNewFor<CPDF_Reference>(pdfium::page_object::kParent,
+                                      m_pDocument.Get(), pPages->GetObjNum());
+    stop_objnums.insert(pPage->GetObjNum());
+    pages.push_back(std::move(pClone));
+  }
+
+  std::vector<uint32_t> written;
+  for (int i = 0; i < page_count; ++i) {
+    const uint32_t objnum = m_pDocument->GetPageDictionary(i)->GetObjNum();
+    if (!WriteIndirectObj(objnum, pages[i].Get()) ||
+        !WriteReachableObjects(pages[i].Get(), stop_objnums, &written)) {
+      return false;
+    }
+    written.push_back(objnum);
+    m_PageObjNums.push_back(objnum);
+  }
+
+  // Pages imported later may share the objects written, if the document
+  // finds identical objects to share.
+  auto* pDeduplicator =
+      static_cast<CPDF_ObjectDeduplicator*>(m_pDocument->GetObjectIndex());
+
+  // The page tree still refers to the pages, so they go first.
+  for (int i = page_count - 1; i >= 0; --i)
+    m_pDocument->DeletePage(i);
+  for (uint32_t objnum : written) {
+    if (pDeduplicator) {
+      if (const CPDF_Object* pObj = m_pDocument->GetIndirectObject(objnum))
+        pDeduplicator->AddWritten(pObj);
+    }
+    m_pDocument->DeleteIndirectObject(objnum);
+  }
+  return Flush();
+}
+
+bool CPDF_PageWriter::Finish() {
+  if (!WritePages())
+    return false;
+
+  RetainPtr<CPDF_Dictionary> pRoot = m_pDocument->GetMutableRoot();
+  RetainPtr<CPDF_Dictionary> pPages = pRoot->GetMutableDictFor("Pages");
+  CPDF_Array* pKids = pPages->SetNewFor<CPDF_Array>("Kids");
+  for (uint32_t objnum : m_PageObjNums)
+    pKids->AppendNew<CPDF_Reference>(m_pDocument.Get(), objnum);
+  pPages->SetNewFor<CPDF_Number>(
+      "Count", pdfium::base::checked_cast<int>(m_PageObjNums.size()));
+
+  std::vector<const CPDF_Dictionary*> dicts = {pRoot.Get()};
+  if (const CPDF_Dictionary* pInfo = m_pDocument->GetInfo())
+    dicts.push_back(pInfo);
+  std::vector<uint32_t> written;
+  for (const CPDF_Dictionary* pDict : dicts) {
+    if (IsWritten(pDict->GetObjNum()))
+      continue;
+    if (!WriteIndirectObj(pDict->GetObjNum(), pDict) ||
+        !WriteReachableObjects(pDict, {}, &written)) {
+      return false;
+    }
+  }
+  return WriteCrossReferenceTable() && Flush();
+}
+
+bool CPDF_PageWriter::WriteReachableObjects(
+    const CPDF_Object* pObj,
+    const std::set<uint32_t>& stop_objnums,
+    std::vector<uint32_t>* written) {
+  std::vector<uint32_t> reached;
+  auto walk = [&reached](const CPDF_Object* pFrom) {
+    CPDF_ObjectWalker walker(pFrom);
+    while (const CPDF_Object* pSub = walker.GetNext()) {
+      if (const CPDF_Reference* pRef = pSub->AsReference())
+        reached.push_back(pRef->GetRefObjNum());
+    }
+  };
+  walk(pObj);
+  for (size_t i = 0; i < reached.size(); ++i) {
+    const uint32_t objnum = reached[i];
+    if (pdfium::Contains(stop_objnums, objnum) || IsWritten(objnum))
+      continue;
+
+    const CPDF_Object* pReached = m_pDocument->GetIndirectObject(objnum);
+    if (!pReached)
+      continue;
+    if (!WriteIndirectObj(objnum, pReached))
+      return false;
+    written->push_back(objnum);
+    walk(pReached);
+  }
+  return true;
+}
+
+bool CPDF_PageWriter::WriteIndirectObj(uint32_t objnum,
+                                       const CPDF_Object* pObj) {
+  if (objnum >= m_ObjectOffsets.size())
+    m_ObjectOffsets.resize(objnum + 1);
+  m_ObjectOffsets[objnum] = CurrentOffset();
+
+  CPDF_StringArchiveStream archive(&m_Buffer);
+  if (!archive.WriteDWord(objnum) || !archive.WriteString(" 0 obj\r\n"))
+    return false;
+
+  if (const CPDF_Stream* pStream = pObj->AsStream()) {
+    std::unique_ptr<CPDF_FlateEncoder> encoder =
+        pStream->CreateEncoder(m_CompressionOptions);
+    if (!encoder->Compress())
+      return false;
+    if (!pStream->WriteEncodedTo(&archive, nullptr, encoder.get()))
+      return false;
+  } else if (!pObj->WriteTo(&archive, nullptr)) {
+    return false;
+  }
+  return archive.WriteString("\r\nendobj\r\n") && FlushIfFull();
+}
+
+bool CPDF_PageWriter::WriteCrossReferenceTable() {
+  const FX_FILESIZE xref_offset = CurrentOffset();
+  if (m_ObjectOffsets.empty())
+    m_ObjectOffsets.resize(1);
+  const uint32_t size = pdfium::base::checked_cast<uint32_t>(
+      m_ObjectOffsets.size());
+
+  CPDF_StringArchiveStream archive(&m_Buffer);
+  if (!archive.WriteString("xref\r\n0 ") || !archive.WriteDWord(size) ||
+      !archive.WriteString("\r\n")) {
+    return false;
+  }
+  for (FX_FILESIZE offset : m_ObjectOffsets) {
+    if (!archive.WriteString(XRefEntry(offset).AsStringView()) ||
+        !FlushIfFull()) {
+      return false;
+    }
+  }
+
+  if (!archive.WriteString("trailer\r\n<</Root ") ||
+      !archive.WriteDWord(m_pDocument->GetRoot()->GetObjNum()) ||
+      !archive.WriteString(" 0 R")) {
+    return false;
+  }
+  if (const CPDF_Dictionary* pInfo = m_pDocument->GetInfo()) {
+    if (!archive.WriteString("/Info ") ||
+        !archive.WriteDWord(pInfo->GetObjNum()) ||
+        !archive.WriteString(" 0 R")) {
+      return false;
+    }
+  }
+  return archive.WriteString("/Size ") && archive.WriteDWord(size) &&
+         archive.WriteString(">>\r\nstartxref\r\n") &&
+         archive.WriteFilesize(xref_offset) &&
+         archive.WriteString("\r\n%%EOF\r\n");
+}
+
+bool CPDF_PageWriter::Flush() {
+  fxcrt::string data = m_Buffer.str();
+  m_Buffer.str(fxcrt::string());
+  if (data.empty())
+    return true;
+
+  m_FlushedSize += data.size();
+  return m_pFile->WriteBlock(data.data(), data.size());
+}
+
+bool CPDF_PageWriter::FlushIfFull() {
+  return m_Buffer.tellp() < static_cast<std::streamoff>(kFlushSize) || Flush();
+}
+
+bool CPDF_PageWriter::IsWritten(uint32_t objnum) const {
+  return objnum < m_ObjectOffsets.size() && m_ObjectOffsets[objnum];
+}
+
+FX_FILESIZE CPDF_PageWriter::CurrentOffset() {
+  return m_FlushedSize + m_Buffer.tellp();
+}
@@ -0,0 +1,80 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_EDIT_CPDF_PAGEWRITER_H_
+#define CORE_FPDFAPI_EDIT_CPDF_PAGEWRITER_H_
+
+#include <stdint.h>
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "core/fxcodec/flate/flatemodule.h"
+#include "core/fxcrt/fx_stream.h"
+#include "core/fxcrt/fx_string_wrappers.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "core/fxcrt/unowned_ptr.h"
+
+class CPDF_Document;
+class CPDF_Object;
+
+// Writes a new document a few pages at a time, so documents too large to hold
+// in memory can get written. Each WritePages() call writes the pages the
+// document has and the objects they use, then takes them out of the
+// document. Finish() writes the page tree, listing every page written, the
+// rest of the document and the cross-reference table.
+class CPDF_PageWriter {
+ public:
+  CPDF_PageWriter(CPDF_Document* pDoc,
+                  RetainPtr<IFX_RetainableWriteStream> file);
+  ~CPDF_PageWriter();
+
+  void SetCompressionOptions(const FlateModule::EncodeOptions& options);
+
+  // Writes the file header, for PDF version `file_version`, from 10 for 1.0
+  // to 17 for 1.7, or 1.7 when 0. Returns false for other versions, and for
+  // documents loaded from a file, which this cannot write.
+  bool Start(int32_t file_version);
+
+  // Writes the pages the document has. Objects a page uses get written along
+  // with it, unless they got written already. Afterwards the document has no
+  // pages, and neither the pages nor the objects written with them can be
+  // reached through it any more.
+  bool WritePages();
+
+  // Writes the pages left, then everything else the document has.
+  bool Finish();
+
+  size_t written_page_count() const { return m_PageObjNums.size(); }
+
+ private:
+  // Writes the objects reachable from `pObj`, other than those numbered
+  // `stop_objnums` and those written already, numbering them in `written`.
+  bool WriteReachableObjects(const CPDF_Object* pObj,
+                             const std::set<uint32_t>& stop_objnums,
+                             std::vector<uint32_t>* written);
+  bool WriteIndirectObj(uint32_t objnum, const CPDF_Object* pObj);
+  bool WriteCrossReferenceTable();
+  bool Flush();
+  bool FlushIfFull();
+  bool IsWritten(uint32_t objnum) const;
+  FX_FILESIZE CurrentOffset();
+
+  UnownedPtr<CPDF_Document> const m_pDocument;
+  RetainPtr<IFX_RetainableWriteStream> const m_pFile;
+  FlateModule::EncodeOptions m_CompressionOptions;
+  // Output not passed on to `m_pFile` yet, which gets it in large blocks.
+  fxcrt::ostringstream m_Buffer;
+  FX_FILESIZE m_FlushedSize = 0;
+  // Offsets of the objects written, by object number, with 0 for objects not
+  // written. Numbers stay with their objects, so this grows with the largest
+  // object number, 8 bytes each.
+  std::vector<FX_FILESIZE> m_ObjectOffsets;
+  // Object numbers of the pages written, in order.
+  std::vector<uint32_t> m_PageObjNums;
+  bool m_bStarted = false;
+};
+
+#endif  // CORE_FPDFAPI_EDIT_CPDF_PAGEWRITER_H_
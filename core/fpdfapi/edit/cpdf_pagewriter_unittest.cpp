@@ -0,0 +1,148 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/edit/cpdf_pagewriter.h"
+
+#include <string.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
+#include "core/fpdfapi/page/test_with_page_module.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_reference.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/parser/cpdf_test_document.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/string_write_stream.h"
+#include "third_party/base/span.h"
+
+namespace {
+
+CPDF_Stream* NewStream(CPDF_Document* doc, const char* data) {
+  CPDF_Stream* stream = doc->NewIndirect<CPDF_Stream>();
+  stream->SetData(pdfium::as_bytes(pdfium::make_span(data, strlen(data))));
+  return stream;
+}
+
+// Adds a page at the end of `doc` that uses the object numbered `objnum` as
+// its /Font resource.
+void AddPageUsing(CPDF_Document* doc, uint32_t objnum) {
+  RetainPtr<CPDF_Dictionary> page = doc->CreateNewPage(doc->GetPageCount());
+  ASSERT_TRUE(page);
+  CPDF_Dictionary* resources = page->SetNewFor<CPDF_Dictionary>("Resources");
+  resources->SetNewFor<CPDF_Reference>("Font", doc, objnum);
+}
+
+size_t CountOccurrences(const std::string& str, const char* substr) {
+  size_t count = 0;
+  for (size_t pos = str.find(substr); pos != std::string::npos;
+       pos = str.find(substr, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace
+
+class CPDF_PageWriterTest : public TestWithPageModule {
+ protected:
+  void SetUp() override {
+    TestWithPageModule::SetUp();
+    m_pDoc = std::make_unique<CPDF_TestDocument>();
+    m_pDoc->CreateNewDoc();
+    m_pStream = pdfium::MakeRetain<StringWriteStream>();
+  }
+
+  void TearDown() override {
+    m_pDoc.reset();
+    TestWithPageModule::TearDown();
+  }
+
+  std::unique_ptr<CPDF_TestDocument> m_pDoc;
+  RetainPtr<StringWriteStream> m_pStream;
+};
+
+TEST_F(CPDF_PageWriterTest, StartWritesVersion) {
+  CPDF_PageWriter writer(m_pDoc.get(), m_pStream);
+  ASSERT_TRUE(writer.Start(14));
+  EXPECT_EQ(0u, m_pStream->ToString().find("%PDF-1.4\r\n"));
+
+  // Starting twice would write a second header.
+  EXPECT_FALSE(writer.Start(14));
+}
+
+TEST_F(CPDF_PageWriterTest, StartDefaultsToVersion17) {
+  CPDF_PageWriter writer(m_pDoc.get(), m_pStream);
+  ASSERT_TRUE(writer.Start(0));
+  EXPECT_EQ(0u, m_pStream->ToString().find("%PDF-1.7\r\n"));
+}
+
+TEST_F(CPDF_PageWriterTest, StartRejectsInvalidVersions) {
+  for (int32_t version : {-14, 1, 9, 18, 20}) {
+    CPDF_PageWriter writer(m_pDoc.get(), m_pStream);
+    EXPECT_FALSE(writer.Start(version)) << version;
+    EXPECT_FALSE(writer.WritePages()) << version;
+  }
+  EXPECT_TRUE(m_pStream->ToString().empty());
+}
+
+TEST_F(CPDF_PageWriterTest, WritePagesInBatches) {
+  const uint32_t font_objnum =
+      NewStream(m_pDoc.get(), "font data")->GetObjNum();
+  AddPageUsing(m_pDoc.get(), font_objnum);
+  AddPageUsing(m_pDoc.get(), font_objnum);
+
+  CPDF_PageWriter writer(m_pDoc.get(), m_pStream);
+  ASSERT_TRUE(writer.Start(0));
+  ASSERT_TRUE(writer.WritePages());
+  EXPECT_EQ(2u, writer.written_page_count());
+  EXPECT_EQ(0, m_pDoc->GetPageCount());
+  EXPECT_FALSE(m_pDoc->GetIndirectObject(font_objnum));
+
+  // Pages added later may still use the objects written already.
+  AddPageUsing(m_pDoc.get(), font_objnum);
+  ASSERT_TRUE(writer.Finish());
+  EXPECT_EQ(3u, writer.written_page_count());
+
+  const std::string output = m_pStream->ToString();
+  EXPECT_EQ(1u, CountOccurrences(output, "endstream"));
+  EXPECT_NE(std::string::npos, output.find("/Count 3"));
+  EXPECT_EQ(output.size() - strlen("%%EOF\r\n"), output.rfind("%%EOF\r\n"));
+}
+
+TEST_F(CPDF_PageWriterTest, DeduplicatorKeepsWrittenObjects) {
+  auto deduplicator = std::make_unique<CPDF_ObjectDeduplicator>(m_pDoc.get());
+  CPDF_ObjectDeduplicator* pDeduplicator = deduplicator.get();
+  m_pDoc->SetObjectIndex(std::move(deduplicator));
+
+  CPDF_Stream* font = NewStream(m_pDoc.get(), "font data");
+  const uint32_t font_objnum = font->GetObjNum();
+  EXPECT_EQ(font_objnum, pDeduplicator->FindOrAdd(font));
+  AddPageUsing(m_pDoc.get(), font_objnum);
+
+  CPDF_PageWriter writer(m_pDoc.get(), m_pStream);
+  ASSERT_TRUE(writer.Start(0));
+  ASSERT_TRUE(writer.WritePages());
+  EXPECT_FALSE(m_pDoc->GetIndirectObject(font_objnum));
+
+  // An identical object added after the batch got written shares the
+  // written one, so it does not get written again.
+  CPDF_Stream* font2 = NewStream(m_pDoc.get(), "font data");
+  const uint32_t shared_objnum = pDeduplicator->FindOrAdd(font2);
+  EXPECT_EQ(font_objnum, shared_objnum);
+  m_pDoc->DeleteIndirectObject(font2->GetObjNum());
+  AddPageUsing(m_pDoc.get(), shared_objnum);
+
+  // Objects that differ do not.
+  CPDF_Stream* other_font = NewStream(m_pDoc.get(), "other font data");
+  EXPECT_EQ(other_font->GetObjNum(), pDeduplicator->FindOrAdd(other_font));
+  AddPageUsing(m_pDoc.get(), other_font->GetObjNum());
+
+  ASSERT_TRUE(writer.Finish());
+  EXPECT_EQ(3u, writer.written_page_count());
+  EXPECT_EQ(2u, CountOccurrences(m_pStream->ToString(), "endstream"));
+}
@@ -32,8 +32,6 @@
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/fpdf_parser_utility.h"
 #include "core/fxcodec/fx_codec.h"
-#include "core/fxcrt/data_vector.h"
-#include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxcrt/maybe_owned.h"
 #include "core/fxcrt/scoped_set_insertion.h"
@@ -247,7 +245,6 @@ class CPDF_ICCBasedCS final : public CPDF_BasedCS {
                                       uint32_t nComponents);
 
   RetainPtr<CPDF_IccProfile> m_pProfile;
-  mutable DataVector<uint8_t> m_pCache;
   std::vector<float> m_pRanges;
 };
 
@@ -992,42 +989,11 @@ void CPDF_ICCBasedCS::TranslateImageLine(pdfium::span<uint8_t> dest_span,
     if (nPixelCount.IsValid())
       bTranslate = nPixelCount.ValueOrDie() < nMaxColors * 3 / 2;
   }
-  if (bTranslate && m_pProfile->IsSupported()) {
+  if (bTranslate) {
     m_pProfile->TranslateScanline(dest_span, src_span, pixels);
     return;
   }
-  if (m_pCache.empty()) {
-    m_pCache =
-        fxcrt::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(nMaxColors, 3);
-    auto temp_src = fxcrt::Vector2D<uint8_t, FxAllocAllocator<uint8_t>>(
-        nMaxColors, nComponents);
-    size_t src_index = 0;
-    for (int i = 0; i < nMaxColors; i++) {
-      uint32_t color = i;
-      uint32_t order = nMaxColors / 52;
-      for (uint32_t c = 0; c < nComponents; c++) {
-        temp_src[src_index++] = static_cast<uint8_t>(color / order * 5);
-        color %= order;
-        order /= 52;
-      }
-    }
-    if (m_pProfile->IsSupported()) {
-      m_pProfile->TranslateScanline(m_pCache, temp_src, nMaxColors);
-    }
-  }
-  uint8_t* pDestBuf = dest_span.data();
-  const uint8_t* pSrcBuf = src_span.data();
-  for (int i = 0; i < pixels; i++) {
-    int index = 0;
-    for (uint32_t c = 0; c < nComponents; c++) {
-      index = index * 52 + (*pSrcBuf) / 5;
-      pSrcBuf++;
-    }
-    index *= 3;
-    *pDestBuf++ = m_pCache[index];
-    *pDestBuf++ = m_pCache[index + 1];
-    *pDestBuf++ = m_pCache[index + 2];
-  }
+  m_pProfile->TranslateScanlineWithLut(dest_span, src_span, pixels);
 }
 
 bool CPDF_ICCBasedCS::IsNormal() const {
@@ -130,13 +130,7 @@ void CPDF_DeviceCS::TranslateImageLine(pdfium::span<uint8_t> dest_span,
             pDestBuf += 3;
           }
         } else {
-          for (int i = 0; i < pixels; i++) {
-            std::tie(pDestBuf[2], pDestBuf[1], pDestBuf[0]) =
-                AdobeCMYK_to_sRGB1(pSrcBuf[0], pSrcBuf[1], pSrcBuf[2],
-                                   pSrcBuf[3]);
-            pSrcBuf += 4;
-            pDestBuf += 3;
-          }
+          AdobeCMYK_to_sRGB1_BGR(dest_span, src_span, pixels);
         }
       }
       break;
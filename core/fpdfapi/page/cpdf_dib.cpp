@@ -6,6 +6,7 @@
 
 #include "core/fpdfapi/page/cpdf_dib.h"
 
+#include <math.h>
 #include <stdint.h>
 
 #include <algorithm>
@@ -43,6 +44,9 @@
 
 namespace {
 
+// No image dimension needs more halvings than this to reach a single pixel.
+constexpr uint32_t kMaxJpxReduction = 17;
+
 bool IsValidDimension(int value) {
   constexpr int kMaxImageDimension = 0x01FFFF;
   return value > 0 && value <= kMaxImageDimension;
@@ -214,11 +218,13 @@ CPDF_DIB::LoadState CPDF_DIB::StartLoadDIBBase(
     const CPDF_Dictionary* pPageResources,
     bool bStdCS,
     CPDF_ColorSpace::Family GroupFamily,
-    bool bLoadMask) {
+    bool bLoadMask,
+    const DecodeHint& hint) {
   m_bStdCS = bStdCS;
   m_bHasMask = bHasMask;
   m_GroupFamily = GroupFamily;
   m_bLoadMask = bLoadMask;
+  m_DecodeHint = hint;
 
   if (!m_pStream->IsInline())
     pFormResources = nullptr;
@@ -477,6 +483,11 @@ CPDF_DIB::LoadState CPDF_DIB::CreateDecoder() {
   if (!m_pDecoder)
     return LoadState::kFail;
 
+  if (m_ScaleDenom > 1) {
+    m_Width = (m_Width + m_ScaleDenom - 1) / m_ScaleDenom;
+    m_Height = (m_Height + m_ScaleDenom - 1) / m_ScaleDenom;
+  }
+
   const absl::optional<uint32_t> requested_pitch =
       fxge::CalculatePitch8(m_bpc, m_nComponents, m_Width);
   if (!requested_pitch.has_value())
@@ -492,9 +503,11 @@ CPDF_DIB::LoadState CPDF_DIB::CreateDecoder() {
 
 bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
                                 const CPDF_Dictionary* pParams) {
+  // libjpeg can scale by 1/2, 1/4 and 1/8 while decoding.
+  m_ScaleDenom = 1u << GetMaxResolutionReduction(3);
   m_pDecoder = JpegModule::CreateDecoder(
       src_span, m_Width, m_Height, m_nComponents,
-      !pParams || pParams->GetIntegerFor("ColorTransform", 1));
+      !pParams || pParams->GetIntegerFor("ColorTransform", 1), m_ScaleDenom);
   if (m_pDecoder)
     return true;
 
@@ -514,8 +527,9 @@ bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
 
   if (m_nComponents == static_cast<uint32_t>(info.num_components)) {
     m_bpc = info.bits_per_components;
-    m_pDecoder = JpegModule::CreateDecoder(src_span, m_Width, m_Height,
-                                           m_nComponents, info.color_transform);
+    m_pDecoder =
+        JpegModule::CreateDecoder(src_span, m_Width, m_Height, m_nComponents,
+                                  info.color_transform, m_ScaleDenom);
     return true;
   }
 
@@ -559,27 +573,111 @@ bool CPDF_DIB::CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
     return false;
 
   m_bpc = info.bits_per_components;
-  m_pDecoder = JpegModule::CreateDecoder(src_span, m_Width, m_Height,
-                                         m_nComponents, info.color_transform);
+  m_pDecoder =
+      JpegModule::CreateDecoder(src_span, m_Width, m_Height, m_nComponents,
+                                info.color_transform, m_ScaleDenom);
   return true;
 }
 
-RetainPtr<CFX_DIBitmap> CPDF_DIB::LoadJpxBitmap() {
+uint32_t CPDF_DIB::GetMaxResolutionReduction(uint32_t max_reduction) const {
+  const CFX_Size& max_size = m_DecodeHint.max_size;
+  if (max_size.width <= 0 || max_size.height <= 0)
+    return 0;
+
+  // Pick the largest reduction that still covers the required size.
+  for (uint32_t reduction = max_reduction; reduction > 0; --reduction) {
+    const uint32_t denom = 1u << reduction;
+    const int width = (m_Width + denom - 1) / denom;
+    const int height = (m_Height + denom - 1) / denom;
+    if (width >= max_size.width && height >= max_size.height)
+      return reduction;
+  }
+  return 0;
+}
+
+std::unique_ptr<CJPX_Decoder> CPDF_DIB::StartJpxDecode(bool allow_partial) {
+  m_ScaleDenom = 1;
+  m_bCropped = false;
   std::unique_ptr<CJPX_Decoder> decoder =
       CJPX_Decoder::Create(m_pStreamAcc->GetSpan(),
                            ColorSpaceOptionFromColorSpace(m_pColorSpace.Get()));
   if (!decoder)
     return nullptr;
 
-  if (!decoder->StartDecode())
-    return nullptr;
-
   CJPX_Decoder::JpxImageInfo image_info = decoder->GetInfo();
   if (static_cast<int>(image_info.width) < m_Width ||
       static_cast<int>(image_info.height) < m_Height) {
     return nullptr;
   }
 
+  if (allow_partial) {
+    // Codestreams may have fewer resolution levels than asked for. Settle
+    // for the largest reduction they can provide.
+    for (uint32_t reduction = GetMaxResolutionReduction(kMaxJpxReduction);
+         reduction > 0; --reduction) {
+      if (decoder->SetResolutionReduction(reduction)) {
+        m_ScaleDenom = 1u << reduction;
+        break;
+      }
+    }
+    absl::optional<FX_RECT> area = GetJpxDecodeArea();
+    if (area.has_value())
+      m_bCropped = decoder->SetDecodeArea(area.value());
+  }
+
+  if (!decoder->StartDecode())
+    return nullptr;
+
+  return decoder;
+}
+
+absl::optional<FX_RECT> CPDF_DIB::GetJpxDecodeArea() const {
+  // Written so NaNs fail the check.
+  const CFX_FloatRect& visible = m_DecodeHint.visible_area;
+  if (!(visible.left >= 0 && visible.bottom >= 0 && visible.right <= 1 &&
+        visible.top <= 1) ||
+      visible.IsEmpty()) {
+    return absl::nullopt;
+  }
+
+  // Map from the unit square, where y points up, to pixel rows and columns.
+  // Keep a margin of a few reduced pixels for the resampling filters.
+  const float margin = 2.0f * m_ScaleDenom;
+  const float left = visible.left * m_Width - margin;
+  const float right = visible.right * m_Width + margin;
+  const float top = (1.0f - visible.top) * m_Height - margin;
+  const float bottom = (1.0f - visible.bottom) * m_Height + margin;
+  if (!(left > 0 || top > 0 || right < m_Width || bottom < m_Height))
+    return absl::nullopt;
+
+  FX_RECT area(static_cast<int>(floorf(std::max(left, 0.0f))),
+               static_cast<int>(floorf(std::max(top, 0.0f))),
+               static_cast<int>(ceilf(std::min<float>(right, m_Width))),
+               static_cast<int>(ceilf(std::min<float>(bottom, m_Height))));
+  if (area.IsEmpty())
+    return absl::nullopt;
+
+  return area;
+}
+
+RetainPtr<CFX_DIBitmap> CPDF_DIB::LoadJpxBitmap() {
+  std::unique_ptr<CJPX_Decoder> decoder =
+      StartJpxDecode(/*allow_partial=*/true);
+  if (!decoder && (IsDownscaled() || IsCropped())) {
+    // Tiles can declare fewer resolution levels than the main header does,
+    // which only shows up while decoding. Fall back to a full decode.
+    decoder = StartJpxDecode(/*allow_partial=*/false);
+  }
+  if (!decoder)
+    return nullptr;
+
+  if (IsDownscaled()) {
+    m_Width = (m_Width + m_ScaleDenom - 1) / m_ScaleDenom;
+    m_Height = (m_Height + m_ScaleDenom - 1) / m_ScaleDenom;
+  }
+
+  CJPX_Decoder::JpxImageInfo image_info = decoder->GetInfo();
+
   RetainPtr<CPDF_ColorSpace> original_colorspace = m_pColorSpace;
   bool swap_rgb = false;
   bool convert_argb_to_rgb = false;
@@ -806,7 +904,8 @@ CPDF_DIB::LoadState CPDF_DIB::StartLoadMaskDIB(
     RetainPtr<const CPDF_Stream> mask_stream) {
   m_pMask = pdfium::MakeRetain<CPDF_DIB>(m_pDocument.Get(), mask_stream.Get());
   LoadState ret = m_pMask->StartLoadDIBBase(
-      false, nullptr, nullptr, true, CPDF_ColorSpace::Family::kUnknown, false);
+      false, nullptr, nullptr, true, CPDF_ColorSpace::Family::kUnknown, false,
+      m_DecodeHint);
   if (ret == LoadState::kContinue) {
     if (m_Status == LoadState::kFail)
       m_Status = LoadState::kContinue;
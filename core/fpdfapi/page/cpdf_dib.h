@@ -14,9 +14,11 @@
 
 #include "core/fpdfapi/page/cpdf_colorspace.h"
 #include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
 #include "core/fxge/dib/cfx_dibbase.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/base/span.h"
 
 class CPDF_Dictionary;
@@ -32,6 +34,7 @@ struct DIB_COMP_DATA {
 };
 
 namespace fxcodec {
+class CJPX_Decoder;
 class Jbig2Context;
 class ScanlineDecoder;
 }  // namespace fxcodec
@@ -42,6 +45,19 @@ class CPDF_DIB final : public CFX_DIBBase {
  public:
   enum class LoadState : uint8_t { kFail, kSuccess, kContinue };
 
+  // Describes how the image is about to be drawn. Decoders that can cheaply
+  // produce less than the full image may do so, as long as the result still
+  // covers what is asked for here. The default asks for the whole image.
+  struct DecodeHint {
+    // Size, in device pixels, the image will be drawn at. Empty means full
+    // resolution.
+    CFX_Size max_size;
+
+    // Part of the image that will be visible, in the image's unit square
+    // (origin at the bottom left). Empty means all of it.
+    CFX_FloatRect visible_area;
+  };
+
   CONSTRUCT_VIA_MAKE_RETAIN;
 
   // CFX_DIBBase:
@@ -54,13 +70,23 @@ class CPDF_DIB final : public CFX_DIBBase {
   uint32_t GetMatteColor() const { return m_MatteColor; }
   bool IsJBigImage() const;
 
+  // Whether the image was decoded at a lower resolution than it has, because
+  // that was all the DecodeHint asked for.
+  bool IsDownscaled() const { return m_ScaleDenom > 1; }
+
+  // Whether only the DecodeHint's visible area of the image was decoded.
+  // The rest of the image is left white.
+  bool IsCropped() const { return m_bCropped; }
+
   bool Load();
+
   LoadState StartLoadDIBBase(bool bHasMask,
                              const CPDF_Dictionary* pFormResources,
                              const CPDF_Dictionary* pPageResources,
                              bool bStdCS,
                              CPDF_ColorSpace::Family GroupFamily,
-                             bool bLoadMask);
+                             bool bLoadMask,
+                             const DecodeHint& hint);
   LoadState ContinueLoadDIBBase(PauseIndicatorIface* pPause);
   RetainPtr<CPDF_DIB> DetachMask();
 
@@ -88,10 +114,15 @@ class CPDF_DIB final : public CFX_DIBBase {
                      const CPDF_Dictionary* pPageResources);
   bool GetDecodeAndMaskArray();
   RetainPtr<CFX_DIBitmap> LoadJpxBitmap();
+  std::unique_ptr<fxcodec::CJPX_Decoder> StartJpxDecode(bool allow_partial);
+  absl::optional<FX_RECT> GetJpxDecodeArea() const;
   void LoadPalette();
   LoadState CreateDecoder();
   bool CreateDCTDecoder(pdfium::span<const uint8_t> src_span,
                         const CPDF_Dictionary* pParams);
+  // Returns the largest `n` up to `max_reduction` for which the image scaled
+  // down by 2^n still satisfies the DecodeHint's size.
+  uint32_t GetMaxResolutionReduction(uint32_t max_reduction) const;
   void TranslateScanline24bpp(pdfium::span<uint8_t> dest_scan,
                               pdfium::span<const uint8_t> src_scan) const;
   bool TranslateScanline24bppDefaultDecode(
@@ -115,6 +146,8 @@ class CPDF_DIB final : public CFX_DIBBase {
   CPDF_ColorSpace::Family m_Family = CPDF_ColorSpace::Family::kUnknown;
   CPDF_ColorSpace::Family m_GroupFamily = CPDF_ColorSpace::Family::kUnknown;
   uint32_t m_MatteColor = 0;
+  uint32_t m_ScaleDenom = 1;
+  DecodeHint m_DecodeHint;
   LoadState m_Status = LoadState::kFail;
   bool m_bLoadMask = false;
   bool m_bDefaultDecode = true;
@@ -123,6 +156,7 @@ class CPDF_DIB final : public CFX_DIBBase {
   bool m_bColorKey = false;
   bool m_bHasMask = false;
   bool m_bStdCS = false;
+  bool m_bCropped = false;
   std::vector<DIB_COMP_DATA> m_CompData;
   mutable DataVector<uint8_t> m_LineBuf;
   mutable DataVector<uint8_t> m_MaskBuf;
@@ -6,8 +6,10 @@
 
 #include "core/fpdfapi/page/cpdf_iccprofile.h"
 
+#include "core/fpdfapi/page/cpdf_pagemodule.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fxcodec/icc/icc_transform.h"
+#include "core/fxcodec/icc/icc_transform_cache.h"
 
 namespace {
 
@@ -26,7 +28,9 @@ CPDF_IccProfile::CPDF_IccProfile(const CPDF_Stream* pStream,
     return;
   }
 
-  m_Transform = fxcodec::IccTransform::CreateTransformSRGB(span);
+  m_Transform = CPDF_PageModule::GetInstance()
+                    ->GetIccTransformCache()
+                    ->GetTransformSRGB(span);
   if (m_Transform)
     m_nSrcComponents = m_Transform->components();
 }
@@ -47,3 +51,10 @@ void CPDF_IccProfile::TranslateScanline(pdfium::span<uint8_t> pDest,
                                         int pixels) {
   m_Transform->TranslateScanline(pDest, pSrc, pixels);
 }
+
+void CPDF_IccProfile::TranslateScanlineWithLut(
+    pdfium::span<uint8_t> pDest,
+    pdfium::span<const uint8_t> pSrc,
+    int pixels) {
+  m_Transform->TranslateScanlineWithLut(pDest, pSrc, pixels);
+}
@@ -9,8 +9,6 @@
 
 #include <stdint.h>
 
-#include <memory>
-
 #include "core/fxcrt/observed_ptr.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "third_party/base/span.h"
@@ -36,6 +34,9 @@ class CPDF_IccProfile final : public Retainable, public Observable {
   void TranslateScanline(pdfium::span<uint8_t> pDest,
                          pdfium::span<const uint8_t> pSrc,
                          int pixels);
+  void TranslateScanlineWithLut(pdfium::span<uint8_t> pDest,
+                                pdfium::span<const uint8_t> pSrc,
+                                int pixels);
 
  private:
   // Keeps stream alive for the duration of the CPDF_IccProfile.
@@ -45,7 +46,7 @@ class CPDF_IccProfile final : public Retainable, public Observable {
   const bool m_bsRGB;
   uint32_t m_nSrcComponents = 0;
   RetainPtr<const CPDF_Stream> const m_pStream;  // Used by `m_Transform`.
-  std::unique_ptr<fxcodec::IccTransform> m_Transform;
+  RetainPtr<fxcodec::IccTransform> m_Transform;
 };
 
 #endif  // CORE_FPDFAPI_PAGE_CPDF_ICCPROFILE_H_
@@ -148,6 +148,12 @@ void CPDF_Image::SetJpegImage(RetainPtr<IFX_SeekableReadStream> pFile) {
     return;
 
   m_pStream->InitStreamFromFile(std::move(pFile), std::move(pDict));
+
+  // The stream keeps its address, so decodes of the old image cached for
+  // other pages would still match it.
+  CPDF_Document::RenderDataIface* pRenderData = m_pDocument->GetRenderData();
+  if (pRenderData)
+    pRenderData->MaybePurgeImage(m_pStream.Get());
 }
 
 void CPDF_Image::SetJpegImageInline(RetainPtr<IFX_SeekableReadStream> pFile) {
@@ -362,10 +368,12 @@ bool CPDF_Image::StartLoadDIBBase(const CPDF_Dictionary* pFormResource,
                                   const CPDF_Dictionary* pPageResource,
                                   bool bStdCS,
                                   CPDF_ColorSpace::Family GroupFamily,
-                                  bool bLoadMask) {
+                                  bool bLoadMask,
+                                  const CPDF_DIB::DecodeHint& hint) {
   RetainPtr<CPDF_DIB> source = CreateNewDIB();
-  CPDF_DIB::LoadState ret = source->StartLoadDIBBase(
-      true, pFormResource, pPageResource, bStdCS, GroupFamily, bLoadMask);
+  CPDF_DIB::LoadState ret =
+      source->StartLoadDIBBase(true, pFormResource, pPageResource, bStdCS,
+                               GroupFamily, bLoadMask, hint);
   if (ret == CPDF_DIB::LoadState::kFail) {
     m_pDIBBase.Reset();
     return false;
@@ -10,6 +10,7 @@
 #include "core/fpdfapi/page/cpdf_colorspace.h"
 #include "core/fpdfapi/page/cpdf_devicecs.h"
 #include "core/fpdfapi/page/cpdf_patterncs.h"
+#include "core/fxcodec/icc/icc_transform_cache.h"
 #include "third_party/base/check.h"
 
 namespace {
@@ -44,7 +45,8 @@ CPDF_PageModule::CPDF_PageModule()
           CPDF_ColorSpace::Family::kDeviceRGB)),
       m_StockCMYKCS(pdfium::MakeRetain<CPDF_DeviceCS>(
           CPDF_ColorSpace::Family::kDeviceCMYK)),
-      m_StockPatternCS(pdfium::MakeRetain<CPDF_PatternCS>()) {
+      m_StockPatternCS(pdfium::MakeRetain<CPDF_PatternCS>()),
+      m_pIccTransformCache(std::make_unique<fxcodec::IccTransformCache>()) {
   m_StockPatternCS->InitializeStockPattern();
   CPDF_FontGlobals::Create();
   CPDF_FontGlobals::GetInstance()->LoadEmbeddedMaps();
@@ -7,6 +7,8 @@
 #ifndef CORE_FPDFAPI_PAGE_CPDF_PAGEMODULE_H_
 #define CORE_FPDFAPI_PAGE_CPDF_PAGEMODULE_H_
 
+#include <memory>
+
 #include "core/fpdfapi/page/cpdf_colorspace.h"
 #include "core/fxcrt/retain_ptr.h"
 
@@ -14,6 +16,10 @@ class CPDF_Document;
 class CPDF_DeviceCS;
 class CPDF_PatternCS;
 
+namespace fxcodec {
+class IccTransformCache;
+}  // namespace fxcodec
+
 class CPDF_PageModule {
  public:
   // Per-process singleton managed by callers.
@@ -23,6 +29,9 @@ class CPDF_PageModule {
 
   RetainPtr<CPDF_ColorSpace> GetStockCS(CPDF_ColorSpace::Family family);
   void ClearStockFont(CPDF_Document* pDoc);
+  fxcodec::IccTransformCache* GetIccTransformCache() const {
+    return m_pIccTransformCache.get();
+  }
 
  private:
   CPDF_PageModule();
@@ -32,6 +41,7 @@ class CPDF_PageModule {
   RetainPtr<CPDF_DeviceCS> m_StockRGBCS;
   RetainPtr<CPDF_DeviceCS> m_StockCMYKCS;
   RetainPtr<CPDF_PatternCS> m_StockPatternCS;
+  std::unique_ptr<fxcodec::IccTransformCache> m_pIccTransformCache;
 };
 
 #endif  // CORE_FPDFAPI_PAGE_CPDF_PAGEMODULE_H_
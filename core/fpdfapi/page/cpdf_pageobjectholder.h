@@ -67,6 +67,12 @@ class CPDF_PageObjectHolder {
   void ContinueParse(PauseIndicatorIface* pPause);
   ParseState GetParseState() const { return m_ParseState; }
 
+  // Must be set before parsing starts. When set, parsing creates text objects
+  // only and skips paths, images, shadings and clipping. Good enough for text
+  // extraction, but not for rendering or content generation.
+  bool IsTextOnly() const { return m_bTextOnly; }
+  void SetTextOnly(bool text_only) { m_bTextOnly = text_only; }
+
   CPDF_Document* GetDocument() const { return m_pDocument.Get(); }
   const CPDF_Dictionary* GetDict() const { return m_pDict.Get(); }
   RetainPtr<CPDF_Dictionary> GetMutableDict() { return m_pDict; }
@@ -126,6 +132,7 @@ class CPDF_PageObjectHolder {
 
  private:
   bool m_bBackgroundAlphaNeeded = false;
+  bool m_bTextOnly = false;
   ParseState m_ParseState = ParseState::kNotParsed;
   RetainPtr<CPDF_Dictionary> const m_pDict;
   UnownedPtr<CPDF_Document> m_pDocument;
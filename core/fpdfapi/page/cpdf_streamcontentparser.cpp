@@ -259,7 +259,8 @@ CPDF_StreamContentParser::CPDF_StreamContentParser(
       m_pObjectHolder(pObjHolder),
       m_ParsedSet(pParsedSet),
       m_BBox(rcBBox),
-      m_pCurStates(std::make_unique<CPDF_AllStates>()) {
+      m_pCurStates(std::make_unique<CPDF_AllStates>()),
+      m_bTextOnly(pObjHolder->IsTextOnly()) {
   if (pmtContentToUser)
     m_mtContentToUser = *pmtContentToUser;
   if (pStates) {
@@ -650,6 +651,9 @@ void CPDF_StreamContentParser::Handle_BeginImage() {
     if (m_pSyntax->GetWord() == "EI")
       break;
   }
+  if (m_bTextOnly)
+    return;
+
   CPDF_ImageObject* pObj = AddImage(std::move(pStream));
   // Record the bounding box of this image, so rendering code can draw it
   // properly.
@@ -721,6 +725,9 @@ void CPDF_StreamContentParser::Handle_SetCachedDevice() {
 
 void CPDF_StreamContentParser::Handle_ExecuteXObject() {
   ByteString name = GetString(0);
+  if (m_bTextOnly && name == m_LastImageName)
+    return;
+
   if (name == m_LastImageName && m_pLastImage && m_pLastImage->GetStream() &&
       m_pLastImage->GetStream()->GetObjNum()) {
     CPDF_ImageObject* pObj = AddImage(m_pLastImage);
@@ -745,6 +752,12 @@ void CPDF_StreamContentParser::Handle_ExecuteXObject() {
   }
 
   if (type == "Image") {
+    if (m_bTextOnly) {
+      // Remember the name so repeated uses are rejected without a lookup.
+      m_LastImageName = std::move(name);
+      return;
+    }
+
     CPDF_ImageObject* pObj = pXObject->IsInline()
                                  ? AddImage(ToStream(pXObject->Clone()))
                                  : AddImage(pXObject->GetObjNum());
@@ -767,6 +780,7 @@ void CPDF_StreamContentParser::AddForm(RetainPtr<CPDF_Stream> pStream) {
   auto form =
       std::make_unique<CPDF_Form>(m_pDocument.Get(), m_pPageResources,
                                   std::move(pStream), m_pResources.Get());
+  form->SetTextOnly(m_bTextOnly);
   form->ParseContent(&status, nullptr, m_ParsedSet.Get());
 
   CFX_Matrix matrix = m_pCurStates->m_CTM * m_mtContentToUser;
@@ -1068,6 +1082,9 @@ void CPDF_StreamContentParser::Handle_SetColorPS_Stroke() {
 }
 
 void CPDF_StreamContentParser::Handle_ShadeFill() {
+  if (m_bTextOnly)
+    return;
+
   RetainPtr<CPDF_ShadingPattern> pShading = FindShading(GetString(0));
   if (!pShading)
     return;
@@ -1239,7 +1256,7 @@ void CPDF_StreamContentParser::AddTextObject(const ByteString* pStrs,
 
     m_pCurStates->m_TextPos +=
         pText->CalcPositionData(m_pCurStates->m_TextHorzScale);
-    if (TextRenderingModeIsClipMode(text_mode))
+    if (TextRenderingModeIsClipMode(text_mode) && !m_bTextOnly)
       m_ClipTextList.push_back(pText->Clone());
     m_pObjectHolder->AppendPageObject(std::move(pText));
   }
@@ -1409,6 +1426,9 @@ void CPDF_StreamContentParser::Handle_Invalid() {}
 
 void CPDF_StreamContentParser::AddPathPoint(const CFX_PointF& point,
                                             CFX_Path::Point::Type type) {
+  if (m_bTextOnly)
+    return;
+
   // If the path point is the same move as the previous one and neither of them
   // closes the path, then just skip it.
   if (type == CFX_Path::Point::Type::kMove && !m_PathPoints.empty() &&
@@ -1449,7 +1469,7 @@ void CPDF_StreamContentParser::AddPathObject(
   CFX_FillRenderOptions::FillType path_clip_type = m_PathClipType;
   m_PathClipType = CFX_FillRenderOptions::FillType::kNoFill;
 
-  if (path_points.empty())
+  if (path_points.empty() || m_bTextOnly)
     return;
 
   if (path_points.size() == 1) {
@@ -237,6 +237,7 @@ class CPDF_StreamContentParser {
       CFX_FillRenderOptions::FillType::kNoFill;
   ByteString m_LastImageName;
   RetainPtr<CPDF_Image> m_pLastImage;
+  const bool m_bTextOnly;
   bool m_bColored = false;
   std::vector<std::unique_ptr<CPDF_AllStates>> m_StateStack;
   float m_Type3Data[6] = {0.0f};
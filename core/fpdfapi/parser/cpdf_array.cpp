@@ -184,13 +184,20 @@ const CPDF_Array* CPDF_Array::GetArrayAt(size_t index) const {
 
 void CPDF_Array::Clear() {
   CHECK(!IsLocked());
+  if (m_Objects.empty())
+    return;
+
+  SetModified();
   m_Objects.clear();
 }
 
 void CPDF_Array::RemoveAt(size_t index) {
   CHECK(!IsLocked());
-  if (index < m_Objects.size())
-    m_Objects.erase(m_Objects.begin() + index);
+  if (index >= m_Objects.size())
+    return;
+
+  SetModified();
+  m_Objects.erase(m_Objects.begin() + index);
 }
 
 void CPDF_Array::ConvertToIndirectObjectAt(size_t index,
@@ -202,6 +209,7 @@ void CPDF_Array::ConvertToIndirectObjectAt(size_t index,
   if (!m_Objects[index] || m_Objects[index]->IsReference())
     return;
 
+  SetModified();
   CPDF_Object* pNew = pHolder->AddIndirectObject(std::move(m_Objects[index]));
   m_Objects[index] = pNew->MakeReference(pHolder);
 }
@@ -213,6 +221,7 @@ CPDF_Object* CPDF_Array::SetAt(size_t index, RetainPtr<CPDF_Object> pObj) {
   if (index >= m_Objects.size())
     return nullptr;
 
+  SetModified();
   CPDF_Object* pRet = pObj.Get();
   m_Objects[index] = std::move(pObj);
   return pRet;
@@ -225,6 +234,7 @@ CPDF_Object* CPDF_Array::InsertAt(size_t index, RetainPtr<CPDF_Object> pObj) {
   if (index > m_Objects.size())
     return nullptr;
 
+  SetModified();
   CPDF_Object* pRet = pObj.Get();
   m_Objects.insert(m_Objects.begin() + index, std::move(pObj));
   return pRet;
@@ -234,6 +244,7 @@ CPDF_Object* CPDF_Array::Append(RetainPtr<CPDF_Object> pObj) {
   CHECK(!IsLocked());
   CHECK(pObj);
   CHECK(pObj->IsInline());
+  SetModified();
   CPDF_Object* pRet = pObj.Get();
   m_Objects.push_back(std::move(pObj));
   return pRet;
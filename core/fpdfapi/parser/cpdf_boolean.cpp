@@ -31,6 +31,7 @@ int CPDF_Boolean::GetInteger() const {
 }
 
 void CPDF_Boolean::SetString(const ByteString& str) {
+  SetModified();
   m_bValue = (str == "true");
 }
 
@@ -14,6 +14,7 @@
 
 #include "constants/form_fields.h"
 #include "core/fdrm/fx_crypt.h"
+#include "core/fpdfapi/parser/cpdf_decryptor.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
 #include "core/fpdfapi/parser/cpdf_object_walker.h"
@@ -21,7 +22,6 @@
 #include "core/fpdfapi/parser/cpdf_security_handler.h"
 #include "core/fpdfapi/parser/cpdf_simple_parser.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
-#include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
 #include "third_party/base/check.h"
 #include "third_party/base/check_op.h"
@@ -92,23 +92,12 @@ void CPDF_CryptoHandler::EncryptContent(uint32_t objnum,
   }
 }
 
-struct AESCryptContext {
-  bool m_bIV;
-  uint32_t m_BlockOffset;
-  CRYPT_aes_context m_Context;
-  uint8_t m_Block[16];
-};
-
-void* CPDF_CryptoHandler::DecryptStart(uint32_t objnum, uint32_t gennum) {
-  if (m_Cipher == Cipher::kNone)
-    return this;
-
+RetainPtr<CPDF_Decryptor> CPDF_CryptoHandler::CreateDecryptor(
+    uint32_t objnum,
+    uint32_t gennum) const {
   if (m_Cipher == Cipher::kAES && m_KeyLen == 32) {
-    AESCryptContext* pContext = FX_Alloc(AESCryptContext, 1);
-    pContext->m_bIV = true;
-    pContext->m_BlockOffset = 0;
-    CRYPT_AESSetKey(&pContext->m_Context, m_EncryptKey, 32);
-    return pContext;
+    return pdfium::MakeRetain<CPDF_Decryptor>(
+        Cipher::kAES, pdfium::make_span(m_EncryptKey, m_KeyLen));
   }
   uint8_t key1[48];
   PopulateKey(objnum, gennum, key1);
@@ -119,105 +108,12 @@ void* CPDF_CryptoHandler::DecryptStart(uint32_t objnum, uint32_t gennum) {
   uint8_t realkey[16];
   size_t len = m_Cipher == Cipher::kAES ? m_KeyLen + 9 : m_KeyLen + 5;
   CRYPT_MD5Generate({key1, len}, realkey);
-  size_t realkeylen = std::min(m_KeyLen + 5, sizeof(realkey));
-
-  if (m_Cipher == Cipher::kAES) {
-    AESCryptContext* pContext = FX_Alloc(AESCryptContext, 1);
-    pContext->m_bIV = true;
-    pContext->m_BlockOffset = 0;
-    CRYPT_AESSetKey(&pContext->m_Context, realkey, 16);
-    return pContext;
-  }
-  CRYPT_rc4_context* pContext = FX_Alloc(CRYPT_rc4_context, 1);
-  CRYPT_ArcFourSetup(pContext, {realkey, realkeylen});
-  return pContext;
-}
-
-bool CPDF_CryptoHandler::DecryptStream(void* context,
-                                       pdfium::span<const uint8_t> source,
-                                       BinaryBuffer& dest_buf) {
-  if (!context)
-    return false;
-
-  if (m_Cipher == Cipher::kNone) {
-    dest_buf.AppendBlock(source.data(), source.size());
-    return true;
-  }
-  if (m_Cipher == Cipher::kRC4) {
-    size_t old_size = dest_buf.GetSize();
-    dest_buf.AppendBlock(source.data(), source.size());
-    CRYPT_ArcFourCrypt(static_cast<CRYPT_rc4_context*>(context),
-                       dest_buf.GetSpan().subspan(old_size, source.size()));
-    return true;
-  }
-  AESCryptContext* pContext = static_cast<AESCryptContext*>(context);
-  uint32_t src_off = 0;
-  uint32_t src_left = source.size();
-  while (true) {
-    uint32_t copy_size = 16 - pContext->m_BlockOffset;
-    if (copy_size > src_left) {
-      copy_size = src_left;
-    }
-    memcpy(pContext->m_Block + pContext->m_BlockOffset, source.data() + src_off,
-           copy_size);
-    src_off += copy_size;
-    src_left -= copy_size;
-    pContext->m_BlockOffset += copy_size;
-    if (pContext->m_BlockOffset == 16) {
-      if (pContext->m_bIV) {
-        CRYPT_AESSetIV(&pContext->m_Context, pContext->m_Block);
-        pContext->m_bIV = false;
-        pContext->m_BlockOffset = 0;
-      } else if (src_off < source.size()) {
-        uint8_t block_buf[16];
-        CRYPT_AESDecrypt(&pContext->m_Context, block_buf, pContext->m_Block,
-                         16);
-        dest_buf.AppendBlock(block_buf, 16);
-        pContext->m_BlockOffset = 0;
-      }
-    }
-    if (!src_left) {
-      break;
-    }
-  }
-  return true;
-}
-
-bool CPDF_CryptoHandler::DecryptFinish(void* context, BinaryBuffer& dest_buf) {
-  if (!context)
-    return false;
-
-  if (m_Cipher == Cipher::kNone)
-    return true;
-
-  if (m_Cipher == Cipher::kRC4) {
-    FX_Free(context);
-    return true;
-  }
-  auto* pContext = static_cast<AESCryptContext*>(context);
-  if (pContext->m_BlockOffset == 16) {
-    uint8_t block_buf[16];
-    CRYPT_AESDecrypt(&pContext->m_Context, block_buf, pContext->m_Block, 16);
-    if (block_buf[15] <= 16) {
-      dest_buf.AppendBlock(block_buf, 16 - block_buf[15]);
-    }
-  }
-  FX_Free(pContext);
-  return true;
-}
-
-ByteString CPDF_CryptoHandler::Decrypt(uint32_t objnum,
-                                       uint32_t gennum,
-                                       const ByteString& str) {
-  BinaryBuffer dest_buf;
-  void* context = DecryptStart(objnum, gennum);
-  DecryptStream(context, str.raw_span(), dest_buf);
-  DecryptFinish(context, dest_buf);
-  return ByteString(dest_buf.GetSpan());
-}
+  if (m_Cipher == Cipher::kAES)
+    return pdfium::MakeRetain<CPDF_Decryptor>(Cipher::kAES, realkey);
 
-size_t CPDF_CryptoHandler::DecryptGetSize(size_t src_size) {
-  return m_Cipher == Cipher::kAES ? src_size - 16 : src_size;
+  size_t realkeylen = std::min(m_KeyLen + 5, sizeof(realkey));
+  return pdfium::MakeRetain<CPDF_Decryptor>(
+      Cipher::kRC4, pdfium::make_span(realkey, realkeylen));
 }
 
 bool CPDF_CryptoHandler::IsCipherAES() const {
@@ -228,14 +124,17 @@ bool CPDF_CryptoHandler::DecryptObjectTree(RetainPtr<CPDF_Object> object) {
   if (!object)
     return false;
 
+  if (m_Cipher == Cipher::kNone)
+    return true;
+
   struct MayBeSignature {
     const CPDF_Dictionary* parent;
     CPDF_Object* contents;
   };
 
   std::stack<MayBeSignature> may_be_sign_dictionaries;
-  const uint32_t obj_num = object->GetObjNum();
-  const uint32_t gen_num = object->GetGenNum();
+  RetainPtr<const CPDF_Decryptor> decryptor =
+      CreateDecryptor(object->GetObjNum(), object->GetGenNum());
 
   CPDF_Object* object_to_decrypt = object.Get();
   while (object_to_decrypt) {
@@ -257,39 +156,11 @@ bool CPDF_CryptoHandler::DecryptObjectTree(RetainPtr<CPDF_Object> object) {
         walker.SkipWalkIntoCurrentObject();
         continue;
       }
-      // Strings decryption.
-      if (child->IsString()) {
-        // TODO(art-snake): Move decryption into the CPDF_String class.
-        CPDF_String* str = child->AsString();
-        str->SetString(Decrypt(obj_num, gen_num, str->GetString()));
-      }
-      // Stream decryption.
-      if (child->IsStream()) {
-        // TODO(art-snake): Move decryption into the CPDF_Stream class.
-        CPDF_Stream* stream = child->AsStream();
-        auto stream_access = pdfium::MakeRetain<CPDF_StreamAcc>(stream);
-        stream_access->LoadAllDataRaw();
-
-        if (IsCipherAES() && stream_access->GetSize() < 16) {
-          stream->SetData({});
-          continue;
-        }
-
-        BinaryBuffer decrypted_buf;
-        decrypted_buf.EstimateSize(DecryptGetSize(stream_access->GetSize()));
-
-        void* context = DecryptStart(obj_num, gen_num);
-        bool decrypt_result =
-            DecryptStream(context, stream_access->GetSpan(), decrypted_buf);
-        decrypt_result &= DecryptFinish(context, decrypted_buf);
-        if (decrypt_result) {
-          const uint32_t decrypted_size = decrypted_buf.GetSize();
-          stream->TakeData(decrypted_buf.DetachBuffer(), decrypted_size);
-        } else {
-          // Decryption failed, set the stream to empty
-          stream->SetData({});
-        }
-      }
+      // Strings and streams get decrypted when their data first gets used.
+      if (child->IsString())
+        child->AsString()->SetDecryptor(decryptor);
+      else if (child->IsStream())
+        child->AsStream()->SetDecryptor(decryptor);
     }
     // Signature dictionaries check.
     while (!may_be_sign_dictionaries.empty()) {
@@ -13,12 +13,11 @@
 #include <memory>
 
 #include "core/fdrm/fx_crypt.h"
-#include "core/fxcrt/binary_buffer.h"
-#include "core/fxcrt/bytestring.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "third_party/base/span.h"
 
+class CPDF_Decryptor;
 class CPDF_Dictionary;
 class CPDF_Object;
 
@@ -47,13 +46,10 @@ class CPDF_CryptoHandler {
   bool IsCipherAES() const;
 
  private:
-  size_t DecryptGetSize(size_t src_size);
-  void* DecryptStart(uint32_t objnum, uint32_t gennum);
-  ByteString Decrypt(uint32_t objnum, uint32_t gennum, const ByteString& str);
-  bool DecryptStream(void* context,
-                     pdfium::span<const uint8_t> source,
-                     BinaryBuffer& dest_buf);
-  bool DecryptFinish(void* context, BinaryBuffer& dest_buf);
+  // Returns the decryptor for the object numbered `objnum`, `gennum`. The
+  // cipher must not be kNone.
+  RetainPtr<CPDF_Decryptor> CreateDecryptor(uint32_t objnum,
+                                            uint32_t gennum) const;
   void PopulateKey(uint32_t objnum, uint32_t gennum, uint8_t* key) const;
 
   const size_t m_KeyLen;
@@ -12,12 +12,14 @@
 
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_cross_ref_avail.h"
+#include "core/fpdfapi/parser/cpdf_cross_ref_table.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_hint_tables.h"
 #include "core/fpdfapi/parser/cpdf_linearized_header.h"
 #include "core/fpdfapi/parser/cpdf_name.h"
 #include "core/fpdfapi/parser/cpdf_number.h"
+#include "core/fpdfapi/parser/cpdf_object_walker.h"
 #include "core/fpdfapi/parser/cpdf_page_object_avail.h"
 #include "core/fpdfapi/parser/cpdf_read_validator.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
@@ -68,8 +70,112 @@ class HintsScope {
   RetainPtr<CPDF_ReadValidator> validator_;
 };
 
+// Adds the objects `object` refers to, other than its parent and pages other
+// than `root`, to `refs`, skipping the same objects CPDF_PageObjectAvail does.
+void AppendObjectRefs(const CPDF_Object* object,
+                      const CPDF_Object* root,
+                      std::vector<uint32_t>* refs) {
+  CPDF_ObjectWalker walker(object);
+  while (const CPDF_Object* obj = walker.GetNext()) {
+    if (walker.dictionary_key() == "Parent" ||
+        (obj != root && ValidateDictType(ToDictionary(obj), "Page"))) {
+      walker.SkipWalkIntoCurrentObject();
+      continue;
+    }
+    if (obj->IsReference())
+      refs->push_back(obj->AsReference()->GetRefObjNum());
+  }
+}
+
 }  // namespace
 
+// Collects the parts of the file still missing. Objects are taken to end where
+// the next object in the cross reference table starts.
+class CPDF_DataAvail::DownloadPlan {
+ public:
+  DownloadPlan(RetainPtr<CPDF_ReadValidator> validator,
+               const CPDF_CrossRefTable* cross_ref_table)
+      : m_pValidator(std::move(validator)),
+        m_pCrossRefTable(cross_ref_table) {
+    if (!m_pCrossRefTable)
+      return;
+    for (const auto& it : m_pCrossRefTable->objects_info()) {
+      if (it.second.type == CPDF_CrossRefTable::ObjectType::kNormal)
+        m_ObjectOffsets.push_back(it.second.pos);
+    }
+    std::sort(m_ObjectOffsets.begin(), m_ObjectOffsets.end());
+  }
+
+  // Adds `size` bytes from `offset`, unless they are available. Like
+  // CPDF_ReadValidator::CheckDataRangeAndRequestIfUnavailable(), this adds
+  // enough after them for the syntax parser to fill its buffer.
+  void AddRange(FX_FILESIZE offset, FX_FILESIZE size) {
+    const FX_FILESIZE file_size = m_pValidator->GetSize();
+    if (offset < 0 || offset >= file_size || size <= 0)
+      return;
+
+    const FX_FILESIZE end =
+        std::min(file_size, offset + std::min(size, file_size) +
+                                CPDF_Stream::kFileBufSize);
+    const size_t range_size = static_cast<size_t>(end - offset);
+    if (!m_pValidator->IsDataRangeAvailable(offset, range_size))
+      m_Segments.push_back({offset, range_size});
+  }
+
+  // Adds the part of the file holding object `objnum`, or the object stream
+  // holding it.
+  void AddObject(uint32_t objnum) {
+    if (!m_pCrossRefTable)
+      return;
+
+    const CPDF_CrossRefTable::ObjectInfo* info =
+        m_pCrossRefTable->GetObjectInfo(objnum);
+    if (info && info->type == CPDF_CrossRefTable::ObjectType::kCompressed)
+      info = m_pCrossRefTable->GetObjectInfo(info->archive.obj_num);
+    if (!info || info->type != CPDF_CrossRefTable::ObjectType::kNormal)
+      return;
+
+    auto next = std::upper_bound(m_ObjectOffsets.begin(),
+                                 m_ObjectOffsets.end(), info->pos);
+    const FX_FILESIZE end =
+        next != m_ObjectOffsets.end() ? *next : m_pValidator->GetSize();
+    AddRange(info->pos, end - info->pos);
+  }
+
+  // Returns the parts added, in order, merging those less than `max_gap`
+  // bytes apart.
+  std::vector<Segment> TakeSegments(FX_FILESIZE max_gap) {
+    std::sort(m_Segments.begin(), m_Segments.end(),
+              [](const Segment& a, const Segment& b) {
+                return a.offset < b.offset;
+              });
+    std::vector<Segment> merged;
+    for (const Segment& segment : m_Segments) {
+      if (!merged.empty()) {
+        Segment& last = merged.back();
+        const FX_FILESIZE last_end =
+            last.offset + static_cast<FX_FILESIZE>(last.size);
+        if (segment.offset <= last_end + std::max<FX_FILESIZE>(max_gap, 0)) {
+          const FX_FILESIZE end =
+              std::max(last_end, segment.offset +
+                                     static_cast<FX_FILESIZE>(segment.size));
+          last.size = static_cast<size_t>(end - last.offset);
+          continue;
+        }
+      }
+      merged.push_back(segment);
+    }
+    m_Segments.clear();
+    return merged;
+  }
+
+ private:
+  RetainPtr<CPDF_ReadValidator> const m_pValidator;
+  UnownedPtr<const CPDF_CrossRefTable> const m_pCrossRefTable;
+  std::vector<FX_FILESIZE> m_ObjectOffsets;
+  std::vector<Segment> m_Segments;
+};
+
 CPDF_DataAvail::FileAvail::~FileAvail() = default;
 
 CPDF_DataAvail::DownloadHints::~DownloadHints() = default;
@@ -943,9 +1049,13 @@ const CPDF_Dictionary* CPDF_DataAvail::GetPageDictionary(int index) const {
   m_pDocument->SetPageObjNum(index, dwObjNum);
   // Page object already can be parsed in document.
   if (!m_pDocument->GetIndirectObject(dwObjNum)) {
-    m_pDocument->ReplaceIndirectObjectIfHigherGeneration(
-        dwObjNum,
-        ParseIndirectObjectAt(szPageStartPos, dwObjNum, m_pDocument.Get()));
+    RetainPtr<CPDF_Object> pPage =
+        ParseIndirectObjectAt(szPageStartPos, dwObjNum, m_pDocument.Get());
+    // It is just as in the file, like objects the document parses itself.
+    if (pPage)
+      pPage->ClearModified();
+    m_pDocument->ReplaceIndirectObjectIfHigherGeneration(dwObjNum,
+                                                         std::move(pPage));
   }
   if (!ValidatePage(index))
     return nullptr;
@@ -1034,6 +1144,193 @@ CPDF_DataAvail::ParseDocument(
   return std::make_pair(CPDF_Parser::SUCCESS, std::move(document));
 }
 
+std::vector<CPDF_DataAvail::Segment> CPDF_DataAvail::PlanFirstPageDownload(
+    FX_FILESIZE max_gap) {
+  if (m_pDocument) {
+    return PlanPageDownload(m_pLinearized ? m_pLinearized->GetFirstPageNo() : 0,
+                            max_gap);
+  }
+
+  // Files that are not linearized have their cross reference table at the
+  // end, which IsDocAvail() has to find first.
+  DownloadPlan plan(GetValidator(), nullptr);
+  switch (CheckHeaderAndLinearized()) {
+    case kDataNotAvailable:
+      // The header and any linearization dictionary are in the first 1024
+      // bytes.
+      plan.AddRange(0, 1024);
+      break;
+    case kDataAvailable:
+      if (m_pLinearized)
+        PlanFirstPageSection(&plan);
+      break;
+    default:
+      break;
+  }
+  return plan.TakeSegments(max_gap);
+}
+
+std::vector<CPDF_DataAvail::Segment> CPDF_DataAvail::PlanPageDownload(
+    uint32_t dwPage,
+    FX_FILESIZE max_gap) {
+  if (!m_pDocument ||
+      dwPage >= pdfium::base::checked_cast<uint32_t>(GetPageCount())) {
+    return std::vector<Segment>();
+  }
+
+  DownloadPlan plan(GetValidator(),
+                    m_pDocument->GetParser()->GetCrossRefTable());
+  const bool is_linearized_first_page =
+      m_pLinearized && dwPage == m_pLinearized->GetFirstPageNo();
+  if (is_linearized_first_page) {
+    PlanFirstPageSection(&plan);
+  } else if (m_pLinearized) {
+    PlanMainXRef(&plan);
+    std::vector<Segment> page_segments;
+    if (m_pHintTables &&
+        m_pHintTables->GetPageSegments(dwPage, &page_segments)) {
+      for (const Segment& segment : page_segments)
+        plan.AddRange(segment.offset, segment.size);
+      return plan.TakeSegments(max_gap);
+    }
+  }
+
+  const CPDF_Dictionary* pPage = FindPageOrPlanDownload(dwPage, &plan);
+  if (pPage)
+    PlanObjectTree(pPage, &plan);
+
+  // As in IsPageAvail(), pages other than the first page of a linearized file
+  // need the form too.
+  if (!is_linearized_first_page)
+    PlanAcroForm(&plan);
+  return plan.TakeSegments(max_gap);
+}
+
+std::vector<CPDF_DataAvail::Segment> CPDF_DataAvail::PlanFormDownload(
+    FX_FILESIZE max_gap) {
+  if (!m_pDocument)
+    return std::vector<Segment>();
+
+  DownloadPlan plan(GetValidator(),
+                    m_pDocument->GetParser()->GetCrossRefTable());
+  if (m_pLinearized)
+    PlanMainXRef(&plan);
+  PlanAcroForm(&plan);
+  return plan.TakeSegments(max_gap);
+}
+
+void CPDF_DataAvail::PlanFirstPageSection(DownloadPlan* plan) const {
+  // Everything CheckFirstPage() and CheckHintTables() need.
+  plan->AddRange(0, m_pLinearized->GetFirstPageEndOffset());
+  plan->AddRange(m_pLinearized->GetHintStart(),
+                 m_pLinearized->GetHintLength());
+}
+
+void CPDF_DataAvail::PlanMainXRef(DownloadPlan* plan) const {
+  // Everything CheckLinearizedData() needs.
+  if (m_bMainXRefLoadTried)
+    return;
+
+  const CPDF_Dictionary* pTrailer = m_pDocument->GetParser()->GetTrailer();
+  if (!pTrailer)
+    return;
+
+  const FX_FILESIZE main_xref_offset = pTrailer->GetIntegerFor("Prev");
+  if (main_xref_offset > 0)
+    plan->AddRange(main_xref_offset, m_dwFileLen - main_xref_offset);
+}
+
+void CPDF_DataAvail::PlanAcroForm(DownloadPlan* plan) {
+  const CPDF_Dictionary* pRoot = m_pDocument->GetRoot();
+  const CPDF_Object* pAcroForm =
+      pRoot ? pRoot->GetObjectFor("AcroForm") : nullptr;
+  if (pAcroForm)
+    PlanObjectTree(pAcroForm, plan);
+}
+
+void CPDF_DataAvail::PlanObjectTree(const CPDF_Object* pRoot,
+                                    DownloadPlan* plan) {
+  std::set<uint32_t> planned_objnums;
+  std::vector<uint32_t> objnums;
+  AppendObjectRefs(pRoot, pRoot, &objnums);
+  while (!objnums.empty()) {
+    const uint32_t objnum = objnums.back();
+    objnums.pop_back();
+    if (!planned_objnums.insert(objnum).second)
+      continue;
+
+    const CPDF_Object* pObj = ParseObjectOrPlanDownload(objnum, plan);
+    if (pObj && pObj != pRoot)
+      AppendObjectRefs(pObj, pRoot, &objnums);
+  }
+}
+
+const CPDF_Dictionary* CPDF_DataAvail::FindPageOrPlanDownload(
+    uint32_t dwPage,
+    DownloadPlan* plan) {
+  const CPDF_Dictionary* pRoot = m_pDocument->GetRoot();
+  if (!pRoot)
+    return nullptr;
+
+  const CPDF_Object* pNode = pRoot->GetObjectFor("Pages");
+  uint32_t index = dwPage;
+  for (int level = 0; level < kMaxPageRecursionDepth; ++level) {
+    const CPDF_Dictionary* pDict =
+        ToDictionary(GetObjectOrPlanDownload(pNode, plan));
+    if (!pDict)
+      return nullptr;
+    if (!pDict->KeyExist("Kids"))
+      return index == 0 ? pDict : nullptr;
+
+    const CPDF_Array* pKids =
+        ToArray(GetObjectOrPlanDownload(pDict->GetObjectFor("Kids"), plan));
+    if (!pKids)
+      return nullptr;
+
+    pNode = nullptr;
+    bool bCounting = true;
+    for (size_t i = 0; i < pKids->size(); ++i) {
+      const CPDF_Dictionary* pKid =
+          ToDictionary(GetObjectOrPlanDownload(pKids->GetObjectAt(i), plan));
+      // Which kid the page is in cannot be told past a kid not downloaded, so
+      // the kids after it get planned too.
+      if (!pKid)
+        bCounting = false;
+      if (!bCounting || pKid == pDict)
+        continue;
+
+      const int count =
+          pKid->KeyExist("Kids") ? pKid->GetIntegerFor("Count") : 1;
+      if (count > 0 && index < static_cast<uint32_t>(count)) {
+        pNode = pKid;
+        break;
+      }
+      index -= std::max(count, 0);
+    }
+    if (!pNode)
+      return nullptr;
+  }
+  return nullptr;
+}
+
+const CPDF_Object* CPDF_DataAvail::GetObjectOrPlanDownload(
+    const CPDF_Object* pObj,
+    DownloadPlan* plan) {
+  const CPDF_Reference* pRef = ToReference(pObj);
+  return pRef ? ParseObjectOrPlanDownload(pRef->GetRefObjNum(), plan) : pObj;
+}
+
+const CPDF_Object* CPDF_DataAvail::ParseObjectOrPlanDownload(
+    uint32_t objnum,
+    DownloadPlan* plan) {
+  // Parsing needs only the start of a stream, so streams get planned even
+  // when they parse.
+  plan->AddObject(objnum);
+  CPDF_ReadValidator::ScopedSession read_session(GetValidator());
+  const CPDF_Object* pObj = m_pDocument->GetOrParseIndirectObject(objnum);
+  return GetValidator()->has_read_problems() ? nullptr : pObj;
+}
+
 CPDF_DataAvail::PageNode::PageNode() = default;
 
 CPDF_DataAvail::PageNode::~PageNode() = default;
@@ -69,6 +69,12 @@ class CPDF_DataAvail final : public Observable::ObserverIface {
     virtual void AddSegment(FX_FILESIZE offset, size_t size) = 0;
   };
 
+  // A part of the file, as passed to DownloadHints::AddSegment().
+  struct Segment {
+    FX_FILESIZE offset;
+    size_t size;
+  };
+
   CPDF_DataAvail(FileAvail* pFileAvail,
                  const RetainPtr<IFX_SeekableReadStream>& pFileRead);
   ~CPDF_DataAvail() override;
@@ -91,7 +97,21 @@ class CPDF_DataAvail final : public Observable::ObserverIface {
 
   const CPDF_HintTables* GetHintTables() const { return m_pHintTables.get(); }
 
+  // Unlike the Is*Avail() methods, which ask for the data they find missing
+  // one part at a time, these return every part of the file still missing
+  // that the first page, page `dwPage` or the form needs, so they can all get
+  // downloaded at once. Parts less than `max_gap` bytes apart get merged.
+  // Hint tables tell everything a page needs. Otherwise objects only get
+  // found through the objects that refer to them, so the parts returned are
+  // those needed to get one level further. Pages and the form can only be
+  // planned once ParseDocument() succeeded.
+  std::vector<Segment> PlanFirstPageDownload(FX_FILESIZE max_gap);
+  std::vector<Segment> PlanPageDownload(uint32_t dwPage, FX_FILESIZE max_gap);
+  std::vector<Segment> PlanFormDownload(FX_FILESIZE max_gap);
+
  private:
+  class DownloadPlan;
+
   enum class InternalStatus : uint8_t {
     kHeader = 0,
     kFirstPage,
@@ -162,6 +182,23 @@ class CPDF_DataAvail final : public Observable::ObserverIface {
   bool ValidatePage(uint32_t dwPage) const;
   CPDF_SyntaxParser* GetSyntaxParser() const;
 
+  void PlanFirstPageSection(DownloadPlan* plan) const;
+  void PlanMainXRef(DownloadPlan* plan) const;
+  void PlanAcroForm(DownloadPlan* plan);
+  // Plans `pRoot` and the objects it refers to, the way CPDF_PageObjectAvail
+  // checks them, as far as they are downloaded.
+  void PlanObjectTree(const CPDF_Object* pRoot, DownloadPlan* plan);
+  // Returns the dictionary of page `dwPage`, when the page tree is downloaded
+  // that far. Otherwise plans the page tree nodes needed to get further.
+  const CPDF_Dictionary* FindPageOrPlanDownload(uint32_t dwPage,
+                                                DownloadPlan* plan);
+  // Returns `pObj`, or the object it refers to, when downloaded. Either way,
+  // plans the parts of the object not downloaded yet.
+  const CPDF_Object* GetObjectOrPlanDownload(const CPDF_Object* pObj,
+                                             DownloadPlan* plan);
+  const CPDF_Object* ParseObjectOrPlanDownload(uint32_t objnum,
+                                               DownloadPlan* plan);
+
   RetainPtr<CPDF_ReadValidator> m_pFileRead;
   CPDF_Parser m_parser;
   RetainPtr<CPDF_Dictionary> m_pRoot;
@@ -0,0 +1,228 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_decryptor.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "core/fdrm/fx_crypt.h"
+#include "core/fxcrt/fx_safe_types.h"
+#include "third_party/base/check.h"
+#include "third_party/base/check_op.h"
+#include "third_party/base/numerics/safe_conversions.h"
+
+namespace {
+
+constexpr size_t kAESBlockSize = 16;
+
+// Decrypts `data` in place. `iv` is the block before `data`.
+void DecryptAESBlocks(pdfium::span<const uint8_t> key,
+                      const uint8_t* iv,
+                      pdfium::span<uint8_t> data) {
+  DCHECK_EQ(data.size() % kAESBlockSize, 0u);
+  CRYPT_aes_context context;
+  CRYPT_AESSetKey(&context, key.data(),
+                  pdfium::base::checked_cast<uint32_t>(key.size()));
+  CRYPT_AESSetIV(&context, iv);
+  CRYPT_AESDecrypt(&context, data.data(), data.data(),
+                   pdfium::base::checked_cast<uint32_t>(data.size()));
+}
+
+// Returns how many bytes of the last block are data rather than padding.
+// Data whose padding does not make sense keeps none of its last block.
+size_t GetAESLastBlockDataSize(const uint8_t* last_block) {
+  const uint8_t padding = last_block[kAESBlockSize - 1];
+  return padding <= kAESBlockSize ? kAESBlockSize - padding : 0;
+}
+
+bool IsValidRange(FX_FILESIZE offset, size_t size, FX_FILESIZE limit) {
+  FX_SAFE_FILESIZE end = offset;
+  end += size;
+  return offset >= 0 && end.IsValid() && end.ValueOrDie() <= limit;
+}
+
+// Data encrypted with AES starts with the IV. Any whole blocks after it get
+// decrypted, and the padding gets taken off the last one, but only when the
+// data ends with a whole block.
+class AESDecryptingStream final : public IFX_SeekableReadStream {
+ public:
+  CONSTRUCT_VIA_MAKE_RETAIN;
+
+  // IFX_SeekableReadStream:
+  bool ReadBlockAtOffset(void* buffer,
+                         FX_FILESIZE offset,
+                         size_t size) override {
+    if (!IsValidRange(offset, size, m_Size))
+      return false;
+
+    uint8_t* dest = static_cast<uint8_t*>(buffer);
+    const size_t head_skip = offset % kAESBlockSize;
+    if (head_skip) {
+      const size_t head_size = std::min(size, kAESBlockSize - head_skip);
+      if (!ReadPartialBlock(offset - head_skip, head_skip, dest, head_size))
+        return false;
+      dest += head_size;
+      offset += head_size;
+      size -= head_size;
+    }
+
+    // Whole blocks get read into `dest` and decrypted there.
+    const size_t whole_size = size - size % kAESBlockSize;
+    if (whole_size) {
+      uint8_t iv[kAESBlockSize];
+      if (!m_pEncrypted->ReadBlockAtOffset(iv, offset, sizeof(iv)) ||
+          !m_pEncrypted->ReadBlockAtOffset(dest, offset + kAESBlockSize,
+                                           whole_size)) {
+        return false;
+      }
+      DecryptAESBlocks(m_Key, iv, {dest, whole_size});
+      dest += whole_size;
+      offset += whole_size;
+      size -= whole_size;
+    }
+    return !size || ReadPartialBlock(offset, 0, dest, size);
+  }
+
+  FX_FILESIZE GetSize() override { return m_Size; }
+
+ private:
+  AESDecryptingStream(pdfium::span<const uint8_t> key,
+                      RetainPtr<IFX_SeekableReadStream> encrypted)
+      : m_Key(key.begin(), key.end()), m_pEncrypted(std::move(encrypted)) {
+    const FX_FILESIZE encrypted_size = m_pEncrypted->GetSize();
+    if (encrypted_size < static_cast<FX_FILESIZE>(2 * kAESBlockSize))
+      return;
+
+    const FX_FILESIZE blocks_size =
+        encrypted_size - encrypted_size % kAESBlockSize - kAESBlockSize;
+    if (encrypted_size % kAESBlockSize) {
+      m_Size = blocks_size;
+      return;
+    }
+    uint8_t last_block[kAESBlockSize];
+    if (ReadPartialBlock(blocks_size - kAESBlockSize, 0, last_block,
+                         sizeof(last_block))) {
+      m_Size = blocks_size - kAESBlockSize +
+               GetAESLastBlockDataSize(last_block);
+    }
+  }
+
+  ~AESDecryptingStream() override = default;
+
+  // Decrypts the block at `block_offset` and copies `size` bytes of it, from
+  // `skip` on, to `dest`.
+  bool ReadPartialBlock(FX_FILESIZE block_offset,
+                        size_t skip,
+                        uint8_t* dest,
+                        size_t size) {
+    DCHECK_LE(skip + size, kAESBlockSize);
+    uint8_t blocks[2 * kAESBlockSize];
+    if (!m_pEncrypted->ReadBlockAtOffset(blocks, block_offset, sizeof(blocks)))
+      return false;
+
+    DecryptAESBlocks(m_Key, blocks, {blocks + kAESBlockSize, kAESBlockSize});
+    memcpy(dest, blocks + kAESBlockSize + skip, size);
+    return true;
+  }
+
+  const DataVector<uint8_t> m_Key;
+  const RetainPtr<IFX_SeekableReadStream> m_pEncrypted;
+  FX_FILESIZE m_Size = 0;
+};
+
+class RC4DecryptingStream final : public IFX_SeekableReadStream {
+ public:
+  CONSTRUCT_VIA_MAKE_RETAIN;
+
+  // IFX_SeekableReadStream:
+  bool ReadBlockAtOffset(void* buffer,
+                         FX_FILESIZE offset,
+                         size_t size) override {
+    if (!IsValidRange(offset, size, GetSize()) ||
+        !m_pEncrypted->ReadBlockAtOffset(buffer, offset, size)) {
+      return false;
+    }
+
+    // The key stream only goes forward, so reads going back start it over.
+    if (!m_pContext || offset < m_Position) {
+      m_pContext = std::make_unique<CRYPT_rc4_context>();
+      CRYPT_ArcFourSetup(m_pContext.get(), m_Key);
+      m_Position = 0;
+    }
+    uint8_t skipped[512];
+    while (m_Position < offset) {
+      const size_t skip_size = static_cast<size_t>(
+          std::min<FX_FILESIZE>(offset - m_Position, sizeof(skipped)));
+      CRYPT_ArcFourCrypt(m_pContext.get(), {skipped, skip_size});
+      m_Position += skip_size;
+    }
+    CRYPT_ArcFourCrypt(m_pContext.get(),
+                       {static_cast<uint8_t*>(buffer), size});
+    m_Position += size;
+    return true;
+  }
+
+  FX_FILESIZE GetSize() override { return m_pEncrypted->GetSize(); }
+
+ private:
+  RC4DecryptingStream(pdfium::span<const uint8_t> key,
+                      RetainPtr<IFX_SeekableReadStream> encrypted)
+      : m_Key(key.begin(), key.end()), m_pEncrypted(std::move(encrypted)) {}
+
+  ~RC4DecryptingStream() override = default;
+
+  const DataVector<uint8_t> m_Key;
+  const RetainPtr<IFX_SeekableReadStream> m_pEncrypted;
+  // Where `m_pContext` is in the key stream.
+  std::unique_ptr<CRYPT_rc4_context> m_pContext;
+  FX_FILESIZE m_Position = 0;
+};
+
+}  // namespace
+
+CPDF_Decryptor::CPDF_Decryptor(CPDF_CryptoHandler::Cipher cipher,
+                               pdfium::span<const uint8_t> key)
+    : m_Cipher(cipher), m_Key(key.begin(), key.end()) {
+  DCHECK(m_Cipher == CPDF_CryptoHandler::Cipher::kAES ||
+         m_Cipher == CPDF_CryptoHandler::Cipher::kRC4);
+}
+
+CPDF_Decryptor::~CPDF_Decryptor() = default;
+
+DataVector<uint8_t> CPDF_Decryptor::Decrypt(
+    pdfium::span<const uint8_t> data) const {
+  if (m_Cipher == CPDF_CryptoHandler::Cipher::kRC4) {
+    DataVector<uint8_t> result(data.begin(), data.end());
+    CRYPT_ArcFourCryptBlock(result, m_Key);
+    return result;
+  }
+
+  if (data.size() < 2 * kAESBlockSize)
+    return DataVector<uint8_t>();
+
+  const size_t blocks_size =
+      data.size() - data.size() % kAESBlockSize - kAESBlockSize;
+  pdfium::span<const uint8_t> blocks = data.subspan(kAESBlockSize, blocks_size);
+  DataVector<uint8_t> result(blocks.begin(), blocks.end());
+  DecryptAESBlocks(m_Key, data.data(), result);
+  if (data.size() % kAESBlockSize == 0) {
+    const size_t last_block_offset = blocks_size - kAESBlockSize;
+    result.resize(last_block_offset +
+                  GetAESLastBlockDataSize(&result[last_block_offset]));
+  }
+  return result;
+}
+
+RetainPtr<IFX_SeekableReadStream> CPDF_Decryptor::CreateDecryptingStream(
+    RetainPtr<IFX_SeekableReadStream> encrypted) const {
+  if (m_Cipher == CPDF_CryptoHandler::Cipher::kRC4) {
+    return pdfium::MakeRetain<RC4DecryptingStream>(m_Key,
+                                                   std::move(encrypted));
+  }
+  return pdfium::MakeRetain<AESDecryptingStream>(m_Key, std::move(encrypted));
+}
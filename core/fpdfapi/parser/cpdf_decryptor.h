@@ -0,0 +1,41 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_PARSER_CPDF_DECRYPTOR_H_
+#define CORE_FPDFAPI_PARSER_CPDF_DECRYPTOR_H_
+
+#include <stdint.h>
+
+#include "core/fpdfapi/parser/cpdf_crypto_handler.h"
+#include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/fx_stream.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "third_party/base/span.h"
+
+// Decrypts the strings and streams of one object, with the key for that
+// object. Objects keep their decryptor until they get decrypted, which is when
+// their data first gets used.
+class CPDF_Decryptor final : public Retainable {
+ public:
+  CONSTRUCT_VIA_MAKE_RETAIN;
+
+  // Decrypts all of `data` at once.
+  DataVector<uint8_t> Decrypt(pdfium::span<const uint8_t> data) const;
+
+  // Returns a stream that reads what `encrypted` decrypts to. Reads decrypt
+  // just the data they read, straight into the caller's buffer.
+  RetainPtr<IFX_SeekableReadStream> CreateDecryptingStream(
+      RetainPtr<IFX_SeekableReadStream> encrypted) const;
+
+ private:
+  // `cipher` must be kAES or kRC4.
+  CPDF_Decryptor(CPDF_CryptoHandler::Cipher cipher,
+                 pdfium::span<const uint8_t> key);
+  ~CPDF_Decryptor() override;
+
+  const CPDF_CryptoHandler::Cipher m_Cipher;
+  const DataVector<uint8_t> m_Key;
+};
+
+#endif  // CORE_FPDFAPI_PARSER_CPDF_DECRYPTOR_H_
@@ -0,0 +1,132 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/parser/cpdf_decryptor.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/fdrm/fx_crypt.h"
+#include "core/fxcrt/cfx_read_only_span_stream.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+const uint8_t kKey[16] = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+                          0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff};
+
+std::vector<uint8_t> MakePlainText(size_t size) {
+  std::vector<uint8_t> result(size);
+  for (size_t i = 0; i < size; ++i)
+    result[i] = static_cast<uint8_t>(i * 7 + 3);
+  return result;
+}
+
+// Encrypts `plain` the way documents encrypted with AES hold their data.
+std::vector<uint8_t> EncryptAES(const std::vector<uint8_t>& plain) {
+  std::vector<uint8_t> padded = plain;
+  const size_t padding = 16 - plain.size() % 16;
+  padded.insert(padded.end(), padding, static_cast<uint8_t>(padding));
+
+  std::vector<uint8_t> result(16 + padded.size());
+  for (size_t i = 0; i < 16; ++i)
+    result[i] = static_cast<uint8_t>(0xf0 - i);
+  CRYPT_aes_context context;
+  CRYPT_AESSetKey(&context, kKey, sizeof(kKey));
+  CRYPT_AESSetIV(&context, result.data());
+  CRYPT_AESEncrypt(&context, result.data() + 16, padded.data(),
+                   padded.size());
+  return result;
+}
+
+// Checks reading `stream` at every offset, with every size, gives `expected`.
+void CheckReads(IFX_SeekableReadStream* stream,
+                const std::vector<uint8_t>& expected) {
+  ASSERT_EQ(static_cast<FX_FILESIZE>(expected.size()), stream->GetSize());
+  for (size_t offset = 0; offset <= expected.size(); ++offset) {
+    for (size_t size = 1; offset + size <= expected.size(); ++size) {
+      std::vector<uint8_t> actual(size);
+      ASSERT_TRUE(stream->ReadBlockAtOffset(actual.data(), offset, size))
+          << offset << ", " << size;
+      EXPECT_EQ(std::vector<uint8_t>(expected.begin() + offset,
+                                     expected.begin() + offset + size),
+                actual)
+          << offset << ", " << size;
+    }
+  }
+  uint8_t byte;
+  EXPECT_FALSE(stream->ReadBlockAtOffset(&byte, expected.size(), 1));
+  EXPECT_FALSE(stream->ReadBlockAtOffset(&byte, -1, 1));
+}
+
+}  // namespace
+
+TEST(CPDF_DecryptorTest, AES) {
+  auto decryptor = pdfium::MakeRetain<CPDF_Decryptor>(
+      CPDF_CryptoHandler::Cipher::kAES, kKey);
+  for (size_t size = 0; size <= 50; ++size) {
+    SCOPED_TRACE(size);
+    const std::vector<uint8_t> plain = MakePlainText(size);
+    const std::vector<uint8_t> encrypted = EncryptAES(plain);
+    DataVector<uint8_t> decrypted = decryptor->Decrypt(encrypted);
+    EXPECT_EQ(plain, std::vector<uint8_t>(decrypted.begin(), decrypted.end()));
+
+    RetainPtr<IFX_SeekableReadStream> stream =
+        decryptor->CreateDecryptingStream(
+            pdfium::MakeRetain<CFX_ReadOnlySpanStream>(encrypted));
+    CheckReads(stream.Get(), plain);
+  }
+}
+
+TEST(CPDF_DecryptorTest, AESMalformed) {
+  auto decryptor = pdfium::MakeRetain<CPDF_Decryptor>(
+      CPDF_CryptoHandler::Cipher::kAES, kKey);
+  const std::vector<uint8_t> plain = MakePlainText(40);
+  std::vector<uint8_t> encrypted = EncryptAES(plain);
+  ASSERT_EQ(64u, encrypted.size());
+
+  // Data that does not end with a whole block keeps its padding.
+  encrypted.insert(encrypted.end(), 5, 0);
+  std::vector<uint8_t> expected = plain;
+  expected.insert(expected.end(), 8, 8);
+  DataVector<uint8_t> decrypted = decryptor->Decrypt(encrypted);
+  EXPECT_EQ(expected, std::vector<uint8_t>(decrypted.begin(), decrypted.end()));
+  RetainPtr<IFX_SeekableReadStream> stream = decryptor->CreateDecryptingStream(
+      pdfium::MakeRetain<CFX_ReadOnlySpanStream>(encrypted));
+  CheckReads(stream.Get(), expected);
+
+  // Data too short to hold a block after the IV is empty.
+  encrypted.resize(31);
+  EXPECT_TRUE(decryptor->Decrypt(encrypted).empty());
+  stream = decryptor->CreateDecryptingStream(
+      pdfium::MakeRetain<CFX_ReadOnlySpanStream>(encrypted));
+  EXPECT_EQ(0, stream->GetSize());
+}
+
+TEST(CPDF_DecryptorTest, RC4) {
+  auto decryptor = pdfium::MakeRetain<CPDF_Decryptor>(
+      CPDF_CryptoHandler::Cipher::kRC4, pdfium::make_span(kKey, 5));
+  const std::vector<uint8_t> plain = MakePlainText(600);
+  std::vector<uint8_t> encrypted = plain;
+  CRYPT_ArcFourCryptBlock(encrypted, pdfium::make_span(kKey, 5));
+  DataVector<uint8_t> decrypted = decryptor->Decrypt(encrypted);
+  EXPECT_EQ(plain, std::vector<uint8_t>(decrypted.begin(), decrypted.end()));
+
+  // Reads go forwards and backwards through the data.
+  const std::vector<uint8_t> short_plain(plain.begin(), plain.begin() + 40);
+  const std::vector<uint8_t> short_encrypted(encrypted.begin(),
+                                             encrypted.begin() + 40);
+  RetainPtr<IFX_SeekableReadStream> stream = decryptor->CreateDecryptingStream(
+      pdfium::MakeRetain<CFX_ReadOnlySpanStream>(short_encrypted));
+  CheckReads(stream.Get(), short_plain);
+
+  // Reads far into the data skip over the key stream before it.
+  stream = decryptor->CreateDecryptingStream(
+      pdfium::MakeRetain<CFX_ReadOnlySpanStream>(encrypted));
+  uint8_t actual[10];
+  ASSERT_TRUE(stream->ReadBlockAtOffset(actual, 580, sizeof(actual)));
+  EXPECT_EQ(std::vector<uint8_t>(plain.begin() + 580, plain.begin() + 590),
+            std::vector<uint8_t>(actual, actual + sizeof(actual)));
+}
@@ -232,10 +232,12 @@ CPDF_Object* CPDF_Dictionary::SetFor(const ByteString& key,
                                      RetainPtr<CPDF_Object> pObj) {
   CHECK(!IsLocked());
   if (!pObj) {
-    m_Map.erase(key);
+    if (m_Map.erase(key))
+      SetModified();
     return nullptr;
   }
   DCHECK(pObj->IsInline());
+  SetModified();
   CPDF_Object* pRet = pObj.Get();
   m_Map[MaybeIntern(key)] = std::move(pObj);
   return pRet;
@@ -249,6 +251,7 @@ void CPDF_Dictionary::ConvertToIndirectObjectFor(
   if (it == m_Map.end() || it->second->IsReference())
     return;
 
+  SetModified();
   CPDF_Object* pObj = pHolder->AddIndirectObject(std::move(it->second));
   it->second = pObj->MakeReference(pHolder);
 }
@@ -258,6 +261,7 @@ RetainPtr<CPDF_Object> CPDF_Dictionary::RemoveFor(ByteStringView key) {
   RetainPtr<CPDF_Object> result;
   auto it = m_Map.find(key);
   if (it != m_Map.end()) {
+    SetModified();
     result = std::move(it->second);
     m_Map.erase(it);
   }
@@ -275,6 +279,7 @@ void CPDF_Dictionary::ReplaceKey(const ByteString& oldkey,
   if (new_it == old_it)
     return;
 
+  SetModified();
   m_Map[MaybeIntern(newkey)] = std::move(old_it->second);
   m_Map.erase(old_it);
 }
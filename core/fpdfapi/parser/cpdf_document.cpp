@@ -6,6 +6,8 @@
 
 #include "core/fpdfapi/parser/cpdf_document.h"
 
+#include <algorithm>
+
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_linearized_header.h"
@@ -180,7 +182,7 @@ void CPDF_Document::LoadPages() {
   uint32_t page_count = linearized_header->GetPageCount();
   DCHECK(first_page_num < page_count);
   m_PageList.resize(page_count);
-  m_PageList[first_page_num] = objnum;
+  SetPageObjNum(first_page_num, objnum);
 }
 
 CPDF_Dictionary* CPDF_Document::TraversePDFPages(int iPage,
@@ -195,7 +197,7 @@ CPDF_Dictionary* CPDF_Document::TraversePDFPages(int iPage,
     m_pTreeTraversal.pop_back();
     if (*nPagesToGo != 1)
       return nullptr;
-    m_PageList[iPage] = pPages->GetObjNum();
+    SetPageObjNum(iPage, pPages->GetObjNum());
     return pPages;
   }
   if (level >= kMaxPageLevel) {
@@ -219,7 +221,7 @@ CPDF_Dictionary* CPDF_Document::TraversePDFPages(int iPage,
       continue;
     }
     if (!pKid->KeyExist("Kids")) {
-      m_PageList[iPage - (*nPagesToGo) + 1] = pKid->GetObjNum();
+      SetPageObjNum(iPage - (*nPagesToGo) + 1, pKid->GetObjNum());
       (*nPagesToGo)--;
       m_pTreeTraversal[level].second++;
       if (*nPagesToGo == 0) {
@@ -311,6 +313,31 @@ RetainPtr<CPDF_Dictionary> CPDF_Document::GetMutablePageDictionary(int iPage) {
 
 void CPDF_Document::SetPageObjNum(int iPage, uint32_t objNum) {
   m_PageList[iPage] = objNum;
+  if (!objNum)
+    return;
+
+  // When a page appears more than once, the first one is its index.
+  const int indexed = LookupPageIndex(objNum);
+  if (indexed < 0 || iPage < indexed)
+    m_PageIndexByObjNum[objNum] = iPage;
+}
+
+bool CPDF_Document::IndexAllPages() {
+  if (!pdfium::Contains(m_PageList, 0))
+    return true;
+
+  CPDF_Dictionary* pPages = GetPagesDict();
+  if (!pPages)
+    return false;
+
+  // Traversing to the last page from the start records every page on the way.
+  ResetTraversal();
+  m_pTreeTraversal.push_back(std::make_pair(pPages, 0));
+  const int page_count = GetPageCount();
+  int nPagesToGo = page_count;
+  TraversePDFPages(page_count - 1, &nPagesToGo, 0);
+  m_iNextPageToTraverse = page_count;
+  return !pdfium::Contains(m_PageList, 0);
 }
 
 JBig2_DocumentContext* CPDF_Document::GetOrCreateCodecContext() {
@@ -330,16 +357,18 @@ bool CPDF_Document::IsModifiedAPStream(const CPDF_Stream* stream) const {
 }
 
 int CPDF_Document::GetPageIndex(uint32_t objnum) {
+  const int indexed = LookupPageIndex(objnum);
+  if (indexed >= 0)
+    return indexed;
+
+  // Every page before the first one not loaded is indexed already, so the
+  // search below skips them.
   uint32_t skip_count = 0;
-  bool bSkipped = false;
-  for (uint32_t i = 0; i < m_PageList.size(); ++i) {
-    if (m_PageList[i] == objnum)
-      return i;
-
-    if (!bSkipped && m_PageList[i] == 0) {
-      skip_count = i;
-      bSkipped = true;
-    }
+  auto first_unloaded = std::find(m_PageList.begin(), m_PageList.end(), 0);
+  if (first_unloaded != m_PageList.end()) {
+    skip_count = first_unloaded - m_PageList.begin();
+    if (objnum == 0)
+      return skip_count;
   }
   const CPDF_Dictionary* pPages = GetPagesDict();
   if (!pPages)
@@ -354,10 +383,21 @@ int CPDF_Document::GetPageIndex(uint32_t objnum) {
 
   // Only update |m_PageList| when |objnum| points to a /Page object.
   if (IsValidPageObject(GetOrParseIndirectObject(objnum)))
-    m_PageList[found_index] = objnum;
+    SetPageObjNum(found_index, objnum);
   return found_index;
 }
 
+int CPDF_Document::LookupPageIndex(uint32_t objnum) const {
+  // Entries go stale when their page gets replaced, so check them.
+  auto it = m_PageIndexByObjNum.find(objnum);
+  if (it == m_PageIndexByObjNum.end() ||
+      !fxcrt::IndexInBounds(m_PageList, it->second) ||
+      m_PageList[it->second] != objnum) {
+    return -1;
+  }
+  return it->second;
+}
+
 int CPDF_Document::GetPageCount() const {
   return fxcrt::CollectionSize<int>(m_PageList);
 }
@@ -479,7 +519,12 @@ bool CPDF_Document::InsertNewPage(int iPage, CPDF_Dictionary* pPageDict) {
     if (!InsertDeletePDFPage(pPages.Get(), iPage, pPageDict, true, &stack))
       return false;
   }
-  m_PageList.insert(m_PageList.begin() + iPage, pPageDict->GetObjNum());
+  m_PageList.insert(m_PageList.begin() + iPage, 0);
+  for (auto& entry : m_PageIndexByObjNum) {
+    if (entry.second >= iPage)
+      ++entry.second;
+  }
+  SetPageObjNum(iPage, pPageDict->GetObjNum());
   return true;
 }
 
@@ -517,6 +562,16 @@ void CPDF_Document::DeletePage(int iPage) {
     return;
 
   m_PageList.erase(m_PageList.begin() + iPage);
+  for (auto it = m_PageIndexByObjNum.begin();
+       it != m_PageIndexByObjNum.end();) {
+    if (it->second == iPage) {
+      it = m_PageIndexByObjNum.erase(it);
+      continue;
+    }
+    if (it->second > iPage)
+      --it->second;
+    ++it;
+  }
 }
 
 void CPDF_Document::SetRootForTesting(CPDF_Dictionary* root) {
@@ -7,6 +7,7 @@
 #ifndef CORE_FPDFAPI_PARSER_CPDF_DOCUMENT_H_
 #define CORE_FPDFAPI_PARSER_CPDF_DOCUMENT_H_
 
+#include <map>
 #include <memory>
 #include <set>
 #include <utility>
@@ -46,6 +47,14 @@ class CPDF_Document : public Observable,
     virtual ~LinkListIface() = default;
   };
 
+  // Lets whoever adds objects to the document remember them, e.g. to reuse
+  // identical ones.
+  class ObjectIndexIface {
+   public:
+    // CPDF_Document merely helps manage the lifetime.
+    virtual ~ObjectIndexIface() = default;
+  };
+
   class PageDataIface {
    public:
     PageDataIface();
@@ -69,6 +78,9 @@ class CPDF_Document : public Observable,
     RenderDataIface();
     virtual ~RenderDataIface();
 
+    // Drops whatever was decoded from `pImageStream`, after its data changed.
+    virtual void MaybePurgeImage(const CPDF_Stream* pImageStream) = 0;
+
     void SetDocument(CPDF_Document* pDoc) { m_pDoc = pDoc; }
     CPDF_Document* GetDocument() const { return m_pDoc.Get(); }
 
@@ -109,11 +121,20 @@ class CPDF_Document : public Observable,
 
   void SetPageObjNum(int iPage, uint32_t objNum);
 
+  // Goes through the whole page tree once, so every page gets indexed and
+  // GetPageIndex() need not search the tree afterwards. Returns whether every
+  // page got found.
+  bool IndexAllPages();
+
   JBig2_DocumentContext* GetOrCreateCodecContext();
   LinkListIface* GetLinksContext() const { return m_pLinksContext.get(); }
   void SetLinksContext(std::unique_ptr<LinkListIface> pContext) {
     m_pLinksContext = std::move(pContext);
   }
+  ObjectIndexIface* GetObjectIndex() const { return m_pObjectIndex.get(); }
+  void SetObjectIndex(std::unique_ptr<ObjectIndexIface> pIndex) {
+    m_pObjectIndex = std::move(pIndex);
+  }
 
   // Behaves like NewIndirect<CPDF_Stream>(), but keeps track of the new stream.
   CPDF_Stream* CreateModifiedAPStream();
@@ -174,6 +195,9 @@ class CPDF_Document : public Observable,
                            std::set<CPDF_Dictionary*>* pVisited);
   bool InsertNewPage(int iPage, CPDF_Dictionary* pPageDict);
   void ResetTraversal();
+  // Returns the index of the page numbered `objnum`, or -1 when that page is
+  // not indexed.
+  int LookupPageIndex(uint32_t objnum) const;
   CPDF_Parser::Error HandleLoadResult(CPDF_Parser::Error error);
 
   std::unique_ptr<CPDF_Parser> m_pParser;
@@ -199,8 +223,11 @@ class CPDF_Document : public Observable,
   std::unique_ptr<PageDataIface> m_pDocPage;  // Must be after |m_pDocRender|.
   std::unique_ptr<JBig2_DocumentContext> m_pCodecContext;
   std::unique_ptr<LinkListIface> m_pLinksContext;
+  std::unique_ptr<ObjectIndexIface> m_pObjectIndex;
   std::set<uint32_t> m_ModifiedAPStreamIDs;
   std::vector<uint32_t> m_PageList;  // Page number to page's dict objnum.
+  // Page's dict objnum to page number, for the pages in |m_PageList|.
+  std::map<uint32_t, int> m_PageIndexByObjNum;
 
   // Must be second to last.
   StockFontClearer m_StockFontClearer;
@@ -297,3 +297,49 @@ TEST_F(DocumentTest, PagesWithoutKids) {
 
   EXPECT_TRUE(pDoc->GetPageDictionary(0));
 }
+
+TEST_F(DocumentTest, IndexAllPages) {
+  auto document = std::make_unique<CPDF_TestDocumentForPages>();
+  const CPDF_Dictionary* page = document->GetPageDictionary(1);
+  ASSERT_TRUE(page);
+  EXPECT_FALSE(document->IsPageLoaded(4));
+
+  EXPECT_TRUE(document->IndexAllPages());
+  for (int i = 0; i < kNumTestPages; i++) {
+    EXPECT_TRUE(document->IsPageLoaded(i));
+    page = document->GetPageDictionary(i);
+    ASSERT_TRUE(page);
+    EXPECT_EQ(i, page->GetIntegerFor("PageNumbering"));
+    EXPECT_EQ(i, document->GetPageIndex(page->GetObjNum()));
+  }
+  EXPECT_EQ(-1, document->GetPageIndex(document->GetRoot()->GetObjNum()));
+  EXPECT_TRUE(document->IndexAllPages());
+}
+
+TEST_F(DocumentTest, IndexAllPagesCountGreaterThanPageTree) {
+  auto document = std::make_unique<CPDF_TestDocumentForPages>();
+  document->SetTreeSize(kNumTestPages + 3);
+  EXPECT_FALSE(document->IndexAllPages());
+  for (int i = 0; i < kNumTestPages; i++)
+    EXPECT_TRUE(document->IsPageLoaded(i));
+  EXPECT_FALSE(document->IsPageLoaded(kNumTestPages));
+}
+
+TEST_F(DocumentTest, GetPageIndexAfterInsertAndDelete) {
+  CPDF_TestDocument document;
+  document.CreateNewDoc();
+  RetainPtr<CPDF_Dictionary> page1 = document.CreateNewPage(0);
+  RetainPtr<CPDF_Dictionary> page0 = document.CreateNewPage(0);
+  RetainPtr<CPDF_Dictionary> page2 = document.CreateNewPage(2);
+  ASSERT_TRUE(page0);
+  ASSERT_TRUE(page1);
+  ASSERT_TRUE(page2);
+  EXPECT_EQ(0, document.GetPageIndex(page0->GetObjNum()));
+  EXPECT_EQ(1, document.GetPageIndex(page1->GetObjNum()));
+  EXPECT_EQ(2, document.GetPageIndex(page2->GetObjNum()));
+
+  document.DeletePage(0);
+  EXPECT_EQ(-1, document.GetPageIndex(page0->GetObjNum()));
+  EXPECT_EQ(0, document.GetPageIndex(page1->GetObjNum()));
+  EXPECT_EQ(1, document.GetPageIndex(page2->GetObjNum()));
+}
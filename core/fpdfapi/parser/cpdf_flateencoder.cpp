@@ -12,15 +12,16 @@
 #include "constants/stream_dict_common.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_name.h"
-#include "core/fpdfapi/parser/cpdf_number.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "third_party/base/check.h"
 
-CPDF_FlateEncoder::CPDF_FlateEncoder(const CPDF_Stream* pStream,
-                                     bool bFlateEncode)
-    : m_pAcc(pdfium::MakeRetain<CPDF_StreamAcc>(pStream)) {
+CPDF_FlateEncoder::CPDF_FlateEncoder(
+    const CPDF_Stream* pStream,
+    bool bFlateEncode,
+    const FlateModule::EncodeOptions& options)
+    : m_pAcc(pdfium::MakeRetain<CPDF_StreamAcc>(pStream)), m_Options(options) {
   m_pAcc->LoadAllDataRaw();
 
   bool bHasFilter = pStream->HasFilter();
@@ -43,13 +44,9 @@ CPDF_FlateEncoder::CPDF_FlateEncoder(const CPDF_Stream* pStream,
     return;
   }
 
-  // TODO(thestig): Move to Init() and check return value.
-  std::unique_ptr<uint8_t, FxFreeDeleter> buffer;
-  ::FlateEncode(m_pAcc->GetSpan(), &buffer, &m_dwSize);
-
-  m_pData = std::move(buffer);
+  // The /Length gets fixed up by the writer, once the data is final.
+  m_bNeedsCompression = true;
   m_pClonedDict = ToDictionary(pStream->GetDict()->Clone());
-  m_pClonedDict->SetNewFor<CPDF_Number>("Length", static_cast<int>(m_dwSize));
   m_pClonedDict->SetNewFor<CPDF_Name>("Filter", "FlateDecode");
   m_pClonedDict->RemoveFor(pdfium::stream::kDecodeParms);
   DCHECK(!m_pDict);
@@ -57,6 +54,21 @@ CPDF_FlateEncoder::CPDF_FlateEncoder(const CPDF_Stream* pStream,
 
 CPDF_FlateEncoder::~CPDF_FlateEncoder() = default;
 
+bool CPDF_FlateEncoder::Compress() {
+  if (!m_bNeedsCompression)
+    return true;
+
+  std::unique_ptr<uint8_t, FxFreeDeleter> buffer;
+  uint32_t size;
+  if (!::FlateEncode(m_pAcc->GetSpan(), m_Options, &buffer, &size))
+    return false;
+
+  m_pData = std::move(buffer);
+  m_dwSize = size;
+  m_bNeedsCompression = false;
+  return true;
+}
+
 void CPDF_FlateEncoder::CloneDict() {
   if (m_pClonedDict) {
     DCHECK(!m_pDict);
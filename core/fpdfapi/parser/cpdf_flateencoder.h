@@ -7,6 +7,7 @@
 #ifndef CORE_FPDFAPI_PARSER_CPDF_FLATEENCODER_H_
 #define CORE_FPDFAPI_PARSER_CPDF_FLATEENCODER_H_
 
+#include "core/fxcodec/flate/flatemodule.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/maybe_owned.h"
 #include "core/fxcrt/retain_ptr.h"
@@ -18,9 +19,17 @@ class CPDF_StreamAcc;
 
 class CPDF_FlateEncoder {
  public:
-  CPDF_FlateEncoder(const CPDF_Stream* pStream, bool bFlateEncode);
+  // Compresses with `options`, and only once Compress() gets called.
+  // Compress() touches nothing but the encoder's own buffers, so it may run
+  // on another thread. It returns false if the data failed to compress.
+  CPDF_FlateEncoder(const CPDF_Stream* pStream,
+                    bool bFlateEncode,
+                    const FlateModule::EncodeOptions& options);
   ~CPDF_FlateEncoder();
 
+  bool NeedsCompression() const { return m_bNeedsCompression; }
+  bool Compress();
+
   void CloneDict();
   CPDF_Dictionary* GetClonedDict();
 
@@ -33,6 +42,8 @@ class CPDF_FlateEncoder {
 
  private:
   RetainPtr<CPDF_StreamAcc> m_pAcc;
+  const FlateModule::EncodeOptions m_Options;
+  bool m_bNeedsCompression = false;
 
   uint32_t m_dwSize = 0;
   MaybeOwned<uint8_t, FxFreeDeleter> m_pData;
@@ -402,23 +402,22 @@ bool CPDF_HintTables::GetPagePos(uint32_t index,
   return true;
 }
 
-CPDF_DataAvail::DocAvailStatus CPDF_HintTables::CheckPage(uint32_t index) {
+bool CPDF_HintTables::GetPageSegments(
+    uint32_t index,
+    std::vector<CPDF_DataAvail::Segment>* segments) const {
   if (index == m_pLinearized->GetFirstPageNo())
-    return CPDF_DataAvail::kDataAvailable;
+    return true;
 
   if (index >= m_pLinearized->GetPageCount())
-    return CPDF_DataAvail::kDataError;
+    return false;
 
   const uint32_t dwLength = m_PageInfos[index].page_length();
   if (!dwLength)
-    return CPDF_DataAvail::kDataError;
+    return false;
 
-  if (!m_pValidator->CheckDataRangeAndRequestIfUnavailable(
-          m_PageInfos[index].page_offset(), dwLength)) {
-    return CPDF_DataAvail::kDataNotAvailable;
-  }
+  segments->push_back({m_PageInfos[index].page_offset(), dwLength});
 
-  // Download data of shared objects in the page.
+  // Shared objects in the page.
   for (const uint32_t dwIndex : m_PageInfos[index].Identifiers()) {
     if (dwIndex >= m_SharedObjGroupInfos.size())
       continue;
@@ -426,14 +425,29 @@ CPDF_DataAvail::DocAvailStatus CPDF_HintTables::CheckPage(uint32_t index) {
         m_SharedObjGroupInfos[dwIndex];
 
     if (!shared_group_info.m_szOffset || !shared_group_info.m_dwLength)
-      return CPDF_DataAvail::kDataError;
+      return false;
+
+    segments->push_back(
+        {shared_group_info.m_szOffset, shared_group_info.m_dwLength});
+  }
+  return true;
+}
+
+CPDF_DataAvail::DocAvailStatus CPDF_HintTables::CheckPage(uint32_t index) {
+  std::vector<CPDF_DataAvail::Segment> segments;
+  if (!GetPageSegments(index, &segments))
+    return CPDF_DataAvail::kDataError;
 
-    if (!m_pValidator->CheckDataRangeAndRequestIfUnavailable(
-            shared_group_info.m_szOffset, shared_group_info.m_dwLength)) {
-      return CPDF_DataAvail::kDataNotAvailable;
+  // Request every part missing at once, not one per round trip.
+  bool available = true;
+  for (const CPDF_DataAvail::Segment& segment : segments) {
+    if (!m_pValidator->CheckDataRangeAndRequestIfUnavailable(segment.offset,
+                                                             segment.size)) {
+      available = false;
     }
   }
-  return CPDF_DataAvail::kDataAvailable;
+  return available ? CPDF_DataAvail::kDataAvailable
+                   : CPDF_DataAvail::kDataNotAvailable;
 }
 
 bool CPDF_HintTables::LoadHintStream(CPDF_Stream* pHintStream) {
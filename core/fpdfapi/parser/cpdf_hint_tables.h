@@ -81,6 +81,12 @@ class CPDF_HintTables {
                   FX_FILESIZE* szPageLength,
                   uint32_t* dwObjNum) const;
 
+  // Adds the parts of the file page `index` needs to `segments`: the page's
+  // own objects and the shared object groups it uses. The first page needs
+  // none besides the first page section. Returns false for bad hint tables.
+  bool GetPageSegments(uint32_t index,
+                       std::vector<CPDF_DataAvail::Segment>* segments) const;
+
   CPDF_DataAvail::DocAvailStatus CheckPage(uint32_t index);
 
   bool LoadHintStream(CPDF_Stream* pHintStream);
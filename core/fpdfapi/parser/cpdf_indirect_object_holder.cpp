@@ -52,6 +52,8 @@ CPDF_Object* CPDF_IndirectObjectHolder::GetOrParseIndirectObject(
     return nullptr;
   }
 
+  // Building the object while parsing it does not count as changing it.
+  pNewObj->ClearModified();
   pNewObj->SetObjNum(objnum);
   m_LastObjNum = std::max(m_LastObjNum, objnum);
   insert_result.first->second = std::move(pNewObj);
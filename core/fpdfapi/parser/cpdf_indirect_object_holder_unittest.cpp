@@ -4,6 +4,7 @@
 
 #include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
 
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_null.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -37,6 +38,17 @@ TEST(IndirectObjectHolderTest, RecursiveParseOfSameObject) {
   EXPECT_TRUE(mock_holder.GetOrParseIndirectObject(1000));
 }
 
+TEST(IndirectObjectHolderTest, ParsedObjectsAreUnmodified) {
+  // Parsing builds the object up like any other.
+  auto parsed = pdfium::MakeRetain<CPDF_Dictionary>();
+  parsed->SetNewFor<CPDF_Null>("Null");
+  MockIndirectObjectHolder mock_holder;
+  EXPECT_CALL(mock_holder, ParseIndirectObject(::testing::_))
+      .WillOnce(::testing::Return(parsed));
+  EXPECT_FALSE(mock_holder.GetOrParseIndirectObject(1000)->IsModified());
+  EXPECT_TRUE(mock_holder.NewIndirect<CPDF_Null>()->IsModified());
+}
+
 TEST(IndirectObjectHolderTest, GetObjectMethods) {
   static constexpr uint32_t kObjNum = 1000;
   MockIndirectObjectHolder mock_holder;
@@ -31,6 +31,7 @@ ByteString CPDF_Name::GetString() const {
 }
 
 void CPDF_Name::SetString(const ByteString& str) {
+  SetModified();
   m_Name = str;
 }
 
@@ -49,6 +49,7 @@ const CPDF_Number* CPDF_Number::AsNumber() const {
 }
 
 void CPDF_Number::SetString(const ByteString& str) {
+  SetModified();
   m_Number = FX_Number(str.AsStringView());
 }
 
@@ -11,6 +11,7 @@
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_indirect_object_holder.h"
+#include "core/fpdfapi/parser/cpdf_object_walker.h"
 #include "core/fpdfapi/parser/cpdf_parser.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fxcrt/fx_string.h"
@@ -32,6 +33,21 @@ uint64_t CPDF_Object::KeyForCache() const {
          static_cast<uint64_t>(m_GenNum);
 }
 
+bool CPDF_Object::IsModified() const {
+  CPDF_ObjectWalker walker(this);
+  while (const CPDF_Object* pObj = walker.GetNext()) {
+    if (pObj->m_bModified)
+      return true;
+  }
+  return false;
+}
+
+void CPDF_Object::ClearModified() {
+  CPDF_NonConstObjectWalker walker(this);
+  while (CPDF_Object* pObj = walker.GetNext())
+    pObj->m_bModified = false;
+}
+
 RetainPtr<CPDF_Object> CPDF_Object::GetMutableDirect() {
   return pdfium::WrapRetain(const_cast<CPDF_Object*>(GetDirect()));
 }
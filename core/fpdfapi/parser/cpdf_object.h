@@ -49,6 +49,15 @@ class CPDF_Object : public Retainable {
   bool IsInline() const { return m_ObjNum == 0; }
   uint64_t KeyForCache() const;
 
+  // Whether the object, or one of the direct objects it holds, changed since
+  // it got parsed. Objects that did not get parsed from a file count as
+  // changed.
+  bool IsModified() const;
+
+  // Marks the object and the direct objects it holds as unchanged, once they
+  // got parsed.
+  void ClearModified();
+
   virtual Type GetType() const = 0;
 
   // Create a deep copy of the object.
@@ -122,8 +131,14 @@ class CPDF_Object : public Retainable {
 
   RetainPtr<CPDF_Object> CloneObjectNonCyclic(bool bDirect) const;
 
+  // Called by the methods that change the object itself.
+  void SetModified() { m_bModified = true; }
+
   uint32_t m_ObjNum = 0;
   uint32_t m_GenNum = 0;
+
+ private:
+  bool m_bModified = true;
 };
 
 template <typename T>
@@ -1022,6 +1022,44 @@ TEST(PDFDictionaryTest, ExtractObjectOnRemove) {
   EXPECT_FALSE(extracted_object);
 }
 
+TEST(PDFObjectTest, Modified) {
+  auto dict = pdfium::MakeRetain<CPDF_Dictionary>();
+  CPDF_Array* array = dict->SetNewFor<CPDF_Array>("array");
+  CPDF_Number* number = array->AppendNew<CPDF_Number>(1);
+  EXPECT_TRUE(dict->IsModified());
+
+  dict->ClearModified();
+  EXPECT_FALSE(dict->IsModified());
+  EXPECT_FALSE(array->IsModified());
+  EXPECT_FALSE(number->IsModified());
+
+  // Changes to direct objects within count, but removing nothing does not.
+  EXPECT_FALSE(dict->RemoveFor("missing"));
+  array->RemoveAt(1);
+  EXPECT_FALSE(dict->IsModified());
+  number->SetString("2");
+  EXPECT_TRUE(dict->IsModified());
+  EXPECT_TRUE(array->IsModified());
+
+  dict->ClearModified();
+  array->Clear();
+  EXPECT_TRUE(dict->IsModified());
+
+  auto stream = pdfium::MakeRetain<CPDF_Stream>();
+  stream->ClearModified();
+  stream->SetData(ByteStringView("data").raw_span());
+  EXPECT_TRUE(stream->IsModified());
+
+  // Objects that other objects refer to do not count.
+  auto holder = std::make_unique<CPDF_IndirectObjectHolder>();
+  auto* referred = holder->NewIndirect<CPDF_Dictionary>();
+  auto ref = pdfium::MakeRetain<CPDF_Reference>(holder.get(),
+                                                referred->GetObjNum());
+  ref->ClearModified();
+  EXPECT_TRUE(referred->IsModified());
+  EXPECT_FALSE(ref->IsModified());
+}
+
 TEST(PDFRefernceTest, MakeReferenceToReference) {
   auto obj_holder = std::make_unique<CPDF_IndirectObjectHolder>();
   auto original_ref = pdfium::MakeRetain<CPDF_Reference>(obj_holder.get(), 42);
@@ -43,6 +43,7 @@ class CPDF_ReadValidator : public IFX_SeekableReadStream {
   bool IsWholeFileAvailable();
   bool CheckDataRangeAndRequestIfUnavailable(FX_FILESIZE offset, size_t size);
   bool CheckWholeFileAndRequestIfUnavailable();
+  bool IsDataRangeAvailable(FX_FILESIZE offset, size_t size) const;
 
   // IFX_SeekableReadStream overrides:
   bool ReadBlockAtOffset(void* buffer,
@@ -57,7 +58,6 @@ class CPDF_ReadValidator : public IFX_SeekableReadStream {
 
  private:
   void ScheduleDownload(FX_FILESIZE offset, size_t size);
-  bool IsDataRangeAvailable(FX_FILESIZE offset, size_t size) const;
 
   RetainPtr<IFX_SeekableReadStream> const file_read_;
   UnownedPtr<CPDF_DataAvail::FileAvail> const file_avail_;
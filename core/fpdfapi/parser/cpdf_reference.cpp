@@ -80,6 +80,7 @@ const CPDF_Object* CPDF_Reference::SafeGetDirect() const {
 }
 
 void CPDF_Reference::SetRef(CPDF_IndirectObjectHolder* pDoc, uint32_t objnum) {
+  SetModified();
   m_pObjList = pDoc;
   m_RefObjNum = objnum;
 }
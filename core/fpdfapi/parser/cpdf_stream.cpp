@@ -8,10 +8,12 @@
 
 #include <stdint.h>
 
+#include <memory>
 #include <sstream>
 #include <utility>
 
 #include "constants/stream_dict_common.h"
+#include "core/fpdfapi/parser/cpdf_decryptor.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_encryptor.h"
 #include "core/fpdfapi/parser/cpdf_flateencoder.h"
@@ -22,6 +24,7 @@
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_stream.h"
 #include "core/fxcrt/span_util.h"
+#include "third_party/base/check.h"
 #include "third_party/base/containers/contains.h"
 #include "third_party/base/numerics/safe_conversions.h"
 
@@ -91,6 +94,7 @@ void CPDF_Stream::InitStream(pdfium::span<const uint8_t> pData,
 
 void CPDF_Stream::InitStreamFromFile(RetainPtr<IFX_SeekableReadStream> pFile,
                                      RetainPtr<CPDF_Dictionary> pDict) {
+  SetModified();
   m_bMemoryBased = false;
   m_pDataBuf.reset();
   m_pFile = std::move(pFile);
@@ -100,6 +104,14 @@ void CPDF_Stream::InitStreamFromFile(RetainPtr<IFX_SeekableReadStream> pFile,
                                   pdfium::base::checked_cast<int>(m_dwSize));
 }
 
+void CPDF_Stream::SetDecryptor(RetainPtr<const CPDF_Decryptor> decryptor) {
+  if (m_bMemoryBased) {
+    SetData(decryptor->Decrypt({m_pDataBuf.get(), m_dwSize}));
+    return;
+  }
+  InitStreamFromFile(decryptor->CreateDecryptingStream(m_pFile), m_pDict);
+}
+
 RetainPtr<CPDF_Object> CPDF_Stream::Clone() const {
   return CloneObjectNonCyclic(false);
 }
@@ -153,6 +165,7 @@ void CPDF_Stream::SetData(pdfium::span<const uint8_t> pData) {
 
 void CPDF_Stream::TakeData(std::unique_ptr<uint8_t, FxFreeDeleter> pData,
                            size_t size) {
+  SetModified();
   m_bMemoryBased = true;
   m_pFile = nullptr;
   m_pDataBuf = std::move(pData);
@@ -191,11 +204,27 @@ WideString CPDF_Stream::GetUnicodeText() const {
 
 bool CPDF_Stream::WriteTo(IFX_ArchiveStream* archive,
                           const CPDF_Encryptor* encryptor) const {
-  const bool is_metadata = IsMetaDataStreamDictionary(GetDict());
-  CPDF_FlateEncoder encoder(this, !is_metadata);
+  std::unique_ptr<CPDF_FlateEncoder> encoder =
+      CreateEncoder(FlateModule::EncodeOptions());
+  if (!encoder->Compress())
+    return false;
 
+  return WriteEncodedTo(archive, encryptor, encoder.get());
+}
+
+std::unique_ptr<CPDF_FlateEncoder> CPDF_Stream::CreateEncoder(
+    const FlateModule::EncodeOptions& options) const {
+  return std::make_unique<CPDF_FlateEncoder>(
+      this, !IsMetaDataStreamDictionary(GetDict()), options);
+}
+
+bool CPDF_Stream::WriteEncodedTo(IFX_ArchiveStream* archive,
+                                 const CPDF_Encryptor* encryptor,
+                                 CPDF_FlateEncoder* encoder) const {
+  DCHECK(!encoder->NeedsCompression());
+  const bool is_metadata = IsMetaDataStreamDictionary(GetDict());
   DataVector<uint8_t> encrypted_data;
-  pdfium::span<const uint8_t> data = encoder.GetSpan();
+  pdfium::span<const uint8_t> data = encoder->GetSpan();
 
   if (encryptor && !is_metadata) {
     encrypted_data = encryptor->Encrypt(data);
@@ -203,13 +232,14 @@ bool CPDF_Stream::WriteTo(IFX_ArchiveStream* archive,
   }
 
   size_t size = data.size();
-  if (static_cast<size_t>(encoder.GetDict()->GetIntegerFor("Length")) != size) {
-    encoder.CloneDict();
-    encoder.GetClonedDict()->SetNewFor<CPDF_Number>("Length",
-                                                    static_cast<int>(size));
+  if (static_cast<size_t>(encoder->GetDict()->GetIntegerFor("Length")) !=
+      size) {
+    encoder->CloneDict();
+    encoder->GetClonedDict()->SetNewFor<CPDF_Number>("Length",
+                                                     static_cast<int>(size));
   }
 
-  if (!encoder.GetDict()->WriteTo(archive, encryptor))
+  if (!encoder->GetDict()->WriteTo(archive, encryptor))
     return false;
 
   if (!archive->WriteString("stream\r\n"))
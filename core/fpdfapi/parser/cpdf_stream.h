@@ -13,12 +13,16 @@
 #include <set>
 
 #include "core/fpdfapi/parser/cpdf_object.h"
+#include "core/fxcodec/flate/flatemodule.h"
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/fx_stream.h"
 #include "core/fxcrt/fx_string_wrappers.h"
 #include "core/fxcrt/retain_ptr.h"
 
+class CPDF_Decryptor;
+class CPDF_FlateEncoder;
+
 class CPDF_Stream final : public CPDF_Object {
  public:
   static constexpr int kFileBufSize = 512;
@@ -36,6 +40,18 @@ class CPDF_Stream final : public CPDF_Object {
   bool WriteTo(IFX_ArchiveStream* archive,
                const CPDF_Encryptor* encryptor) const override;
 
+  // Creates the encoder WriteTo() writes the stream's data with, but
+  // compressing with `options`, and only once the caller calls
+  // CPDF_FlateEncoder::Compress().
+  std::unique_ptr<CPDF_FlateEncoder> CreateEncoder(
+      const FlateModule::EncodeOptions& options) const;
+
+  // Like WriteTo(), with data from `encoder`, which must come from
+  // CreateEncoder() and have been compressed.
+  bool WriteEncodedTo(IFX_ArchiveStream* archive,
+                      const CPDF_Encryptor* encryptor,
+                      CPDF_FlateEncoder* encoder) const;
+
   size_t GetRawSize() const { return m_dwSize; }
   // Will be null in case when stream is not memory based.
   // Use CPDF_StreamAcc to data access in all cases.
@@ -58,6 +74,10 @@ class CPDF_Stream final : public CPDF_Object {
   void InitStreamFromFile(RetainPtr<IFX_SeekableReadStream> pFile,
                           RetainPtr<CPDF_Dictionary> pDict);
 
+  // Makes the stream's data what `decryptor` decrypts it to. Data read from
+  // the file gets decrypted as it gets read.
+  void SetDecryptor(RetainPtr<const CPDF_Decryptor> decryptor);
+
   // Can only be called when a stream is not memory-based.
   bool ReadRawData(FX_FILESIZE offset, uint8_t* pBuf, size_t buf_size) const;
 
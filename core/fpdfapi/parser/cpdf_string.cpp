@@ -10,6 +10,7 @@
 
 #include <utility>
 
+#include "core/fpdfapi/parser/cpdf_decryptor.h"
 #include "core/fpdfapi/parser/cpdf_encryptor.h"
 #include "core/fpdfapi/parser/fpdf_parser_decode.h"
 #include "core/fxcrt/data_vector.h"
@@ -40,16 +41,19 @@ CPDF_Object::Type CPDF_String::GetType() const {
 RetainPtr<CPDF_Object> CPDF_String::Clone() const {
   auto pRet = pdfium::MakeRetain<CPDF_String>();
   pRet->m_String = m_String;
+  pRet->m_pDecryptor = m_pDecryptor;
   pRet->m_bHex = m_bHex;
   return pRet;
 }
 
 ByteString CPDF_String::GetString() const {
-  return m_String;
+  return GetDecryptedString();
 }
 
 void CPDF_String::SetString(const ByteString& str) {
+  SetModified();
   m_String = str;
+  m_pDecryptor.Reset();
 }
 
 bool CPDF_String::IsString() const {
@@ -65,13 +69,13 @@ const CPDF_String* CPDF_String::AsString() const {
 }
 
 WideString CPDF_String::GetUnicodeText() const {
-  return PDF_DecodeText(m_String.raw_span());
+  return PDF_DecodeText(GetDecryptedString().raw_span());
 }
 
 bool CPDF_String::WriteTo(IFX_ArchiveStream* archive,
                           const CPDF_Encryptor* encryptor) const {
   DataVector<uint8_t> encrypted_data;
-  pdfium::span<const uint8_t> data = m_String.raw_span();
+  pdfium::span<const uint8_t> data = GetDecryptedString().raw_span();
   if (encryptor) {
     encrypted_data = encryptor->Encrypt(data);
     data = encrypted_data;
@@ -83,6 +87,20 @@ bool CPDF_String::WriteTo(IFX_ArchiveStream* archive,
 }
 
 ByteString CPDF_String::EncodeString() const {
-  return m_bHex ? PDF_HexEncodeString(m_String.AsStringView())
-                : PDF_EncodeString(m_String.AsStringView());
+  const ByteString& str = GetDecryptedString();
+  return m_bHex ? PDF_HexEncodeString(str.AsStringView())
+                : PDF_EncodeString(str.AsStringView());
+}
+
+void CPDF_String::SetDecryptor(RetainPtr<const CPDF_Decryptor> decryptor) {
+  m_pDecryptor = std::move(decryptor);
+}
+
+const ByteString& CPDF_String::GetDecryptedString() const {
+  if (m_pDecryptor) {
+    DataVector<uint8_t> decrypted = m_pDecryptor->Decrypt(m_String.raw_span());
+    m_String = ByteString(decrypted.data(), decrypted.size());
+    m_pDecryptor.Reset();
+  }
+  return m_String;
 }
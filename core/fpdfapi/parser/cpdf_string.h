@@ -13,6 +13,8 @@
 #include "core/fxcrt/string_pool_template.h"
 #include "core/fxcrt/weak_ptr.h"
 
+class CPDF_Decryptor;
+
 class CPDF_String final : public CPDF_Object {
  public:
   CONSTRUCT_VIA_MAKE_RETAIN;
@@ -32,13 +34,21 @@ class CPDF_String final : public CPDF_Object {
   bool IsHex() const { return m_bHex; }
   ByteString EncodeString() const;
 
+  // Makes the string's value what `decryptor` decrypts its current value to,
+  // once the value first gets used.
+  void SetDecryptor(RetainPtr<const CPDF_Decryptor> decryptor);
+
  private:
   CPDF_String();
   CPDF_String(WeakPtr<ByteStringPool> pPool, const ByteString& str, bool bHex);
   CPDF_String(WeakPtr<ByteStringPool> pPool, WideStringView str);
   ~CPDF_String() override;
 
-  ByteString m_String;
+  // Returns `m_String`, decrypting it first if it has a decryptor.
+  const ByteString& GetDecryptedString() const;
+
+  mutable ByteString m_String;
+  mutable RetainPtr<const CPDF_Decryptor> m_pDecryptor;
   bool m_bHex = false;
 };
 
@@ -600,6 +600,13 @@ bool FlateEncode(pdfium::span<const uint8_t> src_span,
   return FlateModule::Encode(src_span, dest_buf, dest_size);
 }
 
+bool FlateEncode(pdfium::span<const uint8_t> src_span,
+                 const FlateModule::EncodeOptions& options,
+                 std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
+                 uint32_t* dest_size) {
+  return FlateModule::Encode(src_span, options, dest_buf, dest_size);
+}
+
 uint32_t FlateDecode(pdfium::span<const uint8_t> src_span,
                      std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
                      uint32_t* dest_size) {
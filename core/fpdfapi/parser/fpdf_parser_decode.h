@@ -11,6 +11,7 @@
 #include <utility>
 #include <vector>
 
+#include "core/fxcodec/flate/flatemodule.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
 #include "core/fxcrt/fx_string.h"
 #include "core/fxcrt/retain_ptr.h"
@@ -52,6 +53,10 @@ std::unique_ptr<fxcodec::ScanlineDecoder> CreateFlateDecoder(
 bool FlateEncode(pdfium::span<const uint8_t> src_span,
                  std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
                  uint32_t* dest_size);
+bool FlateEncode(pdfium::span<const uint8_t> src_span,
+                 const FlateModule::EncodeOptions& options,
+                 std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
+                 uint32_t* dest_size);
 
 uint32_t FlateDecode(pdfium::span<const uint8_t> src_span,
                      std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
@@ -0,0 +1,166 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
+
+#include <algorithm>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fxge/dib/cfx_dibbase.h"
+
+namespace {
+
+bool IsFullResolution(const CFX_Size& size) {
+  return size.width <= 0 || size.height <= 0;
+}
+
+// Pixels in a decode of at most `size`, with full resolution as the largest.
+int64_t MaxArea(const CFX_Size& size) {
+  if (IsFullResolution(size))
+    return std::numeric_limits<int64_t>::max();
+  return static_cast<int64_t>(size.width) * size.height;
+}
+
+}  // namespace
+
+bool CPDF_DocImageCache::Key::operator<(const Key& other) const {
+  return std::tie(stream, std_cs, group_family, load_mask, form_color_spaces,
+                  page_color_spaces) <
+         std::tie(other.stream, other.std_cs, other.group_family,
+                  other.load_mask, other.form_color_spaces,
+                  other.page_color_spaces);
+}
+
+bool CPDF_DocImageCache::Key::operator==(const Key& other) const {
+  return std::tie(stream, std_cs, group_family, load_mask, form_color_spaces,
+                  page_color_spaces) ==
+         std::tie(other.stream, other.std_cs, other.group_family,
+                  other.load_mask, other.form_color_spaces,
+                  other.page_color_spaces);
+}
+
+CPDF_DocImageCache::Image::Image() = default;
+
+CPDF_DocImageCache::Image::Image(const Image& that) = default;
+
+CPDF_DocImageCache::Image& CPDF_DocImageCache::Image::operator=(
+    const Image& that) = default;
+
+CPDF_DocImageCache::Image::~Image() = default;
+
+CPDF_DocImageCache::CPDF_DocImageCache() = default;
+
+CPDF_DocImageCache::~CPDF_DocImageCache() = default;
+
+void CPDF_DocImageCache::SetBudget(size_t budget) {
+  m_Budget = budget;
+  EvictToFit(0);
+}
+
+absl::optional<CPDF_DocImageCache::Image> CPDF_DocImageCache::Lookup(
+    const Key& key,
+    const CFX_Size& max_size) {
+  // Of the decodes that cover `max_size`, use the smallest.
+  auto best = m_Entries.end();
+  for (auto it = m_Entries.lower_bound({key, {0, 0}});
+       it != m_Entries.end() && it->first.first == key; ++it) {
+    const CFX_Size& cached = it->second.image.max_size;
+    if (Covers(cached, max_size) &&
+        (best == m_Entries.end() ||
+         MaxArea(cached) < MaxArea(best->second.image.max_size))) {
+      best = it;
+    }
+  }
+  if (best == m_Entries.end()) {
+    ++m_Stats.misses;
+    return absl::nullopt;
+  }
+
+  ++m_Stats.hits;
+  best->second.last_used = ++m_UseCount;
+  return best->second.image;
+}
+
+void CPDF_DocImageCache::Put(const Key& key, const Image& image) {
+  size_t size = image.bitmap->GetEstimatedImageMemoryBurden();
+  if (image.mask)
+    size += image.mask->GetEstimatedImageMemoryBurden();
+  if (size > m_Budget)
+    return;
+
+  for (auto it = m_Entries.lower_bound({key, {0, 0}});
+       it != m_Entries.end() && it->first.first == key;) {
+    if (Covers(image.max_size, it->second.image.max_size))
+      EraseEntry(it++);
+    else
+      ++it;
+  }
+  EvictToFit(size);
+
+  CFX_Size max_size;
+  if (!IsFullResolution(image.max_size))
+    max_size = image.max_size;
+  Entry& entry = m_Entries[{key, {max_size.width, max_size.height}}];
+  entry.image = image;
+  entry.image.max_size = max_size;
+  entry.stream.Reset(key.stream);
+  entry.form_color_spaces.Reset(key.form_color_spaces);
+  entry.page_color_spaces.Reset(key.page_color_spaces);
+  entry.size = size;
+  entry.last_used = ++m_UseCount;
+  m_Stats.bytes += size;
+  m_Stats.entries = m_Entries.size();
+}
+
+void CPDF_DocImageCache::Remove(const CPDF_Stream* stream) {
+  for (auto it = m_Entries.begin(); it != m_Entries.end();) {
+    if (it->first.first.stream == stream)
+      EraseEntry(it++);
+    else
+      ++it;
+  }
+}
+
+// static
+bool CPDF_DocImageCache::Covers(const CFX_Size& cached,
+                                const CFX_Size& wanted) {
+  if (IsFullResolution(cached))
+    return true;
+  if (IsFullResolution(wanted))
+    return false;
+  return wanted.width <= cached.width && wanted.height <= cached.height;
+}
+
+void CPDF_DocImageCache::EraseEntry(EntryMap::iterator it) {
+  m_Stats.bytes -= it->second.size;
+  m_Entries.erase(it);
+  m_Stats.entries = m_Entries.size();
+}
+
+void CPDF_DocImageCache::EvictToFit(size_t size) {
+  // Eviction scans every entry, but only runs after a whole image has just
+  // been decoded.
+  while (!m_Entries.empty() && m_Stats.bytes + size > m_Budget) {
+    auto oldest = std::min_element(m_Entries.begin(), m_Entries.end(),
+                                   [](const auto& a, const auto& b) {
+                                     return a.second.last_used <
+                                            b.second.last_used;
+                                   });
+    EraseEntry(oldest);
+    ++m_Stats.evictions;
+  }
+}
+
+CPDF_DocImageCache::Entry::Entry() = default;
+
+CPDF_DocImageCache::Entry::Entry(Entry&&) noexcept = default;
+
+CPDF_DocImageCache::Entry& CPDF_DocImageCache::Entry::operator=(
+    Entry&&) noexcept = default;
+
+CPDF_DocImageCache::Entry::~Entry() = default;
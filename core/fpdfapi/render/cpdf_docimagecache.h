@@ -0,0 +1,121 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
+#define CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <utility>
+
+#include "core/fpdfapi/page/cpdf_colorspace.h"
+#include "core/fxcrt/fx_coordinates.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+class CFX_DIBBase;
+class CPDF_Dictionary;
+class CPDF_Stream;
+
+// Decoded images shared by all the pages of a document, so an image drawn on
+// many pages is decoded once. Holds at most a byte budget's worth of images,
+// evicting the least recently used ones. The budget starts at 0, which keeps
+// the cache off until the embedder opts in.
+class CPDF_DocImageCache {
+ public:
+  // Everything besides the image stream that changes how it decodes.
+  struct Key {
+    bool operator<(const Key& other) const;
+    bool operator==(const Key& other) const;
+
+    const CPDF_Stream* stream = nullptr;
+    bool std_cs = false;
+    CPDF_ColorSpace::Family group_family = CPDF_ColorSpace::Family::kUnknown;
+    bool load_mask = false;
+    // The /ColorSpace resource dictionaries a named color space may resolve
+    // against. Null when the image's color space does not depend on them.
+    const CPDF_Dictionary* form_color_spaces = nullptr;
+    const CPDF_Dictionary* page_color_spaces = nullptr;
+  };
+
+  struct Image {
+    Image();
+    Image(const Image& that);
+    Image& operator=(const Image& that);
+    ~Image();
+
+    RetainPtr<CFX_DIBBase> bitmap;
+    RetainPtr<CFX_DIBBase> mask;
+    uint32_t matte_color = 0;
+    // Size of a reduced resolution decode, which serves any request up to
+    // that size. Empty for full resolution.
+    CFX_Size max_size;
+  };
+
+  struct Stats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  CPDF_DocImageCache();
+  ~CPDF_DocImageCache();
+
+  // Sets the number of bytes of decoded images to keep, evicting images as
+  // needed. 0 disables the cache.
+  void SetBudget(size_t budget);
+  size_t GetBudget() const { return m_Budget; }
+  bool IsEnabled() const { return m_Budget > 0; }
+
+  // Returns a cached decode for `key` with enough resolution to draw at
+  // `max_size`, where an empty `max_size` asks for full resolution.
+  absl::optional<Image> Lookup(const Key& key, const CFX_Size& max_size);
+
+  // Caches `image` for `key`, replacing any cached decodes of it that
+  // `image` has at least as much resolution as. Images larger than the whole
+  // budget are not cached.
+  void Put(const Key& key, const Image& image);
+
+  // Drops all decodes of `stream`, e.g. after its image changed.
+  void Remove(const CPDF_Stream* stream);
+
+  const Stats& GetStats() const { return m_Stats; }
+
+ private:
+  struct Entry {
+    Entry();
+    Entry(Entry&&) noexcept;
+    Entry& operator=(Entry&&) noexcept;
+    ~Entry();
+
+    Image image;
+    // Keep the objects `Key` points to alive, so their addresses cannot be
+    // reused by other objects while the entry exists.
+    RetainPtr<const CPDF_Stream> stream;
+    RetainPtr<const CPDF_Dictionary> form_color_spaces;
+    RetainPtr<const CPDF_Dictionary> page_color_spaces;
+    size_t size = 0;
+    uint64_t last_used = 0;
+  };
+
+  // Keyed by `Key` and then by `Image::max_size`, so all the decodes of one
+  // key are adjacent.
+  using EntryMap = std::map<std::pair<Key, std::pair<int, int>>, Entry>;
+
+  static bool Covers(const CFX_Size& cached, const CFX_Size& wanted);
+
+  void EraseEntry(EntryMap::iterator it);
+  void EvictToFit(size_t size);
+
+  size_t m_Budget = 0;
+  uint64_t m_UseCount = 0;
+  EntryMap m_Entries;
+  Stats m_Stats;
+};
+
+#endif  // CORE_FPDFAPI_RENDER_CPDF_DOCIMAGECACHE_H_
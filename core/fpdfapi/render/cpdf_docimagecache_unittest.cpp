@@ -0,0 +1,161 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
+
+#include <utility>
+
+#include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fxge/dib/cfx_dibitmap.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// 16x16 ARGB, so 1024 bytes each.
+constexpr size_t kImageBytes = 16 * 16 * 4;
+
+CPDF_DocImageCache::Image MakeImage(const CFX_Size& max_size) {
+  auto bitmap = pdfium::MakeRetain<CFX_DIBitmap>();
+  EXPECT_TRUE(bitmap->Create(16, 16, FXDIB_Format::kArgb));
+  CPDF_DocImageCache::Image image;
+  image.bitmap = std::move(bitmap);
+  image.max_size = max_size;
+  return image;
+}
+
+CPDF_DocImageCache::Key MakeKey(const CPDF_Stream* stream) {
+  CPDF_DocImageCache::Key key;
+  key.stream = stream;
+  return key;
+}
+
+}  // namespace
+
+TEST(CPDF_DocImageCacheTest, DisabledByDefault) {
+  auto stream = pdfium::MakeRetain<CPDF_Stream>();
+  CPDF_DocImageCache cache;
+  EXPECT_FALSE(cache.IsEnabled());
+  EXPECT_EQ(0u, cache.GetBudget());
+
+  const CPDF_DocImageCache::Key key = MakeKey(stream.Get());
+  cache.Put(key, MakeImage(CFX_Size()));
+  EXPECT_FALSE(cache.Lookup(key, CFX_Size()).has_value());
+  EXPECT_EQ(0u, cache.GetStats().entries);
+
+  cache.SetBudget(kImageBytes);
+  EXPECT_TRUE(cache.IsEnabled());
+}
+
+TEST(CPDF_DocImageCacheTest, LookupAndPut) {
+  auto stream = pdfium::MakeRetain<CPDF_Stream>();
+  CPDF_DocImageCache cache;
+  cache.SetBudget(kImageBytes * 4);
+  const CPDF_DocImageCache::Key key = MakeKey(stream.Get());
+  EXPECT_FALSE(cache.Lookup(key, CFX_Size()).has_value());
+
+  CPDF_DocImageCache::Image image = MakeImage(CFX_Size());
+  image.matte_color = 0xff00ff00;
+  cache.Put(key, image);
+  absl::optional<CPDF_DocImageCache::Image> found =
+      cache.Lookup(key, CFX_Size());
+  ASSERT_TRUE(found.has_value());
+  EXPECT_EQ(image.bitmap, found.value().bitmap);
+  EXPECT_EQ(0xff00ff00, found.value().matte_color);
+
+  // A full resolution decode serves any size.
+  EXPECT_TRUE(cache.Lookup(key, CFX_Size(10, 10)).has_value());
+
+  // Different decode options need their own decode.
+  CPDF_DocImageCache::Key std_cs_key = key;
+  std_cs_key.std_cs = true;
+  EXPECT_FALSE(cache.Lookup(std_cs_key, CFX_Size()).has_value());
+
+  const CPDF_DocImageCache::Stats& stats = cache.GetStats();
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+  EXPECT_EQ(1u, stats.entries);
+  EXPECT_EQ(kImageBytes, stats.bytes);
+}
+
+TEST(CPDF_DocImageCacheTest, DownscaledDecodes) {
+  auto stream = pdfium::MakeRetain<CPDF_Stream>();
+  CPDF_DocImageCache cache;
+  cache.SetBudget(kImageBytes * 4);
+  const CPDF_DocImageCache::Key key = MakeKey(stream.Get());
+  CPDF_DocImageCache::Image small = MakeImage(CFX_Size(50, 50));
+  cache.Put(key, small);
+  EXPECT_TRUE(cache.Lookup(key, CFX_Size(50, 40)).has_value());
+  EXPECT_FALSE(cache.Lookup(key, CFX_Size(60, 40)).has_value());
+  EXPECT_FALSE(cache.Lookup(key, CFX_Size()).has_value());
+
+  // A larger decode replaces the smaller one.
+  CPDF_DocImageCache::Image large = MakeImage(CFX_Size(100, 100));
+  cache.Put(key, large);
+  EXPECT_EQ(1u, cache.GetStats().entries);
+  EXPECT_EQ(large.bitmap, cache.Lookup(key, CFX_Size(40, 40)).value().bitmap);
+
+  // So does a full resolution one.
+  CPDF_DocImageCache::Image full = MakeImage(CFX_Size());
+  cache.Put(key, full);
+  EXPECT_EQ(1u, cache.GetStats().entries);
+  EXPECT_EQ(kImageBytes, cache.GetStats().bytes);
+  EXPECT_EQ(full.bitmap, cache.Lookup(key, CFX_Size(40, 40)).value().bitmap);
+
+  // A smaller decode is kept alongside, and used when it suffices.
+  cache.Put(key, small);
+  EXPECT_EQ(2u, cache.GetStats().entries);
+  EXPECT_EQ(small.bitmap, cache.Lookup(key, CFX_Size(40, 40)).value().bitmap);
+  EXPECT_EQ(full.bitmap, cache.Lookup(key, CFX_Size(80, 40)).value().bitmap);
+}
+
+TEST(CPDF_DocImageCacheTest, EvictsLeastRecentlyUsed) {
+  auto stream1 = pdfium::MakeRetain<CPDF_Stream>();
+  auto stream2 = pdfium::MakeRetain<CPDF_Stream>();
+  auto stream3 = pdfium::MakeRetain<CPDF_Stream>();
+  CPDF_DocImageCache cache;
+  cache.SetBudget(kImageBytes * 2);
+  cache.Put(MakeKey(stream1.Get()), MakeImage(CFX_Size()));
+  cache.Put(MakeKey(stream2.Get()), MakeImage(CFX_Size()));
+  EXPECT_TRUE(cache.Lookup(MakeKey(stream1.Get()), CFX_Size()).has_value());
+
+  cache.Put(MakeKey(stream3.Get()), MakeImage(CFX_Size()));
+  EXPECT_TRUE(cache.Lookup(MakeKey(stream1.Get()), CFX_Size()).has_value());
+  EXPECT_FALSE(cache.Lookup(MakeKey(stream2.Get()), CFX_Size()).has_value());
+  EXPECT_TRUE(cache.Lookup(MakeKey(stream3.Get()), CFX_Size()).has_value());
+  EXPECT_EQ(1u, cache.GetStats().evictions);
+  EXPECT_EQ(2u, cache.GetStats().entries);
+
+  // Shrinking the budget evicts right away.
+  cache.SetBudget(kImageBytes);
+  EXPECT_EQ(2u, cache.GetStats().evictions);
+  EXPECT_EQ(1u, cache.GetStats().entries);
+  EXPECT_EQ(kImageBytes, cache.GetStats().bytes);
+  EXPECT_TRUE(cache.Lookup(MakeKey(stream3.Get()), CFX_Size()).has_value());
+
+  // Images larger than the budget are not cached.
+  cache.SetBudget(kImageBytes - 1);
+  cache.Put(MakeKey(stream1.Get()), MakeImage(CFX_Size()));
+  EXPECT_EQ(0u, cache.GetStats().entries);
+  EXPECT_EQ(0u, cache.GetStats().bytes);
+}
+
+TEST(CPDF_DocImageCacheTest, Remove) {
+  auto stream1 = pdfium::MakeRetain<CPDF_Stream>();
+  auto stream2 = pdfium::MakeRetain<CPDF_Stream>();
+  CPDF_DocImageCache cache;
+  cache.SetBudget(kImageBytes * 4);
+  CPDF_DocImageCache::Key key1 = MakeKey(stream1.Get());
+  cache.Put(key1, MakeImage(CFX_Size()));
+  key1.load_mask = true;
+  cache.Put(key1, MakeImage(CFX_Size()));
+  cache.Put(MakeKey(stream2.Get()), MakeImage(CFX_Size()));
+  EXPECT_EQ(3u, cache.GetStats().entries);
+
+  cache.Remove(stream1.Get());
+  EXPECT_EQ(1u, cache.GetStats().entries);
+  EXPECT_EQ(kImageBytes, cache.GetStats().bytes);
+  EXPECT_FALSE(cache.Lookup(key1, CFX_Size()).has_value());
+  EXPECT_TRUE(cache.Lookup(MakeKey(stream2.Get()), CFX_Size()).has_value());
+}
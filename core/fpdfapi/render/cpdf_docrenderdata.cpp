@@ -42,6 +42,10 @@ CPDF_DocRenderData::CPDF_DocRenderData() = default;
 
 CPDF_DocRenderData::~CPDF_DocRenderData() = default;
 
+void CPDF_DocRenderData::MaybePurgeImage(const CPDF_Stream* pImageStream) {
+  m_ImageCache.Remove(pImageStream);
+}
+
 RetainPtr<CPDF_Type3Cache> CPDF_DocRenderData::GetCachedType3(
     CPDF_Type3Font* pFont) {
   auto it = m_Type3FaceMap.find(pFont);
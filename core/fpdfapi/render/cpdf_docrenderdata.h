@@ -11,6 +11,7 @@
 
 #include "build/build_config.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
 #include "core/fxcrt/observed_ptr.h"
 #include "core/fxcrt/retain_ptr.h"
 
@@ -38,8 +39,12 @@ class CPDF_DocRenderData : public CPDF_Document::RenderDataIface {
   CPDF_DocRenderData(const CPDF_DocRenderData&) = delete;
   CPDF_DocRenderData& operator=(const CPDF_DocRenderData&) = delete;
 
+  // CPDF_Document::RenderDataIface:
+  void MaybePurgeImage(const CPDF_Stream* pImageStream) override;
+
   RetainPtr<CPDF_Type3Cache> GetCachedType3(CPDF_Type3Font* pFont);
   RetainPtr<CPDF_TransferFunc> GetTransferFunc(const CPDF_Object* pObj);
+  CPDF_DocImageCache* GetImageCache() { return &m_ImageCache; }
 
 #if BUILDFLAG(IS_WIN)
   CFX_PSFontTracker* GetPSFontTracker();
@@ -54,6 +59,7 @@ class CPDF_DocRenderData : public CPDF_Document::RenderDataIface {
   std::map<CPDF_Font*, ObservedPtr<CPDF_Type3Cache>> m_Type3FaceMap;
   std::map<const CPDF_Object*, ObservedPtr<CPDF_TransferFunc>>
       m_TransferFuncMap;
+  CPDF_DocImageCache m_ImageCache;
 
 #if BUILDFLAG(IS_WIN)
   std::unique_ptr<CFX_PSFontTracker> m_PSFontTracker;
@@ -24,17 +24,19 @@ CPDF_ImageLoader::~CPDF_ImageLoader() = default;
 
 bool CPDF_ImageLoader::Start(const CPDF_ImageObject* pImage,
                              const CPDF_RenderStatus* pRenderStatus,
-                             bool bStdCS) {
+                             bool bStdCS,
+                             const CPDF_DIB::DecodeHint& hint) {
   m_pCache = pRenderStatus->GetContext()->GetPageCache();
   m_pImageObject = pImage;
   bool ret;
   if (m_pCache) {
     ret = m_pCache->StartGetCachedBitmap(m_pImageObject->GetImage(),
-                                         pRenderStatus, bStdCS);
+                                         pRenderStatus, bStdCS, hint);
   } else {
     ret = m_pImageObject->GetImage()->StartLoadDIBBase(
         pRenderStatus->GetFormResource(), pRenderStatus->GetPageResource(),
-        bStdCS, pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask());
+        bStdCS, pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask(),
+        hint);
   }
   if (!ret)
     HandleFailure();
@@ -40,6 +40,7 @@
 #include "core/fxge/dib/cfx_imagetransformer.h"
 #include "third_party/base/check.h"
 #include "third_party/base/cxx17_backports.h"
+#include "third_party/base/numerics/safe_conversions.h"
 
 #if defined(_SKIA_SUPPORT_)
 #include "core/fxge/skia/fx_skia_device.h"
@@ -67,13 +68,45 @@ bool CPDF_ImageRenderer::StartLoadDIBBase() {
   if (!GetUnitRect().has_value())
     return false;
 
-  if (!m_Loader.Start(m_pImageObject.Get(), m_pRenderStatus.Get(), m_bStdCS))
+  if (!m_Loader.Start(m_pImageObject.Get(), m_pRenderStatus.Get(), m_bStdCS,
+                      GetDecodeHint())) {
     return false;
+  }
 
   m_Mode = Mode::kDefault;
   return true;
 }
 
+CPDF_DIB::DecodeHint CPDF_ImageRenderer::GetDecodeHint() const {
+  // Only screen output is worth trading image quality for decode time.
+  CPDF_DIB::DecodeHint hint;
+  const CFX_RenderDevice* device = m_pRenderStatus->GetRenderDevice();
+  if (device->GetDeviceType() != DeviceType::kDisplay)
+    return hint;
+
+  // The image's unit square covers this many device pixels along each of
+  // the image's axes.
+  const float width = ceilf(m_ImageMatrix.GetXUnit());
+  const float height = ceilf(m_ImageMatrix.GetYUnit());
+  if (width >= 1 && height >= 1 &&
+      pdfium::base::IsValueInRangeForNumericType<int>(width) &&
+      pdfium::base::IsValueInRangeForNumericType<int>(height)) {
+    hint.max_size = CFX_Size(static_cast<int>(width), static_cast<int>(height));
+  }
+
+  // Map the clip box back into the unit square to find what can be seen.
+  if (m_ImageMatrix.a * m_ImageMatrix.d - m_ImageMatrix.b * m_ImageMatrix.c ==
+      0) {
+    return hint;
+  }
+  CFX_FloatRect visible_area = m_ImageMatrix.GetInverse().TransformRect(
+      CFX_FloatRect(device->GetClipBox()));
+  visible_area.Intersect(CFX_FloatRect(0, 0, 1, 1));
+  if (!visible_area.IsEmpty())
+    hint.visible_area = visible_area;
+  return hint;
+}
+
 bool CPDF_ImageRenderer::StartRenderDIBBase() {
   if (!m_Loader.GetBitmap())
     return false;
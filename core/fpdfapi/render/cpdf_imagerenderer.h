@@ -56,6 +56,7 @@ class CPDF_ImageRenderer {
   bool StartDIBBase();
   bool StartRenderDIBBase();
   bool StartLoadDIBBase();
+  CPDF_DIB::DecodeHint GetDecodeHint() const;
   bool ContinueDefault(PauseIndicatorIface* pPause);
   bool ContinueBlend(PauseIndicatorIface* pPause);
   bool ContinueTransform(PauseIndicatorIface* pPause);
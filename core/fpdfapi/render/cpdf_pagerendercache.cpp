@@ -6,7 +6,10 @@
 
 #include "core/fpdfapi/render/cpdf_pagerendercache.h"
 
+#include <math.h>
+
 #include <algorithm>
+#include <limits>
 #include <utility>
 #include <vector>
 
@@ -16,6 +19,7 @@
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_stream.h"
+#include "core/fpdfapi/render/cpdf_docrenderdata.h"
 #include "core/fpdfapi/render/cpdf_rendercontext.h"
 #include "core/fpdfapi/render/cpdf_renderstatus.h"
 #include "core/fxcrt/stl_util.h"
@@ -32,6 +36,38 @@ struct CacheInfo {
   bool operator<(const CacheInfo& other) const { return time < other.time; }
 };
 
+// Returns the /ColorSpace resources a named color space in an image may
+// resolve against.
+const CPDF_Dictionary* GetColorSpaceResources(
+    const CPDF_Dictionary* pResources) {
+  return pResources ? pResources->GetDictFor("ColorSpace") : nullptr;
+}
+
+// Rounds `area` out to a grid of this many cells per side over the unit
+// square, so clip boxes that differ a little, like neighbouring tiles, share
+// one decode area.
+constexpr float kVisibleAreaGridCells = 4.0f;
+
+CFX_FloatRect SnapVisibleArea(const CFX_FloatRect& area) {
+  if (area.IsEmpty())
+    return area;
+
+  return CFX_FloatRect(
+      floorf(area.left * kVisibleAreaGridCells) / kVisibleAreaGridCells,
+      floorf(area.bottom * kVisibleAreaGridCells) / kVisibleAreaGridCells,
+      ceilf(area.right * kVisibleAreaGridCells) / kVisibleAreaGridCells,
+      ceilf(area.top * kVisibleAreaGridCells) / kVisibleAreaGridCells);
+}
+
+// Shrinks `size` to the size `dib` was decoded to, if that is reduced.
+void FitDownscaledSize(const CPDF_DIB* dib, CFX_Size* size) {
+  if (!dib || !dib->IsDownscaled())
+    return;
+
+  size->width = std::min(size->width, dib->GetWidth());
+  size->height = std::min(size->height, dib->GetHeight());
+}
+
 }  // namespace
 
 CPDF_PageRenderCache::CPDF_PageRenderCache(CPDF_Page* pPage) : m_pPage(pPage) {}
@@ -80,9 +116,20 @@ void CPDF_PageRenderCache::ClearImageCacheEntry(const CPDF_Stream* pStream) {
 bool CPDF_PageRenderCache::StartGetCachedBitmap(
     RetainPtr<CPDF_Image> pImage,
     const CPDF_RenderStatus* pRenderStatus,
-    bool bStdCS) {
+    bool bStdCS,
+    const CPDF_DIB::DecodeHint& hint) {
   const CPDF_Stream* pStream = pImage->GetStream();
-  const auto it = m_ImageCache.find(pStream);
+  CPDF_DIB::DecodeHint decode_hint = hint;
+  decode_hint.visible_area = SnapVisibleArea(hint.visible_area);
+  auto it = m_ImageCache.find(pStream);
+  if (it != m_ImageCache.end() && !it->second->IsCacheValid(decode_hint)) {
+    // Decoded at too low a resolution, or too little of it, for this request.
+    // Decode it again, along with what was decoded before if that is still
+    // sharp enough, so a view moving around the image settles on one decode.
+    it->second->ExtendVisibleArea(&decode_hint);
+    ClearImageCacheEntry(pStream);
+    it = m_ImageCache.end();
+  }
   m_bCurFindCache = it != m_ImageCache.end();
   if (m_bCurFindCache) {
     m_pCurImageCacheEntry = it->second.get();
@@ -91,7 +138,7 @@ bool CPDF_PageRenderCache::StartGetCachedBitmap(
         m_pPage->GetDocument(), std::move(pImage));
   }
   CPDF_DIB::LoadState ret = m_pCurImageCacheEntry->StartGetCachedBitmap(
-      m_pPage->GetPageResources(), pRenderStatus, bStdCS);
+      m_pPage->GetPageResources(), pRenderStatus, bStdCS, decode_hint);
   if (ret == CPDF_DIB::LoadState::kContinue)
     return true;
 
@@ -164,11 +211,46 @@ RetainPtr<CFX_DIBBase> CPDF_PageRenderCache::ImageCacheEntry::DetachMask() {
   return std::move(m_pCurMask);
 }
 
+bool CPDF_PageRenderCache::ImageCacheEntry::IsCacheValid(
+    const CPDF_DIB::DecodeHint& hint) const {
+  if (!HasResolutionFor(hint))
+    return false;
+
+  if (m_bCachedCropped) {
+    if (hint.visible_area.IsEmpty() ||
+        !m_CachedHint.visible_area.Contains(hint.visible_area)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void CPDF_PageRenderCache::ImageCacheEntry::ExtendVisibleArea(
+    CPDF_DIB::DecodeHint* hint) const {
+  if (!m_bCachedCropped || hint->visible_area.IsEmpty() ||
+      !HasResolutionFor(*hint)) {
+    return;
+  }
+  hint->visible_area.Union(m_CachedHint.visible_area);
+}
+
+bool CPDF_PageRenderCache::ImageCacheEntry::HasResolutionFor(
+    const CPDF_DIB::DecodeHint& hint) const {
+  if (!m_bCachedDownscaled)
+    return true;
+
+  const CFX_Size& cached_size = m_CachedHint.max_size;
+  return hint.max_size.width > 0 && hint.max_size.height > 0 &&
+         hint.max_size.width <= cached_size.width &&
+         hint.max_size.height <= cached_size.height;
+}
+
 CPDF_DIB::LoadState CPDF_PageRenderCache::ImageCacheEntry::StartGetCachedBitmap(
     const CPDF_Dictionary* pPageResources,
     const CPDF_RenderStatus* pRenderStatus,
-    bool bStdCS) {
-  if (m_pCachedBitmap) {
+    bool bStdCS,
+    const CPDF_DIB::DecodeHint& hint) {
+  if (m_pCachedBitmap && IsCacheValid(hint)) {
     m_pCurBitmap = m_pCachedBitmap;
     m_pCurMask = m_pCachedMask;
     return CPDF_DIB::LoadState::kSuccess;
@@ -178,10 +260,35 @@ CPDF_DIB::LoadState CPDF_PageRenderCache::ImageCacheEntry::StartGetCachedBitmap(
   if (m_pDocument != m_pImage->GetDocument())
     return CPDF_DIB::LoadState::kFail;
 
+  m_CurHint = hint;
+  m_DocCacheKey.stream = m_pImage->GetStream();
+  m_DocCacheKey.std_cs = bStdCS;
+  m_DocCacheKey.group_family = pRenderStatus->GetGroupFamily();
+  m_DocCacheKey.load_mask = pRenderStatus->GetLoadMask();
+  // Only a named color space is looked up in the resources, and those may
+  // differ from page to page.
+  const CPDF_Dictionary* pDict = m_pImage->GetDict();
+  const CPDF_Object* pCSObj =
+      pDict ? pDict->GetDirectObjectFor("ColorSpace") : nullptr;
+  if (pCSObj && pCSObj->IsName()) {
+    m_DocCacheKey.form_color_spaces =
+        GetColorSpaceResources(pRenderStatus->GetFormResource());
+    m_DocCacheKey.page_color_spaces = GetColorSpaceResources(pPageResources);
+  }
+  CPDF_DocImageCache* pDocCache = GetDocImageCache();
+  if (pDocCache) {
+    absl::optional<CPDF_DocImageCache::Image> image =
+        pDocCache->Lookup(m_DocCacheKey, hint.max_size);
+    if (image.has_value()) {
+      UseDocCacheImage(image.value(), pRenderStatus);
+      return CPDF_DIB::LoadState::kFail;
+    }
+  }
+
   m_pCurBitmap = m_pImage->CreateNewDIB();
   CPDF_DIB::LoadState ret = m_pCurBitmap.As<CPDF_DIB>()->StartLoadDIBBase(
       true, pRenderStatus->GetFormResource(), pPageResources, bStdCS,
-      pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask());
+      pRenderStatus->GetGroupFamily(), pRenderStatus->GetLoadMask(), hint);
   if (ret == CPDF_DIB::LoadState::kContinue)
     return CPDF_DIB::LoadState::kContinue;
 
@@ -211,10 +318,28 @@ void CPDF_PageRenderCache::ImageCacheEntry::ContinueGetCachedBitmap(
     const CPDF_RenderStatus* pRenderStatus) {
   m_MatteColor = m_pCurBitmap.As<CPDF_DIB>()->GetMatteColor();
   m_pCurMask = m_pCurBitmap.As<CPDF_DIB>()->DetachMask();
+  m_bCachedDownscaled =
+      m_pCurBitmap.As<CPDF_DIB>()->IsDownscaled() ||
+      (m_pCurMask && m_pCurMask.As<CPDF_DIB>()->IsDownscaled());
+  m_bCachedCropped = m_pCurBitmap.As<CPDF_DIB>()->IsCropped() ||
+                     (m_pCurMask && m_pCurMask.As<CPDF_DIB>()->IsCropped());
+  m_CachedHint = m_CurHint;
+  if (m_bCachedDownscaled) {
+    // Record the size actually decoded to rather than the size asked for.
+    // Every request up to that size picks the same or a lower resolution
+    // level, so the decode serves all of them.
+    CFX_Size decoded_size(std::numeric_limits<int>::max(),
+                          std::numeric_limits<int>::max());
+    FitDownscaledSize(m_pCurBitmap.As<CPDF_DIB>().Get(), &decoded_size);
+    FitDownscaledSize(m_pCurMask.As<CPDF_DIB>().Get(), &decoded_size);
+    m_CachedHint.max_size = decoded_size;
+  }
   CPDF_RenderContext* pContext = pRenderStatus->GetContext();
   CPDF_PageRenderCache* pPageRenderCache = pContext->GetPageCache();
   m_dwTimeCount = pPageRenderCache->GetTimeCount();
-  if (m_pCurBitmap->GetPitch() * m_pCurBitmap->GetHeight() < kHugeImageSize) {
+  const bool bRealize =
+      m_pCurBitmap->GetPitch() * m_pCurBitmap->GetHeight() < kHugeImageSize;
+  if (bRealize) {
     m_pCachedBitmap = m_pCurBitmap->Realize();
     m_pCurBitmap.Reset();
   } else {
@@ -227,6 +352,45 @@ void CPDF_PageRenderCache::ImageCacheEntry::ContinueGetCachedBitmap(
   m_pCurBitmap = m_pCachedBitmap;
   m_pCurMask = m_pCachedMask;
   CalcSize();
+
+  // Share the decode with the document's other pages, unless it still reads
+  // from the stream as it goes, or only covers this page's view of the image.
+  CPDF_DocImageCache* pDocCache = GetDocImageCache();
+  if (!pDocCache || !m_pCachedBitmap || !bRealize || m_bCachedCropped)
+    return;
+
+  CPDF_DocImageCache::Image image;
+  image.bitmap = m_pCachedBitmap;
+  image.mask = m_pCachedMask;
+  image.matte_color = m_MatteColor;
+  if (m_bCachedDownscaled)
+    image.max_size = m_CachedHint.max_size;
+  pDocCache->Put(m_DocCacheKey, image);
+}
+
+void CPDF_PageRenderCache::ImageCacheEntry::UseDocCacheImage(
+    const CPDF_DocImageCache::Image& image,
+    const CPDF_RenderStatus* pRenderStatus) {
+  m_MatteColor = image.matte_color;
+  m_bCachedDownscaled = image.max_size.width > 0 && image.max_size.height > 0;
+  m_bCachedCropped = false;
+  m_CachedHint = CPDF_DIB::DecodeHint();
+  if (m_bCachedDownscaled)
+    m_CachedHint.max_size = image.max_size;
+  m_dwTimeCount = pRenderStatus->GetContext()->GetPageCache()->GetTimeCount();
+  m_pCachedBitmap = image.bitmap;
+  m_pCachedMask = image.mask;
+  m_pCurBitmap = m_pCachedBitmap;
+  m_pCurMask = m_pCachedMask;
+  CalcSize();
+}
+
+CPDF_DocImageCache*
+CPDF_PageRenderCache::ImageCacheEntry::GetDocImageCache() const {
+  auto* pRenderData = CPDF_DocRenderData::FromDocument(m_pDocument.Get());
+  if (!pRenderData || !pRenderData->GetImageCache()->IsEnabled())
+    return nullptr;
+  return pRenderData->GetImageCache();
 }
 
 void CPDF_PageRenderCache::ImageCacheEntry::CalcSize() {
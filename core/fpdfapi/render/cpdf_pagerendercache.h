@@ -14,6 +14,7 @@
 
 #include "core/fpdfapi/page/cpdf_dib.h"
 #include "core/fpdfapi/page/cpdf_page.h"
+#include "core/fpdfapi/render/cpdf_docimagecache.h"
 #include "core/fxcrt/maybe_owned.h"
 #include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
@@ -40,7 +41,8 @@ class CPDF_PageRenderCache final : public CPDF_Page::RenderCacheIface {
 
   bool StartGetCachedBitmap(RetainPtr<CPDF_Image> pImage,
                             const CPDF_RenderStatus* pRenderStatus,
-                            bool bStdCS);
+                            bool bStdCS,
+                            const CPDF_DIB::DecodeHint& hint);
 
   bool Continue(PauseIndicatorIface* pPause, CPDF_RenderStatus* pRenderStatus);
 
@@ -61,10 +63,18 @@ class CPDF_PageRenderCache final : public CPDF_Page::RenderCacheIface {
     void SetTimeCount(uint32_t count) { m_dwTimeCount = count; }
     CPDF_Image* GetImage() const { return m_pImage.Get(); }
 
+    // Whether the cached bitmap, if any, covers everything `hint` asks for.
+    bool IsCacheValid(const CPDF_DIB::DecodeHint& hint) const;
+
+    // Adds the area decoded for this entry to `hint`'s visible area, if this
+    // entry has enough resolution for `hint` and only lacks some of the area.
+    void ExtendVisibleArea(CPDF_DIB::DecodeHint* hint) const;
+
     CPDF_DIB::LoadState StartGetCachedBitmap(
         const CPDF_Dictionary* pPageResources,
         const CPDF_RenderStatus* pRenderStatus,
-        bool bStdCS);
+        bool bStdCS,
+        const CPDF_DIB::DecodeHint& hint);
 
     // Returns whether to Continue() or not.
     bool Continue(PauseIndicatorIface* pPause,
@@ -74,12 +84,25 @@ class CPDF_PageRenderCache final : public CPDF_Page::RenderCacheIface {
     RetainPtr<CFX_DIBBase> DetachMask();
 
    private:
+    bool HasResolutionFor(const CPDF_DIB::DecodeHint& hint) const;
     void ContinueGetCachedBitmap(const CPDF_RenderStatus* pRenderStatus);
+    void UseDocCacheImage(const CPDF_DocImageCache::Image& image,
+                          const CPDF_RenderStatus* pRenderStatus);
+    CPDF_DocImageCache* GetDocImageCache() const;
     void CalcSize();
 
     uint32_t m_dwTimeCount = 0;
     uint32_t m_MatteColor = 0;
     uint32_t m_dwCacheSize = 0;
+    // Set when the cached images were decoded at reduced resolution, or only
+    // in part. They then only satisfy requests that `m_CachedHint` covers.
+    // Its size is the size decoded to, so it stands for a resolution level,
+    // and its area is a superset of the areas asked for.
+    bool m_bCachedDownscaled = false;
+    bool m_bCachedCropped = false;
+    CPDF_DIB::DecodeHint m_CachedHint;
+    CPDF_DIB::DecodeHint m_CurHint;
+    CPDF_DocImageCache::Key m_DocCacheKey;
     UnownedPtr<CPDF_Document> const m_pDocument;
     RetainPtr<CPDF_Image> const m_pImage;
     RetainPtr<CFX_DIBBase> m_pCurBitmap;
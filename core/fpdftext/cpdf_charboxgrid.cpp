@@ -0,0 +1,165 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_charboxgrid.h"
+
+#include <math.h>
+
+#include <algorithm>
+
+#include "third_party/base/numerics/safe_conversions.h"
+
+namespace {
+
+// Aim for about this many boxes per cell on a page of evenly spread text.
+constexpr float kBoxesPerCell = 2.0f;
+constexpr size_t kMaxCellsPerSide = 256;
+
+// Boxes spanning more cells than this are kept out of the grid.
+constexpr size_t kMaxCellsPerBox = 64;
+
+bool IsFiniteRect(const CFX_FloatRect& rect) {
+  return isfinite(rect.left) && isfinite(rect.right) && isfinite(rect.bottom) &&
+         isfinite(rect.top);
+}
+
+size_t CellCountForSide(float count) {
+  if (!(count >= 1.0f))
+    return 1;
+  return std::min(static_cast<size_t>(count + 0.5f), kMaxCellsPerSide);
+}
+
+}  // namespace
+
+CPDF_CharBoxGrid::CPDF_CharBoxGrid(const std::vector<CFX_FloatRect>& boxes) {
+  std::vector<CFX_FloatRect> normalized;
+  normalized.reserve(boxes.size());
+  bool has_bounds = false;
+  for (const CFX_FloatRect& box : boxes) {
+    CFX_FloatRect rect = box;
+    rect.Normalize();
+    normalized.push_back(rect);
+    if (!IsFiniteRect(rect))
+      continue;
+    if (has_bounds) {
+      m_Bounds.Union(rect);
+    } else {
+      m_Bounds = rect;
+      has_bounds = true;
+    }
+  }
+
+  if (has_bounds) {
+    const float width = m_Bounds.Width();
+    const float height = m_Bounds.Height();
+    const float cells = normalized.size() / kBoxesPerCell;
+    if (width > 0 && height > 0) {
+      m_nCols = CellCountForSide(sqrtf(cells * width / height));
+      m_nRows = CellCountForSide(sqrtf(cells * height / width));
+    } else {
+      m_nCols = width > 0 ? CellCountForSide(cells) : 1;
+      m_nRows = height > 0 ? CellCountForSide(cells) : 1;
+    }
+    m_CellWidth = width / m_nCols;
+    m_CellHeight = height / m_nRows;
+  }
+
+  // First pass counts the entries for each cell, second pass fills them in.
+  const size_t cell_count = m_nCols * m_nRows;
+  m_CellStarts.resize(cell_count + 1);
+  std::vector<bool> bucketed(normalized.size());
+  for (size_t i = 0; i < normalized.size(); ++i) {
+    const CFX_FloatRect& rect = normalized[i];
+    if (!has_bounds || !IsFiniteRect(rect)) {
+      m_Unbucketed.push_back(pdfium::base::checked_cast<uint32_t>(i));
+      continue;
+    }
+    CellRange range = GetCellRange(rect);
+    size_t spanned = (range.last_col - range.first_col + 1) *
+                     (range.last_row - range.first_row + 1);
+    if (spanned > kMaxCellsPerBox) {
+      m_Unbucketed.push_back(pdfium::base::checked_cast<uint32_t>(i));
+      continue;
+    }
+    bucketed[i] = true;
+    for (size_t row = range.first_row; row <= range.last_row; ++row) {
+      for (size_t col = range.first_col; col <= range.last_col; ++col)
+        ++m_CellStarts[row * m_nCols + col + 1];
+    }
+  }
+  for (size_t i = 1; i < m_CellStarts.size(); ++i)
+    m_CellStarts[i] += m_CellStarts[i - 1];
+
+  m_CellItems.resize(m_CellStarts.back());
+  DataVector<uint32_t> cursors(m_CellStarts.begin(), m_CellStarts.end() - 1);
+  for (size_t i = 0; i < normalized.size(); ++i) {
+    if (!bucketed[i])
+      continue;
+    CellRange range = GetCellRange(normalized[i]);
+    for (size_t row = range.first_row; row <= range.last_row; ++row) {
+      for (size_t col = range.first_col; col <= range.last_col; ++col) {
+        m_CellItems[cursors[row * m_nCols + col]++] =
+            pdfium::base::checked_cast<uint32_t>(i);
+      }
+    }
+  }
+}
+
+CPDF_CharBoxGrid::~CPDF_CharBoxGrid() = default;
+
+std::vector<uint32_t> CPDF_CharBoxGrid::GetCandidates(
+    const CFX_FloatRect& area) const {
+  std::vector<uint32_t> result = m_Unbucketed;
+  CFX_FloatRect rect = area;
+  rect.Normalize();
+  // Written so NaNs fail the check.
+  const bool overlaps_grid =
+      m_nCols > 0 && rect.right >= m_Bounds.left &&
+      rect.left <= m_Bounds.right && rect.top >= m_Bounds.bottom &&
+      rect.bottom <= m_Bounds.top;
+  if (!overlaps_grid)
+    return result;
+
+  CellRange range = GetCellRange(rect);
+  for (size_t row = range.first_row; row <= range.last_row; ++row) {
+    for (size_t col = range.first_col; col <= range.last_col; ++col) {
+      const size_t cell = row * m_nCols + col;
+      result.insert(result.end(), m_CellItems.begin() + m_CellStarts[cell],
+                    m_CellItems.begin() + m_CellStarts[cell + 1]);
+    }
+  }
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+CPDF_CharBoxGrid::CellRange CPDF_CharBoxGrid::GetCellRange(
+    const CFX_FloatRect& rect) const {
+  return {ColumnAt(rect.left), ColumnAt(rect.right), RowAt(rect.bottom),
+          RowAt(rect.top)};
+}
+
+size_t CPDF_CharBoxGrid::ColumnAt(float x) const {
+  if (!(m_CellWidth > 0))
+    return 0;
+
+  float col = (x - m_Bounds.left) / m_CellWidth;
+  if (!(col > 0))
+    return 0;
+  if (col >= m_nCols)
+    return m_nCols - 1;
+  return static_cast<size_t>(col);
+}
+
+size_t CPDF_CharBoxGrid::RowAt(float y) const {
+  if (!(m_CellHeight > 0))
+    return 0;
+
+  float row = (y - m_Bounds.bottom) / m_CellHeight;
+  if (!(row > 0))
+    return 0;
+  if (row >= m_nRows)
+    return m_nRows - 1;
+  return static_cast<size_t>(row);
+}
@@ -0,0 +1,57 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFTEXT_CPDF_CHARBOXGRID_H_
+#define CORE_FPDFTEXT_CPDF_CHARBOXGRID_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/fx_coordinates.h"
+
+// Buckets character boxes into a uniform grid, so the boxes around a point or
+// overlapping an area can be found without visiting every box on the page.
+class CPDF_CharBoxGrid {
+ public:
+  // `boxes` are identified by their index. They need not be normalized.
+  explicit CPDF_CharBoxGrid(const std::vector<CFX_FloatRect>& boxes);
+  ~CPDF_CharBoxGrid();
+
+  // Returns the indices of the boxes that may share a point with `area`, in
+  // ascending order. Callers still need to check each candidate's box.
+  std::vector<uint32_t> GetCandidates(const CFX_FloatRect& area) const;
+
+  size_t GetColumnCountForTesting() const { return m_nCols; }
+  size_t GetRowCountForTesting() const { return m_nRows; }
+
+ private:
+  struct CellRange {
+    size_t first_col;
+    size_t last_col;
+    size_t first_row;
+    size_t last_row;
+  };
+
+  CellRange GetCellRange(const CFX_FloatRect& rect) const;
+  size_t ColumnAt(float x) const;
+  size_t RowAt(float y) const;
+
+  CFX_FloatRect m_Bounds;
+  size_t m_nCols = 0;
+  size_t m_nRows = 0;
+  float m_CellWidth = 0;
+  float m_CellHeight = 0;
+
+  // Cell `i` holds `m_CellItems[m_CellStarts[i]..m_CellStarts[i + 1])`.
+  DataVector<uint32_t> m_CellStarts;
+  DataVector<uint32_t> m_CellItems;
+
+  // Boxes too large or too odd to bucket. Always candidates.
+  std::vector<uint32_t> m_Unbucketed;
+};
+
+#endif  // CORE_FPDFTEXT_CPDF_CHARBOXGRID_H_
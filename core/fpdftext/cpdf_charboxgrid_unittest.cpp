@@ -0,0 +1,92 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_charboxgrid.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::Contains;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Not;
+
+TEST(CPDF_CharBoxGrid, Empty) {
+  CPDF_CharBoxGrid grid({});
+  EXPECT_THAT(grid.GetCandidates(CFX_FloatRect(0, 0, 100, 100)), IsEmpty());
+}
+
+TEST(CPDF_CharBoxGrid, FindsOverlappingBoxes) {
+  // A 10x10 page of 10x10 boxes, with index = row * 10 + col.
+  std::vector<CFX_FloatRect> boxes;
+  for (int row = 0; row < 10; ++row) {
+    for (int col = 0; col < 10; ++col)
+      boxes.emplace_back(col * 10 + 1, row * 10 + 1, col * 10 + 9,
+                         row * 10 + 9);
+  }
+  CPDF_CharBoxGrid grid(boxes);
+  EXPECT_GT(grid.GetColumnCountForTesting(), 1u);
+  EXPECT_GT(grid.GetRowCountForTesting(), 1u);
+
+  // Every box overlapping the query must be a candidate, and there should be
+  // far fewer candidates than boxes.
+  std::vector<uint32_t> candidates =
+      grid.GetCandidates(CFX_FloatRect(45, 45, 45, 45));
+  EXPECT_THAT(candidates, Contains(44u));
+  EXPECT_LT(candidates.size(), 20u);
+  EXPECT_TRUE(std::is_sorted(candidates.begin(), candidates.end()));
+
+  candidates = grid.GetCandidates(CFX_FloatRect(12, 12, 28, 18));
+  EXPECT_THAT(candidates, ::testing::IsSupersetOf({11u, 12u}));
+
+  // Outside of all boxes.
+  EXPECT_THAT(grid.GetCandidates(CFX_FloatRect(200, 200, 300, 300)),
+              IsEmpty());
+}
+
+TEST(CPDF_CharBoxGrid, UnnormalizedBoxes) {
+  std::vector<CFX_FloatRect> boxes = {CFX_FloatRect(10, 10, 0, 0),
+                                      CFX_FloatRect(90, 90, 100, 100)};
+  // Enough boxes in the middle to split the page into several cells.
+  for (int i = 0; i < 48; ++i)
+    boxes.emplace_back(50, 50, 51, 51);
+  CPDF_CharBoxGrid grid(boxes);
+  ASSERT_GT(grid.GetColumnCountForTesting(), 2u);
+  ASSERT_GT(grid.GetRowCountForTesting(), 2u);
+
+  std::vector<uint32_t> candidates =
+      grid.GetCandidates(CFX_FloatRect(5, 5, 5, 5));
+  EXPECT_THAT(candidates, Contains(0u));
+  EXPECT_THAT(candidates, Not(Contains(1u)));
+  candidates = grid.GetCandidates(CFX_FloatRect(95, 95, 95, 95));
+  EXPECT_THAT(candidates, Contains(1u));
+  EXPECT_THAT(candidates, Not(Contains(0u)));
+}
+
+TEST(CPDF_CharBoxGrid, OddBoxesAlwaysCandidates) {
+  constexpr float kNan = std::numeric_limits<float>::quiet_NaN();
+  std::vector<CFX_FloatRect> boxes;
+  for (int i = 0; i < 400; ++i) {
+    float x = (i % 20) * 5;
+    float y = (i / 20) * 5;
+    boxes.emplace_back(x, y, x + 1, y + 1);
+  }
+  boxes.emplace_back(kNan, 0, 1, 1);
+  boxes.emplace_back(-1, -1, 101, 101);
+  CPDF_CharBoxGrid grid(boxes);
+
+  std::vector<uint32_t> candidates =
+      grid.GetCandidates(CFX_FloatRect(0.5f, 0.5f, 0.5f, 0.5f));
+  EXPECT_THAT(candidates, Contains(0u));
+  EXPECT_THAT(candidates, Contains(400u));
+  EXPECT_THAT(candidates, Contains(401u));
+
+  // NaN queries cannot hit the grid.
+  EXPECT_THAT(grid.GetCandidates(CFX_FloatRect(kNan, kNan, kNan, kNan)),
+              ElementsAre(400u, 401u));
+}
@@ -0,0 +1,131 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_multipatternmatcher.h"
+
+#include <algorithm>
+#include <map>
+#include <queue>
+#include <utility>
+
+#include "third_party/base/numerics/safe_conversions.h"
+
+CPDF_MultiPatternMatcher::CPDF_MultiPatternMatcher(
+    const std::vector<WideString>& patterns)
+    : m_PatternLengths(patterns.size()),
+      m_NextPattern(patterns.size(), kNone) {
+  // Build the trie with maps first. Maps keep each node's children sorted,
+  // so they can be flattened into the sorted edge arrays afterwards.
+  std::vector<std::map<wchar_t, uint32_t>> children(1);
+  std::vector<uint32_t> last_pattern(1, kNone);
+  m_Nodes.resize(1);
+  for (size_t i = 0; i < patterns.size(); ++i) {
+    const WideString& pattern = patterns[i];
+    m_PatternLengths[i] = pattern.GetLength();
+    if (pattern.IsEmpty())
+      continue;
+
+    uint32_t node = 0;
+    for (wchar_t ch : pattern) {
+      auto it = children[node].find(ch);
+      if (it != children[node].end()) {
+        node = it->second;
+        continue;
+      }
+      uint32_t child = pdfium::base::checked_cast<uint32_t>(m_Nodes.size());
+      children[node][ch] = child;
+      children.emplace_back();
+      last_pattern.push_back(kNone);
+      m_Nodes.emplace_back();
+      node = child;
+    }
+    const uint32_t index = pdfium::base::checked_cast<uint32_t>(i);
+    if (m_Nodes[node].pattern == kNone)
+      m_Nodes[node].pattern = index;
+    else
+      m_NextPattern[last_pattern[node]] = index;
+    last_pattern[node] = index;
+  }
+
+  for (size_t node = 0; node < m_Nodes.size(); ++node) {
+    m_Nodes[node].first_edge =
+        pdfium::base::checked_cast<uint32_t>(m_EdgeChars.size());
+    m_Nodes[node].edge_count =
+        pdfium::base::checked_cast<uint32_t>(children[node].size());
+    for (const auto& edge : children[node]) {
+      m_EdgeChars.push_back(edge.first);
+      m_EdgeTargets.push_back(edge.second);
+    }
+  }
+
+  // Failure links, breadth first so parents are done before their children.
+  std::queue<uint32_t> pending;
+  for (uint32_t e = 0; e < m_Nodes[0].edge_count; ++e)
+    pending.push(m_EdgeTargets[e]);
+  while (!pending.empty()) {
+    const uint32_t node = pending.front();
+    pending.pop();
+    const Node& current = m_Nodes[node];
+    for (uint32_t e = current.first_edge;
+         e < current.first_edge + current.edge_count; ++e) {
+      const uint32_t child = m_EdgeTargets[e];
+      const uint32_t fail = Step(current.fail, m_EdgeChars[e]);
+      m_Nodes[child].fail = fail;
+      m_Nodes[child].output_link =
+          m_Nodes[fail].pattern != kNone ? fail : m_Nodes[fail].output_link;
+      pending.push(child);
+    }
+  }
+}
+
+CPDF_MultiPatternMatcher::~CPDF_MultiPatternMatcher() = default;
+
+std::vector<CPDF_MultiPatternMatcher::Match> CPDF_MultiPatternMatcher::FindAll(
+    WideStringView text) const {
+  std::vector<Match> matches;
+  uint32_t node = 0;
+  for (size_t i = 0; i < text.GetLength(); ++i) {
+    node = Step(node, text[i]);
+    AddMatches(node, i, &matches);
+  }
+  return matches;
+}
+
+uint32_t CPDF_MultiPatternMatcher::Child(uint32_t node, wchar_t ch) const {
+  const Node& current = m_Nodes[node];
+  auto begin = m_EdgeChars.begin() + current.first_edge;
+  auto end = begin + current.edge_count;
+  auto it = std::lower_bound(begin, end, ch);
+  if (it == end || *it != ch)
+    return kNone;
+  return m_EdgeTargets[it - m_EdgeChars.begin()];
+}
+
+uint32_t CPDF_MultiPatternMatcher::Step(uint32_t node, wchar_t ch) const {
+  while (true) {
+    uint32_t child = Child(node, ch);
+    if (child != kNone)
+      return child;
+    if (node == 0)
+      return 0;
+    node = m_Nodes[node].fail;
+  }
+}
+
+void CPDF_MultiPatternMatcher::AddMatches(uint32_t node,
+                                          size_t end,
+                                          std::vector<Match>* matches) const {
+  const size_t first = matches->size();
+  for (uint32_t out = m_Nodes[node].pattern != kNone
+                          ? node
+                          : m_Nodes[node].output_link;
+       out != kNone; out = m_Nodes[out].output_link) {
+    for (uint32_t pattern = m_Nodes[out].pattern; pattern != kNone;
+         pattern = m_NextPattern[pattern]) {
+      matches->push_back({pattern, end + 1 - m_PatternLengths[pattern], end});
+    }
+  }
+  std::sort(matches->begin() + first, matches->end(),
+            [](const Match& a, const Match& b) { return a.pattern < b.pattern; });
+}
@@ -0,0 +1,62 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FPDFTEXT_CPDF_MULTIPATTERNMATCHER_H_
+#define CORE_FPDFTEXT_CPDF_MULTIPATTERNMATCHER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/widestring.h"
+
+// Aho-Corasick automaton. Finds every occurrence of every pattern in a single
+// pass over the text.
+class CPDF_MultiPatternMatcher {
+ public:
+  struct Match {
+    size_t pattern;
+    size_t start;  // Index of the first matched character.
+    size_t end;    // Index of the last matched character.
+  };
+
+  // Empty patterns never match. Duplicate patterns each report their matches.
+  explicit CPDF_MultiPatternMatcher(const std::vector<WideString>& patterns);
+  ~CPDF_MultiPatternMatcher();
+
+  // Returns all matches, ordered by `end` and then by `pattern`.
+  std::vector<Match> FindAll(WideStringView text) const;
+
+  size_t pattern_count() const { return m_PatternLengths.size(); }
+
+ private:
+  static constexpr uint32_t kNone = 0xffffffff;
+
+  struct Node {
+    uint32_t first_edge = 0;
+    uint32_t edge_count = 0;
+    uint32_t fail = 0;
+    // Nearest node on the failure chain, excluding this one, that ends a
+    // pattern.
+    uint32_t output_link = kNone;
+    // First pattern ending at this node. More are in `m_NextPattern`.
+    uint32_t pattern = kNone;
+  };
+
+  uint32_t Child(uint32_t node, wchar_t ch) const;
+  uint32_t Step(uint32_t node, wchar_t ch) const;
+  void AddMatches(uint32_t node, size_t end, std::vector<Match>* matches) const;
+
+  std::vector<Node> m_Nodes;
+  // Edges of node `n` are `m_EdgeChars/m_EdgeTargets[first_edge, +count)`,
+  // sorted by character.
+  DataVector<wchar_t> m_EdgeChars;
+  DataVector<uint32_t> m_EdgeTargets;
+  DataVector<size_t> m_PatternLengths;
+  DataVector<uint32_t> m_NextPattern;
+};
+
+#endif  // CORE_FPDFTEXT_CPDF_MULTIPATTERNMATCHER_H_
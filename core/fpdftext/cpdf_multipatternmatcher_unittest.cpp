@@ -0,0 +1,72 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fpdftext/cpdf_multipatternmatcher.h"
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+void ExpectMatch(const CPDF_MultiPatternMatcher::Match& match,
+                 size_t pattern,
+                 size_t start,
+                 size_t end) {
+  EXPECT_EQ(pattern, match.pattern);
+  EXPECT_EQ(start, match.start);
+  EXPECT_EQ(end, match.end);
+}
+
+}  // namespace
+
+TEST(CPDF_MultiPatternMatcher, NoPatterns) {
+  CPDF_MultiPatternMatcher matcher({});
+  EXPECT_EQ(0u, matcher.pattern_count());
+  EXPECT_TRUE(matcher.FindAll(L"anything").empty());
+}
+
+TEST(CPDF_MultiPatternMatcher, EmptyPatternNeverMatches) {
+  CPDF_MultiPatternMatcher matcher({L"", L"a"});
+  EXPECT_EQ(2u, matcher.pattern_count());
+  std::vector<CPDF_MultiPatternMatcher::Match> matches = matcher.FindAll(L"aa");
+  ASSERT_EQ(2u, matches.size());
+  ExpectMatch(matches[0], 1, 0, 0);
+  ExpectMatch(matches[1], 1, 1, 1);
+}
+
+TEST(CPDF_MultiPatternMatcher, Classic) {
+  // The textbook example, with overlapping and nested patterns.
+  CPDF_MultiPatternMatcher matcher({L"he", L"she", L"his", L"hers"});
+  std::vector<CPDF_MultiPatternMatcher::Match> matches =
+      matcher.FindAll(L"ushers");
+  ASSERT_EQ(3u, matches.size());
+  ExpectMatch(matches[0], 0, 2, 3);
+  ExpectMatch(matches[1], 1, 1, 3);
+  ExpectMatch(matches[2], 3, 2, 5);
+}
+
+TEST(CPDF_MultiPatternMatcher, DuplicatesAndOverlaps) {
+  CPDF_MultiPatternMatcher matcher({L"aa", L"a", L"aa"});
+  std::vector<CPDF_MultiPatternMatcher::Match> matches =
+      matcher.FindAll(L"aaa");
+  ASSERT_EQ(7u, matches.size());
+  ExpectMatch(matches[0], 1, 0, 0);
+  ExpectMatch(matches[1], 0, 0, 1);
+  ExpectMatch(matches[2], 1, 1, 1);
+  ExpectMatch(matches[3], 2, 0, 1);
+  ExpectMatch(matches[4], 0, 1, 2);
+  ExpectMatch(matches[5], 1, 2, 2);
+  ExpectMatch(matches[6], 2, 1, 2);
+}
+
+TEST(CPDF_MultiPatternMatcher, NonAscii) {
+  CPDF_MultiPatternMatcher matcher({L"\u4e2d\u6587", L"\u6587"});
+  std::vector<CPDF_MultiPatternMatcher::Match> matches =
+      matcher.FindAll(L"x\u4e2d\u6587\u6587");
+  ASSERT_EQ(3u, matches.size());
+  ExpectMatch(matches[0], 0, 1, 2);
+  ExpectMatch(matches[1], 1, 2, 2);
+  ExpectMatch(matches[2], 1, 3, 3);
+}
@@ -22,6 +22,7 @@
 #include "core/fpdfapi/page/cpdf_textobject.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
+#include "core/fpdftext/cpdf_charboxgrid.h"
 #include "core/fpdftext/unicodenormalizationdata.h"
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_bidi.h"
@@ -320,6 +321,23 @@ void CPDF_TextPage::Init() {
   }
   if (m_CharIndices.size() % 2)
     m_CharIndices.pop_back();
+
+  m_CharList.shrink_to_fit();
+  m_TempCharList = std::vector<CharInfo>();
+  BuildCharGrid();
+}
+
+void CPDF_TextPage::BuildCharGrid() {
+  std::vector<CFX_FloatRect> boxes;
+  boxes.reserve(m_CharList.size());
+  m_NonSpaceCounts.reserve(m_CharList.size() + 1);
+  m_NonSpaceCounts.push_back(0);
+  for (const CharInfo& charinfo : m_CharList) {
+    boxes.push_back(charinfo.m_CharBox);
+    m_NonSpaceCounts.push_back(m_NonSpaceCounts.back() +
+                               (charinfo.m_Unicode != L' ' ? 1 : 0));
+  }
+  m_pCharGrid = std::make_unique<CPDF_CharBoxGrid>(boxes);
 }
 
 int CPDF_TextPage::CountChars() const {
@@ -395,15 +413,19 @@ std::vector<CFX_FloatRect> CPDF_TextPage::GetRectArray(int start,
 
 int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
                                  const CFX_SizeF& tolerance) const {
-  int pos;
+  // Only chars whose boxes, extended by the tolerance, reach `point` matter.
+  const float half_width = std::max(tolerance.width / 2, 0.0f);
+  const float half_height = std::max(tolerance.height / 2, 0.0f);
+  const CFX_FloatRect area(point.x - half_width, point.y - half_height,
+                           point.x + half_width, point.y + half_height);
+
   int NearPos = -1;
   double xdif = 5000;
   double ydif = 5000;
-  const int nCount = CountChars();
-  for (pos = 0; pos < nCount; ++pos) {
+  for (uint32_t pos : m_pCharGrid->GetCandidates(area)) {
     const CFX_FloatRect& orig_charrect = m_CharList[pos].m_CharBox;
     if (orig_charrect.Contains(point))
-      break;
+      return pos;
 
     if (tolerance.width <= 0 && tolerance.height <= 0)
       continue;
@@ -427,7 +449,7 @@ int CPDF_TextPage::GetIndexAtPos(const CFX_PointF& point,
       NearPos = pos;
     }
   }
-  return pos < nCount ? pos : NearPos;
+  return NearPos;
 }
 
 WideString CPDF_TextPage::GetTextByPredicate(
@@ -463,9 +485,46 @@ WideString CPDF_TextPage::GetTextByPredicate(
 }
 
 WideString CPDF_TextPage::GetTextByRect(const CFX_FloatRect& rect) const {
-  return GetTextByPredicate([&rect](const CharInfo& charinfo) {
-    return IsRectIntersect(rect, charinfo.m_CharBox);
-  });
+  // Produces the same result as GetTextByPredicate() with an intersection
+  // test, but only visits the chars the grid finds near `rect`. The effect of
+  // each run of non-matching chars in between is worked out from its first
+  // char and from `m_NonSpaceCounts`.
+  float posy = 0;
+  bool IsContainPreChar = false;
+  bool IsAddLineFeed = false;
+  WideString strText;
+  size_t next = 0;
+  for (uint32_t pos : m_pCharGrid->GetCandidates(rect)) {
+    const CharInfo& charinfo = m_CharList[pos];
+    if (!IsRectIntersect(rect, charinfo.m_CharBox))
+      continue;
+
+    if (pos > next) {
+      size_t gap_start = next;
+      if (IsContainPreChar) {
+        if (m_CharList[gap_start].m_Unicode == L' ')
+          strText += L' ';
+        else
+          IsAddLineFeed = true;
+        IsContainPreChar = false;
+        ++gap_start;
+      }
+      if (m_NonSpaceCounts[pos] > m_NonSpaceCounts[gap_start])
+        IsAddLineFeed = true;
+    }
+    if (fabs(posy - charinfo.m_Origin.y) > 0 && !IsContainPreChar &&
+        IsAddLineFeed) {
+      posy = charinfo.m_Origin.y;
+      if (!strText.IsEmpty())
+        strText += L"\r\n";
+    }
+    IsContainPreChar = true;
+    IsAddLineFeed = false;
+    if (charinfo.m_Unicode)
+      strText += charinfo.m_Unicode;
+    next = pos + 1;
+  }
+  return strText;
 }
 
 WideString CPDF_TextPage::GetTextByObject(
@@ -489,6 +548,23 @@ CFX_FloatRect CPDF_TextPage::GetCharLooseBounds(size_t index) const {
   return GetLooseBounds(GetCharInfo(index));
 }
 
+int CPDF_TextPage::GetFontId(const CharInfo& charinfo) {
+  if (!charinfo.m_pTextObj)
+    return -1;
+
+  RetainPtr<const CPDF_Font> font = charinfo.m_pTextObj->GetFont();
+  if (!font)
+    return -1;
+
+  auto it = m_FontIds.find(font);
+  if (it != m_FontIds.end())
+    return it->second;
+
+  const int id = fxcrt::CollectionSize<int>(m_FontIds);
+  m_FontIds[std::move(font)] = id;
+  return id;
+}
+
 WideString CPDF_TextPage::GetPageText(int start, int count) const {
   if (start < 0 || start >= CountChars() || count <= 0 || m_CharList.empty() ||
       m_TextBuf.IsEmpty()) {
@@ -9,18 +9,23 @@
 
 #include <stdint.h>
 
-#include <deque>
 #include <functional>
+#include <map>
+#include <memory>
 #include <vector>
 
 #include "core/fpdfapi/page/cpdf_pageobjectholder.h"
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_coordinates.h"
+#include "core/fxcrt/retain_ptr.h"
 #include "core/fxcrt/unowned_ptr.h"
 #include "core/fxcrt/widestring.h"
 #include "core/fxcrt/widetext_buffer.h"
+#include "third_party/base/span.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
+class CPDF_CharBoxGrid;
+class CPDF_Font;
 class CPDF_FormObject;
 class CPDF_Page;
 class CPDF_TextObject;
@@ -64,6 +69,14 @@ class CPDF_TextPage {
   float GetCharFontSize(size_t index) const;
   CFX_FloatRect GetCharLooseBounds(size_t index) const;
 
+  // All characters on the page, in the same order as GetCharInfo().
+  pdfium::span<const CharInfo> GetCharInfos() const { return m_CharList; }
+
+  // Returns a small id for the font of `charinfo`, or -1 if it has none. Ids
+  // are handed out in order of first use and stay the same for the lifetime
+  // of this text page.
+  int GetFontId(const CharInfo& charinfo);
+
   std::vector<CFX_FloatRect> GetRectArray(int start, int count) const;
   int GetIndexAtPos(const CFX_PointF& point, const CFX_SizeF& tolerance) const;
   WideString GetTextByRect(const CFX_FloatRect& rect) const;
@@ -104,6 +117,7 @@ class CPDF_TextPage {
   };
 
   void Init();
+  void BuildCharGrid();
   bool IsHyphen(wchar_t curChar) const;
   void ProcessObject();
   void ProcessFormObject(CPDF_FormObject* pFormObj,
@@ -138,8 +152,8 @@ class CPDF_TextPage {
 
   UnownedPtr<const CPDF_Page> const m_pPage;
   DataVector<uint16_t> m_CharIndices;
-  std::deque<CharInfo> m_CharList;
-  std::deque<CharInfo> m_TempCharList;
+  std::vector<CharInfo> m_CharList;
+  std::vector<CharInfo> m_TempCharList;
   WideTextBuffer m_TextBuf;
   WideTextBuffer m_TempTextBuf;
   UnownedPtr<const CPDF_TextObject> m_pPrevTextObj;
@@ -148,6 +162,11 @@ class CPDF_TextPage {
   const CFX_Matrix m_DisplayMatrix;
   std::vector<CFX_FloatRect> m_SelRects;
   std::vector<TransformedTextObject> mTextObjects;
+  std::unique_ptr<CPDF_CharBoxGrid> m_pCharGrid;
+  std::map<RetainPtr<const CPDF_Font>, int> m_FontIds;
+
+  // Number of chars before each index in `m_CharList` that are not spaces.
+  DataVector<uint32_t> m_NonSpaceCounts;
   TextOrientation m_TextlineDir = TextOrientation::kUnknown;
   CFX_FloatRect m_CurlineRect;
 };
@@ -8,8 +8,10 @@
 
 #include <wchar.h>
 
+#include <algorithm>
 #include <vector>
 
+#include "core/fpdftext/cpdf_multipatternmatcher.h"
 #include "core/fpdftext/cpdf_textpage.h"
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/fx_string.h"
@@ -17,6 +19,7 @@
 #include "core/fxcrt/fx_unicode.h"
 #include "core/fxcrt/stl_util.h"
 #include "third_party/base/check.h"
+#include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/ptr_util.h"
 
 namespace {
@@ -169,6 +172,51 @@ std::vector<WideString> ExtractFindWhat(const WideString& findwhat) {
   return findwhat_array;
 }
 
+bool IsFindSpace(wchar_t ch) {
+  return ch == L'\n' || ch == L' ' || ch == L'\r' || ch == kNonBreakingSpace;
+}
+
+// Rewrites `text` so that FindNext()'s rules for spaces between words become
+// plain string equality. Each run of spaces turns into a single space, or is
+// dropped entirely at either end or next to a character that words may touch
+// without a space in between. If `positions` is given, it receives the index
+// in `text` of each character in the result.
+WideString NormalizeSpaces(WideStringView text,
+                           std::vector<size_t>* positions) {
+  WideString result;
+  const size_t len = text.GetLength();
+  if (positions) {
+    positions->clear();
+    positions->reserve(len);
+  }
+  {
+    pdfium::span<wchar_t> buffer = result.GetBuffer(len);
+    size_t out = 0;
+    size_t i = 0;
+    while (i < len) {
+      if (!IsFindSpace(text[i])) {
+        buffer[out++] = text[i];
+        if (positions)
+          positions->push_back(i);
+        ++i;
+        continue;
+      }
+      const size_t run_start = i;
+      while (i < len && IsFindSpace(text[i]))
+        ++i;
+      if (out == 0 || i == len || IsIgnoreSpaceCharacter(buffer[out - 1]) ||
+          IsIgnoreSpaceCharacter(text[i])) {
+        continue;
+      }
+      buffer[out++] = L' ';
+      if (positions)
+        positions->push_back(run_start);
+    }
+    result.ReleaseBuffer(out);
+  }
+  return result;
+}
+
 }  // namespace
 
 // static
@@ -342,3 +390,67 @@ int CPDF_TextPageFind::GetMatchedCount() const {
   int resEnd = GetCharIndex(m_resEnd);
   return resEnd - resStart + 1;
 }
+
+CPDF_TextPageMultiFind::CPDF_TextPageMultiFind(
+    const std::vector<WideString>& patterns,
+    const CPDF_TextPageFind::Options& options)
+    : m_options(options) {
+  std::vector<WideString> normalized;
+  normalized.reserve(patterns.size());
+  for (const WideString& pattern : patterns) {
+    normalized.push_back(NormalizeSpaces(
+        GetStringCase(pattern, options.bMatchCase).AsStringView(), nullptr));
+  }
+  m_pMatcher = std::make_unique<CPDF_MultiPatternMatcher>(normalized);
+}
+
+CPDF_TextPageMultiFind::~CPDF_TextPageMultiFind() = default;
+
+size_t CPDF_TextPageMultiFind::pattern_count() const {
+  return m_pMatcher->pattern_count();
+}
+
+std::vector<CPDF_TextPageMultiFind::Match> CPDF_TextPageMultiFind::FindAll(
+    const CPDF_TextPage* pTextPage) const {
+  std::vector<Match> results;
+  if (pattern_count() == 0)
+    return results;
+
+  const WideString text =
+      GetStringCase(pTextPage->GetAllPageText(), m_options.bMatchCase);
+  std::vector<size_t> positions;
+  const WideString normalized = NormalizeSpaces(text.AsStringView(), &positions);
+
+  std::vector<CPDF_MultiPatternMatcher::Match> matches =
+      m_pMatcher->FindAll(normalized.AsStringView());
+  std::sort(matches.begin(), matches.end(),
+            [](const CPDF_MultiPatternMatcher::Match& a,
+               const CPDF_MultiPatternMatcher::Match& b) {
+              if (a.start != b.start)
+                return a.start < b.start;
+              return a.pattern < b.pattern;
+            });
+
+  // Unless matches may overlap, each pattern resumes after its last match,
+  // like CPDF_TextPageFind::FindNext() does.
+  std::vector<absl::optional<size_t>> last_ends(pattern_count());
+  for (const CPDF_MultiPatternMatcher::Match& match : matches) {
+    const size_t start = positions[match.start];
+    const size_t end = positions[match.end];
+    absl::optional<size_t>& last_end = last_ends[match.pattern];
+    if (!m_options.bConsecutive && last_end.has_value() &&
+        start <= last_end.value()) {
+      continue;
+    }
+    if (m_options.bMatchWholeWord && !IsMatchWholeWord(text, start, end))
+      continue;
+
+    last_end = end;
+    const int char_index = pTextPage->CharIndexFromTextIndex(
+        pdfium::base::checked_cast<int>(start));
+    const int char_end = pTextPage->CharIndexFromTextIndex(
+        pdfium::base::checked_cast<int>(end));
+    results.push_back({match.pattern, char_index, char_end - char_index + 1});
+  }
+  return results;
+}
@@ -17,6 +17,7 @@
 #include "core/fxcrt/widestring.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
+class CPDF_MultiPatternMatcher;
 class CPDF_TextPage;
 
 class CPDF_TextPageFind {
@@ -61,4 +62,30 @@ class CPDF_TextPageFind {
   const Options m_options;
 };
 
+// Many search terms, prepared once so they can be searched for on any number
+// of pages, in a single pass over each page.
+class CPDF_TextPageMultiFind {
+ public:
+  struct Match {
+    size_t pattern;
+    int char_index;
+    int char_count;
+  };
+
+  CPDF_TextPageMultiFind(const std::vector<WideString>& patterns,
+                         const CPDF_TextPageFind::Options& options);
+  ~CPDF_TextPageMultiFind();
+
+  // Finds all matches of all terms on `pTextPage`. Spaces in a term and the
+  // options are handled the way CPDF_TextPageFind::FindNext() handles them.
+  // Results are ordered by position, then by pattern.
+  std::vector<Match> FindAll(const CPDF_TextPage* pTextPage) const;
+
+  size_t pattern_count() const;
+
+ private:
+  const CPDF_TextPageFind::Options m_options;
+  std::unique_ptr<CPDF_MultiPatternMatcher> m_pMatcher;
+};
+
 #endif  // CORE_FPDFTEXT_CPDF_TEXTPAGEFIND_H_
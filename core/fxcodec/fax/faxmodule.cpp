@@ -17,8 +17,10 @@
 #include "core/fxcrt/binary_buffer.h"
 #include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
+#include "core/fxcrt/fx_system.h"
 #include "core/fxcrt/stl_util.h"
 #include "core/fxge/calculate_pitch.h"
+#include "third_party/base/bits.h"
 #include "third_party/base/check.h"
 #include "third_party/base/check_op.h"
 #include "third_party/base/cxx17_backports.h"
@@ -48,6 +50,15 @@ constexpr int kFaxMaxImageDimension = 65535;
 constexpr int kFaxBpc = 1;
 constexpr int kFaxComps = 1;
 
+uint64_t GetUint64MSBFirst(const uint8_t* p) {
+  return (uint64_t{FXSYS_UINT32_GET_MSBFIRST(p)} << 32) |
+         FXSYS_UINT32_GET_MSBFIRST(p + 4);
+}
+
+int CountLeadingZeros(uint64_t value) {
+  return static_cast<int>(pdfium::base::bits::CountLeadingZeroBits64(value));
+}
+
 int FindBit(const uint8_t* data_buf, int max_pos, int start_pos, bool bit) {
   DCHECK(start_pos >= 0);
   if (start_pos >= max_pos)
@@ -67,18 +78,15 @@ int FindBit(const uint8_t* data_buf, int max_pos, int start_pos, bool bit) {
   const int max_byte = (max_pos + 7) / 8;
   int byte_pos = start_pos / 8;
 
-  // Try reading in bigger chunks in case there are long runs to be skipped.
-  static constexpr int kBulkReadSize = 8;
-  if (max_byte >= kBulkReadSize && byte_pos < max_byte - kBulkReadSize) {
-    static constexpr uint8_t skip_block_0[kBulkReadSize] = {
-        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-    static constexpr uint8_t skip_block_1[kBulkReadSize] = {
-        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff};
-    const uint8_t* skip_block = bit ? skip_block_0 : skip_block_1;
-    while (byte_pos < max_byte - kBulkReadSize &&
-           memcmp(data_buf + byte_pos, skip_block, kBulkReadSize) == 0) {
-      byte_pos += kBulkReadSize;
-    }
+  // Scan 64 bits at a time. The first bit that differs from the run is the
+  // first set bit after flipping, so counting leading zeros finds it.
+  const uint64_t word_xor = bit ? 0 : ~uint64_t{0};
+  while (byte_pos + 8 <= max_byte) {
+    uint64_t data = GetUint64MSBFirst(data_buf + byte_pos) ^ word_xor;
+    if (data)
+      return std::min(byte_pos * 8 + CountLeadingZeros(data), max_pos);
+
+    byte_pos += 8;
   }
 
   while (byte_pos < max_byte) {
@@ -91,27 +99,36 @@ int FindBit(const uint8_t* data_buf, int max_pos, int start_pos, bool bit) {
   return max_pos;
 }
 
-void FaxG4FindB1B2(pdfium::span<const uint8_t> ref_buf,
-                   int columns,
-                   int a0,
-                   bool a0color,
-                   int* b1,
-                   int* b2) {
-  bool first_bit = a0 < 0 || (ref_buf[a0 / 8] & (1 << (7 - a0 % 8))) != 0;
-  *b1 = FindBit(ref_buf.data(), columns, a0 + 1, !first_bit);
-  if (*b1 >= columns) {
-    *b1 = *b2 = columns;
-    return;
-  }
-  if (first_bit == !a0color) {
-    *b1 = FindBit(ref_buf.data(), columns, *b1 + 1, first_bit);
-    first_bit = !first_bit;
-  }
-  if (*b1 >= columns) {
-    *b1 = *b2 = columns;
-    return;
+// Returns the positions in [0, `columns`) where the color of `ref_buf`
+// differs from the color before it. The color before the row is white.
+void FindChangingElements(pdfium::span<const uint8_t> ref_buf,
+                          int columns,
+                          DataVector<int>* changes) {
+  changes->clear();
+  uint64_t prev_bit = 1;
+  for (int word_pos = 0; word_pos < columns; word_pos += 64) {
+    const size_t byte_pos = word_pos / 8;
+    uint64_t bits = 0;
+    if (byte_pos + 8 <= ref_buf.size()) {
+      bits = GetUint64MSBFirst(ref_buf.data() + byte_pos);
+    } else {
+      for (size_t i = 0; i < 8; ++i) {
+        bits <<= 8;
+        if (byte_pos + i < ref_buf.size())
+          bits |= ref_buf[byte_pos + i];
+      }
+    }
+    // A set bit marks a pixel that differs from the one before it.
+    uint64_t transitions = bits ^ ((bits >> 1) | (prev_bit << 63));
+    prev_bit = bits & 1;
+    while (transitions) {
+      const int offset = CountLeadingZeros(transitions);
+      if (word_pos + offset >= columns)
+        return;
+      changes->push_back(word_pos + offset);
+      transitions &= ~(uint64_t{1} << (63 - offset));
+    }
   }
-  *b2 = FindBit(ref_buf.data(), columns, *b1 + 1, first_bit);
 }
 
 void FaxFillBits(uint8_t* dest_buf, int columns, int startpos, int endpos) {
@@ -120,18 +137,18 @@ void FaxFillBits(uint8_t* dest_buf, int columns, int startpos, int endpos) {
   if (startpos >= endpos)
     return;
 
+  // Bits of the first and last bytes that are inside the run.
   int first_byte = startpos / 8;
   int last_byte = (endpos - 1) / 8;
+  uint8_t first_mask = 0xff >> (startpos % 8);
+  uint8_t last_mask = static_cast<uint8_t>(0xff << (7 - (endpos - 1) % 8));
   if (first_byte == last_byte) {
-    for (int i = startpos % 8; i <= (endpos - 1) % 8; ++i)
-      dest_buf[first_byte] -= 1 << (7 - i);
+    dest_buf[first_byte] &= ~(first_mask & last_mask);
     return;
   }
 
-  for (int i = startpos % 8; i < 8; ++i)
-    dest_buf[first_byte] -= 1 << (7 - i);
-  for (int i = 0; i <= (endpos - 1) % 8; ++i)
-    dest_buf[last_byte] -= 1 << (7 - i);
+  dest_buf[first_byte] &= ~first_mask;
+  dest_buf[last_byte] &= ~last_mask;
 
   if (last_byte > first_byte + 1)
     memset(dest_buf + first_byte + 1, 0, last_byte - first_byte - 1);
@@ -142,6 +159,28 @@ inline bool NextBit(const uint8_t* src_buf, int* bitpos) {
   return !!(src_buf[pos / 8] & (1 << (7 - pos % 8)));
 }
 
+// Returns the `count` bits at `bitpos` in the low bits of the result, with
+// zeros in place of any bits past `bitsize`. `count` is at most 25.
+uint32_t PeekBits(const uint8_t* src_buf, int bitsize, int bitpos, int count) {
+  DCHECK_GE(bitpos, 0);
+  DCHECK_LT(bitpos, bitsize);
+  DCHECK_LE(count, 25);
+  const int byte_pos = bitpos / 8;
+  const int byte_count = (bitsize + 7) / 8;
+  uint32_t window;
+  if (byte_pos + 4 <= byte_count) {
+    window = FXSYS_UINT32_GET_MSBFIRST(src_buf + byte_pos);
+  } else {
+    window = 0;
+    for (int i = 0; i < 4; ++i) {
+      window <<= 8;
+      if (byte_pos + i < byte_count)
+        window |= src_buf[byte_pos + i];
+    }
+  }
+  return (window << (bitpos % 8)) >> (32 - count);
+}
+
 const uint8_t FaxBlackRunIns[] = {
     0,          2,          0x02,       3,          0,          0x03,
     2,          0,          2,          0x02,       1,          0,
@@ -257,39 +296,116 @@ const uint8_t FaxWhiteRunIns[] = {
     0xff,
 };
 
-int FaxGetRun(const uint8_t* ins_array,
-              const uint8_t* src_buf,
-              int* bitpos,
-              int bitsize) {
-  uint32_t code = 0;
-  int ins_off = 0;
-  while (true) {
-    uint8_t ins = ins_array[ins_off++];
-    if (ins == 0xff)
-      return -1;
+// Every run code is at most this long.
+constexpr int kFaxRunCodeMaxBits = 13;
 
-    if (*bitpos >= bitsize)
-      return -1;
+// Run lengths indexed by the next kFaxRunCodeMaxBits bits of input, built from
+// the FaxBlackRunIns / FaxWhiteRunIns instructions. Each of those lists the
+// codes of one length, for lengths 1, 2, 3 and so on, until 0xff.
+class FaxRunTable {
+ public:
+  struct Entry {
+    uint16_t run;
+    uint8_t bits;  // Length of the code. 0 if no code matches.
+  };
+
+  explicit FaxRunTable(const uint8_t* ins_array) {
+    int ins_off = 0;
+    int bits = 1;
+    for (; ins_array[ins_off] != 0xff; ++bits) {
+      CHECK_LE(bits, kFaxRunCodeMaxBits);
+      const int next_off = ins_off + 1 + ins_array[ins_off] * 3;
+      for (++ins_off; ins_off < next_off; ins_off += 3) {
+        // Codes read earlier are shorter or come first. Both win.
+        const int shift = kFaxRunCodeMaxBits - bits;
+        const uint32_t first = ins_array[ins_off] << shift;
+        const uint32_t last = (ins_array[ins_off] + 1) << shift;
+        const uint16_t run =
+            ins_array[ins_off + 1] + ins_array[ins_off + 2] * 256;
+        for (uint32_t i = first; i < last; ++i) {
+          if (!m_Entries[i].bits)
+            m_Entries[i] = {run, static_cast<uint8_t>(bits)};
+        }
+      }
+    }
+    m_MaxBits = bits - 1;
+  }
 
-    code <<= 1;
-    if (src_buf[*bitpos / 8] & (1 << (7 - *bitpos % 8)))
-      ++code;
+  const Entry& Lookup(uint32_t code) const { return m_Entries[code]; }
+  int max_bits() const { return m_MaxBits; }
 
-    ++(*bitpos);
-    int next_off = ins_off + ins * 3;
-    for (; ins_off < next_off; ins_off += 3) {
-      if (ins_array[ins_off] == code)
-        return ins_array[ins_off + 1] + ins_array[ins_off + 2] * 256;
-    }
+ private:
+  int m_MaxBits;
+  Entry m_Entries[1 << kFaxRunCodeMaxBits] = {};
+};
+
+const FaxRunTable& GetFaxRunTable(bool white) {
+  static const FaxRunTable white_table(FaxWhiteRunIns);
+  static const FaxRunTable black_table(FaxBlackRunIns);
+  return white ? white_table : black_table;
+}
+
+// Reads one run code. Returns -1 if there is no valid code, having skipped
+// as many bits as the longest code, or up to `bitsize`.
+int FaxGetRun(bool white, const uint8_t* src_buf, int* bitpos, int bitsize) {
+  if (*bitpos >= bitsize)
+    return -1;
+
+  const FaxRunTable& table = GetFaxRunTable(white);
+  const FaxRunTable::Entry& entry = table.Lookup(
+      PeekBits(src_buf, bitsize, *bitpos, kFaxRunCodeMaxBits));
+  const int available = bitsize - *bitpos;
+  if (!entry.bits || entry.bits > available) {
+    *bitpos += std::min(table.max_bits(), available);
+    return -1;
   }
+  *bitpos += entry.bits;
+  return entry.run;
 }
 
+// Two-dimensional coding modes. A code is some zeros and then a one, so the
+// number of leading zeros in the next 7 bits picks the entry here.
+enum class FaxMode : uint8_t {
+  kVertical,
+  kHorizontal,
+  kPass,
+  kExtension,
+  kEndOfData,
+};
+
+struct FaxModeCode {
+  FaxMode mode;
+  uint8_t bits;
+  uint8_t v_delta;  // For kVertical. The last bit of the code is the sign.
+};
+
+constexpr int kFaxModeCodeBits = 7;
+
+constexpr FaxModeCode kFaxModeCodes[kFaxModeCodeBits + 1] = {
+    {FaxMode::kVertical, 1, 0},    // 1
+    {FaxMode::kVertical, 3, 1},    // 01x
+    {FaxMode::kHorizontal, 3, 0},  // 001
+    {FaxMode::kPass, 4, 0},        // 0001
+    {FaxMode::kVertical, 6, 2},    // 00001x
+    {FaxMode::kVertical, 7, 3},    // 000001x
+    {FaxMode::kExtension, 7, 0},   // 0000001
+    {FaxMode::kEndOfData, 7, 0},   // 0000000
+};
+
+// `ref_changes` is scratch space for the changing elements of `ref_buf`.
 void FaxG4GetRow(const uint8_t* src_buf,
                  int bitsize,
                  int* bitpos,
                  uint8_t* dest_buf,
                  pdfium::span<const uint8_t> ref_buf,
-                 int columns) {
+                 int columns,
+                 DataVector<int>* ref_changes) {
+  FindChangingElements(ref_buf, columns, ref_changes);
+  const size_t ref_change_count = ref_changes->size();
+
+  // `a0` never goes backwards, so neither does the first changing element
+  // after it.
+  size_t ref_index = 0;
   int a0 = -1;
   bool a0color = true;
   while (true) {
@@ -298,27 +414,45 @@ void FaxG4GetRow(const uint8_t* src_buf,
 
     int a1;
     int a2;
-    int b1;
-    int b2;
-    FaxG4FindB1B2(ref_buf, columns, a0, a0color, &b1, &b2);
-
-    int v_delta = 0;
-    if (!NextBit(src_buf, bitpos)) {
-      if (*bitpos >= bitsize)
-        return;
+    while (ref_index < ref_change_count && (*ref_changes)[ref_index] <= a0)
+      ++ref_index;
+
+    // b1 is the first changing element after a0 whose color is the opposite
+    // of a0color. Each change flips the color, starting from white.
+    size_t b1_index = ref_index;
+    if ((b1_index % 2 == 0) != a0color)
+      ++b1_index;
+    int b1 = columns;
+    int b2 = columns;
+    if (b1_index < ref_change_count) {
+      b1 = (*ref_changes)[b1_index];
+      if (b1_index + 1 < ref_change_count)
+        b2 = (*ref_changes)[b1_index + 1];
+    }
 
-      bool bit1 = NextBit(src_buf, bitpos);
-      if (*bitpos >= bitsize)
-        return;
+    const uint32_t code =
+        PeekBits(src_buf, bitsize, *bitpos, kFaxModeCodeBits);
+    const FaxModeCode& mode_code =
+        kFaxModeCodes[pdfium::base::bits::CountLeadingZeroBits32(code) -
+                      (32 - kFaxModeCodeBits)];
+    if (bitsize - *bitpos < mode_code.bits) {
+      *bitpos = bitsize;
+      return;
+    }
+    *bitpos += mode_code.bits;
 
-      bool bit2 = NextBit(src_buf, bitpos);
-      if (bit1) {
-        v_delta = bit2 ? 1 : -1;
-      } else if (bit2) {
+    int v_delta = 0;
+    switch (mode_code.mode) {
+      case FaxMode::kVertical: {
+        const bool positive =
+            (code >> (kFaxModeCodeBits - mode_code.bits)) & 1;
+        v_delta = positive ? mode_code.v_delta : -mode_code.v_delta;
+        break;
+      }
+      case FaxMode::kHorizontal: {
         int run_len1 = 0;
         while (true) {
-          int run = FaxGetRun(a0color ? FaxWhiteRunIns : FaxBlackRunIns,
-                              src_buf, bitpos, bitsize);
+          int run = FaxGetRun(a0color, src_buf, bitpos, bitsize);
           run_len1 += run;
           if (run < 64)
             break;
@@ -334,8 +468,7 @@ void FaxG4GetRow(const uint8_t* src_buf,
 
         int run_len2 = 0;
         while (true) {
-          int run = FaxGetRun(a0color ? FaxBlackRunIns : FaxWhiteRunIns,
-                              src_buf, bitpos, bitsize);
+          int run = FaxGetRun(!a0color, src_buf, bitpos, bitsize);
           run_len2 += run;
           if (run < 64)
             break;
@@ -351,48 +484,22 @@ void FaxG4GetRow(const uint8_t* src_buf,
           continue;
 
         return;
-      } else {
-        if (*bitpos >= bitsize)
-          return;
-
-        if (NextBit(src_buf, bitpos)) {
-          if (!a0color)
-            FaxFillBits(dest_buf, columns, a0, b2);
-
-          if (b2 >= columns)
-            return;
-
-          a0 = b2;
-          continue;
-        }
-
-        if (*bitpos >= bitsize)
-          return;
+      }
+      case FaxMode::kPass:
+        if (!a0color)
+          FaxFillBits(dest_buf, columns, a0, b2);
 
-        bool next_bit1 = NextBit(src_buf, bitpos);
-        if (*bitpos >= bitsize)
+        if (b2 >= columns)
           return;
 
-        bool next_bit2 = NextBit(src_buf, bitpos);
-        if (next_bit1) {
-          v_delta = next_bit2 ? 2 : -2;
-        } else if (next_bit2) {
-          if (*bitpos >= bitsize)
-            return;
-
-          v_delta = NextBit(src_buf, bitpos) ? 3 : -3;
-        } else {
-          if (*bitpos >= bitsize)
-            return;
-
-          if (NextBit(src_buf, bitpos)) {
-            *bitpos += 3;
-            continue;
-          }
-          *bitpos += 5;
-          return;
-        }
-      }
+        a0 = b2;
+        continue;
+      case FaxMode::kExtension:
+        *bitpos += 3;
+        continue;
+      case FaxMode::kEndOfData:
+        *bitpos += 5;
+        return;
     }
     a1 = b1 + v_delta;
     if (!a0color)
@@ -412,13 +519,17 @@ void FaxG4GetRow(const uint8_t* src_buf,
 
 void FaxSkipEOL(const uint8_t* src_buf, int bitsize, int* bitpos) {
   int startbit = *bitpos;
-  while (*bitpos < bitsize) {
-    if (!NextBit(src_buf, bitpos))
-      continue;
-    if (*bitpos - startbit <= 11)
-      *bitpos = startbit;
+  if (startbit >= bitsize)
+    return;
+
+  // Skip past the next set bit, unless it is too close to be an EOL.
+  int one_pos = FindBit(src_buf, bitsize, startbit, true);
+  if (one_pos >= bitsize) {
+    *bitpos = bitsize;
     return;
   }
+  if (one_pos + 1 - startbit > 11)
+    *bitpos = one_pos + 1;
 }
 
 void FaxGet1DLine(const uint8_t* src_buf,
@@ -434,13 +545,12 @@ void FaxGet1DLine(const uint8_t* src_buf,
 
     int run_len = 0;
     while (true) {
-      int run = FaxGetRun(color ? FaxWhiteRunIns : FaxBlackRunIns, src_buf,
-                          bitpos, bitsize);
+      int run = FaxGetRun(color, src_buf, bitpos, bitsize);
       if (run < 0) {
-        while (*bitpos < bitsize) {
-          if (NextBit(src_buf, bitpos))
-            return;
-        }
+        // Skip past the next set bit.
+        if (*bitpos < bitsize)
+          *bitpos = std::min(FindBit(src_buf, bitsize, *bitpos, true) + 1,
+                             bitsize);
         return;
       }
       run_len += run;
@@ -485,6 +595,7 @@ class FaxDecoder final : public ScanlineDecoder {
   const pdfium::span<const uint8_t> m_SrcSpan;
   DataVector<uint8_t> m_ScanlineBuf;
   DataVector<uint8_t> m_RefBuf;
+  DataVector<int> m_RefChanges;
 };
 
 FaxDecoder::FaxDecoder(pdfium::span<const uint8_t> src_span,
@@ -529,7 +640,7 @@ pdfium::span<uint8_t> FaxDecoder::GetNextLine() {
   memset(m_ScanlineBuf.data(), 0xff, m_ScanlineBuf.size());
   if (m_Encoding < 0) {
     FaxG4GetRow(m_SrcSpan.data(), bitsize, &m_bitpos, m_ScanlineBuf.data(),
-                m_RefBuf, m_OrigWidth);
+                m_RefBuf, m_OrigWidth, &m_RefChanges);
     m_RefBuf = m_ScanlineBuf;
   } else if (m_Encoding == 0) {
     FaxGet1DLine(m_SrcSpan.data(), bitsize, &m_bitpos, m_ScanlineBuf.data(),
@@ -540,7 +651,7 @@ pdfium::span<uint8_t> FaxDecoder::GetNextLine() {
                    m_OrigWidth);
     } else {
       FaxG4GetRow(m_SrcSpan.data(), bitsize, &m_bitpos, m_ScanlineBuf.data(),
-                  m_RefBuf, m_OrigWidth);
+                  m_RefBuf, m_OrigWidth, &m_RefChanges);
     }
     m_RefBuf = m_ScanlineBuf;
   }
@@ -619,11 +730,13 @@ int FaxModule::FaxG4Decode(const uint8_t* src_buf,
   DCHECK(pitch != 0);
 
   DataVector<uint8_t> ref_buf(pitch, 0xff);
+  DataVector<int> ref_changes;
   int bitpos = starting_bitpos;
   for (int iRow = 0; iRow < height; ++iRow) {
     uint8_t* line_buf = dest_buf + iRow * pitch;
     memset(line_buf, 0xff, pitch);
-    FaxG4GetRow(src_buf, src_size << 3, &bitpos, line_buf, ref_buf, width);
+    FaxG4GetRow(src_buf, src_size << 3, &bitpos, line_buf, ref_buf, width,
+                &ref_changes);
     memcpy(ref_buf.data(), line_buf, pitch);
   }
   return bitpos;
@@ -631,6 +744,29 @@ int FaxModule::FaxG4Decode(const uint8_t* src_buf,
 
 #if BUILDFLAG(IS_WIN)
 namespace {
+
+void FaxG4FindB1B2(pdfium::span<const uint8_t> ref_buf,
+                   int columns,
+                   int a0,
+                   bool a0color,
+                   int* b1,
+                   int* b2) {
+  bool first_bit = a0 < 0 || (ref_buf[a0 / 8] & (1 << (7 - a0 % 8))) != 0;
+  *b1 = FindBit(ref_buf.data(), columns, a0 + 1, !first_bit);
+  if (*b1 >= columns) {
+    *b1 = *b2 = columns;
+    return;
+  }
+  if (first_bit == !a0color) {
+    *b1 = FindBit(ref_buf.data(), columns, *b1 + 1, first_bit);
+    first_bit = !first_bit;
+  }
+  if (*b1 >= columns) {
+    *b1 = *b2 = columns;
+    return;
+  }
+  *b2 = FindBit(ref_buf.data(), columns, *b1 + 1, first_bit);
+}
 const uint8_t BlackRunTerminator[128] = {
     0x37, 10, 0x02, 3,  0x03, 2,  0x02, 2,  0x03, 3,  0x03, 4,  0x02, 4,
     0x03, 5,  0x05, 6,  0x04, 6,  0x04, 7,  0x05, 7,  0x07, 7,  0x04, 8,
@@ -0,0 +1,166 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/fax/faxmodule.h"
+
+#include <stdint.h>
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fxcodec/scanlinedecoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/file_util.h"
+#include "testing/utils/hash.h"
+#include "testing/utils/path_service.h"
+#include "third_party/base/span.h"
+
+namespace {
+
+// The ccitt_page*.bin files hold whole pages encoded by libtiff: page 1 of
+// bug_650.pdf and page 1 of latin_extended.pdf, rendered 1728 pixels wide, the
+// width of a fax page, and 2236 rows high. The expected digests are of the
+// pages as rendered, which the decoders before and after the switch to lookup
+// tables both reproduce exactly.
+constexpr int kPageWidth = 1728;
+constexpr int kPageHeight = 2236;
+constexpr char kPage1MD5[] = "dc02fc8b5d9ff3d45b7752b8ca5ad74c";
+constexpr char kPage2MD5[] = "5d093e82cfb92baf4321f932301108dd";
+
+std::vector<uint8_t> GetTestFileData(const char* file_name) {
+  std::string file_path;
+  if (!PathService::GetTestFilePath(file_name, &file_path))
+    return {};
+
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  if (!file_contents)
+    return {};
+
+  const uint8_t* data = reinterpret_cast<uint8_t*>(file_contents.get());
+  return std::vector<uint8_t>(data, data + file_length);
+}
+
+// Decodes a whole page with the decoder PDF streams use, and returns the
+// digest of its rows.
+std::string DecodePage(const char* file_name,
+                       int K,
+                       bool EndOfLine,
+                       bool EncodedByteAlign) {
+  const std::vector<uint8_t> data = GetTestFileData(file_name);
+  if (data.empty())
+    return "missing " + std::string(file_name);
+
+  std::unique_ptr<ScanlineDecoder> decoder = FaxModule::CreateDecoder(
+      data, kPageWidth, kPageHeight, K, EndOfLine, EncodedByteAlign,
+      /*BlackIs1=*/false, kPageWidth, kPageHeight);
+  if (!decoder)
+    return "no decoder";
+
+  std::vector<uint8_t> rows;
+  for (int row = 0; row < kPageHeight; ++row) {
+    pdfium::span<const uint8_t> line = decoder->GetScanline(row);
+    if (line.empty())
+      return "short by " + std::to_string(kPageHeight - row) + " rows";
+    rows.insert(rows.end(), line.begin(), line.end());
+  }
+  return GenerateMD5Base16(rows);
+}
+
+}  // namespace
+
+TEST(FaxModule, G4Decode) {
+  // 16 pixels wide. Row 0 is white, using V0. Row 1 has pixels 4 to 7 black,
+  // using horizontal mode with runs of 4 and 4, then V0. Row 2 repeats row 1
+  // with V0 three times. Row 3 uses VR1, V0 and V0 to make pixels 5 to 7
+  // black.
+  const uint8_t kData[] = {0x9b, 0x7e, 0xf0};
+  constexpr int kPitch = 4;
+  uint8_t dest[4 * kPitch];
+  EXPECT_EQ(20, FaxModule::FaxG4Decode(kData, sizeof(kData), 0, 16, 4, kPitch,
+                                       dest));
+
+  const uint8_t kExpected[] = {0xff, 0xff, 0xff, 0xff, 0xf0, 0xff, 0xff, 0xff,
+                               0xf0, 0xff, 0xff, 0xff, 0xf8, 0xff, 0xff, 0xff};
+  EXPECT_EQ(std::vector<uint8_t>(std::begin(kExpected), std::end(kExpected)),
+            std::vector<uint8_t>(std::begin(dest), std::end(dest)));
+}
+
+TEST(FaxModule, G4DecodeTruncated) {
+  // Same as above, without the last byte. Row 3 runs out of data in its first
+  // code, so it stays white.
+  const uint8_t kData[] = {0x9b, 0x7e};
+  constexpr int kPitch = 4;
+  uint8_t dest[4 * kPitch];
+  EXPECT_EQ(16, FaxModule::FaxG4Decode(kData, sizeof(kData), 0, 16, 4, kPitch,
+                                       dest));
+  EXPECT_EQ(0xff, dest[3 * kPitch]);
+}
+
+TEST(FaxModule, Decode1D) {
+  // 16 pixels wide, white run of 4, black run of 4, white run of 8.
+  const uint8_t kData[] = {0xb7, 0x30};
+  std::unique_ptr<ScanlineDecoder> decoder = FaxModule::CreateDecoder(
+      kData, 16, 1, /*K=*/0, /*EndOfLine=*/false, /*EncodedByteAlign=*/false,
+      /*BlackIs1=*/false, /*Columns=*/16, /*Rows=*/1);
+  ASSERT_TRUE(decoder);
+
+  pdfium::span<const uint8_t> line = decoder->GetScanline(0);
+  ASSERT_EQ(4u, line.size());
+  EXPECT_EQ(0xf0, line[0]);
+  EXPECT_EQ(0xff, line[1]);
+  EXPECT_EQ(2u, decoder->GetSrcOffset());
+}
+
+TEST(FaxModule, Decode1DBlackIs1) {
+  const uint8_t kData[] = {0xb7, 0x30};
+  std::unique_ptr<ScanlineDecoder> decoder = FaxModule::CreateDecoder(
+      kData, 16, 1, /*K=*/0, /*EndOfLine=*/false, /*EncodedByteAlign=*/false,
+      /*BlackIs1=*/true, /*Columns=*/16, /*Rows=*/1);
+  ASSERT_TRUE(decoder);
+
+  pdfium::span<const uint8_t> line = decoder->GetScanline(0);
+  ASSERT_EQ(4u, line.size());
+  EXPECT_EQ(0x0f, line[0]);
+  EXPECT_EQ(0x00, line[1]);
+}
+
+TEST(FaxModule, G4DecodePages) {
+  EXPECT_EQ(kPage1MD5, DecodePage("ccitt_page1_g4.bin", /*K=*/-1,
+                                  /*EndOfLine=*/false,
+                                  /*EncodedByteAlign=*/false));
+  EXPECT_EQ(kPage2MD5, DecodePage("ccitt_page2_g4.bin", /*K=*/-1,
+                                  /*EndOfLine=*/false,
+                                  /*EncodedByteAlign=*/false));
+
+  // Same as above, through the decoder JBIG2 uses for MMR data.
+  const std::vector<uint8_t> data = GetTestFileData("ccitt_page1_g4.bin");
+  ASSERT_FALSE(data.empty());
+  constexpr int kPitch = kPageWidth / 8;
+  std::vector<uint8_t> dest(kPitch * kPageHeight);
+  // Decoding stops at the end-of-block code, 24 bits and 7 bits of padding
+  // before the end of the data.
+  EXPECT_EQ(static_cast<int>(data.size()) * 8 - 31,
+            FaxModule::FaxG4Decode(data.data(), data.size(), 0, kPageWidth,
+                                   kPageHeight, kPitch, dest.data()));
+  EXPECT_EQ(kPage1MD5, GenerateMD5Base16(dest));
+}
+
+TEST(FaxModule, G3DecodePages) {
+  EXPECT_EQ(kPage1MD5, DecodePage("ccitt_page1_g3_1d.bin", /*K=*/0,
+                                  /*EndOfLine=*/true,
+                                  /*EncodedByteAlign=*/false));
+  EXPECT_EQ(kPage2MD5, DecodePage("ccitt_page2_g3_1d.bin", /*K=*/0,
+                                  /*EndOfLine=*/true,
+                                  /*EncodedByteAlign=*/false));
+  EXPECT_EQ(kPage1MD5, DecodePage("ccitt_page1_g3_2d.bin", /*K=*/1,
+                                  /*EndOfLine=*/true,
+                                  /*EncodedByteAlign=*/false));
+  EXPECT_EQ(kPage1MD5, DecodePage("ccitt_page1_g3_2d_aligned.bin", /*K=*/1,
+                                  /*EndOfLine=*/true,
+                                  /*EncodedByteAlign=*/true));
+}
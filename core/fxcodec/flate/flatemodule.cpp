@@ -13,7 +13,6 @@
 #include <limits>
 #include <memory>
 #include <utility>
-#include <vector>
 
 #include "core/fxcodec/scanlinedecoder.h"
 #include "core/fxcrt/data_vector.h"
@@ -22,6 +21,7 @@
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxge/calculate_pitch.h"
 #include "third_party/base/check.h"
+#include "third_party/base/check_op.h"
 #include "third_party/base/notreached.h"
 #include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/span.h"
@@ -32,6 +32,10 @@
 #include "third_party/zlib/zlib.h"
 #endif
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 extern "C" {
 
 static void* my_alloc_func(void* opaque,
@@ -61,11 +65,19 @@ uint32_t FlateGetPossiblyTruncatedTotalIn(z_stream* context) {
   return pdfium::base::saturated_cast<uint32_t>(context->total_in);
 }
 
-bool FlateCompress(unsigned char* dest_buf,
-                   unsigned long* dest_size,
-                   const unsigned char* src_buf,
-                   uint32_t src_size) {
-  return compress(dest_buf, dest_size, src_buf, src_size) == Z_OK;
+int ToZlibStrategy(FlateModule::Strategy strategy) {
+  switch (strategy) {
+    case FlateModule::Strategy::kDefault:
+      return Z_DEFAULT_STRATEGY;
+    case FlateModule::Strategy::kFiltered:
+      return Z_FILTERED;
+    case FlateModule::Strategy::kHuffmanOnly:
+      return Z_HUFFMAN_ONLY;
+    case FlateModule::Strategy::kRle:
+      return Z_RLE;
+  }
+  NOTREACHED();
+  return Z_DEFAULT_STRATEGY;
 }
 
 z_stream* FlateInit() {
@@ -295,74 +307,174 @@ uint8_t PathPredictor(int a, int b, int c) {
   return (uint8_t)c;
 }
 
+#if defined(__SSE2__)
+// Sub, Average and Paeth depend on the pixel to the left, so only the bytes of
+// one pixel can be done at a time. For 3 and 4 byte pixels that still beats
+// going byte by byte.
+bool CanUnfilterWithSSE2(size_t bpp) {
+  return bpp == 3 || bpp == 4;
+}
+
+__m128i LoadPixel(const uint8_t* p, size_t bpp) {
+  uint32_t value = 0;
+  memcpy(&value, p, bpp);
+  return _mm_cvtsi32_si128(value);
+}
+
+void StorePixel(uint8_t* p, __m128i pixel, size_t bpp) {
+  uint32_t value = _mm_cvtsi128_si32(pixel);
+  memcpy(p, &value, bpp);
+}
+
+__m128i Abs16(__m128i x) {
+  return _mm_max_epi16(x, _mm_sub_epi16(_mm_setzero_si128(), x));
+}
+
+__m128i IfThenElse(__m128i cond, __m128i then_value, __m128i else_value) {
+  return _mm_or_si128(_mm_and_si128(cond, then_value),
+                      _mm_andnot_si128(cond, else_value));
+}
+#endif  // defined(__SSE2__)
+
+// The functions below undo one PNG filter for a row of `size` bytes. `prior`
+// is the previous unfiltered row, all zeros for the first row. Each loop
+// starts where the SIMD loop, if any, left off.
+
+void UnfilterPngSub(const uint8_t* src,
+                    uint8_t* dest,
+                    size_t size,
+                    size_t bpp) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  if (CanUnfilterWithSSE2(bpp)) {
+    __m128i left = _mm_setzero_si128();
+    for (; i + bpp <= size; i += bpp) {
+      left = _mm_add_epi8(left, LoadPixel(src + i, bpp));
+      StorePixel(dest + i, left, bpp);
+    }
+  }
+#endif
+  for (; i < std::min(bpp, size); ++i)
+    dest[i] = src[i];
+  for (; i < size; ++i)
+    dest[i] = src[i] + dest[i - bpp];
+}
+
+void UnfilterPngUp(const uint8_t* src,
+                   const uint8_t* prior,
+                   uint8_t* dest,
+                   size_t size) {
+  // No dependency between bytes, so compilers vectorize this as written.
+  for (size_t i = 0; i < size; ++i)
+    dest[i] = src[i] + prior[i];
+}
+
+void UnfilterPngAverage(const uint8_t* src,
+                        const uint8_t* prior,
+                        uint8_t* dest,
+                        size_t size,
+                        size_t bpp) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  if (CanUnfilterWithSSE2(bpp)) {
+    // _mm_avg_epu8() rounds up, so take away the bit that rounding added.
+    const __m128i ones = _mm_set1_epi8(1);
+    __m128i left = _mm_setzero_si128();
+    for (; i + bpp <= size; i += bpp) {
+      __m128i up = LoadPixel(prior + i, bpp);
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(left, up),
+                                 _mm_and_si128(_mm_xor_si128(left, up), ones));
+      left = _mm_add_epi8(avg, LoadPixel(src + i, bpp));
+      StorePixel(dest + i, left, bpp);
+    }
+  }
+#endif
+  for (; i < std::min(bpp, size); ++i)
+    dest[i] = src[i] + prior[i] / 2;
+  for (; i < size; ++i)
+    dest[i] = src[i] + (prior[i] + dest[i - bpp]) / 2;
+}
+
+void UnfilterPngPaeth(const uint8_t* src,
+                      const uint8_t* prior,
+                      uint8_t* dest,
+                      size_t size,
+                      size_t bpp) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  if (CanUnfilterWithSSE2(bpp)) {
+    // Same as PathPredictor(), on 16-bit lanes. With p = a + b - c, the
+    // distances |p - a|, |p - b| and |p - c| are |b - c|, |a - c| and
+    // |a + b - 2c|. Ties favor a over b over c.
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = zero;
+    __m128i c = zero;
+    for (; i + bpp <= size; i += bpp) {
+      __m128i b = _mm_unpacklo_epi8(LoadPixel(prior + i, bpp), zero);
+      __m128i pa = _mm_sub_epi16(b, c);
+      __m128i pb = _mm_sub_epi16(a, c);
+      __m128i pc = Abs16(_mm_add_epi16(pa, pb));
+      pa = Abs16(pa);
+      pb = Abs16(pb);
+      __m128i smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+      __m128i nearest = IfThenElse(_mm_cmpeq_epi16(smallest, pc), c, b);
+      nearest = IfThenElse(_mm_cmpeq_epi16(smallest, pb), b, nearest);
+      nearest = IfThenElse(_mm_cmpeq_epi16(smallest, pa), a, nearest);
+      __m128i pixel = _mm_add_epi8(LoadPixel(src + i, bpp),
+                                   _mm_packus_epi16(nearest, nearest));
+      StorePixel(dest + i, pixel, bpp);
+      a = _mm_unpacklo_epi8(pixel, zero);
+      c = b;
+    }
+  }
+#endif
+  // With nothing to the left, Paeth always picks the byte above.
+  for (; i < std::min(bpp, size); ++i)
+    dest[i] = src[i] + prior[i];
+  for (; i < size; ++i)
+    dest[i] = src[i] + PathPredictor(dest[i - bpp], prior[i], prior[i - bpp]);
+}
+
+// Undoes the filter given by `tag` on `src`, writing `src.size()` bytes to
+// `dest`. `prior` must hold at least that many bytes.
+void UnfilterPngRow(uint8_t tag,
+                    pdfium::span<const uint8_t> src,
+                    pdfium::span<const uint8_t> prior,
+                    pdfium::span<uint8_t> dest,
+                    size_t bpp) {
+  const size_t size = src.size();
+  CHECK_LE(size, dest.size());
+  CHECK_LE(size, prior.size());
+  switch (tag) {
+    case 1:
+      UnfilterPngSub(src.data(), dest.data(), size, bpp);
+      break;
+    case 2:
+      UnfilterPngUp(src.data(), prior.data(), dest.data(), size);
+      break;
+    case 3:
+      UnfilterPngAverage(src.data(), prior.data(), dest.data(), size, bpp);
+      break;
+    case 4:
+      UnfilterPngPaeth(src.data(), prior.data(), dest.data(), size, bpp);
+      break;
+    default:
+      if (size)
+        memmove(dest.data(), src.data(), size);
+      break;
+  }
+}
+
 void PNG_PredictLine(pdfium::span<uint8_t> dest_span,
                      pdfium::span<const uint8_t> src_span,
                      pdfium::span<const uint8_t> last_span,
                      int bpc,
                      int nColors,
                      int nPixels) {
-  uint8_t* pDestData = dest_span.data();
-  const uint8_t* pSrcData = src_span.data();
-  const uint8_t* pLastLine = last_span.data();
   const uint32_t row_size = fxge::CalculatePitch8OrDie(bpc, nColors, nPixels);
   const uint32_t BytesPerPixel = (bpc * nColors + 7) / 8;
-  uint8_t tag = pSrcData[0];
-  if (tag == 0) {
-    memmove(pDestData, pSrcData + 1, row_size);
-    return;
-  }
-  for (uint32_t byte = 0; byte < row_size; ++byte) {
-    uint8_t raw_byte = pSrcData[byte + 1];
-    switch (tag) {
-      case 1: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + left;
-        break;
-      }
-      case 2: {
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + up;
-        break;
-      }
-      case 3: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        pDestData[byte] = raw_byte + (up + left) / 2;
-        break;
-      }
-      case 4: {
-        uint8_t left = 0;
-        if (byte >= BytesPerPixel) {
-          left = pDestData[byte - BytesPerPixel];
-        }
-        uint8_t up = 0;
-        if (pLastLine) {
-          up = pLastLine[byte];
-        }
-        uint8_t upper_left = 0;
-        if (byte >= BytesPerPixel && pLastLine) {
-          upper_left = pLastLine[byte - BytesPerPixel];
-        }
-        pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-        break;
-      }
-      default:
-        pDestData[byte] = raw_byte;
-        break;
-    }
-  }
+  UnfilterPngRow(src_span[0], src_span.subspan(1, row_size), last_span,
+                 dest_span, BytesPerPixel);
 }
 
 bool PNG_Predictor(int Colors,
@@ -381,76 +493,19 @@ bool PNG_Predictor(int Colors,
   const int last_row_size = *data_size % (row_size + 1);
   std::unique_ptr<uint8_t, FxFreeDeleter> dest_buf(
       FX_Alloc2D(uint8_t, row_size, row_count));
-  uint32_t byte_cnt = 0;
-  uint8_t* pSrcData = data_buf->get();
+  const DataVector<uint8_t> zero_row(row_size);
+  const uint8_t* pSrcData = data_buf->get();
   uint8_t* pDestData = dest_buf.get();
+  pdfium::span<const uint8_t> prior = zero_row;
   for (int row = 0; row < row_count; row++) {
-    uint8_t tag = pSrcData[0];
-    byte_cnt++;
-    if (tag == 0) {
-      int move_size = row_size;
-      if ((row + 1) * (move_size + 1) > static_cast<int>(*data_size)) {
-        move_size = last_row_size - 1;
-      }
-      memcpy(pDestData, pSrcData + 1, move_size);
-      pSrcData += move_size + 1;
-      pDestData += move_size;
-      byte_cnt += move_size;
-      continue;
-    }
-    for (int byte = 0; byte < row_size && byte_cnt < *data_size;
-         ++byte, ++byte_cnt) {
-      uint8_t raw_byte = pSrcData[byte + 1];
-      switch (tag) {
-        case 1: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + left;
-          break;
-        }
-        case 2: {
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + up;
-          break;
-        }
-        case 3: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          pDestData[byte] = raw_byte + (up + left) / 2;
-          break;
-        }
-        case 4: {
-          uint8_t left = 0;
-          if (byte >= BytesPerPixel) {
-            left = pDestData[byte - BytesPerPixel];
-          }
-          uint8_t up = 0;
-          if (row) {
-            up = pDestData[byte - row_size];
-          }
-          uint8_t upper_left = 0;
-          if (byte >= BytesPerPixel && row) {
-            upper_left = pDestData[byte - row_size - BytesPerPixel];
-          }
-          pDestData[byte] = raw_byte + PathPredictor(left, up, upper_left);
-          break;
-        }
-        default:
-          pDestData[byte] = raw_byte;
-          break;
-      }
-    }
+    // A truncated last row unfilters as many bytes as there are.
+    int src_size = row_size;
+    if (row == row_count - 1 && last_row_size > 0)
+      src_size = last_row_size - 1;
+    UnfilterPngRow(pSrcData[0], {pSrcData + 1, static_cast<size_t>(src_size)},
+                   prior, {pDestData, static_cast<size_t>(row_size)},
+                   BytesPerPixel);
+    prior = {pDestData, static_cast<size_t>(row_size)};
     pSrcData += row_size + 1;
     pDestData += row_size;
   }
@@ -538,57 +593,42 @@ void FlateUncompress(pdfium::span<const uint8_t> src_buf,
   uint32_t guess_size =
       orig_size ? orig_size
                 : pdfium::base::checked_cast<uint32_t>(src_buf.size() * 2);
-  guess_size = std::min(guess_size, kMaxInitialAllocSize);
+  guess_size = std::max(std::min(guess_size, kMaxInitialAllocSize), 1u);
 
+  // Inflate into a single buffer, growing it when full. A good `orig_size`
+  // means it never has to grow, and there is nothing to copy at the end.
   uint32_t buf_size = guess_size;
-  uint32_t last_buf_size = buf_size;
-  std::unique_ptr<uint8_t, FxFreeDeleter> guess_buf(
-      FX_Alloc(uint8_t, guess_size + 1));
-  guess_buf.get()[guess_size] = '\0';
-
-  std::vector<std::unique_ptr<uint8_t, FxFreeDeleter>> result_tmp_bufs;
-  {
-    std::unique_ptr<uint8_t, FxFreeDeleter> cur_buf = std::move(guess_buf);
-    while (true) {
-      uint32_t ret = FlateOutput(context.get(), cur_buf.get(), buf_size);
-      uint32_t avail_buf_size = FlateGetAvailOut(context.get());
-      if (ret != Z_OK || avail_buf_size != 0) {
-        last_buf_size = buf_size - avail_buf_size;
-        result_tmp_bufs.push_back(std::move(cur_buf));
-        break;
-      }
-      result_tmp_bufs.push_back(std::move(cur_buf));
-      cur_buf.reset(FX_Alloc(uint8_t, buf_size + 1));
-      cur_buf.get()[buf_size] = '\0';
-    }
+  uint32_t used_size = 0;
+  std::unique_ptr<uint8_t, FxFreeDeleter> result_buf(
+      FX_Alloc(uint8_t, buf_size));
+  while (true) {
+    uint32_t avail_size = buf_size - used_size;
+    uint32_t ret =
+        FlateOutput(context.get(), result_buf.get() + used_size, avail_size);
+    uint32_t avail_buf_size = FlateGetAvailOut(context.get());
+    used_size += avail_size - avail_buf_size;
+    if (ret != Z_OK || avail_buf_size != 0)
+      break;
+
+    FX_SAFE_UINT32 new_size = buf_size;
+    new_size += std::max(buf_size / 2, guess_size);
+    if (!new_size.IsValid())
+      break;
+
+    buf_size = new_size.ValueOrDie();
+    result_buf.reset(FX_Realloc(uint8_t, result_buf.release(), buf_size));
   }
 
   // The TotalOut size returned from the library may not be big enough to
   // handle the content the library returns. We can only handle items
   // up to 4GB in size.
-  *dest_size = FlateGetPossiblyTruncatedTotalOut(context.get());
+  *dest_size = std::min(FlateGetPossiblyTruncatedTotalOut(context.get()),
+                        used_size);
   *offset = FlateGetPossiblyTruncatedTotalIn(context.get());
-  if (result_tmp_bufs.size() == 1) {
-    *dest_buf = std::move(result_tmp_bufs[0]);
-    return;
-  }
 
-  std::unique_ptr<uint8_t, FxFreeDeleter> result_buf(
-      FX_Alloc(uint8_t, *dest_size));
-  uint32_t result_pos = 0;
-  uint32_t remaining = *dest_size;
-  for (size_t i = 0; i < result_tmp_bufs.size(); i++) {
-    std::unique_ptr<uint8_t, FxFreeDeleter> tmp_buf =
-        std::move(result_tmp_bufs[i]);
-    uint32_t tmp_buf_size = buf_size;
-    if (i == result_tmp_bufs.size() - 1)
-      tmp_buf_size = last_buf_size;
-
-    uint32_t cp_size = std::min(tmp_buf_size, remaining);
-    memcpy(result_buf.get() + result_pos, tmp_buf.get(), cp_size);
-    result_pos += cp_size;
-    remaining -= cp_size;
-  }
+  // Give back the slack left by growing, as the result may be kept around.
+  if (buf_size != guess_size && *dest_size > 0 && *dest_size < buf_size)
+    result_buf.reset(FX_Realloc(uint8_t, result_buf.release(), *dest_size));
   *dest_buf = std::move(result_buf);
 }
 
@@ -601,6 +641,31 @@ static PredictorType GetPredictor(int predictor) {
   return PredictorType::kNone;
 }
 
+// `estimated_size` is the expected size after the predictor is undone. PNG
+// predictors add a tag byte to every row, so the inflated data is larger.
+uint32_t GetFilteredSizeHint(PredictorType predictor,
+                             int Colors,
+                             int BitsPerComponent,
+                             int Columns,
+                             uint32_t estimated_size) {
+  if (predictor != PredictorType::kPng || estimated_size == 0)
+    return estimated_size;
+
+  FX_SAFE_UINT32 row_size = Colors;
+  row_size *= BitsPerComponent;
+  row_size *= Columns;
+  row_size += 7;
+  row_size /= 8;
+  if (!row_size.IsValid() || row_size.ValueOrDie() == 0)
+    return estimated_size;
+
+  FX_SAFE_UINT32 row_count = estimated_size;
+  row_count += row_size - 1;
+  row_count /= row_size;
+  FX_SAFE_UINT32 hint = row_count + estimated_size;
+  return hint.ValueOrDefault(estimated_size);
+}
+
 class FlateScanlineDecoder : public ScanlineDecoder {
  public:
   FlateScanlineDecoder(pdfium::span<const uint8_t> src_span,
@@ -842,7 +907,11 @@ uint32_t FlateModule::FlateOrLZWDecode(
     *dest_size = decoder->GetDestSize();
     *dest_buf = decoder->TakeDestBuf();
   } else {
-    FlateUncompress(src_span, estimated_size, dest_buf, dest_size, &offset);
+    FlateUncompress(src_span,
+                    GetFilteredSizeHint(predictor_type, Colors,
+                                        BitsPerComponent, Columns,
+                                        estimated_size),
+                    dest_buf, dest_size, &offset);
   }
 
   bool ret = false;
@@ -868,16 +937,43 @@ uint32_t FlateModule::FlateOrLZWDecode(
 bool FlateModule::Encode(pdfium::span<const uint8_t> src_span,
                          std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
                          uint32_t* dest_size) {
-  const uint8_t* src_buf = src_span.data();
-  FX_SAFE_UINT32 src_size = src_span.size();
-  *dest_size = (src_size + src_size / 1000 + 12).ValueOrDie();
-  dest_buf->reset(FX_Alloc(uint8_t, *dest_size));
-  unsigned long temp_size = *dest_size;
-  if (!FlateCompress(dest_buf->get(), &temp_size, src_buf,
-                     src_size.ValueOrDie())) {
+  return Encode(src_span, EncodeOptions(), dest_buf, dest_size);
+}
+
+// static
+bool FlateModule::Encode(pdfium::span<const uint8_t> src_span,
+                         const EncodeOptions& options,
+                         std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
+                         uint32_t* dest_size) {
+  DCHECK_GE(options.level, Z_DEFAULT_COMPRESSION);
+  DCHECK_LE(options.level, Z_BEST_COMPRESSION);
+
+  // The same parameters as compress(), apart from the level and strategy.
+  z_stream context = {};
+  if (deflateInit2(&context, options.level, Z_DEFLATED, MAX_WBITS,
+                   /*memLevel=*/8, ToZlibStrategy(options.strategy)) != Z_OK) {
+    return false;
+  }
+
+  const uint32_t src_size = pdfium::base::checked_cast<uint32_t>(
+      src_span.size());
+  FX_SAFE_UINT32 bound = deflateBound(&context, src_size);
+  if (!bound.IsValid()) {
+    deflateEnd(&context);
     return false;
   }
-  *dest_size = pdfium::base::checked_cast<uint32_t>(temp_size);
+  *dest_size = bound.ValueOrDie();
+  dest_buf->reset(FX_Alloc(uint8_t, *dest_size));
+  context.next_in = const_cast<uint8_t*>(src_span.data());
+  context.avail_in = src_size;
+  context.next_out = dest_buf->get();
+  context.avail_out = *dest_size;
+  int ret = deflate(&context, Z_FINISH);
+  deflateEnd(&context);
+  if (ret != Z_STREAM_END)
+    return false;
+
+  *dest_size = pdfium::base::checked_cast<uint32_t>(context.total_out);
   return true;
 }
 
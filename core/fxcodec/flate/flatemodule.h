@@ -20,6 +20,16 @@ class ScanlineDecoder;
 
 class FlateModule {
  public:
+  // Mirrors zlib's compression strategies.
+  enum class Strategy { kDefault, kFiltered, kHuffmanOnly, kRle };
+
+  struct EncodeOptions {
+    // From 0 for no compression to 9 for the smallest output, or -1 for
+    // zlib's default.
+    int level = -1;
+    Strategy strategy = Strategy::kDefault;
+  };
+
   static std::unique_ptr<ScanlineDecoder> CreateDecoder(
       pdfium::span<const uint8_t> src_span,
       int width,
@@ -46,6 +56,10 @@ class FlateModule {
   static bool Encode(pdfium::span<const uint8_t> src_span,
                      std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
                      uint32_t* dest_size);
+  static bool Encode(pdfium::span<const uint8_t> src_span,
+                     const EncodeOptions& options,
+                     std::unique_ptr<uint8_t, FxFreeDeleter>* dest_buf,
+                     uint32_t* dest_size);
 
   FlateModule() = delete;
   FlateModule(const FlateModule&) = delete;
@@ -0,0 +1,213 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/flate/flatemodule.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <vector>
+
+#include "core/fxcodec/scanlinedecoder.h"
+#include "core/fxcrt/fx_extension.h"
+#include "core/fxcrt/fx_memory_wrappers.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/base/span.h"
+
+namespace {
+
+constexpr int kPngPredictor = 15;
+constexpr uint32_t kWidth = 37;
+constexpr uint32_t kHeight = 10;
+
+uint8_t Paeth(int a, int b, int c) {
+  int p = a + b - c;
+  int pa = abs(p - a);
+  int pb = abs(p - b);
+  int pc = abs(p - c);
+  if (pa <= pb && pa <= pc)
+    return a;
+  return pb <= pc ? b : c;
+}
+
+std::vector<uint8_t> MakeImage(size_t row_size, size_t rows) {
+  std::vector<uint8_t> image(row_size * rows);
+  uint32_t seed = 12345;
+  for (uint8_t& byte : image) {
+    seed = seed * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(seed >> 16);
+  }
+  return image;
+}
+
+// Applies PNG filters to `image`, cycling through all five row by row.
+std::vector<uint8_t> FilterPng(const std::vector<uint8_t>& image,
+                               size_t row_size,
+                               size_t bpp) {
+  std::vector<uint8_t> zero_row(row_size);
+  std::vector<uint8_t> filtered;
+  const size_t rows = image.size() / row_size;
+  for (size_t row = 0; row < rows; ++row) {
+    const uint8_t* cur = &image[row * row_size];
+    const uint8_t* prior = row ? cur - row_size : zero_row.data();
+    const uint8_t tag = row % 5;
+    filtered.push_back(tag);
+    for (size_t i = 0; i < row_size; ++i) {
+      uint8_t left = i >= bpp ? cur[i - bpp] : 0;
+      uint8_t up_left = i >= bpp ? prior[i - bpp] : 0;
+      uint8_t predicted = 0;
+      switch (tag) {
+        case 1:
+          predicted = left;
+          break;
+        case 2:
+          predicted = prior[i];
+          break;
+        case 3:
+          predicted = (left + prior[i]) / 2;
+          break;
+        case 4:
+          predicted = Paeth(left, prior[i], up_left);
+          break;
+      }
+      filtered.push_back(cur[i] - predicted);
+    }
+  }
+  return filtered;
+}
+
+std::vector<uint8_t> Compress(pdfium::span<const uint8_t> data) {
+  std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+  uint32_t size = 0;
+  EXPECT_TRUE(FlateModule::Encode(data, &buf, &size));
+  return std::vector<uint8_t>(buf.get(), buf.get() + size);
+}
+
+}  // namespace
+
+TEST(FlateModule, PngPredictor) {
+  for (int bpp : {1, 2, 3, 4, 6, 8}) {
+    SCOPED_TRACE(bpp);
+    const uint32_t row_size = kWidth * bpp;
+    std::vector<uint8_t> image = MakeImage(row_size, kHeight);
+    std::vector<uint8_t> compressed =
+        Compress(FilterPng(image, row_size, bpp));
+
+    for (uint32_t estimated_size : {0u, 1u, row_size * kHeight}) {
+      std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+      uint32_t size = 0;
+      EXPECT_NE(FX_INVALID_OFFSET,
+                FlateModule::FlateOrLZWDecode(
+                    false, compressed, false, kPngPredictor, bpp, 8, kWidth,
+                    estimated_size, &buf, &size));
+      ASSERT_EQ(image.size(), size);
+      EXPECT_EQ(image, std::vector<uint8_t>(buf.get(), buf.get() + size));
+    }
+  }
+}
+
+TEST(FlateModule, PngPredictorTruncatedLastRow) {
+  for (int bpp : {1, 3, 4}) {
+    SCOPED_TRACE(bpp);
+    const uint32_t row_size = kWidth * bpp;
+    std::vector<uint8_t> image = MakeImage(row_size, kHeight);
+    std::vector<uint8_t> filtered = FilterPng(image, row_size, bpp);
+
+    // Keep the tag and 10 pixels of the last row, which uses Paeth.
+    const uint32_t kept = 10 * bpp;
+    ASSERT_EQ(4, filtered[(kHeight - 1) * (row_size + 1)]);
+    filtered.resize(filtered.size() - row_size + kept);
+    std::vector<uint8_t> compressed = Compress(filtered);
+
+    std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+    uint32_t size = 0;
+    EXPECT_NE(FX_INVALID_OFFSET,
+              FlateModule::FlateOrLZWDecode(false, compressed, false,
+                                            kPngPredictor, bpp, 8, kWidth, 0,
+                                            &buf, &size));
+    image.resize(image.size() - row_size + kept);
+    ASSERT_EQ(image.size(), size);
+    EXPECT_EQ(image, std::vector<uint8_t>(buf.get(), buf.get() + size));
+  }
+}
+
+TEST(FlateModule, PngPredictorScanlineDecoder) {
+  for (int bpp : {1, 3, 4}) {
+    SCOPED_TRACE(bpp);
+    const uint32_t row_size = kWidth * bpp;
+    std::vector<uint8_t> image = MakeImage(row_size, kHeight);
+    std::vector<uint8_t> compressed =
+        Compress(FilterPng(image, row_size, bpp));
+
+    std::unique_ptr<ScanlineDecoder> decoder = FlateModule::CreateDecoder(
+        compressed, kWidth, kHeight, bpp, 8, kPngPredictor, bpp, 8, kWidth);
+    ASSERT_TRUE(decoder);
+    for (uint32_t row = 0; row < kHeight; ++row) {
+      pdfium::span<const uint8_t> line = decoder->GetScanline(row);
+      ASSERT_EQ(row_size, line.size());
+      EXPECT_EQ(std::vector<uint8_t>(image.begin() + row * row_size,
+                                     image.begin() + (row + 1) * row_size),
+                std::vector<uint8_t>(line.begin(), line.end()))
+          << " at row " << row;
+    }
+  }
+}
+
+TEST(FlateModule, DecodeGrowsBuffer) {
+  // Compresses far better than the 2:1 ratio guessed without a size hint.
+  std::vector<uint8_t> data(1024 * 1024);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i / 4096);
+  std::vector<uint8_t> compressed = Compress(data);
+  ASSERT_LT(compressed.size() * 8, data.size());
+
+  std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+  uint32_t size = 0;
+  EXPECT_EQ(compressed.size(),
+            FlateModule::FlateOrLZWDecode(false, compressed, false, 0, 0, 0, 0,
+                                          0, &buf, &size));
+  ASSERT_EQ(data.size(), size);
+  EXPECT_EQ(data, std::vector<uint8_t>(buf.get(), buf.get() + size));
+}
+
+TEST(FlateModule, EncodeOptions) {
+  std::vector<uint8_t> data = MakeImage(kWidth * 3, kHeight);
+  std::vector<uint8_t> filtered = FilterPng(data, kWidth * 3, 3);
+  data.insert(data.end(), filtered.begin(), filtered.end());
+  data.insert(data.end(), 4096, 'a');
+
+  std::vector<size_t> sizes;
+  for (int level : {-1, 0, 1, 9}) {
+    for (FlateModule::Strategy strategy :
+         {FlateModule::Strategy::kDefault, FlateModule::Strategy::kFiltered,
+          FlateModule::Strategy::kHuffmanOnly, FlateModule::Strategy::kRle}) {
+      SCOPED_TRACE(level);
+      SCOPED_TRACE(static_cast<int>(strategy));
+      FlateModule::EncodeOptions options;
+      options.level = level;
+      options.strategy = strategy;
+      std::unique_ptr<uint8_t, FxFreeDeleter> buf;
+      uint32_t size = 0;
+      ASSERT_TRUE(FlateModule::Encode(data, options, &buf, &size));
+      std::vector<uint8_t> compressed(buf.get(), buf.get() + size);
+
+      uint32_t decoded_size = 0;
+      EXPECT_EQ(compressed.size(),
+                FlateModule::FlateOrLZWDecode(false, compressed, false, 0, 0,
+                                              0, 0, 0, &buf, &decoded_size));
+      ASSERT_EQ(data.size(), decoded_size);
+      EXPECT_EQ(data,
+                std::vector<uint8_t>(buf.get(), buf.get() + decoded_size));
+      if (strategy == FlateModule::Strategy::kDefault)
+        sizes.push_back(compressed.size());
+    }
+  }
+
+  // The default options match the overload without options.
+  EXPECT_EQ(Compress(data).size(), sizes[0]);
+  // Level 0 stores the data, and level 9 compresses at least as well as 1.
+  EXPECT_GT(sizes[1], data.size());
+  EXPECT_LE(sizes[3], sizes[2]);
+}
@@ -7,15 +7,14 @@
 #include "core/fxcodec/icc/icc_transform.h"
 
 #include <stdint.h>
+#include <string.h>
 
 #include <algorithm>
-#include <memory>
 
-#include "core/fxcrt/data_vector.h"
+#include "third_party/base/check.h"
 #include "third_party/base/cxx17_backports.h"
 #include "third_party/base/notreached.h"
 #include "third_party/base/numerics/safe_conversions.h"
-#include "third_party/base/ptr_util.h"
 
 namespace fxcodec {
 
@@ -28,6 +27,11 @@ struct CmsProfileDeleter {
 
 using ScopedCmsProfile = std::unique_ptr<void, CmsProfileDeleter>;
 
+// TranslateScanlineWithLut() samples every 5th level, giving 52 levels per
+// component.
+constexpr int kSampledLevels = 52;
+constexpr int kSampledStep = 5;
+
 bool Check3Components(cmsColorSpaceSignature cs) {
   switch (cs) {
     case cmsSigGrayData:
@@ -47,14 +51,24 @@ IccTransform::IccTransform(cmsHTRANSFORM hTransform,
     : m_hTransform(hTransform),
       m_nSrcComponents(srcComponents),
       m_bLab(bIsLab),
-      m_bNormal(bNormal) {}
+      m_bNormal(bNormal) {
+  // With a single 8-bit component, every possible input fits in a small
+  // table, which gives the same results as running lcms on each pixel.
+  if (m_nSrcComponents == 1 && !m_bLab) {
+    uint8_t inputs[256];
+    for (int i = 0; i < 256; ++i)
+      inputs[i] = static_cast<uint8_t>(i);
+    m_GrayTable = DataVector<uint8_t>(256 * 3);
+    cmsDoTransform(m_hTransform, inputs, m_GrayTable.data(), 256);
+  }
+}
 
 IccTransform::~IccTransform() {
   cmsDeleteTransform(m_hTransform);
 }
 
 // static
-std::unique_ptr<IccTransform> IccTransform::CreateTransformSRGB(
+RetainPtr<IccTransform> IccTransform::CreateTransformSRGB(
     pdfium::span<const uint8_t> span) {
   ScopedCmsProfile srcProfile(cmsOpenProfileFromMem(
       span.data(), pdfium::base::checked_cast<cmsUInt32Number>(span.size())));
@@ -109,9 +123,8 @@ std::unique_ptr<IccTransform> IccTransform::CreateTransformSRGB(
   if (!hTransform)
     return nullptr;
 
-  // Private ctor.
-  return pdfium::WrapUnique(
-      new IccTransform(hTransform, nSrcComponents, bLab, bNormal));
+  return pdfium::MakeRetain<IccTransform>(hTransform, nSrcComponents, bLab,
+                                         bNormal);
 }
 
 void IccTransform::Translate(pdfium::span<const float> pSrcValues,
@@ -132,7 +145,10 @@ void IccTransform::Translate(pdfium::span<const float> pSrcValues,
       inputs[i] =
           pdfium::clamp(static_cast<int>(pSrcValues[i] * 255.0f), 0, 255);
     }
-    cmsDoTransform(m_hTransform, inputs.data(), output, 1);
+    if (m_GrayTable.empty())
+      cmsDoTransform(m_hTransform, inputs.data(), output, 1);
+    else
+      memcpy(output, &m_GrayTable[inputs[0] * 3], 3);
   }
   pDestValues[0] = output[2] / 255.0f;
   pDestValues[1] = output[1] / 255.0f;
@@ -142,7 +158,61 @@ void IccTransform::Translate(pdfium::span<const float> pSrcValues,
 void IccTransform::TranslateScanline(pdfium::span<uint8_t> pDest,
                                      pdfium::span<const uint8_t> pSrc,
                                      int32_t pixels) {
-  cmsDoTransform(m_hTransform, pSrc.data(), pDest.data(), pixels);
+  if (m_GrayTable.empty()) {
+    cmsDoTransform(m_hTransform, pSrc.data(), pDest.data(), pixels);
+    return;
+  }
+
+  uint8_t* dest = pDest.data();
+  const uint8_t* src = pSrc.data();
+  for (int32_t i = 0; i < pixels; ++i) {
+    const uint8_t* bgr = &m_GrayTable[src[i] * 3];
+    dest[0] = bgr[0];
+    dest[1] = bgr[1];
+    dest[2] = bgr[2];
+    dest += 3;
+  }
+}
+
+void IccTransform::TranslateScanlineWithLut(pdfium::span<uint8_t> pDest,
+                                            pdfium::span<const uint8_t> pSrc,
+                                            int32_t pixels) {
+  DCHECK(m_nSrcComponents == 1 || m_nSrcComponents == 3);
+  const int nComponents = m_nSrcComponents;
+  if (m_SampledTable.empty()) {
+    int nMaxColors = 1;
+    for (int i = 0; i < nComponents; ++i)
+      nMaxColors *= kSampledLevels;
+
+    DataVector<uint8_t> samples(nMaxColors * nComponents);
+    size_t src_index = 0;
+    for (int i = 0; i < nMaxColors; ++i) {
+      int color = i;
+      int order = nMaxColors / kSampledLevels;
+      for (int c = 0; c < nComponents; ++c) {
+        samples[src_index++] =
+            static_cast<uint8_t>(color / order * kSampledStep);
+        color %= order;
+        order /= kSampledLevels;
+      }
+    }
+    m_SampledTable = DataVector<uint8_t>(nMaxColors * 3);
+    TranslateScanline(m_SampledTable, samples, nMaxColors);
+  }
+
+  uint8_t* pDestBuf = pDest.data();
+  const uint8_t* pSrcBuf = pSrc.data();
+  for (int32_t i = 0; i < pixels; ++i) {
+    int index = 0;
+    for (int c = 0; c < nComponents; ++c)
+      index = index * kSampledLevels + pSrcBuf[c] / kSampledStep;
+    pSrcBuf += nComponents;
+    const uint8_t* bgr = &m_SampledTable[index * 3];
+    pDestBuf[0] = bgr[0];
+    pDestBuf[1] = bgr[1];
+    pDestBuf[2] = bgr[2];
+    pDestBuf += 3;
+  }
 }
 
 }  // namespace fxcodec
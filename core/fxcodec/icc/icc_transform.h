@@ -9,9 +9,9 @@
 
 #include <stdint.h>
 
-#include <memory>
-
 #include "core/fxcodec/fx_codec_def.h"
+#include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/retain_ptr.h"
 #include "third_party/base/span.h"
 
 #if defined(USE_SYSTEM_LCMS2)
@@ -22,12 +22,12 @@
 
 namespace fxcodec {
 
-class IccTransform {
+class IccTransform final : public Retainable {
  public:
-  static std::unique_ptr<IccTransform> CreateTransformSRGB(
-      pdfium::span<const uint8_t> span);
+  CONSTRUCT_VIA_MAKE_RETAIN;
 
-  ~IccTransform();
+  static RetainPtr<IccTransform> CreateTransformSRGB(
+      pdfium::span<const uint8_t> span);
 
   void Translate(pdfium::span<const float> pSrcValues,
                  pdfium::span<float> pDestValues);
@@ -35,6 +35,14 @@ class IccTransform {
                          pdfium::span<const uint8_t> pSrc,
                          int pixels);
 
+  // Like TranslateScanline(), but looks each pixel up in a table of colors
+  // sampled at every 5th level of each component. The table is built on first
+  // use and shared by everyone using this transform. Only for 1 or 3
+  // components.
+  void TranslateScanlineWithLut(pdfium::span<uint8_t> pDest,
+                                pdfium::span<const uint8_t> pSrc,
+                                int pixels);
+
   int components() const { return m_nSrcComponents; }
   bool IsNormal() const { return m_bNormal; }
 
@@ -43,11 +51,18 @@ class IccTransform {
                int srcComponents,
                bool bIsLab,
                bool bNormal);
+  ~IccTransform() override;
 
   const cmsHTRANSFORM m_hTransform;
   const int m_nSrcComponents;
   const bool m_bLab;
   const bool m_bNormal;
+
+  // BGR output for each of the 256 input values, when there is 1 component.
+  DataVector<uint8_t> m_GrayTable;
+
+  // BGR output for each sampled color, for TranslateScanlineWithLut().
+  DataVector<uint8_t> m_SampledTable;
 };
 
 }  // namespace fxcodec
@@ -0,0 +1,55 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/icc/icc_transform_cache.h"
+
+#include <algorithm>
+
+#include "core/fxcodec/icc/icc_transform.h"
+#include "core/fxcrt/bytestring.h"
+
+namespace fxcodec {
+
+IccTransformCache::IccTransformCache() = default;
+
+IccTransformCache::~IccTransformCache() = default;
+
+RetainPtr<IccTransform> IccTransformCache::GetTransformSRGB(
+    pdfium::span<const uint8_t> span) {
+  const Key key = {FX_HashCode_GetA(ByteStringView(span)), span.size()};
+  auto it = m_Entries.find(key);
+  if (it != m_Entries.end()) {
+    if (std::equal(span.begin(), span.end(), it->second.profile.begin())) {
+      it->second.last_used = ++m_UseCount;
+      return it->second.transform;
+    }
+    // A hash collision. The newer profile takes the slot.
+    m_Entries.erase(it);
+  }
+
+  if (m_Entries.size() >= kMaxEntries) {
+    m_Entries.erase(std::min_element(
+        m_Entries.begin(), m_Entries.end(), [](const auto& a, const auto& b) {
+          return a.second.last_used < b.second.last_used;
+        }));
+  }
+
+  // Profiles lcms rejects are cached too, so they are only parsed once.
+  Entry& entry = m_Entries[key];
+  entry.profile = DataVector<uint8_t>(span.begin(), span.end());
+  entry.transform = IccTransform::CreateTransformSRGB(span);
+  entry.last_used = ++m_UseCount;
+  return entry.transform;
+}
+
+IccTransformCache::Entry::Entry() = default;
+
+IccTransformCache::Entry::Entry(Entry&&) noexcept = default;
+
+IccTransformCache::Entry& IccTransformCache::Entry::operator=(
+    Entry&&) noexcept = default;
+
+IccTransformCache::Entry::~Entry() = default;
+
+}  // namespace fxcodec
@@ -0,0 +1,67 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CORE_FXCODEC_ICC_ICC_TRANSFORM_CACHE_H_
+#define CORE_FXCODEC_ICC_ICC_TRANSFORM_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+
+#include "core/fxcrt/data_vector.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "third_party/base/span.h"
+
+namespace fxcodec {
+
+class IccTransform;
+
+// Shares ICC transforms between profiles with identical data, across
+// documents. Creating a transform parses the profile and builds lcms's
+// optimized pipeline, and print workflows embed the same profile in many
+// images and documents.
+class IccTransformCache {
+ public:
+  static constexpr size_t kMaxEntries = 16;
+
+  IccTransformCache();
+  ~IccTransformCache();
+
+  // Returns the transform from the profile in `span` to sRGB, creating it on
+  // the first request. Returns nullptr if lcms cannot use the profile.
+  RetainPtr<IccTransform> GetTransformSRGB(pdfium::span<const uint8_t> span);
+
+  size_t GetEntryCountForTesting() const { return m_Entries.size(); }
+
+ private:
+  // Every transform uses the perceptual intent and BGR 8-bit output, so the
+  // profile data alone identifies one.
+  struct Key {
+    bool operator<(const Key& that) const {
+      return hash != that.hash ? hash < that.hash : size < that.size;
+    }
+
+    uint32_t hash;
+    size_t size;
+  };
+
+  struct Entry {
+    Entry();
+    Entry(Entry&&) noexcept;
+    Entry& operator=(Entry&&) noexcept;
+    ~Entry();
+
+    DataVector<uint8_t> profile;
+    RetainPtr<IccTransform> transform;
+    uint64_t last_used = 0;
+  };
+
+  uint64_t m_UseCount = 0;
+  std::map<Key, Entry> m_Entries;
+};
+
+}  // namespace fxcodec
+
+#endif  // CORE_FXCODEC_ICC_ICC_TRANSFORM_CACHE_H_
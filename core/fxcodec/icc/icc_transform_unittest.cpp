@@ -0,0 +1,137 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/icc/icc_transform.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "core/fxcodec/icc/icc_transform_cache.h"
+#include "core/fxcrt/retain_ptr.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+std::vector<uint8_t> SaveProfile(cmsHPROFILE profile) {
+  cmsUInt32Number size = 0;
+  EXPECT_TRUE(cmsSaveProfileToMem(profile, nullptr, &size));
+  std::vector<uint8_t> data(size);
+  EXPECT_TRUE(cmsSaveProfileToMem(profile, data.data(), &size));
+  cmsCloseProfile(profile);
+  return data;
+}
+
+std::vector<uint8_t> MakeGrayProfile(double gamma) {
+  cmsToneCurve* curve = cmsBuildGamma(nullptr, gamma);
+  std::vector<uint8_t> data =
+      SaveProfile(cmsCreateGrayProfile(cmsD50_xyY(), curve));
+  cmsFreeToneCurve(curve);
+  return data;
+}
+
+std::vector<uint8_t> MakeRgbProfile() {
+  return SaveProfile(cmsCreate_sRGBProfile());
+}
+
+}  // namespace
+
+TEST(IccTransform, GrayScanlineMatchesLcms) {
+  std::vector<uint8_t> profile_data = MakeGrayProfile(1.8);
+  RetainPtr<fxcodec::IccTransform> transform =
+      fxcodec::IccTransform::CreateTransformSRGB(profile_data);
+  ASSERT_TRUE(transform);
+  ASSERT_EQ(1, transform->components());
+
+  cmsHPROFILE src = cmsOpenProfileFromMem(profile_data.data(),
+                                          profile_data.size());
+  cmsHPROFILE dst = cmsCreate_sRGBProfile();
+  // Same formats as IccTransform uses.
+  cmsHTRANSFORM expected_transform = cmsCreateTransform(
+      src, COLORSPACE_SH(PT_ANY) | CHANNELS_SH(1) | BYTES_SH(1), dst,
+      TYPE_BGR_8, INTENT_PERCEPTUAL, 0);
+  ASSERT_TRUE(expected_transform);
+
+  std::vector<uint8_t> gray(256);
+  for (int i = 0; i < 256; ++i)
+    gray[i] = static_cast<uint8_t>(255 - i);
+  std::vector<uint8_t> expected(256 * 3);
+  std::vector<uint8_t> actual(256 * 3);
+  cmsDoTransform(expected_transform, gray.data(), expected.data(), 256);
+  transform->TranslateScanline(actual, gray, 256);
+  EXPECT_EQ(expected, actual);
+
+  cmsDeleteTransform(expected_transform);
+  cmsCloseProfile(dst);
+  cmsCloseProfile(src);
+}
+
+TEST(IccTransform, ScanlineWithLut) {
+  RetainPtr<fxcodec::IccTransform> transform =
+      fxcodec::IccTransform::CreateTransformSRGB(MakeRgbProfile());
+  ASSERT_TRUE(transform);
+  ASSERT_EQ(3, transform->components());
+
+  // Sampled colors come straight from the table. Others use the sample below.
+  const std::vector<uint8_t> sampled = {0, 5, 10, 100, 200, 255, 25, 30, 35};
+  const std::vector<uint8_t> unsampled = {4, 9, 14, 104, 204, 255, 29, 34, 39};
+  std::vector<uint8_t> expected(9);
+  std::vector<uint8_t> actual(9);
+  transform->TranslateScanline(expected, sampled, 3);
+  transform->TranslateScanlineWithLut(actual, sampled, 3);
+  EXPECT_EQ(expected, actual);
+  transform->TranslateScanlineWithLut(actual, unsampled, 3);
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(IccTransformCache, SharesTransforms) {
+  fxcodec::IccTransformCache cache;
+  std::vector<uint8_t> gray = MakeGrayProfile(2.2);
+  std::vector<uint8_t> rgb = MakeRgbProfile();
+
+  RetainPtr<fxcodec::IccTransform> gray_transform =
+      cache.GetTransformSRGB(gray);
+  ASSERT_TRUE(gray_transform);
+  RetainPtr<fxcodec::IccTransform> rgb_transform = cache.GetTransformSRGB(rgb);
+  ASSERT_TRUE(rgb_transform);
+  EXPECT_NE(gray_transform, rgb_transform);
+
+  // A separate copy of the same data shares the transform.
+  std::vector<uint8_t> gray_copy = gray;
+  EXPECT_EQ(gray_transform, cache.GetTransformSRGB(gray_copy));
+  EXPECT_EQ(rgb_transform, cache.GetTransformSRGB(rgb));
+  EXPECT_EQ(2u, cache.GetEntryCountForTesting());
+
+  const std::vector<uint8_t> garbage(200, 0x42);
+  EXPECT_FALSE(cache.GetTransformSRGB(garbage));
+  EXPECT_FALSE(cache.GetTransformSRGB(garbage));
+  EXPECT_EQ(3u, cache.GetEntryCountForTesting());
+}
+
+TEST(IccTransformCache, EvictsLeastRecentlyUsed) {
+  fxcodec::IccTransformCache cache;
+  std::vector<uint8_t> first = MakeGrayProfile(1.0);
+  RetainPtr<fxcodec::IccTransform> first_transform =
+      cache.GetTransformSRGB(first);
+  ASSERT_TRUE(first_transform);
+
+  std::vector<uint8_t> second = MakeGrayProfile(1.1);
+  RetainPtr<fxcodec::IccTransform> second_transform =
+      cache.GetTransformSRGB(second);
+  for (size_t i = 2; i < fxcodec::IccTransformCache::kMaxEntries; ++i)
+    EXPECT_TRUE(cache.GetTransformSRGB(MakeGrayProfile(1.0 + i / 10.0)));
+  EXPECT_EQ(first_transform, cache.GetTransformSRGB(first));
+  EXPECT_EQ(fxcodec::IccTransformCache::kMaxEntries,
+            cache.GetEntryCountForTesting());
+
+  // `second` is now the least recently used, so it makes room.
+  EXPECT_TRUE(cache.GetTransformSRGB(MakeGrayProfile(3.0)));
+  EXPECT_EQ(fxcodec::IccTransformCache::kMaxEntries,
+            cache.GetEntryCountForTesting());
+  EXPECT_EQ(first_transform, cache.GetTransformSRGB(first));
+  RetainPtr<fxcodec::IccTransform> new_second_transform =
+      cache.GetTransformSRGB(second);
+  ASSERT_TRUE(new_second_transform);
+  EXPECT_NE(second_transform, new_second_transform);
+}
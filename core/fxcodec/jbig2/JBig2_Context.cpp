@@ -10,7 +10,6 @@
 
 #include <algorithm>
 #include <limits>
-#include <list>
 #include <utility>
 #include <vector>
 
@@ -40,41 +39,30 @@ size_t GetRefAggContextSize(bool val) {
 
 }  // namespace
 
-// Implement a very small least recently used (LRU) cache. It is very
-// common for a JBIG2 dictionary to span multiple pages in a PDF file,
-// and we do not want to decode the same dictionary over and over
-// again. We key off of the memory location of the dictionary. The
-// list keeps track of the freshness of entries, with freshest ones
-// at the front. Even a tiny cache size like 2 makes a dramatic
-// difference for typical JBIG2 documents.
-static const size_t kSymbolDictCacheMaxSize = 2;
-static_assert(kSymbolDictCacheMaxSize > 0,
-              "Symbol Dictionary Cache must have non-zero size");
-
 // static
 std::unique_ptr<CJBig2_Context> CJBig2_Context::Create(
     pdfium::span<const uint8_t> pGlobalSpan,
     uint64_t global_key,
     pdfium::span<const uint8_t> pSrcSpan,
     uint64_t src_key,
-    std::list<CJBig2_CachePair>* pSymbolDictCache) {
+    JBig2_DocumentContext* pDocumentContext) {
   auto result = pdfium::WrapUnique(
-      new CJBig2_Context(pSrcSpan, src_key, pSymbolDictCache, false));
+      new CJBig2_Context(pSrcSpan, src_key, pDocumentContext, false));
   if (!pGlobalSpan.empty()) {
     result->m_pGlobalContext = pdfium::WrapUnique(
-        new CJBig2_Context(pGlobalSpan, global_key, pSymbolDictCache, true));
+        new CJBig2_Context(pGlobalSpan, global_key, pDocumentContext, true));
   }
   return result;
 }
 
 CJBig2_Context::CJBig2_Context(pdfium::span<const uint8_t> pSrcSpan,
                                uint64_t src_key,
-                               std::list<CJBig2_CachePair>* pSymbolDictCache,
+                               JBig2_DocumentContext* pDocumentContext,
                                bool bIsGlobal)
     : m_pStream(std::make_unique<CJBig2_BitStream>(pSrcSpan, src_key)),
       m_HuffmanTables(CJBig2_HuffmanTable::kNumHuffmanTables),
       m_bIsGlobal(bIsGlobal),
-      m_pSymbolDictCache(pSymbolDictCache) {}
+      m_pDocumentContext(pDocumentContext) {}
 
 CJBig2_Context::~CJBig2_Context() = default;
 
@@ -521,23 +509,14 @@ JBig2_Result CJBig2_Context::ParseSymbolDict(CJBig2_Segment* pSegment) {
       grContext.resize(grContextSize);
   }
 
+  // Global dictionaries are often shared by many pages, so keep decoded
+  // copies in the document context. They are keyed by the stream they come
+  // from and their offset within it.
   CJBig2_CompoundKey key(pSegment->m_Key, pSegment->m_dwDataOffset);
-  bool cache_hit = false;
   pSegment->m_nResultType = JBIG2_SYMBOL_DICT_POINTER;
-  if (m_bIsGlobal && key.first != 0) {
-    for (auto it = m_pSymbolDictCache->begin(); it != m_pSymbolDictCache->end();
-         ++it) {
-      if (it->first == key) {
-        pSegment->m_SymbolDict = it->second->DeepCopy();
-        m_pSymbolDictCache->push_front(
-            CJBig2_CachePair(key, std::move(it->second)));
-        m_pSymbolDictCache->erase(it);
-        cache_hit = true;
-        break;
-      }
-    }
-  }
-  if (!cache_hit) {
+  if (m_bIsGlobal && key.first != 0)
+    pSegment->m_SymbolDict = m_pDocumentContext->GetSymbolDict(key);
+  if (!pSegment->m_SymbolDict) {
     if (bUseGbContext) {
       auto pArithDecoder =
           std::make_unique<CJBig2_ArithDecoder>(m_pStream.get());
@@ -555,16 +534,8 @@ JBig2_Result CJBig2_Context::ParseSymbolDict(CJBig2_Segment* pSegment) {
         return JBig2_Result::kFailure;
       m_pStream->alignByte();
     }
-    if (m_bIsGlobal) {
-      std::unique_ptr<CJBig2_SymbolDict> value =
-          pSegment->m_SymbolDict->DeepCopy();
-      size_t size = m_pSymbolDictCache->size();
-      while (size >= kSymbolDictCacheMaxSize) {
-        m_pSymbolDictCache->pop_back();
-        --size;
-      }
-      m_pSymbolDictCache->push_front(CJBig2_CachePair(key, std::move(value)));
-    }
+    if (m_bIsGlobal)
+      m_pDocumentContext->PutSymbolDict(key, *pSegment->m_SymbolDict);
   }
   if (wFlags & 0x0200) {
     if (bUseGbContext)
@@ -7,7 +7,6 @@
 #ifndef CORE_FXCODEC_JBIG2_JBIG2_CONTEXT_H_
 #define CORE_FXCODEC_JBIG2_JBIG2_CONTEXT_H_
 
-#include <list>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -34,7 +33,7 @@ class CJBig2_Context {
       uint64_t global_key,
       pdfium::span<const uint8_t> pSrcSpan,
       uint64_t src_key,
-      std::list<CJBig2_CachePair>* pSymbolDictCache);
+      JBig2_DocumentContext* pDocumentContext);
 
   ~CJBig2_Context();
 
@@ -52,7 +51,7 @@ class CJBig2_Context {
  private:
   CJBig2_Context(pdfium::span<const uint8_t> pSrcSpan,
                  uint64_t src_key,
-                 std::list<CJBig2_CachePair>* pSymbolDictCache,
+                 JBig2_DocumentContext* pDocumentContext,
                  bool bIsGlobal);
 
   JBig2_Result DecodeSequential(PauseIndicatorIface* pPause);
@@ -98,7 +97,7 @@ class CJBig2_Context {
   std::unique_ptr<CJBig2_Segment> m_pSegment;
   uint32_t m_nOffset = 0;
   JBig2RegionInfo m_ri;
-  UnownedPtr<std::list<CJBig2_CachePair>> const m_pSymbolDictCache;
+  UnownedPtr<JBig2_DocumentContext> const m_pDocumentContext;
 };
 
 #endif  // CORE_FXCODEC_JBIG2_JBIG2_CONTEXT_H_
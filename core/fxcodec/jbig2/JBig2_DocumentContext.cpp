@@ -6,9 +6,79 @@
 
 #include "core/fxcodec/jbig2/JBig2_DocumentContext.h"
 
+#include <algorithm>
+
 #include "core/fxcodec/jbig2/JBig2_Image.h"
 #include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
 
-JBig2_DocumentContext::JBig2_DocumentContext() = default;
+namespace {
+
+size_t g_SymbolDictCacheBudget =
+    JBig2_DocumentContext::kDefaultSymbolDictCacheBudget;
+
+}  // namespace
+
+// static
+void JBig2_DocumentContext::SetSymbolDictCacheBudget(size_t budget) {
+  g_SymbolDictCacheBudget = budget;
+}
+
+JBig2_DocumentContext::JBig2_DocumentContext()
+    : m_SymbolDictCacheBudget(g_SymbolDictCacheBudget) {}
 
 JBig2_DocumentContext::~JBig2_DocumentContext() = default;
+
+std::unique_ptr<CJBig2_SymbolDict> JBig2_DocumentContext::GetSymbolDict(
+    const CJBig2_CompoundKey& key) {
+  auto it = m_SymbolDictCache.find(key);
+  if (it == m_SymbolDictCache.end()) {
+    ++m_SymbolDictCacheStats.misses;
+    return nullptr;
+  }
+
+  ++m_SymbolDictCacheStats.hits;
+  it->second.last_used = ++m_UseCount;
+  return it->second.dict->DeepCopy();
+}
+
+void JBig2_DocumentContext::PutSymbolDict(const CJBig2_CompoundKey& key,
+                                          const CJBig2_SymbolDict& dict) {
+  const size_t size = dict.GetEstimatedSize();
+  if (size > m_SymbolDictCacheBudget)
+    return;
+
+  auto existing = m_SymbolDictCache.find(key);
+  if (existing != m_SymbolDictCache.end()) {
+    m_SymbolDictCacheStats.bytes -= existing->second.size;
+    m_SymbolDictCache.erase(existing);
+  }
+
+  // Eviction scans every entry, but only runs on a miss, when a whole
+  // dictionary has just been decoded.
+  while (m_SymbolDictCacheStats.bytes + size > m_SymbolDictCacheBudget) {
+    auto oldest = std::min_element(
+        m_SymbolDictCache.begin(), m_SymbolDictCache.end(),
+        [](const auto& a, const auto& b) {
+          return a.second.last_used < b.second.last_used;
+        });
+    m_SymbolDictCacheStats.bytes -= oldest->second.size;
+    m_SymbolDictCache.erase(oldest);
+    ++m_SymbolDictCacheStats.evictions;
+  }
+
+  CacheEntry& entry = m_SymbolDictCache[key];
+  entry.dict = dict.DeepCopy();
+  entry.size = size;
+  entry.last_used = ++m_UseCount;
+  m_SymbolDictCacheStats.bytes += size;
+  m_SymbolDictCacheStats.entries = m_SymbolDictCache.size();
+}
+
+JBig2_DocumentContext::CacheEntry::CacheEntry() = default;
+
+JBig2_DocumentContext::CacheEntry::CacheEntry(CacheEntry&&) noexcept = default;
+
+JBig2_DocumentContext::CacheEntry&
+JBig2_DocumentContext::CacheEntry::operator=(CacheEntry&&) noexcept = default;
+
+JBig2_DocumentContext::CacheEntry::~CacheEntry() = default;
@@ -7,7 +7,10 @@
 #ifndef CORE_FXCODEC_JBIG2_JBIG2_DOCUMENTCONTEXT_H_
 #define CORE_FXCODEC_JBIG2_JBIG2_DOCUMENTCONTEXT_H_
 
-#include <list>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
 #include <memory>
 #include <utility>
 
@@ -15,21 +18,58 @@ class CJBig2_SymbolDict;
 
 // Cache is keyed by both the key of a stream and an index within the stream.
 using CJBig2_CompoundKey = std::pair<uint64_t, uint32_t>;
-using CJBig2_CachePair =
-    std::pair<CJBig2_CompoundKey, std::unique_ptr<CJBig2_SymbolDict>>;
 
 // Holds per-document JBig2 related data.
 class JBig2_DocumentContext {
  public:
+  struct SymbolDictCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t bytes = 0;
+  };
+
+  static constexpr size_t kDefaultSymbolDictCacheBudget = 64 * 1024 * 1024;
+
+  // Sets the number of bytes of decoded global symbol dictionaries that each
+  // document created afterwards keeps for reuse across pages. 0 disables the
+  // cache.
+  static void SetSymbolDictCacheBudget(size_t budget);
+
   JBig2_DocumentContext();
   ~JBig2_DocumentContext();
 
-  std::list<CJBig2_CachePair>* GetSymbolDictCache() {
-    return &m_SymbolDictCache;
+  // Returns a copy of the dictionary cached for `key`, or nullptr on a miss.
+  std::unique_ptr<CJBig2_SymbolDict> GetSymbolDict(
+      const CJBig2_CompoundKey& key);
+
+  // Caches a copy of `dict` for `key`, evicting the least recently used
+  // dictionaries to stay within budget. Dictionaries larger than the whole
+  // budget are not cached.
+  void PutSymbolDict(const CJBig2_CompoundKey& key,
+                     const CJBig2_SymbolDict& dict);
+
+  const SymbolDictCacheStats& GetSymbolDictCacheStats() const {
+    return m_SymbolDictCacheStats;
   }
 
  private:
-  std::list<CJBig2_CachePair> m_SymbolDictCache;
+  struct CacheEntry {
+    CacheEntry();
+    CacheEntry(CacheEntry&&) noexcept;
+    CacheEntry& operator=(CacheEntry&&) noexcept;
+    ~CacheEntry();
+
+    std::unique_ptr<CJBig2_SymbolDict> dict;
+    size_t size = 0;
+    uint64_t last_used = 0;
+  };
+
+  const size_t m_SymbolDictCacheBudget;
+  uint64_t m_UseCount = 0;
+  std::map<CJBig2_CompoundKey, CacheEntry> m_SymbolDictCache;
+  SymbolDictCacheStats m_SymbolDictCacheStats;
 };
 
 #endif  // CORE_FXCODEC_JBIG2_JBIG2_DOCUMENTCONTEXT_H_
@@ -0,0 +1,114 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jbig2/JBig2_DocumentContext.h"
+
+#include <memory>
+
+#include "core/fxcodec/jbig2/JBig2_Image.h"
+#include "core/fxcodec/jbig2/JBig2_SymbolDict.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+// Makes a dictionary of `count` 32x32 symbols, each 128 bytes of pixels.
+std::unique_ptr<CJBig2_SymbolDict> MakeDict(int count) {
+  auto dict = std::make_unique<CJBig2_SymbolDict>();
+  for (int i = 0; i < count; ++i) {
+    auto image = std::make_unique<CJBig2_Image>(32, 32);
+    image->SetPixel(i, i, 1);
+    dict->AddImage(std::move(image));
+  }
+  return dict;
+}
+
+class ScopedSymbolDictCacheBudget {
+ public:
+  explicit ScopedSymbolDictCacheBudget(size_t budget) {
+    JBig2_DocumentContext::SetSymbolDictCacheBudget(budget);
+  }
+  ~ScopedSymbolDictCacheBudget() {
+    JBig2_DocumentContext::SetSymbolDictCacheBudget(
+        JBig2_DocumentContext::kDefaultSymbolDictCacheBudget);
+  }
+};
+
+}  // namespace
+
+TEST(JBig2DocumentContext, SymbolDictCacheHit) {
+  JBig2_DocumentContext context;
+  const CJBig2_CompoundKey key(1, 0);
+  EXPECT_FALSE(context.GetSymbolDict(key));
+
+  std::unique_ptr<CJBig2_SymbolDict> dict = MakeDict(3);
+  context.PutSymbolDict(key, *dict);
+  for (int page = 0; page < 5; ++page) {
+    std::unique_ptr<CJBig2_SymbolDict> cached = context.GetSymbolDict(key);
+    ASSERT_TRUE(cached);
+    ASSERT_EQ(3u, cached->NumImages());
+    EXPECT_NE(dict->GetImage(2), cached->GetImage(2));
+    EXPECT_EQ(1, cached->GetImage(2)->GetPixel(2, 2));
+  }
+  EXPECT_FALSE(context.GetSymbolDict(CJBig2_CompoundKey(1, 4)));
+
+  const auto& stats = context.GetSymbolDictCacheStats();
+  EXPECT_EQ(5u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(0u, stats.evictions);
+  EXPECT_EQ(1u, stats.entries);
+  EXPECT_EQ(dict->GetEstimatedSize(), stats.bytes);
+}
+
+TEST(JBig2DocumentContext, SymbolDictCacheKeepsManyDictionaries) {
+  // Far more than the two dictionaries the cache used to hold.
+  JBig2_DocumentContext context;
+  std::unique_ptr<CJBig2_SymbolDict> dict = MakeDict(1);
+  for (uint64_t chapter = 1; chapter <= 20; ++chapter)
+    context.PutSymbolDict(CJBig2_CompoundKey(chapter, 0), *dict);
+  for (uint64_t chapter = 1; chapter <= 20; ++chapter)
+    EXPECT_TRUE(context.GetSymbolDict(CJBig2_CompoundKey(chapter, 0)));
+  EXPECT_EQ(20u, context.GetSymbolDictCacheStats().entries);
+  EXPECT_EQ(0u, context.GetSymbolDictCacheStats().evictions);
+}
+
+TEST(JBig2DocumentContext, SymbolDictCacheEvictsLeastRecentlyUsed) {
+  const size_t size = MakeDict(4)->GetEstimatedSize();
+  ScopedSymbolDictCacheBudget budget(size * 2);
+  JBig2_DocumentContext context;
+  const CJBig2_CompoundKey key1(1, 0);
+  const CJBig2_CompoundKey key2(2, 0);
+  const CJBig2_CompoundKey key3(3, 0);
+  context.PutSymbolDict(key1, *MakeDict(4));
+  context.PutSymbolDict(key2, *MakeDict(4));
+  EXPECT_TRUE(context.GetSymbolDict(key1));
+
+  context.PutSymbolDict(key3, *MakeDict(4));
+  EXPECT_TRUE(context.GetSymbolDict(key1));
+  EXPECT_FALSE(context.GetSymbolDict(key2));
+  EXPECT_TRUE(context.GetSymbolDict(key3));
+
+  const auto& stats = context.GetSymbolDictCacheStats();
+  EXPECT_EQ(1u, stats.evictions);
+  EXPECT_EQ(2u, stats.entries);
+  EXPECT_EQ(size * 2, stats.bytes);
+}
+
+TEST(JBig2DocumentContext, SymbolDictCacheBudget) {
+  {
+    ScopedSymbolDictCacheBudget budget(0);
+    JBig2_DocumentContext context;
+    context.PutSymbolDict(CJBig2_CompoundKey(1, 0), *MakeDict(1));
+    EXPECT_FALSE(context.GetSymbolDict(CJBig2_CompoundKey(1, 0)));
+    EXPECT_EQ(0u, context.GetSymbolDictCacheStats().entries);
+  }
+  {
+    // Too large for the budget on its own.
+    ScopedSymbolDictCacheBudget budget(MakeDict(1)->GetEstimatedSize());
+    JBig2_DocumentContext context;
+    context.PutSymbolDict(CJBig2_CompoundKey(1, 0), *MakeDict(1));
+    context.PutSymbolDict(CJBig2_CompoundKey(2, 0), *MakeDict(2));
+    EXPECT_TRUE(context.GetSymbolDict(CJBig2_CompoundKey(1, 0)));
+    EXPECT_FALSE(context.GetSymbolDict(CJBig2_CompoundKey(2, 0)));
+  }
+}
@@ -16,6 +16,7 @@
 #include "core/fxcrt/fx_memory.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "third_party/base/check.h"
+#include "third_party/base/notreached.h"
 
 #define JBIG2_GETDWORD(buf)                  \
   ((static_cast<uint32_t>((buf)[0]) << 24) | \
@@ -42,6 +43,32 @@ int BitIndexToAlignedByte(int index) {
   return index / 32 * 4;
 }
 
+// The op is a template parameter so the compose loops below compile to
+// straight-line word operations, with no per-word switch.
+template <JBig2ComposeOp op>
+uint32_t ComposeWord(uint32_t src, uint32_t dst) {
+  switch (op) {
+    case JBIG2_COMPOSE_OR:
+      return dst | src;
+    case JBIG2_COMPOSE_AND:
+      return dst & src;
+    case JBIG2_COMPOSE_XOR:
+      return dst ^ src;
+    case JBIG2_COMPOSE_XNOR:
+      return ~(dst ^ src);
+    case JBIG2_COMPOSE_REPLACE:
+      return src;
+  }
+  NOTREACHED();
+  return 0;
+}
+
+// Composes only the bits set in `mask`, keeping the rest of `dst`.
+template <JBig2ComposeOp op>
+uint32_t ComposeWordWithMask(uint32_t src, uint32_t dst, uint32_t mask) {
+  return (dst & ~mask) | (ComposeWord<op>(src, dst) & mask);
+}
+
 }  // namespace
 
 CJBig2_Image::CJBig2_Image(int32_t w, int32_t h) {
@@ -268,6 +295,29 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
                                      const FX_RECT& rtSrc) {
   DCHECK(m_pData);
 
+  switch (op) {
+    case JBIG2_COMPOSE_OR:
+      return ComposeToInternalWithOp<JBIG2_COMPOSE_OR>(pDst, x, y, rtSrc);
+    case JBIG2_COMPOSE_AND:
+      return ComposeToInternalWithOp<JBIG2_COMPOSE_AND>(pDst, x, y, rtSrc);
+    case JBIG2_COMPOSE_XOR:
+      return ComposeToInternalWithOp<JBIG2_COMPOSE_XOR>(pDst, x, y, rtSrc);
+    case JBIG2_COMPOSE_XNOR:
+      return ComposeToInternalWithOp<JBIG2_COMPOSE_XNOR>(pDst, x, y, rtSrc);
+    case JBIG2_COMPOSE_REPLACE:
+      return ComposeToInternalWithOp<JBIG2_COMPOSE_REPLACE>(pDst, x, y,
+                                                            rtSrc);
+  }
+  // Halftone regions can carry combination operators outside the spec's
+  // range. Those have no defined result, so leave the destination alone.
+  return false;
+}
+
+template <JBig2ComposeOp op>
+bool CJBig2_Image::ComposeToInternalWithOp(CJBig2_Image* pDst,
+                                           int32_t x,
+                                           int32_t y,
+                                           const FX_RECT& rtSrc) {
   // TODO(weili): Check whether the range check is correct. Should x>=1048576?
   if (x < -1048576 || x > 1048576 || y < -1048576 || y > 1048576)
     return false;
@@ -322,24 +372,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
             return false;
           uint32_t tmp1 = JBIG2_GETDWORD(lineSrc) << shift;
           uint32_t tmp2 = JBIG2_GETDWORD(lineDst);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskM) | ((tmp1 | tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskM) | ((tmp1 & tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskM) | ((tmp1 ^ tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskM) | ((~(tmp1 ^ tmp2)) & maskM);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskM) | (tmp1 & maskM);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskM);
           JBIG2_PUTDWORD(lineDst, tmp);
           lineSrc += m_nStride;
           lineDst += pDst->m_nStride;
@@ -351,24 +384,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
             return false;
           uint32_t tmp1 = JBIG2_GETDWORD(lineSrc) >> shift;
           uint32_t tmp2 = JBIG2_GETDWORD(lineDst);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskM) | ((tmp1 | tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskM) | ((tmp1 & tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskM) | ((tmp1 ^ tmp2) & maskM);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskM) | ((~(tmp1 ^ tmp2)) & maskM);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskM) | (tmp1 & maskM);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskM);
           JBIG2_PUTDWORD(lineDst, tmp);
           lineSrc += m_nStride;
           lineDst += pDst->m_nStride;
@@ -383,24 +399,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
         uint32_t tmp1 = (JBIG2_GETDWORD(lineSrc) << shift1) |
                         (JBIG2_GETDWORD(lineSrc + 4) >> shift2);
         uint32_t tmp2 = JBIG2_GETDWORD(lineDst);
-        uint32_t tmp = 0;
-        switch (op) {
-          case JBIG2_COMPOSE_OR:
-            tmp = (tmp2 & ~maskM) | ((tmp1 | tmp2) & maskM);
-            break;
-          case JBIG2_COMPOSE_AND:
-            tmp = (tmp2 & ~maskM) | ((tmp1 & tmp2) & maskM);
-            break;
-          case JBIG2_COMPOSE_XOR:
-            tmp = (tmp2 & ~maskM) | ((tmp1 ^ tmp2) & maskM);
-            break;
-          case JBIG2_COMPOSE_XNOR:
-            tmp = (tmp2 & ~maskM) | ((~(tmp1 ^ tmp2)) & maskM);
-            break;
-          case JBIG2_COMPOSE_REPLACE:
-            tmp = (tmp2 & ~maskM) | (tmp1 & maskM);
-            break;
-        }
+        uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskM);
         JBIG2_PUTDWORD(lineDst, tmp);
         lineSrc += m_nStride;
         lineDst += pDst->m_nStride;
@@ -420,24 +419,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
           uint32_t tmp1 = (JBIG2_GETDWORD(sp) << shift1) |
                           (JBIG2_GETDWORD(sp + 4) >> shift2);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 | tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskL) | ((tmp1 & tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 ^ tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskL) | ((~(tmp1 ^ tmp2)) & maskL);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskL) | (tmp1 & maskL);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskL);
           JBIG2_PUTDWORD(dp, tmp);
           sp += 4;
           dp += 4;
@@ -446,24 +428,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
           uint32_t tmp1 = (JBIG2_GETDWORD(sp) << shift1) |
                           (JBIG2_GETDWORD(sp + 4) >> shift2);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = tmp1 | tmp2;
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = tmp1 & tmp2;
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = tmp1 ^ tmp2;
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = ~(tmp1 ^ tmp2);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = tmp1;
-              break;
-          }
+          uint32_t tmp = ComposeWord<op>(tmp1, tmp2);
           JBIG2_PUTDWORD(dp, tmp);
           sp += 4;
           dp += 4;
@@ -474,24 +439,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
               (((sp + 4) < lineSrc + lineLeft ? JBIG2_GETDWORD(sp + 4) : 0) >>
                shift2);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 | tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskR) | ((tmp1 & tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 ^ tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskR) | ((~(tmp1 ^ tmp2)) & maskR);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskR) | (tmp1 & maskR);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskR);
           JBIG2_PUTDWORD(dp, tmp);
         }
         lineSrc += m_nStride;
@@ -507,24 +455,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
         if (d1 != 0) {
           uint32_t tmp1 = JBIG2_GETDWORD(sp);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 | tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskL) | ((tmp1 & tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 ^ tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskL) | ((~(tmp1 ^ tmp2)) & maskL);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskL) | (tmp1 & maskL);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskL);
           JBIG2_PUTDWORD(dp, tmp);
           sp += 4;
           dp += 4;
@@ -532,24 +463,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
         for (int32_t xx = 0; xx < middleDwords; xx++) {
           uint32_t tmp1 = JBIG2_GETDWORD(sp);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = tmp1 | tmp2;
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = tmp1 & tmp2;
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = tmp1 ^ tmp2;
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = ~(tmp1 ^ tmp2);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = tmp1;
-              break;
-          }
+          uint32_t tmp = ComposeWord<op>(tmp1, tmp2);
           JBIG2_PUTDWORD(dp, tmp);
           sp += 4;
           dp += 4;
@@ -557,24 +471,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
         if (d2 != 0) {
           uint32_t tmp1 = JBIG2_GETDWORD(sp);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 | tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskR) | ((tmp1 & tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 ^ tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskR) | ((~(tmp1 ^ tmp2)) & maskR);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskR) | (tmp1 & maskR);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskR);
           JBIG2_PUTDWORD(dp, tmp);
         }
         lineSrc += m_nStride;
@@ -592,24 +489,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
         if (d1 != 0) {
           uint32_t tmp1 = JBIG2_GETDWORD(sp) >> shift1;
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 | tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskL) | ((tmp1 & tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskL) | ((tmp1 ^ tmp2) & maskL);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskL) | ((~(tmp1 ^ tmp2)) & maskL);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskL) | (tmp1 & maskL);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskL);
           JBIG2_PUTDWORD(dp, tmp);
           dp += 4;
         }
@@ -617,24 +497,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
           uint32_t tmp1 = (JBIG2_GETDWORD(sp) << shift2) |
                           ((JBIG2_GETDWORD(sp + 4)) >> shift1);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = tmp1 | tmp2;
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = tmp1 & tmp2;
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = tmp1 ^ tmp2;
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = ~(tmp1 ^ tmp2);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = tmp1;
-              break;
-          }
+          uint32_t tmp = ComposeWord<op>(tmp1, tmp2);
           JBIG2_PUTDWORD(dp, tmp);
           sp += 4;
           dp += 4;
@@ -645,24 +508,7 @@ bool CJBig2_Image::ComposeToInternal(CJBig2_Image* pDst,
               (((sp + 4) < lineSrc + lineLeft ? JBIG2_GETDWORD(sp + 4) : 0) >>
                shift1);
           uint32_t tmp2 = JBIG2_GETDWORD(dp);
-          uint32_t tmp = 0;
-          switch (op) {
-            case JBIG2_COMPOSE_OR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 | tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_AND:
-              tmp = (tmp2 & ~maskR) | ((tmp1 & tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XOR:
-              tmp = (tmp2 & ~maskR) | ((tmp1 ^ tmp2) & maskR);
-              break;
-            case JBIG2_COMPOSE_XNOR:
-              tmp = (tmp2 & ~maskR) | ((~(tmp1 ^ tmp2)) & maskR);
-              break;
-            case JBIG2_COMPOSE_REPLACE:
-              tmp = (tmp2 & ~maskR) | (tmp1 & maskR);
-              break;
-          }
+          uint32_t tmp = ComposeWordWithMask<op>(tmp1, tmp2, maskR);
           JBIG2_PUTDWORD(dp, tmp);
         }
         lineSrc += m_nStride;
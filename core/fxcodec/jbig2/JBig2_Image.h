@@ -85,6 +85,11 @@ class CJBig2_Image {
                          int32_t y,
                          JBig2ComposeOp op,
                          const FX_RECT& rtSrc);
+  template <JBig2ComposeOp op>
+  bool ComposeToInternalWithOp(CJBig2_Image* pDst,
+                               int32_t x,
+                               int32_t y,
+                               const FX_RECT& rtSrc);
 
   MaybeOwned<uint8_t, FxFreeDeleter> m_pData;
   int32_t m_nWidth = 0;   // 1-bit pixels
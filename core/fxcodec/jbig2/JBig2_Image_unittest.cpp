@@ -350,3 +350,80 @@ TEST(fxcodec, JBig2CopyLine) {
 
   CheckImageEq(expected.get(), img.get(), __LINE__);
 }
+
+TEST(fxcodec, JBig2ComposeTo) {
+  static constexpr JBig2ComposeOp kOps[] = {
+      JBIG2_COMPOSE_OR, JBIG2_COMPOSE_AND, JBIG2_COMPOSE_XOR,
+      JBIG2_COMPOSE_XNOR, JBIG2_COMPOSE_REPLACE};
+  // Destination offsets that land in one word, straddle two words, and cover
+  // whole words, each with the source shifted left, right, or not at all.
+  static constexpr int32_t kOffsets[] = {-3, 0, 5, 13, 32, 40};
+  for (JBig2ComposeOp op : kOps) {
+    for (int32_t width : {7, 20, 70}) {
+      for (int32_t x : kOffsets) {
+        SCOPED_TRACE(testing::Message() << op << " " << width << " " << x);
+        CJBig2_Image src(width, 3);
+        CJBig2_Image dst(kWidthPixels, 4);
+        for (int32_t y = 0; y < 3; ++y) {
+          for (int32_t i = 0; i < width; ++i)
+            src.SetPixel(i, y, (i * 7 + y * 3) % 5 < 2);
+        }
+        for (int32_t y = 0; y < 4; ++y) {
+          for (int32_t i = 0; i < kWidthPixels; ++i)
+            dst.SetPixel(i, y, (i + y) % 3 == 0);
+        }
+        CJBig2_Image expected(kWidthPixels, 4);
+        for (int32_t y = 0; y < 4; ++y) {
+          for (int32_t i = 0; i < kWidthPixels; ++i) {
+            int d = dst.GetPixel(i, y);
+            int s = src.GetPixel(i - x, y - 1);
+            if (i - x >= 0 && i - x < width && y >= 1) {
+              switch (op) {
+                case JBIG2_COMPOSE_OR:
+                  d |= s;
+                  break;
+                case JBIG2_COMPOSE_AND:
+                  d &= s;
+                  break;
+                case JBIG2_COMPOSE_XOR:
+                  d ^= s;
+                  break;
+                case JBIG2_COMPOSE_XNOR:
+                  d = !(d ^ s);
+                  break;
+                case JBIG2_COMPOSE_REPLACE:
+                  d = s;
+                  break;
+              }
+            }
+            expected.SetPixel(i, y, d);
+          }
+        }
+
+        EXPECT_TRUE(src.ComposeTo(&dst, x, 1, op));
+        CheckImageEq(&expected, &dst, __LINE__);
+      }
+    }
+  }
+}
+
+TEST(fxcodec, JBig2ComposeToInvalidOp) {
+  CJBig2_Image src(20, 3);
+  CJBig2_Image dst(kWidthPixels, 4);
+  for (int32_t y = 0; y < 3; ++y) {
+    for (int32_t i = 0; i < 20; ++i)
+      src.SetPixel(i, y, (i + y) % 2);
+  }
+  for (int32_t y = 0; y < 4; ++y) {
+    for (int32_t i = 0; i < kWidthPixels; ++i)
+      dst.SetPixel(i, y, (i + y) % 3 == 0);
+  }
+  CJBig2_Image expected(dst);
+
+  // A halftone region's 3-bit operator field can hold 5 to 7.
+  for (int op = JBIG2_COMPOSE_REPLACE + 1; op < 8; ++op) {
+    SCOPED_TRACE(op);
+    EXPECT_FALSE(src.ComposeTo(&dst, 5, 1, static_cast<JBig2ComposeOp>(op)));
+    CheckImageEq(&expected, &dst, __LINE__);
+  }
+}
@@ -22,3 +22,15 @@ std::unique_ptr<CJBig2_SymbolDict> CJBig2_SymbolDict::DeepCopy() const {
   dst->m_grContext = m_grContext;
   return dst;
 }
+
+size_t CJBig2_SymbolDict::GetEstimatedSize() const {
+  size_t size = sizeof(*this) +
+                (m_gbContext.size() + m_grContext.size()) *
+                    sizeof(JBig2ArithCtx) +
+                m_SDEXSYMS.size() * sizeof(CJBig2_Image);
+  for (const auto& image : m_SDEXSYMS) {
+    if (image)
+      size += static_cast<size_t>(image->stride()) * image->height();
+  }
+  return size;
+}
@@ -22,6 +22,9 @@ class CJBig2_SymbolDict {
 
   std::unique_ptr<CJBig2_SymbolDict> DeepCopy() const;
 
+  // Returns roughly how many bytes the symbol images and contexts occupy.
+  size_t GetEstimatedSize() const;
+
   void AddImage(std::unique_ptr<CJBig2_Image> image) {
     m_SDEXSYMS.push_back(std::move(image));
   }
@@ -61,7 +61,7 @@ FXCODEC_STATUS Jbig2Decoder::StartDecode(
   memset(dest_buf, 0, height * dest_pitch);
   pJbig2Context->m_pContext =
       CJBig2_Context::Create(global_span, global_key, src_span, src_key,
-                             pJBig2DocumentContext->GetSymbolDictCache());
+                             pJBig2DocumentContext);
   bool succeeded = pJbig2Context->m_pContext->GetFirstPage(
       dest_buf, width, height, dest_pitch, pPause);
   return Decode(pJbig2Context, succeeded);
@@ -121,7 +121,8 @@ class JpegDecoder final : public ScanlineDecoder {
               uint32_t width,
               uint32_t height,
               int nComps,
-              bool ColorTransform);
+              bool ColorTransform,
+              uint32_t scale_denom);
 
   // ScanlineDecoder:
   bool Rewind() override;
@@ -163,6 +164,7 @@ class JpegDecoder final : public ScanlineDecoder {
   bool m_bStarted = false;
   bool m_bJpegTransform = false;
   uint32_t m_nDefaultScaleDenom = 1;
+  uint32_t m_nScaleDenom = 1;
 };
 
 JpegDecoder::JpegDecoder() {
@@ -227,6 +229,12 @@ bool JpegDecoder::InitDecode(bool bAcceptKnownBadHeader) {
   m_OutputWidth = m_OrigWidth;
   m_OutputHeight = m_OrigHeight;
   m_nDefaultScaleDenom = m_Cinfo.scale_denom;
+  if (m_nScaleDenom > 1) {
+    m_Cinfo.scale_denom = m_nDefaultScaleDenom * m_nScaleDenom;
+    jpeg_calc_output_dimensions(&m_Cinfo);
+    m_OutputWidth = m_Cinfo.output_width;
+    m_OutputHeight = m_Cinfo.output_height;
+  }
   return true;
 }
 
@@ -234,7 +242,8 @@ bool JpegDecoder::Create(pdfium::span<const uint8_t> src_span,
                          uint32_t width,
                          uint32_t height,
                          int nComps,
-                         bool ColorTransform) {
+                         bool ColorTransform,
+                         uint32_t scale_denom) {
   m_SrcSpan = JpegScanSOI(src_span);
   if (m_SrcSpan.size() < 2)
     return false;
@@ -252,6 +261,7 @@ bool JpegDecoder::Create(pdfium::span<const uint8_t> src_span,
   m_Src.fill_input_buffer = src_fill_buffer;
   m_Src.resync_to_restart = src_resync;
   m_bJpegTransform = ColorTransform;
+  m_nScaleDenom = scale_denom;
   m_OutputWidth = m_OrigWidth = width;
   m_OutputHeight = m_OrigHeight = height;
   if (!InitDecode(/*bAcceptKnownBadHeader=*/true))
@@ -281,14 +291,13 @@ bool JpegDecoder::Rewind() {
   if (setjmp(m_JmpBuf) == -1) {
     return false;
   }
-  m_Cinfo.scale_denom = m_nDefaultScaleDenom;
-  m_OutputWidth = m_OrigWidth;
-  m_OutputHeight = m_OrigHeight;
+  m_Cinfo.scale_denom = m_nDefaultScaleDenom * m_nScaleDenom;
   if (!jpeg_start_decompress(&m_Cinfo)) {
     jpeg_destroy_decompress(&m_Cinfo);
     return false;
   }
-  if (static_cast<int>(m_Cinfo.output_width) > m_OrigWidth) {
+  if (static_cast<int>(m_Cinfo.output_width) > m_OrigWidth ||
+      static_cast<int>(m_Cinfo.output_width) != m_OutputWidth) {
     NOTREACHED();
     return false;
   }
@@ -385,11 +394,15 @@ std::unique_ptr<ScanlineDecoder> JpegModule::CreateDecoder(
     uint32_t width,
     uint32_t height,
     int nComps,
-    bool ColorTransform) {
+    bool ColorTransform,
+    uint32_t scale_denom) {
   DCHECK(!src_span.empty());
+  DCHECK(scale_denom == 1 || scale_denom == 2 || scale_denom == 4 ||
+         scale_denom == 8);
 
   auto pDecoder = std::make_unique<JpegDecoder>();
-  if (!pDecoder->Create(src_span, width, height, nComps, ColorTransform))
+  if (!pDecoder->Create(src_span, width, height, nComps, ColorTransform,
+                        scale_denom))
     return nullptr;
 
   return std::move(pDecoder);
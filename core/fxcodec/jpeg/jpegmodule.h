@@ -35,12 +35,16 @@ class JpegModule {
     bool color_transform;
   };
 
+  // `scale_denom` must be 1, 2, 4 or 8. The decoder's output is that many
+  // times smaller than the image in each direction, rounded up. Scaling
+  // happens inside the inverse DCT, so decoding gets cheaper as well.
   static std::unique_ptr<ScanlineDecoder> CreateDecoder(
       pdfium::span<const uint8_t> src_span,
       uint32_t width,
       uint32_t height,
       int nComps,
-      bool ColorTransform);
+      bool ColorTransform,
+      uint32_t scale_denom);
 
   static absl::optional<ImageInfo> LoadInfo(
       pdfium::span<const uint8_t> src_span);
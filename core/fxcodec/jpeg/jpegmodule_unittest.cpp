@@ -0,0 +1,133 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxcodec/jpeg/jpegmodule.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/fxcodec/scanlinedecoder.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/file_util.h"
+#include "testing/utils/path_service.h"
+#include "third_party/base/span.h"
+
+namespace {
+
+// mona_lisa.jpg is a 120x120 baseline JPEG with 3 components.
+constexpr int kImageSize = 120;
+constexpr int kComps = 3;
+
+std::vector<uint8_t> GetTestFileData(const char* file_name) {
+  std::string file_path;
+  if (!PathService::GetTestFilePath(file_name, &file_path))
+    return {};
+
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  if (!file_contents)
+    return {};
+
+  const uint8_t* data = reinterpret_cast<uint8_t*>(file_contents.get());
+  return std::vector<uint8_t>(data, data + file_length);
+}
+
+// Decodes every row, or returns an empty vector if any row is missing.
+std::vector<uint8_t> DecodeRows(ScanlineDecoder* decoder) {
+  const size_t row_size = decoder->GetWidth() * decoder->CountComps();
+  std::vector<uint8_t> rows;
+  for (int row = 0; row < decoder->GetHeight(); ++row) {
+    pdfium::span<const uint8_t> line = decoder->GetScanline(row);
+    if (line.size() < row_size)
+      return {};
+    rows.insert(rows.end(), line.begin(), line.begin() + row_size);
+  }
+  return rows;
+}
+
+}  // namespace
+
+TEST(JpegModule, ScaledDecodeDimensions) {
+  const std::vector<uint8_t> data = GetTestFileData("mona_lisa.jpg");
+  ASSERT_FALSE(data.empty());
+
+  for (uint32_t scale_denom : {1u, 2u, 4u, 8u}) {
+    std::unique_ptr<ScanlineDecoder> decoder =
+        JpegModule::CreateDecoder(data, kImageSize, kImageSize, kComps,
+                                  /*ColorTransform=*/true, scale_denom);
+    ASSERT_TRUE(decoder) << scale_denom;
+
+    const int expected_size = kImageSize / scale_denom;
+    EXPECT_EQ(expected_size, decoder->GetWidth()) << scale_denom;
+    EXPECT_EQ(expected_size, decoder->GetHeight()) << scale_denom;
+    EXPECT_EQ(kComps, decoder->CountComps()) << scale_denom;
+
+    const std::vector<uint8_t> rows = DecodeRows(decoder.get());
+    EXPECT_EQ(static_cast<size_t>(expected_size * expected_size * kComps),
+              rows.size())
+        << scale_denom;
+  }
+}
+
+TEST(JpegModule, ScaledDecodeRewind) {
+  const std::vector<uint8_t> data = GetTestFileData("mona_lisa.jpg");
+  ASSERT_FALSE(data.empty());
+
+  std::unique_ptr<ScanlineDecoder> decoder =
+      JpegModule::CreateDecoder(data, kImageSize, kImageSize, kComps,
+                                /*ColorTransform=*/true, /*scale_denom=*/4);
+  ASSERT_TRUE(decoder);
+
+  // Going back to row 0 rewinds the decoder, which must keep the scale.
+  const std::vector<uint8_t> first = DecodeRows(decoder.get());
+  ASSERT_FALSE(first.empty());
+  const std::vector<uint8_t> second = DecodeRows(decoder.get());
+  EXPECT_EQ(first, second);
+}
+
+TEST(JpegModule, ScaledDecodeMatchesBlockAverages) {
+  const std::vector<uint8_t> data = GetTestFileData("mona_lisa.jpg");
+  ASSERT_FALSE(data.empty());
+
+  std::unique_ptr<ScanlineDecoder> full_decoder =
+      JpegModule::CreateDecoder(data, kImageSize, kImageSize, kComps,
+                                /*ColorTransform=*/true, /*scale_denom=*/1);
+  ASSERT_TRUE(full_decoder);
+  const std::vector<uint8_t> full = DecodeRows(full_decoder.get());
+  ASSERT_FALSE(full.empty());
+
+  constexpr int kScale = 8;
+  constexpr int kScaledSize = kImageSize / kScale;
+  std::unique_ptr<ScanlineDecoder> scaled_decoder =
+      JpegModule::CreateDecoder(data, kImageSize, kImageSize, kComps,
+                                /*ColorTransform=*/true, kScale);
+  ASSERT_TRUE(scaled_decoder);
+  const std::vector<uint8_t> scaled = DecodeRows(scaled_decoder.get());
+  ASSERT_FALSE(scaled.empty());
+
+  // At 1/8 scale, each output pixel is the DC term of an 8x8 block, so it
+  // should be close to the average of that block at full scale.
+  for (int y = 0; y < kScaledSize; ++y) {
+    for (int x = 0; x < kScaledSize; ++x) {
+      for (int c = 0; c < kComps; ++c) {
+        int sum = 0;
+        for (int dy = 0; dy < kScale; ++dy) {
+          for (int dx = 0; dx < kScale; ++dx) {
+            const int full_x = x * kScale + dx;
+            const int full_y = y * kScale + dy;
+            sum += full[(full_y * kImageSize + full_x) * kComps + c];
+          }
+        }
+        const int average = sum / (kScale * kScale);
+        const int value = scaled[(y * kScaledSize + x) * kComps + c];
+        EXPECT_LE(abs(average - value), 16) << x << ", " << y << ", " << c;
+      }
+    }
+  }
+}
@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -17,6 +18,7 @@
 #include "core/fxcrt/fx_safe_types.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 #include "third_party/base/cxx17_backports.h"
+#include "third_party/base/numerics/safe_conversions.h"
 #include "third_party/base/ptr_util.h"
 
 #if !defined(USE_SYSTEM_LIBOPENJPEG2)
@@ -27,6 +29,34 @@ namespace fxcodec {
 
 namespace {
 
+int g_ThreadCount = 1;
+
+// Bands shorter than this are not worth handing to another thread.
+constexpr uint32_t kMinRowsPerBand = 64;
+
+// Splits [0, `count`) into contiguous bands and calls `fn(first, last)` for
+// each, using up to `thread_count` threads. The calling thread takes the first
+// band itself. `fn` must be safe to run concurrently on disjoint bands.
+template <typename Fn>
+void ForEachBand(uint32_t count, int thread_count, const Fn& fn) {
+  const uint32_t max_bands = std::max<uint32_t>(count / kMinRowsPerBand, 1);
+  const uint32_t bands =
+      std::min(static_cast<uint32_t>(std::max(thread_count, 1)), max_bands);
+  if (bands <= 1) {
+    fn(0, count);
+    return;
+  }
+
+  const uint32_t band_size = (count + bands - 1) / bands;
+  std::vector<std::thread> workers;
+  workers.reserve(bands - 1);
+  for (uint32_t first = band_size; first < count; first += band_size)
+    workers.emplace_back(fn, first, std::min(count - first, band_size) + first);
+  fn(0, band_size);
+  for (std::thread& worker : workers)
+    worker.join();
+}
+
 // Used with std::unique_ptr to call opj_image_data_free on raw memory.
 struct OpjImageDataDeleter {
   inline void operator()(void* ptr) const { opj_image_data_free(ptr); }
@@ -42,6 +72,13 @@ struct OpjImageRgbData {
 
 void fx_ignore_callback(const char* msg, void* client_data) {}
 
+// Size of `value` pixels after `reduction` halvings, as OpenJPEG computes it.
+uint32_t ReducedSize(uint32_t value, uint32_t reduction) {
+  return static_cast<uint32_t>(
+      (static_cast<uint64_t>(value) + (uint64_t{1} << reduction) - 1) >>
+      reduction);
+}
+
 opj_stream_t* fx_opj_stream_create_memory_stream(DecodeData* data) {
   if (!data || !data->src_data || data->src_size <= 0)
     return nullptr;
@@ -91,7 +128,7 @@ void sycc_to_rgb(int offset,
   *out_b = pdfium::clamp(y + static_cast<int>(1.772 * cb), 0, upb);
 }
 
-void sycc444_to_rgb(opj_image_t* img) {
+void sycc444_to_rgb(opj_image_t* img, int thread_count) {
   int prec = img->comps[0].prec;
   // If we shift 31 we're going to go negative, then things go bad.
   if (prec > 30)
@@ -121,9 +158,11 @@ void sycc444_to_rgb(opj_image_t* img) {
   int* r = data.value().r.get();
   int* g = data.value().g.get();
   int* b = data.value().b.get();
-  max_size /= sizeof(int);
-  for (size_t i = 0; i < max_size.ValueOrDie(); ++i)
-    sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
+  ForEachBand(maxh, thread_count, [&](uint32_t first, uint32_t last) {
+    const size_t end = static_cast<size_t>(last) * maxw;
+    for (size_t i = static_cast<size_t>(first) * maxw; i < end; ++i)
+      sycc_to_rgb(offset, upb, y[i], cb[i], cr[i], &r[i], &g[i], &b[i]);
+  });
 
   opj_image_data_free(img->comps[0].data);
   opj_image_data_free(img->comps[1].data);
@@ -150,7 +189,62 @@ bool sycc420_must_extend_cbcr(OPJ_UINT32 y, OPJ_UINT32 cbcr) {
   return (y & 1) && (cbcr == y / 2);
 }
 
-void sycc420_to_rgb(opj_image_t* img) {
+// Converts the rows [`row`, `row` + 2), or just `row` when `has_next_row` is
+// false, sharing one row of subsampled chroma. `row` is even.
+void sycc420_to_rgb_rows(OPJ_UINT32 offset,
+                         OPJ_UINT32 upb,
+                         OPJ_UINT32 yw,
+                         bool extw,
+                         bool has_next_row,
+                         const int* y,
+                         const int* cb,
+                         const int* cr,
+                         int* r,
+                         int* g,
+                         int* b) {
+  const int* ny = y + yw;
+  int* nr = r + yw;
+  int* ng = g + yw;
+  int* nb = b + yw;
+  OPJ_UINT32 j = 0;
+  for (j = 0; j < (yw & ~(OPJ_UINT32)1); j += 2) {
+    sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
+    ++y;
+    ++r;
+    ++g;
+    ++b;
+    sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
+    ++y;
+    ++r;
+    ++g;
+    ++b;
+    if (has_next_row) {
+      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
+      ++ny;
+      ++nr;
+      ++ng;
+      ++nb;
+      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
+      ++ny;
+      ++nr;
+      ++ng;
+      ++nb;
+    }
+    ++cb;
+    ++cr;
+  }
+  if (j < yw) {
+    if (extw) {
+      --cb;
+      --cr;
+    }
+    sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
+    if (has_next_row)
+      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
+  }
+}
+
+void sycc420_to_rgb(opj_image_t* img, int thread_count) {
   if (!sycc420_size_is_valid(img))
     return;
 
@@ -164,7 +258,6 @@ void sycc420_to_rgb(opj_image_t* img) {
   OPJ_UINT32 yh = img->comps[0].h;
   OPJ_UINT32 cbw = img->comps[1].w;
   OPJ_UINT32 cbh = img->comps[1].h;
-  OPJ_UINT32 crw = img->comps[2].w;
   bool extw = sycc420_must_extend_cbcr(yw, cbw);
   bool exth = sycc420_must_extend_cbcr(yh, cbh);
   FX_SAFE_UINT32 safe_size = yw;
@@ -183,93 +276,29 @@ void sycc420_to_rgb(opj_image_t* img) {
   if (!data.has_value())
     return;
 
+  // Each pair of luma rows shares one row of chroma, which is `cbw` wide.
   int* r = data.value().r.get();
   int* g = data.value().g.get();
   int* b = data.value().b.get();
-  const int* ny = nullptr;
-  int* nr = nullptr;
-  int* ng = nullptr;
-  int* nb = nullptr;
-  OPJ_UINT32 i = 0;
-  OPJ_UINT32 j = 0;
-  for (i = 0; i < (yh & ~(OPJ_UINT32)1); i += 2) {
-    ny = y + yw;
-    nr = r + yw;
-    ng = g + yw;
-    nb = b + yw;
-    for (j = 0; j < (yw & ~(OPJ_UINT32)1); j += 2) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      ++cb;
-      ++cr;
-    }
-    if (j < yw) {
-      if (extw) {
-        --cb;
-        --cr;
-      }
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *ny, *cb, *cr, nr, ng, nb);
-      ++ny;
-      ++nr;
-      ++ng;
-      ++nb;
-      ++cb;
-      ++cr;
-    }
-    y += yw;
-    r += yw;
-    g += yw;
-    b += yw;
-  }
-  if (i < yh) {
-    if (exth) {
-      cb -= cbw;
-      cr -= crw;
-    }
-    for (j = 0; j < (yw & ~(OPJ_UINT32)1); j += 2) {
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
-      ++y;
-      ++r;
-      ++g;
-      ++b;
-      ++cb;
-      ++cr;
-    }
-    if (j < yw) {
-      if (extw) {
-        --cb;
-        --cr;
-      }
-      sycc_to_rgb(offset, upb, *y, *cb, *cr, r, g, b);
+  const OPJ_UINT32 row_pairs = yh / 2;
+  ForEachBand(row_pairs, thread_count, [&](uint32_t first, uint32_t last) {
+    for (uint32_t pair = first; pair < last; ++pair) {
+      const size_t luma_offset = static_cast<size_t>(pair) * 2 * yw;
+      const size_t chroma_offset = static_cast<size_t>(pair) * cbw;
+      sycc420_to_rgb_rows(offset, upb, yw, extw, /*has_next_row=*/true,
+                          y + luma_offset, cb + chroma_offset,
+                          cr + chroma_offset, r + luma_offset, g + luma_offset,
+                          b + luma_offset);
     }
+  });
+  if (yh & 1) {
+    const size_t luma_offset = static_cast<size_t>(row_pairs) * 2 * yw;
+    size_t chroma_offset = static_cast<size_t>(row_pairs) * cbw;
+    if (exth)
+      chroma_offset -= cbw;
+    sycc420_to_rgb_rows(offset, upb, yw, extw, /*has_next_row=*/false,
+                        y + luma_offset, cb + chroma_offset, cr + chroma_offset,
+                        r + luma_offset, g + luma_offset, b + luma_offset);
   }
 
   opj_image_data_free(img->comps[0].data);
@@ -292,7 +321,7 @@ bool sycc422_size_is_valid(opj_image_t* img) {
   return sycc420_422_size_is_valid(img) && img->comps[0].h == img->comps[1].h;
 }
 
-void sycc422_to_rgb(opj_image_t* img) {
+void sycc422_to_rgb(opj_image_t* img, int thread_count) {
   if (!sycc422_size_is_valid(img))
     return;
 
@@ -320,19 +349,31 @@ void sycc422_to_rgb(opj_image_t* img) {
   if (!data.has_value())
     return;
 
-  int* r = data.value().r.get();
-  int* g = data.value().g.get();
-  int* b = data.value().b.get();
-  for (uint32_t i = 0; i < maxh; ++i) {
-    OPJ_UINT32 j;
-    for (j = 0; j < (maxw & ~static_cast<OPJ_UINT32>(1)); j += 2) {
-      sycc_to_rgb(offset, upb, *y++, *cb, *cr, r++, g++, b++);
-      sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
-    }
-    if (j < maxw) {
-      sycc_to_rgb(offset, upb, *y++, *cb++, *cr++, r++, g++, b++);
+  // Each row of chroma is `cbw` wide.
+  const OPJ_UINT32 cbw = img->comps[1].w;
+  int* const r_base = data.value().r.get();
+  int* const g_base = data.value().g.get();
+  int* const b_base = data.value().b.get();
+  ForEachBand(maxh, thread_count, [&](uint32_t first, uint32_t last) {
+    for (uint32_t i = first; i < last; ++i) {
+      const size_t luma_offset = static_cast<size_t>(i) * maxw;
+      const size_t chroma_offset = static_cast<size_t>(i) * cbw;
+      const int* py = y + luma_offset;
+      const int* pcb = cb + chroma_offset;
+      const int* pcr = cr + chroma_offset;
+      int* r = r_base + luma_offset;
+      int* g = g_base + luma_offset;
+      int* b = b_base + luma_offset;
+      OPJ_UINT32 j;
+      for (j = 0; j < (maxw & ~static_cast<OPJ_UINT32>(1)); j += 2) {
+        sycc_to_rgb(offset, upb, *py++, *pcb, *pcr, r++, g++, b++);
+        sycc_to_rgb(offset, upb, *py++, *pcb++, *pcr++, r++, g++, b++);
+      }
+      if (j < maxw) {
+        sycc_to_rgb(offset, upb, *py++, *pcb++, *pcr++, r++, g++, b++);
+      }
     }
-  }
+  });
 
   opj_image_data_free(img->comps[0].data);
   opj_image_data_free(img->comps[1].data);
@@ -368,17 +409,17 @@ bool is_sycc444(const opj_image_t* img) {
          img->comps[2].dx == 1 && img->comps[2].dy == 1;
 }
 
-void color_sycc_to_rgb(opj_image_t* img) {
+void color_sycc_to_rgb(opj_image_t* img, int thread_count) {
   if (img->numcomps < 3) {
     img->color_space = OPJ_CLRSPC_GRAY;
     return;
   }
   if (is_sycc420(img))
-    sycc420_to_rgb(img);
+    sycc420_to_rgb(img, thread_count);
   else if (is_sycc422(img))
-    sycc422_to_rgb(img);
+    sycc422_to_rgb(img, thread_count);
   else if (is_sycc444(img))
-    sycc444_to_rgb(img);
+    sycc444_to_rgb(img, thread_count);
   else
     return;
 
@@ -399,12 +440,23 @@ std::unique_ptr<CJPX_Decoder> CJPX_Decoder::Create(
 }
 
 // static
-void CJPX_Decoder::Sycc420ToRgbForTesting(opj_image_t* img) {
-  sycc420_to_rgb(img);
+void CJPX_Decoder::Sycc420ToRgbForTesting(opj_image_t* img,
+                                          int thread_count) {
+  sycc420_to_rgb(img, thread_count);
+}
+
+// static
+void CJPX_Decoder::SetThreadCount(int count) {
+  // Threads beyond the number of cores only add start-up and switching costs,
+  // and every band pass starts its threads afresh.
+  const int max_count = std::max(
+      pdfium::base::saturated_cast<int>(std::thread::hardware_concurrency()),
+      1);
+  g_ThreadCount = pdfium::clamp(count, 1, max_count);
 }
 
 CJPX_Decoder::CJPX_Decoder(ColorSpaceOption option)
-    : m_ColorSpaceOption(option) {}
+    : m_ColorSpaceOption(option), m_ThreadCount(g_ThreadCount) {}
 
 CJPX_Decoder::~CJPX_Decoder() {
   if (m_Codec)
@@ -448,12 +500,54 @@ bool CJPX_Decoder::Init(pdfium::span<const uint8_t> src_data) {
   if (!opj_setup_decoder(m_Codec.Get(), &m_Parameters))
     return false;
 
+  // Lets OpenJPEG decode code-blocks in parallel. This quietly does nothing
+  // when OpenJPEG was built without thread support.
+  if (m_ThreadCount > 1 && opj_has_thread_support())
+    opj_codec_set_threads(m_Codec.Get(), m_ThreadCount);
+
   m_Image = nullptr;
   opj_image_t* pTempImage = nullptr;
   if (!opj_read_header(m_Stream.Get(), m_Codec.Get(), &pTempImage))
     return false;
 
   m_Image = pTempImage;
+  m_ImageWidth = m_Image->x1;
+  m_ImageHeight = m_Image->y1;
+  return true;
+}
+
+bool CJPX_Decoder::SetResolutionReduction(uint32_t reduction) {
+  // Shifts beyond this are meaningless for 32-bit image dimensions.
+  if (reduction >= 32)
+    return false;
+
+  if (!opj_set_decoded_resolution_factor(m_Codec.Get(), reduction)) {
+    // OpenJPEG keeps the rejected factor. Put it back to full resolution.
+    opj_set_decoded_resolution_factor(m_Codec.Get(), 0);
+    m_Reduction = 0;
+    return false;
+  }
+  m_Reduction = reduction;
+  return true;
+}
+
+bool CJPX_Decoder::SetDecodeArea(const FX_RECT& area) {
+  // Decode() only places partial output correctly for images anchored at the
+  // origin of the reference grid.
+  if (m_Image->x0 != 0 || m_Image->y0 != 0)
+    return false;
+
+  if (area.IsEmpty() || area.left < 0 || area.top < 0 ||
+      static_cast<uint32_t>(area.right) > m_ImageWidth ||
+      static_cast<uint32_t>(area.bottom) > m_ImageHeight) {
+    return false;
+  }
+
+  m_Parameters.DA_x0 = area.left;
+  m_Parameters.DA_y0 = area.top;
+  m_Parameters.DA_x1 = area.right;
+  m_Parameters.DA_y1 = area.bottom;
+  m_bHasDecodeArea = true;
   return true;
 }
 
@@ -484,7 +578,7 @@ bool CJPX_Decoder::StartDecode() {
     m_Image->color_space = OPJ_CLRSPC_GRAY;
   }
   if (m_Image->color_space == OPJ_CLRSPC_SYCC)
-    color_sycc_to_rgb(m_Image.Get());
+    color_sycc_to_rgb(m_Image.Get(), m_ThreadCount);
 
   if (m_Image->icc_profile_buf) {
     // TODO(palmer): Using |opj_free| here resolves the crash described in
@@ -502,24 +596,44 @@ bool CJPX_Decoder::StartDecode() {
 }
 
 CJPX_Decoder::JpxImageInfo CJPX_Decoder::GetInfo() const {
-  return {m_Image->x1, m_Image->y1, m_Image->numcomps, m_Image->color_space};
+  return {ReducedSize(m_ImageWidth, m_Reduction),
+          ReducedSize(m_ImageHeight, m_Reduction), m_Image->numcomps,
+          m_Image->color_space};
 }
 
 bool CJPX_Decoder::Decode(uint8_t* dest_buf, uint32_t pitch, bool swap_rgb) {
-  if (m_Image->comps[0].w != m_Image->x1 || m_Image->comps[0].h != m_Image->y1)
+  const uint32_t image_width = ReducedSize(m_ImageWidth, m_Reduction);
+  const uint32_t image_height = ReducedSize(m_ImageHeight, m_Reduction);
+
+  // With a decode area, the decoded pixels start part way into the image.
+  uint32_t x_offset = 0;
+  uint32_t y_offset = 0;
+  if (m_bHasDecodeArea) {
+    x_offset = ReducedSize(m_Image->comps[0].x0, m_Reduction);
+    y_offset = ReducedSize(m_Image->comps[0].y0, m_Reduction);
+    if (x_offset > image_width ||
+        m_Image->comps[0].w > image_width - x_offset ||
+        y_offset > image_height ||
+        m_Image->comps[0].h > image_height - y_offset) {
+      return false;
+    }
+  } else if (m_Image->comps[0].w != image_width ||
+             m_Image->comps[0].h != image_height) {
     return false;
+  }
 
-  if (pitch < ((m_Image->comps[0].w * 8 * m_Image->numcomps + 31) >> 5) << 2)
+  if (pitch < ((image_width * 8 * m_Image->numcomps + 31) >> 5) << 2)
     return false;
 
   if (swap_rgb && m_Image->numcomps < 3)
     return false;
 
-  memset(dest_buf, 0xff, m_Image->y1 * pitch);
+  memset(dest_buf, 0xff, image_height * pitch);
   std::vector<uint8_t*> channel_bufs(m_Image->numcomps);
   std::vector<int> adjust_comps(m_Image->numcomps);
   for (uint32_t i = 0; i < m_Image->numcomps; i++) {
-    channel_bufs[i] = dest_buf + i;
+    channel_bufs[i] =
+        dest_buf + y_offset * pitch + x_offset * m_Image->numcomps + i;
     adjust_comps[i] = m_Image->comps[i].prec - 8;
     if (i > 0) {
       if (m_Image->comps[i].dx != m_Image->comps[i - 1].dx ||
@@ -534,47 +648,50 @@ bool CJPX_Decoder::Decode(uint8_t* dest_buf, uint32_t pitch, bool swap_rgb) {
 
   uint32_t width = m_Image->comps[0].w;
   uint32_t height = m_Image->comps[0].h;
-  for (uint32_t channel = 0; channel < m_Image->numcomps; ++channel) {
-    uint8_t* pChannel = channel_bufs[channel];
-    const int adjust = adjust_comps[channel];
-    const opj_image_comp_t& comps = m_Image->comps[channel];
-    if (!comps.data)
-      continue;
-
-    // Perfomance-sensitive code below. Combining these 3 for-loops below will
-    // cause a slowdown.
-    const uint32_t src_offset = comps.sgnd ? 1 << (comps.prec - 1) : 0;
-    if (adjust < 0) {
-      for (uint32_t row = 0; row < height; ++row) {
-        uint8_t* pScanline = pChannel + row * pitch;
-        for (uint32_t col = 0; col < width; ++col) {
-          uint8_t* pPixel = pScanline + col * m_Image->numcomps;
-          int src = comps.data[row * width + col] + src_offset;
-          *pPixel = static_cast<uint8_t>(src << -adjust);
+  ForEachBand(height, m_ThreadCount, [&](uint32_t first_row,
+                                         uint32_t last_row) {
+    for (uint32_t channel = 0; channel < m_Image->numcomps; ++channel) {
+      uint8_t* pChannel = channel_bufs[channel];
+      const int adjust = adjust_comps[channel];
+      const opj_image_comp_t& comps = m_Image->comps[channel];
+      if (!comps.data)
+        continue;
+
+      // Perfomance-sensitive code below. Combining these 3 for-loops below
+      // will cause a slowdown.
+      const uint32_t src_offset = comps.sgnd ? 1 << (comps.prec - 1) : 0;
+      if (adjust < 0) {
+        for (uint32_t row = first_row; row < last_row; ++row) {
+          uint8_t* pScanline = pChannel + row * pitch;
+          for (uint32_t col = 0; col < width; ++col) {
+            uint8_t* pPixel = pScanline + col * m_Image->numcomps;
+            int src = comps.data[row * width + col] + src_offset;
+            *pPixel = static_cast<uint8_t>(src << -adjust);
+          }
         }
-      }
-    } else if (adjust == 0) {
-      for (uint32_t row = 0; row < height; ++row) {
-        uint8_t* pScanline = pChannel + row * pitch;
-        for (uint32_t col = 0; col < width; ++col) {
-          uint8_t* pPixel = pScanline + col * m_Image->numcomps;
-          int src = comps.data[row * width + col] + src_offset;
-          *pPixel = static_cast<uint8_t>(src);
+      } else if (adjust == 0) {
+        for (uint32_t row = first_row; row < last_row; ++row) {
+          uint8_t* pScanline = pChannel + row * pitch;
+          for (uint32_t col = 0; col < width; ++col) {
+            uint8_t* pPixel = pScanline + col * m_Image->numcomps;
+            int src = comps.data[row * width + col] + src_offset;
+            *pPixel = static_cast<uint8_t>(src);
+          }
         }
-      }
-    } else {
-      for (uint32_t row = 0; row < height; ++row) {
-        uint8_t* pScanline = pChannel + row * pitch;
-        for (uint32_t col = 0; col < width; ++col) {
-          uint8_t* pPixel = pScanline + col * m_Image->numcomps;
-          int src = comps.data[row * width + col] + src_offset;
-          int pixel = (src >> adjust) + ((src >> (adjust - 1)) % 2);
-          pixel = pdfium::clamp(pixel, 0, 255);
-          *pPixel = static_cast<uint8_t>(pixel);
+      } else {
+        for (uint32_t row = first_row; row < last_row; ++row) {
+          uint8_t* pScanline = pChannel + row * pitch;
+          for (uint32_t col = 0; col < width; ++col) {
+            uint8_t* pPixel = pScanline + col * m_Image->numcomps;
+            int src = comps.data[row * width + col] + src_offset;
+            int pixel = (src >> adjust) + ((src >> (adjust - 1)) % 2);
+            pixel = pdfium::clamp(pixel, 0, 255);
+            *pPixel = static_cast<uint8_t>(pixel);
+          }
         }
       }
     }
-  }
+  });
   return true;
 }
 
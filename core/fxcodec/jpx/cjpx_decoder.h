@@ -9,6 +9,7 @@
 
 #include <memory>
 
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/unowned_ptr.h"
 #include "third_party/base/span.h"
 
@@ -41,10 +42,26 @@ class CJPX_Decoder {
       pdfium::span<const uint8_t> src_span,
       CJPX_Decoder::ColorSpaceOption option);
 
-  static void Sycc420ToRgbForTesting(opj_image_t* img);
+  // Sets how many threads, counting the calling thread, decoders created
+  // afterwards may use. Defaults to 1, which keeps all work on the calling
+  // thread.
+  static void SetThreadCount(int count);
+
+  static void Sycc420ToRgbForTesting(opj_image_t* img, int thread_count);
 
   ~CJPX_Decoder();
 
+  // Decodes the image at 1/2^`reduction` of its resolution. Returns false,
+  // and stays at full resolution, if the codestream does not have that many
+  // resolution levels. Must be called before StartDecode().
+  bool SetResolutionReduction(uint32_t reduction);
+
+  // Only decodes the pixels within `area`, given at full resolution. Decode()
+  // still fills in the whole image, leaving the rest of it white. Returns
+  // false if the area cannot be applied. Must be called before StartDecode().
+  bool SetDecodeArea(const FX_RECT& area);
+
+  // The size reported is that of the whole image, after any reduction.
   JpxImageInfo GetInfo() const;
   bool StartDecode();
 
@@ -58,6 +75,12 @@ class CJPX_Decoder {
   bool Init(pdfium::span<const uint8_t> src_data);
 
   const ColorSpaceOption m_ColorSpaceOption;
+  const int m_ThreadCount;
+  uint32_t m_Reduction = 0;
+  bool m_bHasDecodeArea = false;
+  // Size of the whole image at full resolution, as read from the header.
+  uint32_t m_ImageWidth = 0;
+  uint32_t m_ImageHeight = 0;
   pdfium::span<const uint8_t> m_SrcData;
   UnownedPtr<opj_image_t> m_Image;
   UnownedPtr<opj_codec_t> m_Codec;
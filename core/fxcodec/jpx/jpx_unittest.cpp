@@ -6,11 +6,18 @@
 #include <stdint.h>
 
 #include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "core/fxcodec/jpx/cjpx_decoder.h"
 #include "core/fxcodec/jpx/jpx_decode_utils.h"
+#include "core/fxcrt/fx_coordinates.h"
 #include "core/fxcrt/fx_memory.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "testing/utils/file_util.h"
+#include "testing/utils/path_service.h"
 #include "third_party/libopenjpeg/opj_malloc.h"
 
 namespace fxcodec {
@@ -23,6 +30,41 @@ static const uint8_t stream_data[] = {
     0x84, 0x85, 0x86, 0x87,  // Include some hi-bytes, too.
 };
 
+// bug_1469.jp2 is a 64x64 image with 4 components, coded with 5 wavelet
+// decomposition levels and the reversible transform.
+constexpr char kTestImage[] = "bug_1469.jp2";
+constexpr uint32_t kTestImageSize = 64;
+constexpr uint32_t kTestImageComps = 4;
+constexpr uint32_t kTestImageLevels = 5;
+
+std::vector<uint8_t> GetTestFileData(const char* file_name) {
+  std::string file_path;
+  if (!PathService::GetTestFilePath(file_name, &file_path))
+    return {};
+
+  size_t file_length = 0;
+  std::unique_ptr<char, pdfium::FreeDeleter> file_contents =
+      GetFileContents(file_path.c_str(), &file_length);
+  if (!file_contents)
+    return {};
+
+  const uint8_t* data = reinterpret_cast<uint8_t*>(file_contents.get());
+  return std::vector<uint8_t>(data, data + file_length);
+}
+
+// Decodes the whole image, or returns an empty vector on failure.
+std::vector<uint8_t> DecodeImage(CJPX_Decoder* decoder) {
+  if (!decoder->StartDecode())
+    return {};
+
+  CJPX_Decoder::JpxImageInfo info = decoder->GetInfo();
+  const uint32_t pitch = info.width * info.components;
+  std::vector<uint8_t> pixels(pitch * info.height);
+  if (!decoder->Decode(pixels.data(), pitch, /*swap_rgb=*/false))
+    return {};
+  return pixels;
+}
+
 TEST(fxcodec, DecodeDataNullDecodeData) {
   uint8_t buffer[16];
   DecodeData* ptr = nullptr;
@@ -430,7 +472,7 @@ TEST(fxcodec, YUV420ToRGB) {
     img.comps[0] = y;
     img.comps[1] = u;
     img.comps[2] = v;
-    CJPX_Decoder::Sycc420ToRgbForTesting(&img);
+    CJPX_Decoder::Sycc420ToRgbForTesting(&img, /*thread_count=*/1);
     if (testcase.expected) {
       EXPECT_EQ(img.comps[0].w, img.comps[1].w);
       EXPECT_EQ(img.comps[0].h, img.comps[1].h);
@@ -449,4 +491,184 @@ TEST(fxcodec, YUV420ToRGB) {
   FX_Free(img.comps);
 }
 
+TEST(fxcodec, YUV420ToRGBMultipleThreads) {
+  // Odd sizes exercise the unpaired last row and column.
+  constexpr OPJ_UINT32 kWidth = 33;
+  constexpr OPJ_UINT32 kHeight = 1001;
+  constexpr OPJ_UINT32 kChromaWidth = (kWidth + 1) / 2;
+  constexpr OPJ_UINT32 kChromaHeight = (kHeight + 1) / 2;
+
+  std::vector<std::vector<OPJ_INT32>> results;
+  for (int thread_count : {1, 4}) {
+    opj_image_t img;
+    memset(&img, 0, sizeof(img));
+    img.numcomps = 3;
+    img.color_space = OPJ_CLRSPC_SYCC;
+    img.x1 = kWidth;
+    img.y1 = kHeight;
+    img.comps = FX_Alloc(opj_image_comp_t, 3);
+    memset(img.comps, 0, 3 * sizeof(opj_image_comp_t));
+    for (OPJ_UINT32 i = 0; i < 3; ++i) {
+      opj_image_comp_t& comp = img.comps[i];
+      comp.dx = i == 0 ? 1 : 2;
+      comp.dy = i == 0 ? 1 : 2;
+      comp.w = i == 0 ? kWidth : kChromaWidth;
+      comp.h = i == 0 ? kHeight : kChromaHeight;
+      comp.prec = 8;
+      comp.bpp = 8;
+      comp.data = static_cast<OPJ_INT32*>(
+          opj_image_data_alloc(comp.w * comp.h * sizeof(OPJ_INT32)));
+      for (OPJ_UINT32 j = 0; j < comp.w * comp.h; ++j)
+        comp.data[j] = (j * (i + 7)) % 256;
+    }
+
+    CJPX_Decoder::Sycc420ToRgbForTesting(&img, thread_count);
+    ASSERT_EQ(kWidth, img.comps[1].w);
+    ASSERT_EQ(kHeight, img.comps[1].h);
+
+    std::vector<OPJ_INT32> rgb;
+    for (OPJ_UINT32 i = 0; i < 3; ++i) {
+      rgb.insert(rgb.end(), img.comps[i].data,
+                 img.comps[i].data + kWidth * kHeight);
+      opj_image_data_free(img.comps[i].data);
+    }
+    FX_Free(img.comps);
+    results.push_back(std::move(rgb));
+  }
+  EXPECT_EQ(results[0], results[1]);
+}
+
+TEST(fxcodec, ResolutionReduction) {
+  const std::vector<uint8_t> data = GetTestFileData(kTestImage);
+  ASSERT_FALSE(data.empty());
+
+  for (uint32_t reduction = 0; reduction <= kTestImageLevels; ++reduction) {
+    std::unique_ptr<CJPX_Decoder> decoder =
+        CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+    ASSERT_TRUE(decoder);
+    ASSERT_TRUE(decoder->SetResolutionReduction(reduction)) << reduction;
+
+    CJPX_Decoder::JpxImageInfo info = decoder->GetInfo();
+    EXPECT_EQ(kTestImageSize >> reduction, info.width) << reduction;
+    EXPECT_EQ(kTestImageSize >> reduction, info.height) << reduction;
+    EXPECT_EQ(kTestImageComps, info.components) << reduction;
+    EXPECT_FALSE(DecodeImage(decoder.get()).empty()) << reduction;
+  }
+}
+
+TEST(fxcodec, ResolutionReductionTooLarge) {
+  const std::vector<uint8_t> data = GetTestFileData(kTestImage);
+  ASSERT_FALSE(data.empty());
+
+  std::unique_ptr<CJPX_Decoder> full_decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(full_decoder);
+  const std::vector<uint8_t> full = DecodeImage(full_decoder.get());
+  ASSERT_FALSE(full.empty());
+
+  // Rejected reductions leave the decoder at full resolution.
+  for (uint32_t reduction : {kTestImageLevels + 1, 32u}) {
+    std::unique_ptr<CJPX_Decoder> decoder =
+        CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+    ASSERT_TRUE(decoder);
+    EXPECT_FALSE(decoder->SetResolutionReduction(reduction)) << reduction;
+
+    CJPX_Decoder::JpxImageInfo info = decoder->GetInfo();
+    EXPECT_EQ(kTestImageSize, info.width) << reduction;
+    EXPECT_EQ(kTestImageSize, info.height) << reduction;
+    EXPECT_EQ(full, DecodeImage(decoder.get())) << reduction;
+  }
+}
+
+TEST(fxcodec, DecodeArea) {
+  const std::vector<uint8_t> data = GetTestFileData(kTestImage);
+  ASSERT_FALSE(data.empty());
+
+  std::unique_ptr<CJPX_Decoder> full_decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(full_decoder);
+  const std::vector<uint8_t> full = DecodeImage(full_decoder.get());
+  ASSERT_FALSE(full.empty());
+
+  std::unique_ptr<CJPX_Decoder> decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(decoder);
+  const FX_RECT area(8, 16, 40, 56);
+  ASSERT_TRUE(decoder->SetDecodeArea(area));
+
+  // The output still covers the whole image.
+  CJPX_Decoder::JpxImageInfo info = decoder->GetInfo();
+  EXPECT_EQ(kTestImageSize, info.width);
+  EXPECT_EQ(kTestImageSize, info.height);
+  const std::vector<uint8_t> partial = DecodeImage(decoder.get());
+  ASSERT_EQ(full.size(), partial.size());
+
+  // The reversible transform makes the area match the full decode exactly.
+  // Everything outside the area is white.
+  for (uint32_t y = 0; y < kTestImageSize; ++y) {
+    for (uint32_t x = 0; x < kTestImageSize; ++x) {
+      const bool inside =
+          area.Contains(static_cast<int>(x), static_cast<int>(y));
+      for (uint32_t c = 0; c < kTestImageComps; ++c) {
+        const size_t offset = (y * kTestImageSize + x) * kTestImageComps + c;
+        if (inside)
+          ASSERT_EQ(full[offset], partial[offset]) << x << ", " << y;
+        else
+          ASSERT_EQ(0xff, partial[offset]) << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(fxcodec, DecodeAreaWithResolutionReduction) {
+  const std::vector<uint8_t> data = GetTestFileData(kTestImage);
+  ASSERT_FALSE(data.empty());
+
+  constexpr uint32_t kReduction = 1;
+  constexpr uint32_t kReducedSize = kTestImageSize >> kReduction;
+  std::unique_ptr<CJPX_Decoder> full_decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(full_decoder);
+  ASSERT_TRUE(full_decoder->SetResolutionReduction(kReduction));
+  const std::vector<uint8_t> full = DecodeImage(full_decoder.get());
+  ASSERT_FALSE(full.empty());
+
+  std::unique_ptr<CJPX_Decoder> decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(decoder);
+  ASSERT_TRUE(decoder->SetResolutionReduction(kReduction));
+  // Given at full resolution. This is the reduced image's right half.
+  ASSERT_TRUE(decoder->SetDecodeArea(FX_RECT(32, 0, 64, 64)));
+  const std::vector<uint8_t> partial = DecodeImage(decoder.get());
+  ASSERT_EQ(full.size(), partial.size());
+
+  for (uint32_t y = 0; y < kReducedSize; ++y) {
+    for (uint32_t x = 0; x < kReducedSize; ++x) {
+      for (uint32_t c = 0; c < kTestImageComps; ++c) {
+        const size_t offset = (y * kReducedSize + x) * kTestImageComps + c;
+        if (x >= kReducedSize / 2)
+          ASSERT_EQ(full[offset], partial[offset]) << x << ", " << y;
+        else
+          ASSERT_EQ(0xff, partial[offset]) << x << ", " << y;
+      }
+    }
+  }
+}
+
+TEST(fxcodec, DecodeAreaInvalid) {
+  const std::vector<uint8_t> data = GetTestFileData(kTestImage);
+  ASSERT_FALSE(data.empty());
+
+  std::unique_ptr<CJPX_Decoder> decoder =
+      CJPX_Decoder::Create(data, CJPX_Decoder::kNoColorSpace);
+  ASSERT_TRUE(decoder);
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT()));
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT(-1, 0, 16, 16)));
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT(0, -1, 16, 16)));
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT(0, 0, 65, 16)));
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT(0, 0, 16, 65)));
+  EXPECT_FALSE(decoder->SetDecodeArea(FX_RECT(16, 16, 8, 32)));
+  EXPECT_TRUE(decoder->SetDecodeArea(FX_RECT(0, 0, 64, 64)));
+}
+
 }  // namespace fxcodec
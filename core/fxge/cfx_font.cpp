@@ -14,7 +14,6 @@
 #include <utility>
 
 #include "build/build_config.h"
-#include "core/fxcrt/data_vector.h"
 #include "core/fxcrt/fx_codepage.h"
 #include "core/fxcrt/fx_stream.h"
 #include "core/fxcrt/unowned_ptr.h"
@@ -441,12 +440,14 @@ bool CFX_Font::LoadEmbedded(pdfium::span<const uint8_t> src_span,
                             uint64_t object_tag) {
   m_bVertical = force_vertical;
   m_ObjectTag = object_tag;
-  m_FontDataAllocation = DataVector<uint8_t>(src_span.begin(), src_span.end());
-  m_Face = CFX_GEModule::Get()->GetFontMgr()->NewFixedFace(
-      nullptr, m_FontDataAllocation, 0);
+  m_Face = CFX_GEModule::Get()->GetFontMgr()->GetEmbeddedFace(src_span);
   m_bEmbedded = true;
-  m_FontData = m_FontDataAllocation;
-  return !!m_Face;
+  if (!m_Face)
+    return false;
+
+  m_FontData = {FXFT_Get_Face_Stream_Base(m_Face->GetRec()),
+                FXFT_Get_Face_Stream_Size(m_Face->GetRec())};
+  return true;
 }
 
 bool CFX_Font::IsTTFont() const {
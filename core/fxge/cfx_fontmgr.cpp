@@ -6,10 +6,13 @@
 
 #include "core/fxge/cfx_fontmgr.h"
 
+#include <string.h>
+
 #include <iterator>
 #include <memory>
 #include <utility>
 
+#include "core/fxcrt/fx_memory.h"
 #include "core/fxge/cfx_face.h"
 #include "core/fxge/cfx_fontmapper.h"
 #include "core/fxge/cfx_substfont.h"
@@ -44,6 +47,9 @@ constexpr BuiltinFont kFoxitFonts[] = {
 static_assert(std::size(kFoxitFonts) == CFX_FontMapper::kNumStandardFonts,
               "Wrong font count");
 
+// Enough for a few dozen typical subsetted fonts.
+constexpr size_t kDefaultEmbeddedFaceCacheBudget = 16 * 1024 * 1024;
+
 constexpr BuiltinFont kGenericSansFont = {kFoxitSansMMFontData, 66919};
 constexpr BuiltinFont kGenericSerifFont = {kFoxitSerifMMFontData, 113417};
 
@@ -71,13 +77,28 @@ CFX_Face* CFX_FontMgr::FontDesc::GetFace(size_t index) const {
   return m_TTCFaces[index].Get();
 }
 
+CFX_FontMgr::EmbeddedFace::EmbeddedFace(std::pair<size_t, uint32_t> key,
+                                        RetainPtr<FontDesc> desc,
+                                        RetainPtr<CFX_Face> face)
+    : key(key),
+      desc(std::move(desc)),
+      face(std::move(face)),
+      initial_charmap(this->face->GetRec()->charmap) {}
+
+CFX_FontMgr::EmbeddedFace::~EmbeddedFace() = default;
+
 CFX_FontMgr::CFX_FontMgr()
     : m_FTLibrary(FTLibraryInitHelper()),
       m_pBuiltinMapper(std::make_unique<CFX_FontMapper>(this)),
       m_FTLibrarySupportsHinting(SetLcdFilterMode() ||
-                                 FreeTypeVersionSupportsHinting()) {}
+                                 FreeTypeVersionSupportsHinting()),
+      m_EmbeddedFaceCacheBudget(kDefaultEmbeddedFaceCacheBudget) {}
 
-CFX_FontMgr::~CFX_FontMgr() = default;
+CFX_FontMgr::~CFX_FontMgr() {
+  // Faces must go away before `m_FTLibrary`.
+  m_EmbeddedFaceMap.clear();
+  m_EmbeddedFaceList.clear();
+}
 
 RetainPtr<CFX_FontMgr::FontDesc> CFX_FontMgr::GetCachedFontDesc(
     const ByteString& face_name,
@@ -131,6 +152,69 @@ RetainPtr<CFX_Face> CFX_FontMgr::NewFixedFace(RetainPtr<FontDesc> pDesc,
   return face;
 }
 
+RetainPtr<CFX_Face> CFX_FontMgr::GetEmbeddedFace(
+    pdfium::span<const uint8_t> span) {
+  if (span.empty())
+    return nullptr;
+
+  const std::pair<size_t, uint32_t> key(span.size(),
+                                        FX_HashCode_GetA(ByteStringView(span)));
+  auto it = m_EmbeddedFaceMap.find(key);
+  const bool cached_key = it != m_EmbeddedFaceMap.end();
+  if (cached_key) {
+    auto entry = it->second;
+    pdfium::span<const uint8_t> cached = entry->desc->FontData();
+    if (memcmp(cached.data(), span.data(), span.size()) == 0) {
+      m_EmbeddedFaceList.splice(m_EmbeddedFaceList.begin(), m_EmbeddedFaceList,
+                                entry);
+      if (entry->face->HasOneRef()) {
+        // Nobody else is using the face, so hand it out again after undoing
+        // the state a previous font may have left on it.
+        FXFT_FaceRec* rec = entry->face->GetRec();
+        rec->charmap = entry->initial_charmap;
+        FT_Set_Transform(rec, nullptr, nullptr);
+        if (FT_Set_Pixel_Sizes(rec, 64, 64) == 0)
+          return entry->face;
+      }
+      // Share the data, but give the caller a face of its own.
+      return NewFixedFace(entry->desc, cached, 0);
+    }
+  }
+
+  std::unique_ptr<uint8_t, FxFreeDeleter> data(
+      FX_Alloc(uint8_t, span.size()));
+  memcpy(data.get(), span.data(), span.size());
+  auto desc = pdfium::MakeRetain<FontDesc>(std::move(data), span.size());
+  RetainPtr<CFX_Face> face = NewFixedFace(desc, desc->FontData(), 0);
+  // On a hash collision with a different program, the face still gets its own
+  // copy of the data, since callers may free `span` once this returns, but the
+  // cache is left alone.
+  if (!face || cached_key || span.size() > m_EmbeddedFaceCacheBudget)
+    return face;
+
+  m_EmbeddedFaceList.emplace_front(key, std::move(desc), face);
+  m_EmbeddedFaceMap[key] = m_EmbeddedFaceList.begin();
+  m_EmbeddedFaceCacheSize += span.size();
+  TrimEmbeddedFaceCache();
+  return face;
+}
+
+void CFX_FontMgr::SetEmbeddedFaceCacheBudget(size_t budget) {
+  m_EmbeddedFaceCacheBudget = budget;
+  TrimEmbeddedFaceCache();
+}
+
+void CFX_FontMgr::TrimEmbeddedFaceCache() {
+  // Evicting only drops the cache's references. Faces still in use by fonts
+  // stay alive until those fonts go away.
+  while (m_EmbeddedFaceCacheSize > m_EmbeddedFaceCacheBudget) {
+    const EmbeddedFace& victim = m_EmbeddedFaceList.back();
+    m_EmbeddedFaceCacheSize -= victim.desc->FontData().size();
+    m_EmbeddedFaceMap.erase(victim.key);
+    m_EmbeddedFaceList.pop_back();
+  }
+}
+
 // static
 pdfium::span<const uint8_t> CFX_FontMgr::GetStandardFont(size_t index) {
   CHECK_LT(index, std::size(kFoxitFonts));
@@ -10,9 +10,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <list>
 #include <map>
 #include <memory>
 #include <tuple>
+#include <utility>
 
 #include "core/fxcrt/bytestring.h"
 #include "core/fxcrt/fx_memory_wrappers.h"
@@ -74,6 +76,19 @@ class CFX_FontMgr {
                                    pdfium::span<const uint8_t> span,
                                    size_t face_index);
 
+  // Returns a face for the embedded font program in `span`. Font programs are
+  // shared process-wide by content, so documents embedding identical programs
+  // share one copy of the data, and reuse an existing face when no other font
+  // currently holds it.
+  RetainPtr<CFX_Face> GetEmbeddedFace(pdfium::span<const uint8_t> span);
+
+  // Sets the number of bytes of embedded font data kept alive by the cache
+  // once no font refers to it any more. 0 disables the cache.
+  void SetEmbeddedFaceCacheBudget(size_t budget);
+  size_t GetEmbeddedFaceCacheSizeForTesting() const {
+    return m_EmbeddedFaceCacheSize;
+  }
+
   // Always present.
   CFX_FontMapper* GetBuiltinMapper() const { return m_pBuiltinMapper.get(); }
 
@@ -81,14 +96,34 @@ class CFX_FontMgr {
   bool FTLibrarySupportsHinting() const { return m_FTLibrarySupportsHinting; }
 
  private:
+  struct EmbeddedFace {
+    EmbeddedFace(std::pair<size_t, uint32_t> key,
+                 RetainPtr<FontDesc> desc,
+                 RetainPtr<CFX_Face> face);
+    ~EmbeddedFace();
+
+    const std::pair<size_t, uint32_t> key;
+    RetainPtr<FontDesc> const desc;
+    RetainPtr<CFX_Face> const face;
+    FT_CharMap const initial_charmap;
+  };
+
   bool FreeTypeVersionSupportsHinting() const;
   bool SetLcdFilterMode() const;
+  void TrimEmbeddedFaceCache();
 
   // Must come before |m_pBuiltinMapper| and |m_FaceMap|.
   ScopedFXFTLibraryRec const m_FTLibrary;
   std::unique_ptr<CFX_FontMapper> m_pBuiltinMapper;
   std::map<std::tuple<ByteString, int, bool>, ObservedPtr<FontDesc>> m_FaceMap;
   std::map<std::tuple<size_t, uint32_t>, ObservedPtr<FontDesc>> m_TTCFaceMap;
+
+  // Most recently used first. Keyed by data size and content hash.
+  std::list<EmbeddedFace> m_EmbeddedFaceList;
+  std::map<std::pair<size_t, uint32_t>, std::list<EmbeddedFace>::iterator>
+      m_EmbeddedFaceMap;
+  size_t m_EmbeddedFaceCacheSize = 0;
+  size_t m_EmbeddedFaceCacheBudget;
   const bool m_FTLibrarySupportsHinting;
 };
 
@@ -0,0 +1,112 @@
+// Copyright 2022 PDFium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "core/fxge/cfx_fontmgr.h"
+
+#include <memory>
+#include <vector>
+
+#include "core/fxge/cfx_face.h"
+#include "core/fxge/cfx_gemodule.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+class CFX_FontMgrTest : public testing::Test {
+ public:
+  void SetUp() override {
+    mgr_ = CFX_GEModule::Get()->GetFontMgr();
+    mgr_->SetEmbeddedFaceCacheBudget(0);
+    mgr_->SetEmbeddedFaceCacheBudget(16 * 1024 * 1024);
+  }
+  void TearDown() override { mgr_->SetEmbeddedFaceCacheBudget(0); }
+
+  CFX_FontMgr* mgr() const { return mgr_; }
+
+ private:
+  CFX_FontMgr* mgr_ = nullptr;
+};
+
+TEST_F(CFX_FontMgrTest, EmbeddedFaceSharesIdenticalPrograms) {
+  pdfium::span<const uint8_t> font = CFX_FontMgr::GetStandardFont(0);
+  std::vector<uint8_t> copy1(font.begin(), font.end());
+  std::vector<uint8_t> copy2(font.begin(), font.end());
+
+  RetainPtr<CFX_Face> face1 = mgr()->GetEmbeddedFace(copy1);
+  ASSERT_TRUE(face1);
+  EXPECT_EQ(font.size(), mgr()->GetEmbeddedFaceCacheSizeForTesting());
+
+  // Still in use, so the second caller gets its own face over the same data.
+  RetainPtr<CFX_Face> face2 = mgr()->GetEmbeddedFace(copy2);
+  ASSERT_TRUE(face2);
+  EXPECT_NE(face1, face2);
+  EXPECT_EQ(FXFT_Get_Face_Stream_Base(face1->GetRec()),
+            FXFT_Get_Face_Stream_Base(face2->GetRec()));
+  EXPECT_EQ(font.size(), mgr()->GetEmbeddedFaceCacheSizeForTesting());
+
+  // Once idle, the cached face itself is handed out again.
+  CFX_Face* raw_face1 = face1.Get();
+  face1.Reset();
+  face2.Reset();
+  RetainPtr<CFX_Face> face3 = mgr()->GetEmbeddedFace(copy1);
+  EXPECT_EQ(raw_face1, face3.Get());
+}
+
+TEST_F(CFX_FontMgrTest, EmbeddedFaceDistinguishesPrograms) {
+  RetainPtr<CFX_Face> face1 =
+      mgr()->GetEmbeddedFace(CFX_FontMgr::GetStandardFont(0));
+  RetainPtr<CFX_Face> face2 =
+      mgr()->GetEmbeddedFace(CFX_FontMgr::GetStandardFont(1));
+  ASSERT_TRUE(face1);
+  ASSERT_TRUE(face2);
+  EXPECT_NE(FXFT_Get_Face_Stream_Base(face1->GetRec()),
+            FXFT_Get_Face_Stream_Base(face2->GetRec()));
+  EXPECT_EQ(
+      CFX_FontMgr::GetStandardFont(0).size() +
+          CFX_FontMgr::GetStandardFont(1).size(),
+      mgr()->GetEmbeddedFaceCacheSizeForTesting());
+}
+
+TEST_F(CFX_FontMgrTest, EmbeddedFaceHashCollision) {
+  pdfium::span<const uint8_t> font = CFX_FontMgr::GetStandardFont(0);
+  RetainPtr<CFX_Face> face1 = mgr()->GetEmbeddedFace(font);
+  ASSERT_TRUE(face1);
+
+  // Raising one byte by 1 and lowering the next by 31 keeps the hash.
+  auto colliding = std::make_unique<std::vector<uint8_t>>(font.begin(),
+                                                           font.end());
+  size_t pos = colliding->size() - 2;
+  while ((*colliding)[pos] == 0xff || (*colliding)[pos + 1] < 31)
+    --pos;
+  ++(*colliding)[pos];
+  (*colliding)[pos + 1] -= 31;
+  RetainPtr<CFX_Face> face2 = mgr()->GetEmbeddedFace(*colliding);
+  ASSERT_TRUE(face2);
+
+  // The colliding program gets a copy of its own, outside the cache, so the
+  // face outlives the caller's data.
+  EXPECT_NE(colliding->data(), FXFT_Get_Face_Stream_Base(face2->GetRec()));
+  EXPECT_NE(FXFT_Get_Face_Stream_Base(face1->GetRec()),
+            FXFT_Get_Face_Stream_Base(face2->GetRec()));
+  EXPECT_EQ(font.size(), mgr()->GetEmbeddedFaceCacheSizeForTesting());
+  colliding.reset();
+  EXPECT_EQ(0, FT_Load_Glyph(face2->GetRec(), 1, FT_LOAD_NO_SCALE));
+}
+
+TEST_F(CFX_FontMgrTest, EmbeddedFaceBudget) {
+  pdfium::span<const uint8_t> font = CFX_FontMgr::GetStandardFont(0);
+  mgr()->SetEmbeddedFaceCacheBudget(font.size());
+  RetainPtr<CFX_Face> face1 = mgr()->GetEmbeddedFace(font);
+  ASSERT_TRUE(face1);
+  EXPECT_EQ(font.size(), mgr()->GetEmbeddedFaceCacheSizeForTesting());
+
+  // Evicting the first program does not invalidate its face.
+  RetainPtr<CFX_Face> face2 =
+      mgr()->GetEmbeddedFace(CFX_FontMgr::GetStandardFont(1));
+  ASSERT_TRUE(face2);
+  EXPECT_GE(font.size(), mgr()->GetEmbeddedFaceCacheSizeForTesting());
+  EXPECT_TRUE(face1->GetRec());
+
+  mgr()->SetEmbeddedFaceCacheBudget(0);
+  EXPECT_EQ(0u, mgr()->GetEmbeddedFaceCacheSizeForTesting());
+  EXPECT_FALSE(mgr()->GetEmbeddedFace({}));
+}
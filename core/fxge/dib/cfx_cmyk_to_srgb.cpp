@@ -6,12 +6,19 @@
 
 #include "core/fxge/dib/cfx_cmyk_to_srgb.h"
 
+#include <string.h>
+
 #include <algorithm>
+#include <array>
 #include <tuple>
 
 #include "core/fxcrt/fx_system.h"
 #include "third_party/base/check_op.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace fxge {
 
 namespace {
@@ -1660,66 +1667,198 @@ constexpr uint8_t kCMYK[81 * 81][3] = {
     {0, 0, 0},
 };
 
+// Where one CMYK component lands in the 9x9x9x9 grid above: the nearest
+// grid index, the direction of the neighbor to interpolate towards, and the
+// interpolation rate. Depends only on the component's value, so it is
+// precomputed for all 256 values.
+struct GridStep {
+  uint8_t index;
+  int8_t neighbor;
+  int16_t rate;
+};
+
+constexpr std::array<GridStep, 256> MakeGridSteps() {
+  std::array<GridStep, 256> steps = {};
+  for (int value = 0; value < 256; ++value) {
+    const int fix = value << 8;
+    const int index = (fix + 4096) >> 13;
+    int index1 = fix >> 13;
+    if (index1 == index)
+      index1 = index1 == 8 ? index1 - 1 : index1 + 1;
+    steps[value].index = static_cast<uint8_t>(index);
+    steps[value].neighbor = static_cast<int8_t>(index1 - index);
+    steps[value].rate =
+        static_cast<int16_t>((fix - (index << 13)) * (index - index1));
+  }
+  return steps;
+}
+
+constexpr std::array<GridStep, 256> kGridSteps = MakeGridSteps();
+
+// Converts one pixel, writing red, green and blue to `rgb[0]`, `rgb[1]` and
+// `rgb[2]`.
+inline void CMYKToRGB(uint8_t c, uint8_t m, uint8_t y, uint8_t k, int* rgb) {
+  const GridStep& c_step = kGridSteps[c];
+  const GridStep& m_step = kGridSteps[m];
+  const GridStep& y_step = kGridSteps[y];
+  const GridStep& k_step = kGridSteps[k];
+  const int pos = c_step.index * 9 * 9 * 9 + m_step.index * 9 * 9 +
+                  y_step.index * 9 + k_step.index;
+  const uint8_t* base = kCMYK[pos];
+  const uint8_t* c1 = kCMYK[pos + c_step.neighbor * 9 * 9 * 9];
+  const uint8_t* m1 = kCMYK[pos + m_step.neighbor * 9 * 9];
+  const uint8_t* y1 = kCMYK[pos + y_step.neighbor * 9];
+  const uint8_t* k1 = kCMYK[pos + k_step.neighbor];
+  for (int i = 0; i < 3; ++i) {
+    int fix = base[i] << 8;
+    fix += (base[i] - c1[i]) * c_step.rate / 32;
+    fix += (base[i] - m1[i]) * m_step.rate / 32;
+    fix += (base[i] - y1[i]) * y_step.rate / 32;
+    fix += (base[i] - k1[i]) * k_step.rate / 32;
+    rgb[i] = std::max(fix, 0) >> 8;
+  }
+}
+
+#if defined(__SSE2__)
+// `kCMYK` with each entry packed into the low 3 bytes of a word, so an entry
+// can be loaded with a single 32-bit load.
+constexpr std::array<uint32_t, 81 * 81> MakePackedCMYK() {
+  std::array<uint32_t, 81 * 81> packed = {};
+  for (size_t i = 0; i < packed.size(); ++i)
+    packed[i] = kCMYK[i][0] | kCMYK[i][1] << 8 | kCMYK[i][2] << 16;
+  return packed;
+}
+
+constexpr std::array<uint32_t, 81 * 81> kPackedCMYK = MakePackedCMYK();
+
+// Loads grid entries `pos0` and `pos1` as 16-bit lanes R0 G0 B0 0 R1 G1 B1 0.
+__m128i LoadGridPair(int pos0, int pos1) {
+  return _mm_unpacklo_epi8(
+      _mm_unpacklo_epi32(_mm_cvtsi32_si128(kPackedCMYK[pos0]),
+                         _mm_cvtsi32_si128(kPackedCMYK[pos1])),
+      _mm_setzero_si128());
+}
+
+// Divides signed 32-bit lanes by 32, rounding towards zero like `/ 32`.
+__m128i DivideBy32(__m128i value) {
+  const __m128i bias =
+      _mm_and_si128(_mm_srai_epi32(value, 31), _mm_set1_epi32(31));
+  return _mm_srai_epi32(_mm_add_epi32(value, bias), 5);
+}
+
+// Adds one component's interpolation term for two pixels to `acc0` and
+// `acc1`. `stride` is the distance between neighboring grid entries along
+// that component.
+void AddGridTerm(__m128i base,
+                 int pos0,
+                 int pos1,
+                 const GridStep& step0,
+                 const GridStep& step1,
+                 int stride,
+                 __m128i* acc0,
+                 __m128i* acc1) {
+  const __m128i diff = _mm_sub_epi16(
+      base, LoadGridPair(pos0 + step0.neighbor * stride,
+                         pos1 + step1.neighbor * stride));
+  const __m128i rate = _mm_unpacklo_epi64(_mm_set1_epi16(step0.rate),
+                                          _mm_set1_epi16(step1.rate));
+  const __m128i lo = _mm_mullo_epi16(diff, rate);
+  const __m128i hi = _mm_mulhi_epi16(diff, rate);
+  *acc0 = _mm_add_epi32(*acc0, DivideBy32(_mm_unpacklo_epi16(lo, hi)));
+  *acc1 = _mm_add_epi32(*acc1, DivideBy32(_mm_unpackhi_epi16(lo, hi)));
+}
+
+// Converts the two pixels at `src` into BGR at `dest`, exactly like
+// CMYKToRGB().
+void CMYKPairToBGR(const uint8_t* src, uint8_t* dest) {
+  const GridStep* steps0[4];
+  const GridStep* steps1[4];
+  for (int i = 0; i < 4; ++i) {
+    steps0[i] = &kGridSteps[src[i]];
+    steps1[i] = &kGridSteps[src[i + 4]];
+  }
+  const int pos0 = steps0[0]->index * 9 * 9 * 9 + steps0[1]->index * 9 * 9 +
+                   steps0[2]->index * 9 + steps0[3]->index;
+  const int pos1 = steps1[0]->index * 9 * 9 * 9 + steps1[1]->index * 9 * 9 +
+                   steps1[2]->index * 9 + steps1[3]->index;
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i base = LoadGridPair(pos0, pos1);
+  __m128i acc0 = _mm_slli_epi32(_mm_unpacklo_epi16(base, zero), 8);
+  __m128i acc1 = _mm_slli_epi32(_mm_unpackhi_epi16(base, zero), 8);
+  static constexpr int kStrides[4] = {9 * 9 * 9, 9 * 9, 9, 1};
+  for (int i = 0; i < 4; ++i) {
+    AddGridTerm(base, pos0, pos1, *steps0[i], *steps1[i], kStrides[i], &acc0,
+                &acc1);
+  }
+
+  // Clamp negatives to 0, shift back down, and keep the low byte like the
+  // scalar code's conversion to uint8_t does.
+  const __m128i low_byte = _mm_set1_epi32(0xff);
+  acc0 = _mm_and_si128(acc0, _mm_cmpgt_epi32(acc0, zero));
+  acc1 = _mm_and_si128(acc1, _mm_cmpgt_epi32(acc1, zero));
+  acc0 = _mm_and_si128(_mm_srli_epi32(acc0, 8), low_byte);
+  acc1 = _mm_and_si128(_mm_srli_epi32(acc1, 8), low_byte);
+  const __m128i packed =
+      _mm_packus_epi16(_mm_packs_epi32(acc0, acc1), zero);
+  uint8_t rgb[8];
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(rgb), packed);
+  dest[0] = rgb[2];
+  dest[1] = rgb[1];
+  dest[2] = rgb[0];
+  dest[3] = rgb[6];
+  dest[4] = rgb[5];
+  dest[5] = rgb[4];
+}
+#endif  // defined(__SSE2__)
+
 }  // namespace
 
 std::tuple<uint8_t, uint8_t, uint8_t> AdobeCMYK_to_sRGB1(uint8_t c,
                                                          uint8_t m,
                                                          uint8_t y,
                                                          uint8_t k) {
-  int fix_c = c << 8;
-  int fix_m = m << 8;
-  int fix_y = y << 8;
-  int fix_k = k << 8;
-  int c_index = (fix_c + 4096) >> 13;
-  int m_index = (fix_m + 4096) >> 13;
-  int y_index = (fix_y + 4096) >> 13;
-  int k_index = (fix_k + 4096) >> 13;
-  const int pos = c_index * 9 * 9 * 9 + m_index * 9 * 9 + y_index * 9 + k_index;
-  int fix_r = kCMYK[pos][0] << 8;
-  int fix_g = kCMYK[pos][1] << 8;
-  int fix_b = kCMYK[pos][2] << 8;
-  int c1_index = fix_c >> 13;
-  if (c1_index == c_index)
-    c1_index = c1_index == 8 ? c1_index - 1 : c1_index + 1;
-  int m1_index = fix_m >> 13;
-  if (m1_index == m_index)
-    m1_index = m1_index == 8 ? m1_index - 1 : m1_index + 1;
-  int y1_index = fix_y >> 13;
-  if (y1_index == y_index)
-    y1_index = y1_index == 8 ? y1_index - 1 : y1_index + 1;
-  int k1_index = fix_k >> 13;
-  if (k1_index == k_index)
-    k1_index = k1_index == 8 ? k1_index - 1 : k1_index + 1;
-
-  const int c1_pos = pos + (c1_index - c_index) * 9 * 9 * 9;
-  const int c_rate = (fix_c - (c_index << 13)) * (c_index - c1_index);
-  fix_r += (kCMYK[pos][0] - kCMYK[c1_pos][0]) * c_rate / 32;
-  fix_g += (kCMYK[pos][1] - kCMYK[c1_pos][1]) * c_rate / 32;
-  fix_b += (kCMYK[pos][2] - kCMYK[c1_pos][2]) * c_rate / 32;
-
-  const int m1_pos = pos + (m1_index - m_index) * 9 * 9;
-  const int m_rate = (fix_m - (m_index << 13)) * (m_index - m1_index);
-  fix_r += (kCMYK[pos][0] - kCMYK[m1_pos][0]) * m_rate / 32;
-  fix_g += (kCMYK[pos][1] - kCMYK[m1_pos][1]) * m_rate / 32;
-  fix_b += (kCMYK[pos][2] - kCMYK[m1_pos][2]) * m_rate / 32;
-
-  const int y1_pos = pos + (y1_index - y_index) * 9;
-  const int y_rate = (fix_y - (y_index << 13)) * (y_index - y1_index);
-  fix_r += (kCMYK[pos][0] - kCMYK[y1_pos][0]) * y_rate / 32;
-  fix_g += (kCMYK[pos][1] - kCMYK[y1_pos][1]) * y_rate / 32;
-  fix_b += (kCMYK[pos][2] - kCMYK[y1_pos][2]) * y_rate / 32;
-
-  const int k1_pos = pos + (k1_index - k_index);
-  const int k_rate = (fix_k - (k_index << 13)) * (k_index - k1_index);
-  fix_r += (kCMYK[pos][0] - kCMYK[k1_pos][0]) * k_rate / 32;
-  fix_g += (kCMYK[pos][1] - kCMYK[k1_pos][1]) * k_rate / 32;
-  fix_b += (kCMYK[pos][2] - kCMYK[k1_pos][2]) * k_rate / 32;
+  int rgb[3];
+  CMYKToRGB(c, m, y, k, rgb);
+  return std::make_tuple(rgb[0], rgb[1], rgb[2]);
+}
 
-  fix_r = std::max(fix_r, 0);
-  fix_g = std::max(fix_g, 0);
-  fix_b = std::max(fix_b, 0);
+void AdobeCMYK_to_sRGB1_BGR(pdfium::span<uint8_t> dest,
+                            pdfium::span<const uint8_t> src,
+                            int pixels) {
+  DCHECK_GE(pixels, 0);
+  DCHECK_LE(static_cast<size_t>(pixels) * 4, src.size());
+  DCHECK_LE(static_cast<size_t>(pixels) * 3, dest.size());
 
-  return std::make_tuple(fix_r >> 8, fix_g >> 8, fix_b >> 8);
+  uint8_t* dest_buf = dest.data();
+  const uint8_t* src_buf = src.data();
+  int i = 0;
+#if defined(__SSE2__)
+  // Images often repeat a color over many pixels in a row, so reuse the last
+  // pair's result whenever the input matches.
+  uint64_t last_pair = 0;
+  uint8_t last_bgr[6];
+  CMYKPairToBGR(reinterpret_cast<const uint8_t*>(&last_pair), last_bgr);
+  for (; i + 2 <= pixels; i += 2) {
+    uint64_t pair;
+    memcpy(&pair, src_buf, sizeof(pair));
+    if (pair != last_pair) {
+      CMYKPairToBGR(src_buf, last_bgr);
+      last_pair = pair;
+    }
+    memcpy(dest_buf, last_bgr, sizeof(last_bgr));
+    src_buf += 8;
+    dest_buf += 6;
+  }
+#endif
+  for (; i < pixels; ++i) {
+    int rgb[3];
+    CMYKToRGB(src_buf[0], src_buf[1], src_buf[2], src_buf[3], rgb);
+    dest_buf[0] = rgb[2];
+    dest_buf[1] = rgb[1];
+    dest_buf[2] = rgb[0];
+    src_buf += 4;
+    dest_buf += 3;
+  }
 }
 
 std::tuple<float, float, float> AdobeCMYK_to_sRGB(float c,
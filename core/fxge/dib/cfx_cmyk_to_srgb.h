@@ -11,6 +11,8 @@
 
 #include <tuple>
 
+#include "third_party/base/span.h"
+
 namespace fxge {
 
 std::tuple<float, float, float> AdobeCMYK_to_sRGB(float c,
@@ -22,9 +24,16 @@ std::tuple<uint8_t, uint8_t, uint8_t> AdobeCMYK_to_sRGB1(uint8_t c,
                                                          uint8_t y,
                                                          uint8_t k);
 
+// Converts `pixels` 4-byte CMYK pixels from `src` into 3-byte BGR pixels in
+// `dest`, with the same results as calling AdobeCMYK_to_sRGB1() on each one.
+void AdobeCMYK_to_sRGB1_BGR(pdfium::span<uint8_t> dest,
+                            pdfium::span<const uint8_t> src,
+                            int pixels);
+
 }  // namespace fxge
 
 using fxge::AdobeCMYK_to_sRGB;
 using fxge::AdobeCMYK_to_sRGB1;
+using fxge::AdobeCMYK_to_sRGB1_BGR;
 
 #endif  // CORE_FXGE_DIB_CFX_CMYK_TO_SRGB_H_
@@ -4,6 +4,10 @@
 
 #include "core/fxge/dib/cfx_cmyk_to_srgb.h"
 
+#include <stdint.h>
+
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 union Float_t {
@@ -30,3 +34,36 @@ TEST(fxge, CMYK_Rounding) {
   // Check various other 'special' numbers.
   std::tie(R, G, B) = AdobeCMYK_to_sRGB(0.0f, 0.25f, 0.5f, 1.0f);
 }
+
+TEST(fxge, CMYK_BGRBatch) {
+  // Cover every grid position and interpolation rate for each component, plus
+  // runs of repeated pixels and an odd pixel count.
+  std::vector<uint8_t> src;
+  for (int i = 0; i < 256; ++i) {
+    for (int component = 0; component < 4; ++component) {
+      uint8_t pixel[4] = {
+          static_cast<uint8_t>(i * 7), static_cast<uint8_t>(i * 13),
+          static_cast<uint8_t>(i * 29), static_cast<uint8_t>(i * 3)};
+      pixel[component] = static_cast<uint8_t>(i);
+      src.insert(src.end(), pixel, pixel + 4);
+      if (i % 16 == 0)
+        src.insert(src.end(), pixel, pixel + 4);
+    }
+  }
+  src.insert(src.end(), {255, 255, 255, 255});
+  const int pixels = static_cast<int>(src.size() / 4);
+  ASSERT_EQ(1, pixels % 2);
+
+  std::vector<uint8_t> dest(pixels * 3);
+  AdobeCMYK_to_sRGB1_BGR(dest, src, pixels);
+  for (int i = 0; i < pixels; ++i) {
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+    std::tie(r, g, b) = AdobeCMYK_to_sRGB1(src[i * 4], src[i * 4 + 1],
+                                           src[i * 4 + 2], src[i * 4 + 3]);
+    EXPECT_EQ(b, dest[i * 3]) << " at pixel " << i;
+    EXPECT_EQ(g, dest[i * 3 + 1]) << " at pixel " << i;
+    EXPECT_EQ(r, dest[i * 3 + 2]) << " at pixel " << i;
+  }
+}
@@ -31,12 +31,14 @@ class CPDF_Object;
 class CPDF_Font;
 class CPDF_LinkExtract;
 class CPDF_PageObject;
+class CPDF_PageWriter;
 class CPDF_RenderOptions;
 class CPDF_Stream;
 class CPDF_StructElement;
 class CPDF_StructTree;
 class CPDF_TextPage;
 class CPDF_TextPageFind;
+class CPDF_TextPageMultiFind;
 class CPDFSDK_FormFillEnvironment;
 class CPDFSDK_InteractiveForm;
 struct CPDF_JavaScript;
@@ -158,6 +160,15 @@ inline const CPDF_Array* CPDFArrayFromFPDFPageRange(FPDF_PAGERANGE range) {
   return reinterpret_cast<const CPDF_Array*>(range);
 }
 
+inline FPDF_PAGEWRITER FPDFPageWriterFromCPDFPageWriter(
+    CPDF_PageWriter* writer) {
+  return reinterpret_cast<FPDF_PAGEWRITER>(writer);
+}
+inline CPDF_PageWriter* CPDFPageWriterFromFPDFPageWriter(
+    FPDF_PAGEWRITER writer) {
+  return reinterpret_cast<CPDF_PageWriter*>(writer);
+}
+
 inline FPDF_PATHSEGMENT FPDFPathSegmentFromFXPathPoint(
     const CFX_Path::Point* segment) {
   return reinterpret_cast<FPDF_PATHSEGMENT>(segment);
@@ -210,6 +221,15 @@ inline CPDF_TextPageFind* CPDFTextPageFindFromFPDFSchHandle(
   return reinterpret_cast<CPDF_TextPageFind*>(handle);
 }
 
+inline FPDF_TEXTFINDPATTERNS FPDFTextFindPatternsFromCPDFTextPageMultiFind(
+    CPDF_TextPageMultiFind* patterns) {
+  return reinterpret_cast<FPDF_TEXTFINDPATTERNS>(patterns);
+}
+inline CPDF_TextPageMultiFind* CPDFTextPageMultiFindFromFPDFTextFindPatterns(
+    FPDF_TEXTFINDPATTERNS patterns) {
+  return reinterpret_cast<CPDF_TextPageMultiFind*>(patterns);
+}
+
 inline FPDF_FORMHANDLE FPDFFormHandleFromCPDFSDKFormFillEnvironment(
     CPDFSDK_FormFillEnvironment* handle) {
   return reinterpret_cast<FPDF_FORMHANDLE>(handle);
@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "core/fpdfapi/page/cpdf_docpagedata.h"
 #include "core/fpdfapi/parser/cpdf_data_avail.h"
@@ -16,6 +17,7 @@
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxcrt/fx_stream.h"
 #include "core/fxcrt/retain_ptr.h"
+#include "core/fxcrt/stl_util.h"
 #include "core/fxcrt/unowned_ptr.h"
 #include "fpdfsdk/cpdfsdk_helpers.h"
 #include "public/fpdf_formfill.h"
@@ -142,6 +144,14 @@ FPDF_AVAIL FPDFAvailFromFPDFAvailContext(FPDF_AvailContext* pAvailContext) {
   return reinterpret_cast<FPDF_AVAIL>(pAvailContext);
 }
 
+int AddSegmentsToHints(const std::vector<CPDF_DataAvail::Segment>& segments,
+                       FX_DOWNLOADHINTS* hints) {
+  FPDF_DownloadHintsContext hints_context(hints);
+  for (const CPDF_DataAvail::Segment& segment : segments)
+    hints_context.AddSegment(segment.offset, segment.size);
+  return fxcrt::CollectionSize<int>(segments);
+}
+
 }  // namespace
 
 FPDF_EXPORT FPDF_AVAIL FPDF_CALLCONV FPDFAvail_Create(FX_FILEAVAIL* file_avail,
@@ -217,3 +227,43 @@ FPDF_EXPORT int FPDF_CALLCONV FPDFAvail_IsLinearized(FPDF_AVAIL avail) {
     return PDF_LINEARIZATION_UNKNOWN;
   return avail_context->data_avail()->IsLinearizedPDF();
 }
+
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanFirstPageDownload(FPDF_AVAIL avail,
+                                unsigned long max_gap,
+                                FX_DOWNLOADHINTS* hints) {
+  auto* avail_context = FPDFAvailContextFromFPDFAvail(avail);
+  if (!avail_context || !hints)
+    return -1;
+  return AddSegmentsToHints(
+      avail_context->data_avail()->PlanFirstPageDownload(
+          pdfium::base::saturated_cast<FX_FILESIZE>(max_gap)),
+      hints);
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanPageDownload(FPDF_AVAIL avail,
+                           int page_index,
+                           unsigned long max_gap,
+                           FX_DOWNLOADHINTS* hints) {
+  auto* avail_context = FPDFAvailContextFromFPDFAvail(avail);
+  if (!avail_context || page_index < 0 || !hints)
+    return -1;
+  return AddSegmentsToHints(
+      avail_context->data_avail()->PlanPageDownload(
+          page_index, pdfium::base::saturated_cast<FX_FILESIZE>(max_gap)),
+      hints);
+}
+
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanFormDownload(FPDF_AVAIL avail,
+                           unsigned long max_gap,
+                           FX_DOWNLOADHINTS* hints) {
+  auto* avail_context = FPDFAvailContextFromFPDFAvail(avail);
+  if (!avail_context || !hints)
+    return -1;
+  return AddSegmentsToHints(
+      avail_context->data_avail()->PlanFormDownload(
+          pdfium::base::saturated_cast<FX_FILESIZE>(max_gap)),
+      hints);
+}
@@ -274,6 +274,86 @@ TEST_F(FPDFDataAvailEmbedderTest, LoadSecondPageIfLinearizedWithHints) {
   EXPECT_TRUE(page);
 }
 
+TEST_F(FPDFDataAvailEmbedderTest, PlanDownloadsIfLinearized) {
+  TestAsyncLoader loader("linearized.pdf");
+  loader.set_is_new_data_available(false);
+  CreateAvail(loader.file_avail(), loader.file_access());
+
+  // The first 1k tells where the first page and the hint tables are.
+  int rounds = 0;
+  while (true) {
+    ASSERT_GE(FPDFAvail_PlanFirstPageDownload(avail(), 4096, loader.hints()),
+              0);
+    if (FPDFAvail_IsDocAvail(avail(), loader.hints()) == PDF_DATA_AVAIL)
+      break;
+    loader.FlushRequestedData();
+    ASSERT_LT(++rounds, 10);
+  }
+  EXPECT_LE(rounds, 2);
+  SetDocumentFromAvail();
+  ASSERT_TRUE(document());
+
+  // The hint tables tell everything the second page needs, so one download
+  // is enough.
+  static constexpr int kSecondPageNum = 1;
+  EXPECT_GT(
+      FPDFAvail_PlanPageDownload(avail(), kSecondPageNum, 0, loader.hints()),
+      0);
+  loader.FlushRequestedData();
+  EXPECT_EQ(PDF_DATA_AVAIL,
+            FPDFAvail_IsPageAvail(avail(), kSecondPageNum, loader.hints()));
+  EXPECT_EQ(0, FPDFAvail_PlanPageDownload(avail(), kSecondPageNum, 0,
+                                          loader.hints()));
+
+  // The page loads from the data downloaded.
+  ScopedFPDFPage page(FPDF_LoadPage(document(), kSecondPageNum));
+  EXPECT_TRUE(page);
+}
+
+TEST_F(FPDFDataAvailEmbedderTest, PlanDownloadsIfNotLinearized) {
+  TestAsyncLoader loader("annotation_stamp_with_ap.pdf");
+  loader.set_is_new_data_available(false);
+  CreateAvail(loader.file_avail(), loader.file_access());
+
+  int rounds = 0;
+  while (true) {
+    ASSERT_GE(FPDFAvail_PlanFirstPageDownload(avail(), 4096, loader.hints()),
+              0);
+    if (FPDFAvail_IsDocAvail(avail(), loader.hints()) == PDF_DATA_AVAIL)
+      break;
+    loader.FlushRequestedData();
+    ASSERT_LT(++rounds, 20);
+  }
+  SetDocumentFromAvail();
+  ASSERT_TRUE(document());
+
+  // Objects are found through the objects referring to them, so each plan
+  // covers one more level of them.
+  int status = PDF_DATA_NOTAVAIL;
+  while (true) {
+    ASSERT_GE(FPDFAvail_PlanPageDownload(avail(), 0, 4096, loader.hints()), 0);
+    status = FPDFAvail_IsPageAvail(avail(), 0, loader.hints());
+    if (status != PDF_DATA_NOTAVAIL)
+      break;
+    loader.FlushRequestedData();
+    ASSERT_LT(++rounds, 20);
+  }
+  EXPECT_EQ(PDF_DATA_AVAIL, status);
+  while (true) {
+    ASSERT_GE(FPDFAvail_PlanFormDownload(avail(), 4096, loader.hints()), 0);
+    status = FPDFAvail_IsFormAvail(avail(), loader.hints());
+    if (status != PDF_FORM_NOTAVAIL)
+      break;
+    loader.FlushRequestedData();
+    ASSERT_LT(++rounds, 20);
+  }
+  EXPECT_NE(PDF_FORM_ERROR, status);
+
+  // The page loads from the data downloaded.
+  ScopedFPDFPage page(FPDF_LoadPage(document(), 0));
+  EXPECT_TRUE(page);
+}
+
 TEST_F(FPDFDataAvailEmbedderTest, LoadInfoAfterReceivingWholeDocument) {
   TestAsyncLoader loader("linearized.pdf");
   loader.set_is_new_data_available(false);
@@ -381,6 +461,9 @@ TEST_F(FPDFDataAvailEmbedderTest, BadInputsToAPIs) {
   EXPECT_EQ(PDF_DATA_ERROR, FPDFAvail_IsPageAvail(nullptr, 0, nullptr));
   EXPECT_EQ(PDF_FORM_ERROR, FPDFAvail_IsFormAvail(nullptr, nullptr));
   EXPECT_EQ(PDF_LINEARIZATION_UNKNOWN, FPDFAvail_IsLinearized(nullptr));
+  EXPECT_EQ(-1, FPDFAvail_PlanFirstPageDownload(nullptr, 0, nullptr));
+  EXPECT_EQ(-1, FPDFAvail_PlanPageDownload(nullptr, 0, 0, nullptr));
+  EXPECT_EQ(-1, FPDFAvail_PlanFormDownload(nullptr, 0, nullptr));
 }
 
 TEST_F(FPDFDataAvailEmbedderTest, NegativePageIndex) {
@@ -389,6 +472,7 @@ TEST_F(FPDFDataAvailEmbedderTest, NegativePageIndex) {
   ASSERT_EQ(PDF_DATA_AVAIL, FPDFAvail_IsDocAvail(avail(), loader.hints()));
   EXPECT_EQ(PDF_DATA_NOTAVAIL,
             FPDFAvail_IsPageAvail(avail(), -1, loader.hints()));
+  EXPECT_EQ(-1, FPDFAvail_PlanPageDownload(avail(), -1, 0, loader.hints()));
 }
 
 TEST_F(FPDFDataAvailEmbedderTest, Bug_1324189) {
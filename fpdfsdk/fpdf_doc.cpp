@@ -254,6 +254,11 @@ FPDF_EXPORT int FPDF_CALLCONV FPDFDest_GetDestPageIndex(FPDF_DOCUMENT document,
   return destination.GetDestPageIndex(pDoc);
 }
 
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_IndexPageTree(FPDF_DOCUMENT document) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  return pDoc && pDoc->IndexAllPages();
+}
+
 FPDF_EXPORT unsigned long FPDF_CALLCONV
 FPDFDest_GetView(FPDF_DEST dest, unsigned long* pNumParams, FS_FLOAT* pParams) {
   if (!dest) {
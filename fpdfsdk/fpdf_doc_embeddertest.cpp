@@ -65,6 +65,22 @@ TEST_F(FPDFDocEmbedderTest, DestGetPageIndex) {
   EXPECT_EQ(-1, FPDFDest_GetDestPageIndex(document(), dest));
 }
 
+TEST_F(FPDFDocEmbedderTest, DestGetPageIndexAfterIndexPageTree) {
+  EXPECT_FALSE(FPDF_IndexPageTree(nullptr));
+
+  ASSERT_TRUE(OpenDocument("named_dests.pdf"));
+  EXPECT_TRUE(FPDF_IndexPageTree(document()));
+  EXPECT_TRUE(FPDF_IndexPageTree(document()));
+
+  FPDF_DEST dest = FPDF_GetNamedDestByName(document(), "Next");
+  EXPECT_TRUE(dest);
+  EXPECT_EQ(1, FPDFDest_GetDestPageIndex(document(), dest));
+
+  dest = FPDF_GetNamedDestByName(document(), "LastAlternate");
+  EXPECT_TRUE(dest);
+  EXPECT_EQ(-1, FPDFDest_GetDestPageIndex(document(), dest));
+}
+
 TEST_F(FPDFDocEmbedderTest, DestGetView) {
   ASSERT_TRUE(OpenDocument("named_dests.pdf"));
 
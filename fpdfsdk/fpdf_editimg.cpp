@@ -382,7 +382,7 @@ FPDFImageObj_GetImageMetadata(FPDF_PAGEOBJECT image_object,
   RetainPtr<CPDF_DIB> pSource = pImg->CreateNewDIB();
   CPDF_DIB::LoadState ret = pSource->StartLoadDIBBase(
       false, nullptr, pPage->GetPageResources(), false,
-      CPDF_ColorSpace::Family::kUnknown, false);
+      CPDF_ColorSpace::Family::kUnknown, false, CPDF_DIB::DecodeHint());
   if (ret == CPDF_DIB::LoadState::kFail)
     return true;
 
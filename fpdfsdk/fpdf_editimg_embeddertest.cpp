@@ -8,6 +8,19 @@
 #include "testing/embedder_test.h"
 #include "testing/utils/file_util.h"
 
+namespace {
+
+// Returns the color at (`x`, `y`) of a 4-bytes-per-pixel `bitmap`, as
+// 0xRRGGBB.
+uint32_t GetRGBAt(FPDF_BITMAP bitmap, int x, int y) {
+  const uint8_t* pixel =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap)) +
+      y * FPDFBitmap_GetStride(bitmap) + x * 4;
+  return pixel[2] << 16 | pixel[1] << 8 | pixel[0];
+}
+
+}  // namespace
+
 class PDFEditImgTest : public EmbedderTest {};
 
 TEST_F(PDFEditImgTest, InsertObjectWithInvalidPage) {
@@ -87,6 +100,41 @@ TEST_F(PDFEditImgTest, NewImageObjLoadJpeg) {
   EXPECT_EQ(120, FPDFBitmap_GetHeight(bitmap.get()));
 }
 
+TEST_F(PDFEditImgTest, LoadJpegIntoImageSharedWithRenderedPage) {
+  // Both pages draw the same red image over the whole page.
+  ASSERT_TRUE(OpenDocument("shared_image.pdf"));
+  ASSERT_TRUE(FPDF_SetImageCacheBudget(document(), 1024 * 1024));
+  {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    EXPECT_EQ(0xff0000u, GetRGBAt(bitmap.get(), 50, 50));
+    UnloadPage(page);
+  }
+
+  // Replace the image through the other page, which never rendered it. The
+  // decode cached while rendering the first page must not be used.
+  FPDF_PAGE page = LoadPage(1);
+  ASSERT_TRUE(page);
+  FPDF_PAGEOBJECT image = FPDFPage_GetObject(page, 0);
+  ASSERT_EQ(FPDF_PAGEOBJ_IMAGE, FPDFPageObj_GetType(image));
+  FileAccessForTesting file_access("mona_lisa.jpg");
+  ASSERT_TRUE(FPDFImageObj_LoadJpegFile(&page, 1, image, &file_access));
+  {
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    EXPECT_NE(0xff0000u, GetRGBAt(bitmap.get(), 50, 50));
+  }
+  UnloadPage(page);
+
+  page = LoadPage(0);
+  ASSERT_TRUE(page);
+  {
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    EXPECT_NE(0xff0000u, GetRGBAt(bitmap.get(), 50, 50));
+  }
+  UnloadPage(page);
+}
+
 TEST_F(PDFEditImgTest, NewImageObjLoadJpegInline) {
   ScopedFPDFDocument doc(FPDF_CreateNewDocument());
   ScopedFPDFPage page(FPDFPage_New(doc.get(), 0, 200, 200));
@@ -186,6 +186,10 @@ void FFLCommon(FPDF_FORMHANDLE hHandle,
   if (!pPage)
     return;
 
+  const CPDF_Page* pPDFPage = pPage->AsPDFPage();
+  if (pPDFPage && pPDFPage->IsTextOnly())
+    return;
+
   CPDF_Document* pPDFDoc = pPage->GetDocument();
   CPDFSDK_PageView* pPageView = FormHandleToPageView(hHandle, fpdf_page);
 
@@ -10,11 +10,13 @@
 #include <map>
 #include <memory>
 #include <numeric>
+#include <set>
 #include <sstream>
 #include <utility>
 #include <vector>
 
 #include "constants/page_object.h"
+#include "core/fpdfapi/edit/cpdf_objectdeduplicator.h"
 #include "core/fpdfapi/page/cpdf_form.h"
 #include "core/fpdfapi/page/cpdf_formobject.h"
 #include "core/fpdfapi/page/cpdf_page.h"
@@ -235,14 +237,25 @@ class CPDF_PageOrganizer {
 
   UnownedPtr<CPDF_Document> const m_pDestDoc;
   UnownedPtr<CPDF_Document> const m_pSrcDoc;
+  // Set when identical objects get shared rather than copied again.
+  UnownedPtr<CPDF_ObjectDeduplicator> const m_pDeduplicator;
 
   // Mapping of source object number to destination object number.
   std::map<uint32_t, uint32_t> m_ObjectNumberMap;
+
+  // Destination objects whose references are being updated, outermost first,
+  // and those of them that refer back to themselves. The latter cannot be
+  // replaced by identical objects, as their references point at them.
+  std::vector<uint32_t> m_PendingObjNums;
+  std::set<uint32_t> m_SelfReferencingObjNums;
 };
 
 CPDF_PageOrganizer::CPDF_PageOrganizer(CPDF_Document* pDestDoc,
                                        CPDF_Document* pSrcDoc)
-    : m_pDestDoc(pDestDoc), m_pSrcDoc(pSrcDoc) {}
+    : m_pDestDoc(pDestDoc),
+      m_pSrcDoc(pSrcDoc),
+      m_pDeduplicator(static_cast<CPDF_ObjectDeduplicator*>(
+          pDestDoc->GetObjectIndex())) {}
 
 CPDF_PageOrganizer::~CPDF_PageOrganizer() = default;
 
@@ -340,8 +353,12 @@ uint32_t CPDF_PageOrganizer::GetNewObjId(CPDF_Reference* pRef) {
   const auto it = m_ObjectNumberMap.find(dwObjnum);
   if (it != m_ObjectNumberMap.end())
     dwNewObjNum = it->second;
-  if (dwNewObjNum)
+  if (dwNewObjNum) {
+    auto pending_it = std::find(m_PendingObjNums.begin(),
+                                m_PendingObjNums.end(), dwNewObjNum);
+    m_SelfReferencingObjNums.insert(pending_it, m_PendingObjNums.end());
     return dwNewObjNum;
+  }
 
   const CPDF_Object* pDirect = pRef->GetDirect();
   if (!pDirect)
@@ -361,9 +378,23 @@ uint32_t CPDF_PageOrganizer::GetNewObjId(CPDF_Reference* pRef) {
       dest()->AddIndirectObject(std::move(pClone)));
   dwNewObjNum = pIndirectClone->GetObjNum();
   AddObjectMapping(dwObjnum, dwNewObjNum);
-  if (!UpdateReference(std::move(pIndirectClone)))
+  m_PendingObjNums.push_back(dwNewObjNum);
+  const bool bUpdated = UpdateReference(pIndirectClone);
+  m_PendingObjNums.pop_back();
+  if (!bUpdated)
     return 0;
 
+  if (m_pDeduplicator && !m_SelfReferencingObjNums.erase(dwNewObjNum)) {
+    // The clone's references are final by now, so an identical object that
+    // got imported earlier can take its place.
+    const uint32_t dwSharedObjNum =
+        m_pDeduplicator->FindOrAdd(pIndirectClone.Get());
+    if (dwSharedObjNum != dwNewObjNum) {
+      dest()->DeleteIndirectObject(dwNewObjNum);
+      AddObjectMapping(dwObjnum, dwSharedObjNum);
+      dwNewObjNum = dwSharedObjNum;
+    }
+  }
   return dwNewObjNum;
 }
 
@@ -841,3 +872,18 @@ FPDF_CopyViewerPreferences(FPDF_DOCUMENT dest_doc, FPDF_DOCUMENT src_doc) {
   pDstDict->SetFor("ViewerPreferences", pSrcDict->CloneDirectObject());
   return true;
 }
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SetImportDeduplication(FPDF_DOCUMENT dest_doc, FPDF_BOOL enable) {
+  CPDF_Document* pDestDoc = CPDFDocumentFromFPDFDocument(dest_doc);
+  if (!pDestDoc)
+    return false;
+
+  if (!enable) {
+    pDestDoc->SetObjectIndex(nullptr);
+  } else if (!pDestDoc->GetObjectIndex()) {
+    pDestDoc->SetObjectIndex(
+        std::make_unique<CPDF_ObjectDeduplicator>(pDestDoc));
+  }
+  return true;
+}
@@ -568,3 +568,36 @@ TEST_F(FPDFPPOEmbedderTest, ImportWithZeroLengthStream) {
   ScopedFPDFBitmap new_bitmap = RenderPage(new_page.get());
   CompareBitmap(new_bitmap.get(), 200, 200, pdfium::HelloWorldChecksum());
 }
+
+TEST_F(FPDFPPOEmbedderTest, ImportPagesWithDeduplication) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+
+  ScopedFPDFDocument plain_doc(FPDF_CreateNewDocument());
+  ASSERT_TRUE(plain_doc);
+  ScopedFPDFDocument dedup_doc(FPDF_CreateNewDocument());
+  ASSERT_TRUE(dedup_doc);
+  EXPECT_TRUE(FPDF_SetImportDeduplication(dedup_doc.get(), true));
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(FPDF_ImportPages(plain_doc.get(), document(), "1", i));
+    EXPECT_TRUE(FPDF_ImportPages(dedup_doc.get(), document(), "1", i));
+  }
+  EXPECT_EQ(3, FPDF_GetPageCount(dedup_doc.get()));
+
+  // The pages share one content stream and one set of fonts, so the saved
+  // document is smaller.
+  EXPECT_TRUE(FPDF_SaveAsCopy(plain_doc.get(), this, 0));
+  const size_t plain_size = GetString().size();
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(dedup_doc.get(), this, 0));
+  EXPECT_LT(GetString().size(), plain_size);
+
+  for (int i = 0; i < 3; ++i) {
+    ScopedFPDFPage page(FPDF_LoadPage(dedup_doc.get(), i));
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderPage(page.get());
+    CompareBitmap(bitmap.get(), 200, 200, pdfium::HelloWorldChecksum());
+  }
+
+  EXPECT_FALSE(FPDF_SetImportDeduplication(nullptr, true));
+  EXPECT_TRUE(FPDF_SetImportDeduplication(dedup_doc.get(), false));
+}
@@ -56,7 +56,7 @@ FPDF_RenderPageBitmapWithColorScheme_Start(FPDF_BITMAP bitmap,
     return FPDF_RENDER_FAILED;
 
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
-  if (!pPage)
+  if (!pPage || pPage->IsTextOnly())
     return FPDF_RENDER_FAILED;
 
   auto pOwnedContext = std::make_unique<CPDF_PageRenderContext>();
@@ -6,17 +6,20 @@
 
 #include "public/fpdf_save.h"
 
+#include <memory>
 #include <utility>
 #include <vector>
 
 #include "build/build_config.h"
 #include "core/fpdfapi/edit/cpdf_creator.h"
+#include "core/fpdfapi/edit/cpdf_pagewriter.h"
 #include "core/fpdfapi/parser/cpdf_array.h"
 #include "core/fpdfapi/parser/cpdf_dictionary.h"
 #include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfapi/parser/cpdf_reference.h"
 #include "core/fpdfapi/parser/cpdf_stream_acc.h"
 #include "core/fpdfapi/parser/cpdf_string.h"
+#include "core/fxcodec/flate/flatemodule.h"
 #include "core/fxcrt/fx_extension.h"
 #include "core/fxcrt/stl_util.h"
 #include "fpdfsdk/cpdfsdk_filewriteadapter.h"
@@ -151,14 +154,47 @@ bool SaveXFADocumentData(CPDFXFA_Context* pContext,
 }
 #endif  // PDF_ENABLE_XFA
 
+absl::optional<FlateModule::Strategy> GetCompressionStrategy(int strategy) {
+  switch (strategy) {
+    case FPDF_COMPRESSION_STRATEGY_DEFAULT:
+      return FlateModule::Strategy::kDefault;
+    case FPDF_COMPRESSION_STRATEGY_FILTERED:
+      return FlateModule::Strategy::kFiltered;
+    case FPDF_COMPRESSION_STRATEGY_HUFFMAN_ONLY:
+      return FlateModule::Strategy::kHuffmanOnly;
+    case FPDF_COMPRESSION_STRATEGY_RLE:
+      return FlateModule::Strategy::kRle;
+    default:
+      return absl::nullopt;
+  }
+}
+
 bool DoDocSave(FPDF_DOCUMENT document,
                FPDF_FILEWRITE* pFileWrite,
                FPDF_DWORD flags,
-               absl::optional<int> version) {
+               absl::optional<int> version,
+               const FPDF_SAVE_OPTIONS* options) {
   CPDF_Document* pPDFDoc = CPDFDocumentFromFPDFDocument(document);
   if (!pPDFDoc)
     return false;
 
+  FlateModule::EncodeOptions compression_options;
+  int thread_count = 1;
+  if (options) {
+    absl::optional<FlateModule::Strategy> strategy =
+        GetCompressionStrategy(options->compression_strategy);
+    if (options->version != 1 || options->compression_level < -1 ||
+        options->compression_level > 9 || !strategy.has_value() ||
+        options->thread_count < 0) {
+      return false;
+    }
+    compression_options.level = options->compression_level;
+    compression_options.strategy = strategy.value();
+    thread_count = options->thread_count;
+    if (options->file_version)
+      version = options->file_version;
+  }
+
 #ifdef PDF_ENABLE_XFA
   auto* pContext = static_cast<CPDFXFA_Context*>(pPDFDoc->GetExtension());
   if (pContext) {
@@ -168,13 +204,35 @@ bool DoDocSave(FPDF_DOCUMENT document,
   }
 #endif  // PDF_ENABLE_XFA
 
-  if (flags < FPDF_INCREMENTAL || flags > FPDF_REMOVE_SECURITY)
+  constexpr FPDF_DWORD kOptionFlags = FPDF_OBJECT_STREAMS |
+                                      FPDF_OBJECT_STREAM_SIZE(0xFFFF) |
+                                      FPDF_LINEARIZE | FPDF_DEDUPLICATE;
+  // Invalid flags get ignored as a whole, as they were before the option
+  // flags existed, rather than enabling whichever options their bits hit.
+  if ((flags & ~kOptionFlags) > FPDF_REMOVE_SECURITY)
     flags = 0;
 
+  const bool bObjectStreams = !!(flags & FPDF_OBJECT_STREAMS);
+  const uint32_t objects_per_stream = flags >> 16;
+  const bool bLinearize = !!(flags & FPDF_LINEARIZE);
+  const bool bDeduplicate = !!(flags & FPDF_DEDUPLICATE);
+  flags &= ~kOptionFlags;
+
   CPDF_Creator fileMaker(
       pPDFDoc, pdfium::MakeRetain<CPDFSDK_FileWriteAdapter>(pFileWrite));
   if (version.has_value())
     fileMaker.SetFileVersion(version.value());
+  fileMaker.SetCompressionOptions(compression_options);
+  fileMaker.SetThreadCount(thread_count);
+  if (bObjectStreams) {
+    fileMaker.EnableObjectStreams(objects_per_stream
+                                      ? objects_per_stream
+                                      : CPDF_Creator::kDefaultObjectsPerStream);
+  }
+  if (bLinearize)
+    fileMaker.EnableLinearization();
+  if (bDeduplicate)
+    fileMaker.EnableDeduplication();
   if (flags == FPDF_REMOVE_SECURITY) {
     flags = 0;
     fileMaker.RemoveSecurity();
@@ -195,7 +253,7 @@ bool DoDocSave(FPDF_DOCUMENT document,
 FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_SaveAsCopy(FPDF_DOCUMENT document,
                                                     FPDF_FILEWRITE* pFileWrite,
                                                     FPDF_DWORD flags) {
-  return DoDocSave(document, pFileWrite, flags, {});
+  return DoDocSave(document, pFileWrite, flags, {}, nullptr);
 }
 
 FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
@@ -203,5 +261,45 @@ FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                      FPDF_FILEWRITE* pFileWrite,
                      FPDF_DWORD flags,
                      int fileVersion) {
-  return DoDocSave(document, pFileWrite, flags, fileVersion);
+  return DoDocSave(document, pFileWrite, flags, fileVersion, nullptr);
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SaveWithOptions(FPDF_DOCUMENT document,
+                     FPDF_FILEWRITE* pFileWrite,
+                     FPDF_DWORD flags,
+                     const FPDF_SAVE_OPTIONS* options) {
+  if (!options)
+    return false;
+  return DoDocSave(document, pFileWrite, flags, {}, options);
+}
+
+FPDF_EXPORT FPDF_PAGEWRITER FPDF_CALLCONV
+FPDF_StartPageWriter(FPDF_DOCUMENT document,
+                     FPDF_FILEWRITE* pFileWrite,
+                     int fileVersion) {
+  CPDF_Document* pPDFDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pPDFDoc || !pFileWrite)
+    return nullptr;
+
+  auto writer = std::make_unique<CPDF_PageWriter>(
+      pPDFDoc, pdfium::MakeRetain<CPDFSDK_FileWriteAdapter>(pFileWrite));
+  if (!writer->Start(fileVersion))
+    return nullptr;
+
+  // Caller takes ownership.
+  return FPDFPageWriterFromCPDFPageWriter(writer.release());
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_PageWriter_WritePages(FPDF_PAGEWRITER writer) {
+  CPDF_PageWriter* pWriter = CPDFPageWriterFromFPDFPageWriter(writer);
+  return pWriter && pWriter->WritePages();
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_FinishPageWriter(FPDF_PAGEWRITER writer) {
+  std::unique_ptr<CPDF_PageWriter> pWriter(
+      CPDFPageWriterFromFPDFPageWriter(writer));
+  return pWriter && pWriter->Finish();
 }
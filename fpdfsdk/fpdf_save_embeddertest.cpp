@@ -15,6 +15,21 @@
 #include "testing/gmock/include/gmock/gmock-matchers.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+namespace {
+
+// Returns `saved` without its /ID, which differs from save to save.
+std::string WithoutFileID(std::string saved) {
+  size_t begin = saved.find("/ID");
+  if (begin == std::string::npos)
+    return saved;
+  size_t end = saved.find(']', begin);
+  if (end == std::string::npos)
+    return saved;
+  return saved.erase(begin, end + 1 - begin);
+}
+
+}  // namespace
+
 class FPDFSaveEmbedderTest : public EmbedderTest {};
 
 TEST_F(FPDFSaveEmbedderTest, SaveSimpleDoc) {
@@ -54,6 +69,42 @@ TEST_F(FPDFSaveEmbedderTest, SaveSimpleDocIncremental) {
   EXPECT_EQ(985u, GetString().size());
 }
 
+TEST_F(FPDFSaveEmbedderTest, SaveIncrementalWritesModifiedObjects) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  FPDFPage_SetRotation(page, 1);
+  UnloadPage(page);
+
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_INCREMENTAL));
+  // Only the page object got appended to the 840 bytes of hello_world.pdf,
+  // not the objects it uses.
+  const std::string appended = GetString().substr(840);
+  EXPECT_THAT(appended, testing::StartsWith("3 0 obj\r\n"));
+  EXPECT_THAT(appended, testing::HasSubstr("/Rotate 90"));
+  EXPECT_THAT(appended, testing::HasSubstr("xref\r\n3 1\r\n"));
+  EXPECT_THAT(appended, testing::Not(testing::HasSubstr("stream")));
+
+  ASSERT_TRUE(OpenSavedDocument());
+  FPDF_PAGE saved_page = LoadSavedPage(0);
+  ASSERT_TRUE(saved_page);
+  EXPECT_EQ(1, FPDFPage_GetRotation(saved_page));
+  CloseSavedPage(saved_page);
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveIncrementalAfterRenderingWritesNoObjects) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+  UnloadPage(page);
+
+  // Loading objects to render them does not change them.
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_INCREMENTAL));
+  EXPECT_THAT(GetString().substr(840), testing::Not(testing::HasSubstr("obj")));
+}
+
 TEST_F(FPDFSaveEmbedderTest, SaveSimpleDocNoIncremental) {
   ASSERT_TRUE(OpenDocument("hello_world.pdf"));
   EXPECT_TRUE(FPDF_SaveWithVersion(document(), this, FPDF_NO_INCREMENTAL, 14));
@@ -73,6 +124,13 @@ TEST_F(FPDFSaveEmbedderTest, SaveSimpleDocBadFlags) {
   EXPECT_TRUE(FPDF_SaveWithVersion(document(), this, 999999, 14));
   EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.4\r\n"));
   EXPECT_EQ(805u, GetString().size());
+
+  // Option flags along with invalid ones get ignored too.
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveWithVersion(
+      document(), this, 4 | FPDF_LINEARIZE | FPDF_OBJECT_STREAMS, 14));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.4\r\n"));
+  EXPECT_EQ(805u, GetString().size());
 }
 
 TEST_F(FPDFSaveEmbedderTest, SaveCopiedDoc) {
@@ -123,6 +181,263 @@ TEST_F(FPDFSaveEmbedderTest, SaveLinearizedDoc) {
   CloseSavedDocument();
 }
 
+TEST_F(FPDFSaveEmbedderTest, SaveWithObjectStreams) {
+  const int kPageCount = 3;
+  std::string original_md5[kPageCount];
+
+  ASSERT_TRUE(OpenDocument("linearized.pdf"));
+  for (int i = 0; i < kPageCount; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    original_md5[i] = HashBitmap(bitmap.get());
+    UnloadPage(page);
+  }
+
+  ASSERT_TRUE(FPDF_SaveAsCopy(document(), this, FPDF_NO_INCREMENTAL));
+  const size_t plain_size = GetString().size();
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(
+      document(), this,
+      FPDF_NO_INCREMENTAL | FPDF_OBJECT_STREAMS | FPDF_OBJECT_STREAM_SIZE(4)));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.6\r\n"));
+  EXPECT_THAT(GetString(), testing::HasSubstr("/Type/ObjStm"));
+  EXPECT_THAT(GetString(), testing::HasSubstr("/Type/XRef"));
+  EXPECT_THAT(GetString(), testing::Not(testing::HasSubstr("\r\nxref\r\n")));
+  EXPECT_THAT(GetString(), testing::Not(testing::HasSubstr("trailer")));
+  EXPECT_LT(GetString().size(), plain_size);
+
+  // Make sure new document renders the same as the old one.
+  ASSERT_TRUE(OpenSavedDocument());
+  EXPECT_EQ(kPageCount, FPDF_GetPageCount(saved_document()));
+  for (int i = 0; i < kPageCount; ++i) {
+    FPDF_PAGE page = LoadSavedPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+    EXPECT_EQ(original_md5[i], HashBitmap(bitmap.get()));
+    CloseSavedPage(page);
+  }
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveIncrementalIgnoresObjectStreams) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this,
+                              FPDF_INCREMENTAL | FPDF_OBJECT_STREAMS));
+  EXPECT_THAT(GetString(), testing::Not(testing::HasSubstr("/ObjStm")));
+  EXPECT_EQ(985u, GetString().size());
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveLinearized) {
+  const int kPageCount = 5;
+  std::string original_md5[kPageCount];
+
+  ASSERT_TRUE(OpenDocument("rectangles_multi_pages.pdf"));
+  for (int i = 0; i < kPageCount; ++i) {
+    FPDF_PAGE page = LoadPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    original_md5[i] = HashBitmap(bitmap.get());
+    UnloadPage(page);
+  }
+
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this,
+                              FPDF_NO_INCREMENTAL | FPDF_LINEARIZE));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.7\r\n"));
+  EXPECT_THAT(GetString(), testing::HasSubstr("/Linearized 1"));
+  EXPECT_THAT(GetString(), testing::HasSubstr("/Prev "));
+
+  // The saved document loads through the linearized path, so this also checks
+  // the hint tables.
+  ASSERT_TRUE(OpenSavedDocument());
+  EXPECT_EQ(kPageCount, FPDF_GetPageCount(saved_document()));
+  for (int i = 0; i < kPageCount; ++i) {
+    FPDF_PAGE page = LoadSavedPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+    EXPECT_EQ(original_md5[i], HashBitmap(bitmap.get()));
+    CloseSavedPage(page);
+  }
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithDeduplication) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  ScopedFPDFDocument merged_doc(FPDF_CreateNewDocument());
+  ASSERT_TRUE(merged_doc);
+  for (int i = 0; i < 3; ++i)
+    ASSERT_TRUE(FPDF_ImportPages(merged_doc.get(), document(), "1", i));
+
+  ASSERT_TRUE(FPDF_SaveAsCopy(merged_doc.get(), this, FPDF_NO_INCREMENTAL));
+  const size_t plain_size = GetString().size();
+
+  ClearString();
+  EXPECT_TRUE(FPDF_SaveAsCopy(merged_doc.get(), this,
+                              FPDF_NO_INCREMENTAL | FPDF_DEDUPLICATE));
+  EXPECT_LT(GetString().size(), plain_size);
+
+  ASSERT_TRUE(OpenSavedDocument());
+  EXPECT_EQ(3, FPDF_GetPageCount(saved_document()));
+  for (int i = 0; i < 3; ++i) {
+    FPDF_PAGE page = LoadSavedPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+    CompareBitmap(bitmap.get(), 200, 200, pdfium::HelloWorldChecksum());
+    CloseSavedPage(page);
+  }
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithDeduplicationKeepsLayers) {
+  // Two optional content groups with the same name, one of them off.
+  ASSERT_TRUE(OpenDocument("ocg_same_names.pdf"));
+  EXPECT_TRUE(FPDF_SaveAsCopy(document(), this,
+                              FPDF_NO_INCREMENTAL | FPDF_DEDUPLICATE));
+
+  const std::string& saved = GetString();
+  size_t pos = saved.find("(Layer)");
+  ASSERT_NE(std::string::npos, pos);
+  pos = saved.find("(Layer)", pos + 1);
+  EXPECT_NE(std::string::npos, pos);
+
+  ASSERT_TRUE(OpenSavedDocument());
+  FPDF_PAGE page = LoadSavedPage(0);
+  ASSERT_TRUE(page);
+  ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap.get()));
+  const int stride = FPDFBitmap_GetStride(bitmap.get());
+  // The layer that is on shows in red, the other one does not show.
+  const uint8_t* on_pixel = buffer + 50 * stride + 25 * 4;
+  EXPECT_EQ(0xff, on_pixel[2]);
+  EXPECT_EQ(0x00, on_pixel[0]);
+  const uint8_t* off_pixel = buffer + 50 * stride + 75 * 4;
+  EXPECT_EQ(0xff, off_pixel[2]);
+  EXPECT_EQ(0xff, off_pixel[0]);
+  CloseSavedPage(page);
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, PageWriter) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  ScopedFPDFDocument new_doc(FPDF_CreateNewDocument());
+  ASSERT_TRUE(new_doc);
+  FPDF_PAGEWRITER writer = FPDF_StartPageWriter(new_doc.get(), this, 0);
+  ASSERT_TRUE(writer);
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_TRUE(FPDF_ImportPages(new_doc.get(), document(), "1", 0));
+    EXPECT_TRUE(FPDF_PageWriter_WritePages(writer));
+    EXPECT_EQ(0, FPDF_GetPageCount(new_doc.get()));
+  }
+  EXPECT_TRUE(FPDF_FinishPageWriter(writer));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.7\r\n"));
+
+  ASSERT_TRUE(OpenSavedDocument());
+  EXPECT_TRUE(FPDF_DocumentHasValidCrossReferenceTable(saved_document()));
+  EXPECT_EQ(3, FPDF_GetPageCount(saved_document()));
+  for (int i = 0; i < 3; ++i) {
+    FPDF_PAGE page = LoadSavedPage(i);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+    CompareBitmap(bitmap.get(), 200, 200, pdfium::HelloWorldChecksum());
+    CloseSavedPage(page);
+  }
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, PageWriterNeedsNewDocument) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  EXPECT_FALSE(FPDF_StartPageWriter(document(), this, 0));
+  EXPECT_FALSE(FPDF_PageWriter_WritePages(nullptr));
+  EXPECT_FALSE(FPDF_FinishPageWriter(nullptr));
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveIncrementalIgnoresLinearize) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  EXPECT_TRUE(
+      FPDF_SaveAsCopy(document(), this, FPDF_INCREMENTAL | FPDF_LINEARIZE));
+  EXPECT_THAT(GetString(), testing::Not(testing::HasSubstr("/Linearized")));
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithOptions) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_SAVE_OPTIONS options = {};
+  options.version = 1;
+  options.compression_level = -1;
+  EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.7\r\n"));
+  EXPECT_EQ(805u, GetString().size());
+  const std::string single_threaded = WithoutFileID(GetString());
+
+  // More threads give the same output.
+  ClearString();
+  options.thread_count = 4;
+  EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  EXPECT_EQ(single_threaded, WithoutFileID(GetString()));
+
+  // The content stream has no filter, so it gets compressed.
+  ClearString();
+  options.compression_level = 0;
+  EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  EXPECT_EQ(830u, GetString().size());
+
+  ClearString();
+  options.file_version = 15;
+  options.compression_level = 9;
+  options.compression_strategy = FPDF_COMPRESSION_STRATEGY_FILTERED;
+  EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  EXPECT_THAT(GetString(), testing::StartsWith("%PDF-1.5\r\n"));
+
+  ASSERT_TRUE(OpenSavedDocument());
+  FPDF_PAGE page = LoadSavedPage(0);
+  ASSERT_TRUE(page);
+  ScopedFPDFBitmap bitmap = RenderSavedPage(page);
+  CompareBitmap(bitmap.get(), 200, 200, pdfium::HelloWorldChecksum());
+  CloseSavedPage(page);
+  CloseSavedDocument();
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithOptionsThreadCounts) {
+  // Several pages, each with a content stream to compress.
+  ASSERT_TRUE(OpenDocument("rectangles_multi_pages.pdf"));
+  FPDF_SAVE_OPTIONS options = {};
+  options.version = 1;
+  options.compression_level = -1;
+  EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  const std::string single_threaded = WithoutFileID(GetString());
+  EXPECT_THAT(single_threaded, testing::HasSubstr("/FlateDecode"));
+
+  for (int thread_count : {2, 3, 16, 1000}) {
+    ClearString();
+    options.thread_count = thread_count;
+    EXPECT_TRUE(FPDF_SaveWithOptions(document(), this, 0, &options));
+    EXPECT_EQ(single_threaded, WithoutFileID(GetString()))
+        << "thread_count " << thread_count;
+  }
+}
+
+TEST_F(FPDFSaveEmbedderTest, SaveWithBadOptions) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  EXPECT_FALSE(FPDF_SaveWithOptions(document(), this, 0, nullptr));
+
+  FPDF_SAVE_OPTIONS options = {};
+  EXPECT_FALSE(FPDF_SaveWithOptions(document(), this, 0, &options));
+
+  options.version = 1;
+  options.compression_level = 10;
+  EXPECT_FALSE(FPDF_SaveWithOptions(document(), this, 0, &options));
+
+  options.compression_level = 6;
+  options.compression_strategy = 4;
+  EXPECT_FALSE(FPDF_SaveWithOptions(document(), this, 0, &options));
+
+  options.compression_strategy = FPDF_COMPRESSION_STRATEGY_RLE;
+  options.thread_count = -1;
+  EXPECT_FALSE(FPDF_SaveWithOptions(document(), this, 0, &options));
+  EXPECT_TRUE(GetString().empty());
+}
+
 TEST_F(FPDFSaveEmbedderTest, Bug1409) {
   ASSERT_TRUE(OpenDocument("jpx_lzw.pdf"));
   FPDF_PAGE page = LoadPage(0);
@@ -8,12 +8,15 @@
 
 #include <algorithm>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "build/build_config.h"
 #include "core/fpdfapi/font/cpdf_font.h"
 #include "core/fpdfapi/page/cpdf_page.h"
 #include "core/fpdfapi/page/cpdf_textobject.h"
+#include "core/fpdfapi/parser/cpdf_dictionary.h"
+#include "core/fpdfapi/parser/cpdf_document.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
 #include "core/fpdftext/cpdf_linkextract.h"
 #include "core/fpdftext/cpdf_textpage.h"
@@ -50,6 +53,30 @@ FPDF_EXPORT FPDF_TEXTPAGE FPDF_CALLCONV FPDFText_LoadPage(FPDF_PAGE page) {
   return FPDFTextPageFromCPDFTextPage(textpage.release());
 }
 
+FPDF_EXPORT FPDF_PAGE FPDF_CALLCONV
+FPDFText_LoadTextOnlyPage(FPDF_DOCUMENT document, int page_index) {
+  CPDF_Document* pDoc = CPDFDocumentFromFPDFDocument(document);
+  if (!pDoc)
+    return nullptr;
+
+  // XFA pages have their own loading path. They just get parsed in full.
+  CPDF_Document::Extension* pExtension = pDoc->GetExtension();
+  if (pExtension && pExtension->ContainsExtensionForm())
+    return FPDF_LoadPage(document, page_index);
+
+  if (page_index < 0 || page_index >= pDoc->GetPageCount())
+    return nullptr;
+
+  RetainPtr<CPDF_Dictionary> pDict = pDoc->GetMutablePageDictionary(page_index);
+  if (!pDict)
+    return nullptr;
+
+  auto pPage = pdfium::MakeRetain<CPDF_Page>(pDoc, std::move(pDict));
+  pPage->SetTextOnly(true);
+  pPage->ParseContent();
+  return FPDFPageFromIPDFPage(pPage.Leak());
+}
+
 FPDF_EXPORT void FPDF_CALLCONV FPDFText_ClosePage(FPDF_TEXTPAGE text_page) {
   // PDFium takes ownership.
   std::unique_ptr<CPDF_TextPage> textpage_deleter(
@@ -267,6 +294,60 @@ FPDFText_GetCharOrigin(FPDF_TEXTPAGE text_page,
   return true;
 }
 
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFText_GetCharInfoBatch(FPDF_TEXTPAGE text_page,
+                          int start_index,
+                          int count,
+                          unsigned int* unicodes,
+                          FS_RECTF* boxes,
+                          FS_POINTF* origins,
+                          float* font_sizes,
+                          int* flags,
+                          int* font_ids) {
+  CPDF_TextPage* textpage = CPDFTextPageFromFPDFTextPage(text_page);
+  if (!textpage || start_index < 0 || count < 0)
+    return -1;
+
+  pdfium::span<const CPDF_TextPage::CharInfo> chars = textpage->GetCharInfos();
+  const size_t start = static_cast<size_t>(start_index);
+  if (start >= chars.size())
+    return 0;
+
+  chars = chars.subspan(start, std::min<size_t>(count, chars.size() - start));
+  for (size_t i = 0; i < chars.size(); ++i) {
+    const CPDF_TextPage::CharInfo& charinfo = chars[i];
+    if (unicodes)
+      unicodes[i] = charinfo.m_Unicode;
+    if (boxes)
+      boxes[i] = FSRectFFromCFXFloatRect(charinfo.m_CharBox);
+    if (origins)
+      origins[i] = {charinfo.m_Origin.x, charinfo.m_Origin.y};
+    if (font_sizes)
+      font_sizes[i] = textpage->GetCharFontSize(start + i);
+    if (flags) {
+      int char_flags = 0;
+      switch (charinfo.m_CharType) {
+        case CPDF_TextPage::CharType::kGenerated:
+          char_flags = FPDF_TEXTCHAR_GENERATED;
+          break;
+        case CPDF_TextPage::CharType::kHyphen:
+          char_flags = FPDF_TEXTCHAR_HYPHEN;
+          break;
+        case CPDF_TextPage::CharType::kNotUnicode:
+          char_flags = FPDF_TEXTCHAR_UNICODE_MAP_ERROR;
+          break;
+        case CPDF_TextPage::CharType::kNormal:
+        case CPDF_TextPage::CharType::kPiece:
+          break;
+      }
+      flags[i] = char_flags;
+    }
+    if (font_ids)
+      font_ids[i] = textpage->GetFontId(charinfo);
+  }
+  return pdfium::base::checked_cast<int>(chars.size());
+}
+
 FPDF_EXPORT int FPDF_CALLCONV
 FPDFText_GetCharIndexAtPos(FPDF_TEXTPAGE text_page,
                            double x,
@@ -436,6 +517,65 @@ FPDF_EXPORT void FPDF_CALLCONV FPDFText_FindClose(FPDF_SCHHANDLE handle) {
       CPDFTextPageFindFromFPDFSchHandle(handle));
 }
 
+FPDF_EXPORT FPDF_TEXTFINDPATTERNS FPDF_CALLCONV
+FPDFText_LoadFindPatterns(const FPDF_WIDESTRING* patterns,
+                          int count,
+                          unsigned long flags) {
+  if (!patterns || count < 0)
+    return nullptr;
+
+  std::vector<WideString> pattern_array;
+  pattern_array.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (!patterns[i])
+      return nullptr;
+    pattern_array.push_back(WideStringFromFPDFWideString(patterns[i]));
+  }
+
+  CPDF_TextPageFind::Options options;
+  options.bMatchCase = !!(flags & FPDF_MATCHCASE);
+  options.bMatchWholeWord = !!(flags & FPDF_MATCHWHOLEWORD);
+  options.bConsecutive = !!(flags & FPDF_CONSECUTIVE);
+  auto multi_find =
+      std::make_unique<CPDF_TextPageMultiFind>(pattern_array, options);
+
+  // Caller takes ownership.
+  return FPDFTextFindPatternsFromCPDFTextPageMultiFind(multi_find.release());
+}
+
+FPDF_EXPORT int FPDF_CALLCONV FPDFText_FindAll(FPDF_TEXTPAGE text_page,
+                                               FPDF_TEXTFINDPATTERNS patterns,
+                                               int* pattern_indices,
+                                               int* start_indices,
+                                               int* char_counts,
+                                               int max_matches) {
+  CPDF_TextPage* textpage = CPDFTextPageFromFPDFTextPage(text_page);
+  if (!textpage || !patterns || max_matches < 0)
+    return -1;
+
+  std::vector<CPDF_TextPageMultiFind::Match> matches =
+      CPDFTextPageMultiFindFromFPDFTextFindPatterns(patterns)->FindAll(
+          textpage);
+  const size_t to_write =
+      std::min(matches.size(), static_cast<size_t>(max_matches));
+  for (size_t i = 0; i < to_write; ++i) {
+    if (pattern_indices)
+      pattern_indices[i] = static_cast<int>(matches[i].pattern);
+    if (start_indices)
+      start_indices[i] = matches[i].char_index;
+    if (char_counts)
+      char_counts[i] = matches[i].char_count;
+  }
+  return pdfium::base::checked_cast<int>(matches.size());
+}
+
+FPDF_EXPORT void FPDF_CALLCONV
+FPDFText_CloseFindPatterns(FPDF_TEXTFINDPATTERNS patterns) {
+  // Take ownership back from caller and destroy.
+  std::unique_ptr<CPDF_TextPageMultiFind> multi_find(
+      CPDFTextPageMultiFindFromFPDFTextFindPatterns(patterns));
+}
+
 // web link
 FPDF_EXPORT FPDF_PAGELINK FPDF_CALLCONV
 FPDFLink_LoadWebLinks(FPDF_TEXTPAGE text_page) {
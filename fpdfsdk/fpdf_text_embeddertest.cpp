@@ -10,6 +10,7 @@
 #include "core/fxge/fx_font.h"
 #include "public/cpp/fpdf_scopers.h"
 #include "public/fpdf_doc.h"
+#include "public/fpdf_edit.h"
 #include "public/fpdf_text.h"
 #include "public/fpdf_transformpage.h"
 #include "public/fpdfview.h"
@@ -1702,3 +1703,212 @@ TEST_F(FPDFTextEmbedderTest, Bug1769) {
 
   UnloadPage(page);
 }
+
+TEST_F(FPDFTextEmbedderTest, TextOnlyPage) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  ScopedFPDFPage page(FPDFText_LoadTextOnlyPage(document(), 0));
+  ASSERT_TRUE(page);
+  EXPECT_FALSE(FPDFText_LoadTextOnlyPage(document(), -1));
+  EXPECT_FALSE(FPDFText_LoadTextOnlyPage(document(), 1));
+
+  ScopedFPDFTextPage textpage(FPDFText_LoadPage(page.get()));
+  ASSERT_TRUE(textpage);
+
+  unsigned short buffer[128];
+  int num_chars = FPDFText_GetText(textpage.get(), 0, 128, buffer);
+  ASSERT_EQ(kHelloGoodbyeTextSize, num_chars);
+  EXPECT_TRUE(
+      check_unsigned_shorts(kHelloGoodbyeText, buffer, kHelloGoodbyeTextSize));
+}
+
+TEST_F(FPDFTextEmbedderTest, TextOnlyPageSkipsNonText) {
+  ASSERT_TRUE(OpenDocument("marked_content_id.pdf"));
+
+  // Loaded normally, the page has a text object and an image object.
+  FPDF_PAGE full_page = LoadPage(0);
+  ASSERT_TRUE(full_page);
+  EXPECT_EQ(2, FPDFPage_CountObjects(full_page));
+  UnloadPage(full_page);
+
+  ScopedFPDFPage page(FPDFText_LoadTextOnlyPage(document(), 0));
+  ASSERT_TRUE(page);
+  ASSERT_EQ(1, FPDFPage_CountObjects(page.get()));
+
+  // Marked content is still tracked.
+  FPDF_PAGEOBJECT text = FPDFPage_GetObject(page.get(), 0);
+  EXPECT_EQ(FPDF_PAGEOBJ_TEXT, FPDFPageObj_GetType(text));
+  EXPECT_EQ(1, FPDFPageObj_CountMarks(text));
+  EXPECT_EQ(-1, FPDFClipPath_CountPaths(FPDFPageObj_GetClipPath(text)));
+}
+
+TEST_F(FPDFTextEmbedderTest, TextOnlyPageCannotBeRenderedOrGenerated) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  ScopedFPDFPage page(FPDFText_LoadTextOnlyPage(document(), 0));
+  ASSERT_TRUE(page);
+
+  const int width = static_cast<int>(FPDF_GetPageWidthF(page.get()));
+  const int height = static_cast<int>(FPDF_GetPageHeightF(page.get()));
+  ScopedFPDFBitmap bitmap(FPDFBitmap_Create(width, height, 0));
+  ASSERT_TRUE(bitmap);
+  FPDFBitmap_FillRect(bitmap.get(), 0, 0, width, height, 0xFF00FF00);
+  FPDF_RenderPageBitmap(bitmap.get(), page.get(), 0, 0, width, height, 0, 0);
+  FPDF_FFLDraw(form_handle(), bitmap.get(), page.get(), 0, 0, width, height, 0,
+               0);
+
+  // Nothing was drawn over the fill.
+  const int stride = FPDFBitmap_GetStride(bitmap.get());
+  const uint8_t* buffer =
+      static_cast<const uint8_t*>(FPDFBitmap_GetBuffer(bitmap.get()));
+  for (int row = 0; row < height; ++row) {
+    const uint32_t* pixels =
+        reinterpret_cast<const uint32_t*>(buffer + row * stride);
+    for (int col = 0; col < width; ++col)
+      ASSERT_EQ(0xFF00FF00u, pixels[col]) << row << ", " << col;
+  }
+
+  EXPECT_FALSE(FPDFPage_GenerateContent(page.get()));
+}
+
+TEST_F(FPDFTextEmbedderTest, GetCharInfoBatch) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  ASSERT_TRUE(textpage);
+
+  const int count = FPDFText_CountChars(textpage);
+  ASSERT_EQ(kHelloGoodbyeTextSize - 1, count);
+
+  std::vector<unsigned int> unicodes(count);
+  std::vector<FS_RECTF> boxes(count);
+  std::vector<FS_POINTF> origins(count);
+  std::vector<float> font_sizes(count);
+  std::vector<int> flags(count);
+  std::vector<int> font_ids(count);
+  ASSERT_EQ(count,
+            FPDFText_GetCharInfoBatch(textpage, 0, count, unicodes.data(),
+                                      boxes.data(), origins.data(),
+                                      font_sizes.data(), flags.data(),
+                                      font_ids.data()));
+
+  for (int i = 0; i < count; ++i) {
+    EXPECT_EQ(FPDFText_GetUnicode(textpage, i), unicodes[i]);
+
+    double left;
+    double right;
+    double bottom;
+    double top;
+    ASSERT_TRUE(FPDFText_GetCharBox(textpage, i, &left, &right, &bottom, &top));
+    EXPECT_FLOAT_EQ(left, boxes[i].left);
+    EXPECT_FLOAT_EQ(right, boxes[i].right);
+    EXPECT_FLOAT_EQ(bottom, boxes[i].bottom);
+    EXPECT_FLOAT_EQ(top, boxes[i].top);
+
+    double x;
+    double y;
+    ASSERT_TRUE(FPDFText_GetCharOrigin(textpage, i, &x, &y));
+    EXPECT_FLOAT_EQ(x, origins[i].x);
+    EXPECT_FLOAT_EQ(y, origins[i].y);
+
+    EXPECT_FLOAT_EQ(FPDFText_GetFontSize(textpage, i), font_sizes[i]);
+  }
+
+  // "Hello, world!\r\nGoodbye, world!" has a generated line break, and the
+  // two lines use different fonts.
+  EXPECT_EQ(0, flags[0]);
+  EXPECT_EQ(FPDF_TEXTCHAR_GENERATED, flags[13]);
+  EXPECT_EQ(FPDF_TEXTCHAR_GENERATED, flags[14]);
+  EXPECT_EQ(0, font_ids[0]);
+  EXPECT_EQ(-1, font_ids[13]);
+  EXPECT_EQ(1, font_ids[15]);
+  EXPECT_EQ(font_ids[0], font_ids[12]);
+  EXPECT_EQ(font_ids[15], font_ids[count - 1]);
+
+  // Ranges are clamped to the end of the page, and all buffers are optional.
+  EXPECT_EQ(2, FPDFText_GetCharInfoBatch(textpage, count - 2, 100, nullptr,
+                                         nullptr, nullptr, nullptr, nullptr,
+                                         font_ids.data()));
+  EXPECT_EQ(font_ids[15], font_ids[0]);
+  EXPECT_EQ(0, FPDFText_GetCharInfoBatch(textpage, count, 1, nullptr, nullptr,
+                                         nullptr, nullptr, nullptr, nullptr));
+  EXPECT_EQ(-1, FPDFText_GetCharInfoBatch(textpage, -1, 1, nullptr, nullptr,
+                                          nullptr, nullptr, nullptr, nullptr));
+  EXPECT_EQ(-1, FPDFText_GetCharInfoBatch(nullptr, 0, 1, nullptr, nullptr,
+                                          nullptr, nullptr, nullptr, nullptr));
+
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFTextEmbedderTest, FindAll) {
+  ASSERT_TRUE(OpenDocument("hello_world.pdf"));
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+
+  FPDF_TEXTPAGE textpage = FPDFText_LoadPage(page);
+  ASSERT_TRUE(textpage);
+
+  ScopedFPDFWideString world = GetFPDFWideString(L"world");
+  ScopedFPDFWideString world_caps = GetFPDFWideString(L"WORLD");
+  ScopedFPDFWideString world_substr = GetFPDFWideString(L"orld");
+  ScopedFPDFWideString across_lines = GetFPDFWideString(L"world!  goodbye");
+  ScopedFPDFWideString nope = GetFPDFWideString(L"nope");
+  const FPDF_WIDESTRING patterns[] = {world.get(), world_caps.get(),
+                                      world_substr.get(), across_lines.get(),
+                                      nope.get()};
+
+  EXPECT_FALSE(FPDFText_LoadFindPatterns(nullptr, 1, 0));
+  EXPECT_FALSE(FPDFText_LoadFindPatterns(patterns, -1, 0));
+  const FPDF_WIDESTRING patterns_with_null[] = {world.get(), nullptr};
+  EXPECT_FALSE(FPDFText_LoadFindPatterns(
+      patterns_with_null, std::size(patterns_with_null), 0));
+
+  {
+    ScopedFPDFTextFindPatterns find(
+        FPDFText_LoadFindPatterns(patterns, std::size(patterns), 0));
+    ASSERT_TRUE(find);
+    EXPECT_EQ(-1, FPDFText_FindAll(nullptr, find.get(), nullptr, nullptr,
+                                   nullptr, 0));
+    EXPECT_EQ(-1, FPDFText_FindAll(textpage, nullptr, nullptr, nullptr,
+                                   nullptr, 0));
+    EXPECT_EQ(-1, FPDFText_FindAll(textpage, find.get(), nullptr, nullptr,
+                                   nullptr, -1));
+
+    // Asking for the count only.
+    ASSERT_EQ(7, FPDFText_FindAll(textpage, find.get(), nullptr, nullptr,
+                                  nullptr, 0));
+
+    int pattern_indices[7];
+    int start_indices[7];
+    int char_counts[7];
+    ASSERT_EQ(7, FPDFText_FindAll(textpage, find.get(), pattern_indices,
+                                  start_indices, char_counts, 7));
+    const int kExpectedPatterns[] = {0, 1, 3, 2, 0, 1, 2};
+    const int kExpectedStarts[] = {7, 7, 7, 8, 24, 24, 25};
+    const int kExpectedCounts[] = {5, 5, 15, 4, 5, 5, 4};
+    for (size_t i = 0; i < std::size(kExpectedPatterns); ++i) {
+      EXPECT_EQ(kExpectedPatterns[i], pattern_indices[i]);
+      EXPECT_EQ(kExpectedStarts[i], start_indices[i]);
+      EXPECT_EQ(kExpectedCounts[i], char_counts[i]);
+    }
+  }
+  {
+    // Case sensitive, and whole words only.
+    ScopedFPDFTextFindPatterns find(FPDFText_LoadFindPatterns(
+        patterns, std::size(patterns), FPDF_MATCHCASE | FPDF_MATCHWHOLEWORD));
+    ASSERT_TRUE(find);
+
+    int pattern_indices[2];
+    int start_indices[2];
+    ASSERT_EQ(2, FPDFText_FindAll(textpage, find.get(), pattern_indices,
+                                  start_indices, nullptr, 2));
+    EXPECT_EQ(0, pattern_indices[0]);
+    EXPECT_EQ(7, start_indices[0]);
+    EXPECT_EQ(0, pattern_indices[1]);
+    EXPECT_EQ(24, start_indices[1]);
+  }
+
+  FPDFText_ClosePage(textpage);
+  UnloadPage(page);
+}
@@ -63,7 +63,7 @@ FPDFPage_GetThumbnailAsBitmap(FPDF_PAGE page) {
       pdfium::MakeRetain<CPDF_DIB>(p_page->GetDocument(), thumb_stream);
   const CPDF_DIB::LoadState start_status = p_source->StartLoadDIBBase(
       false, nullptr, p_page->GetPageResources(), false,
-      CPDF_ColorSpace::Family::kUnknown, false);
+      CPDF_ColorSpace::Family::kUnknown, false, CPDF_DIB::DecodeHint());
   if (start_status == CPDF_DIB::LoadState::kFail)
     return nullptr;
 
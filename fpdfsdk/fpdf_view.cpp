@@ -31,6 +31,8 @@
 #include "core/fpdfapi/render/cpdf_renderoptions.h"
 #include "core/fpdfdoc/cpdf_nametree.h"
 #include "core/fpdfdoc/cpdf_viewerpreferences.h"
+#include "core/fxcodec/jbig2/JBig2_DocumentContext.h"
+#include "core/fxcodec/jpx/cjpx_decoder.h"
 #include "core/fxcrt/cfx_read_only_span_stream.h"
 #include "core/fxcrt/fx_safe_types.h"
 #include "core/fxcrt/fx_stream.h"
@@ -38,6 +40,7 @@
 #include "core/fxcrt/stl_util.h"
 #include "core/fxcrt/unowned_ptr.h"
 #include "core/fxge/cfx_defaultrenderdevice.h"
+#include "core/fxge/cfx_fontmgr.h"
 #include "core/fxge/cfx_gemodule.h"
 #include "core/fxge/cfx_renderdevice.h"
 #include "fpdfsdk/cpdfsdk_customaccess.h"
@@ -183,6 +186,16 @@ FPDF_InitLibraryWithConfig(const FPDF_LIBRARY_CONFIG* config) {
 
   FX_InitializeMemoryAllocators();
   CFX_GEModule::Create(config ? config->m_pUserFontPaths : nullptr);
+  if (config && config->version >= 4) {
+    CFX_GEModule::Get()->GetFontMgr()->SetEmbeddedFaceCacheBudget(
+        config->m_EmbeddedFontCacheSize);
+  }
+  if (config && config->version >= 5)
+    CJPX_Decoder::SetThreadCount(config->m_JpxDecodeThreadCount);
+  if (config && config->version >= 6) {
+    JBig2_DocumentContext::SetSymbolDictCacheBudget(
+        config->m_JBig2SymbolDictCacheSize);
+  }
   CPDF_PageModule::Create();
 
 #ifdef PDF_ENABLE_XFA
@@ -207,6 +220,9 @@ FPDF_EXPORT void FPDF_CALLCONV FPDF_DestroyLibrary() {
 
   CPDF_PageModule::Destroy();
   CFX_GEModule::Destroy();
+  CJPX_Decoder::SetThreadCount(1);
+  JBig2_DocumentContext::SetSymbolDictCacheBudget(
+      JBig2_DocumentContext::kDefaultSymbolDictCacheBudget);
   IJS_Runtime::Destroy();
 
   g_bLibraryInitialized = false;
@@ -499,7 +515,7 @@ FPDF_EXPORT void FPDF_CALLCONV FPDF_RenderPage(HDC dc,
                                                int rotate,
                                                int flags) {
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
-  if (!pPage)
+  if (!pPage || pPage->IsTextOnly())
     return;
 
   auto pOwnedContext = std::make_unique<CPDF_PageRenderContext>();
@@ -616,7 +632,7 @@ FPDF_EXPORT void FPDF_CALLCONV FPDF_RenderPageBitmap(FPDF_BITMAP bitmap,
     return;
 
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
-  if (!pPage)
+  if (!pPage || pPage->IsTextOnly())
     return;
 
   auto pOwnedContext = std::make_unique<CPDF_PageRenderContext>();
@@ -651,7 +667,7 @@ FPDF_RenderPageBitmapWithMatrix(FPDF_BITMAP bitmap,
     return;
 
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
-  if (!pPage)
+  if (!pPage || pPage->IsTextOnly())
     return;
 
   auto pOwnedContext = std::make_unique<CPDF_PageRenderContext>();
@@ -685,7 +701,7 @@ FPDF_EXPORT FPDF_RECORDER FPDF_CALLCONV FPDF_RenderPageSkp(FPDF_PAGE page,
                                                            int size_x,
                                                            int size_y) {
   CPDF_Page* pPage = CPDFPageFromFPDFPage(page);
-  if (!pPage)
+  if (!pPage || pPage->IsTextOnly())
     return nullptr;
 
   auto pOwnedContext = std::make_unique<CPDF_PageRenderContext>();
@@ -1225,6 +1241,43 @@ FPDF_GetXFAPacketContent(FPDF_DOCUMENT document,
   return true;
 }
 
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SetImageCacheBudget(FPDF_DOCUMENT document, size_t budget) {
+  auto* doc = CPDFDocumentFromFPDFDocument(document);
+  if (!doc)
+    return false;
+
+  auto* render_data = CPDF_DocRenderData::FromDocument(doc);
+  if (!render_data)
+    return false;
+
+  render_data->GetImageCache()->SetBudget(budget);
+  return true;
+}
+
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats) {
+  auto* doc = CPDFDocumentFromFPDFDocument(document);
+  if (!doc || !stats)
+    return false;
+
+  auto* render_data = CPDF_DocRenderData::FromDocument(doc);
+  if (!render_data)
+    return false;
+
+  const CPDF_DocImageCache::Stats& cache_stats =
+      render_data->GetImageCache()->GetStats();
+  stats->hits = pdfium::base::saturated_cast<unsigned long>(cache_stats.hits);
+  stats->misses =
+      pdfium::base::saturated_cast<unsigned long>(cache_stats.misses);
+  stats->evictions =
+      pdfium::base::saturated_cast<unsigned long>(cache_stats.evictions);
+  stats->entries =
+      pdfium::base::saturated_cast<unsigned long>(cache_stats.entries);
+  stats->bytes = cache_stats.bytes;
+  return true;
+}
+
 FPDF_EXPORT unsigned long FPDF_CALLCONV
 FPDF_GetTrailerEnds(FPDF_DOCUMENT document,
                     unsigned int* buffer,
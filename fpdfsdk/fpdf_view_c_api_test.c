@@ -125,6 +125,9 @@ int CheckPDFiumCApi() {
     CHK(FPDFAvail_IsFormAvail);
     CHK(FPDFAvail_IsLinearized);
     CHK(FPDFAvail_IsPageAvail);
+    CHK(FPDFAvail_PlanFirstPageDownload);
+    CHK(FPDFAvail_PlanFormDownload);
+    CHK(FPDFAvail_PlanPageDownload);
 
     // fpdf_doc.h
     CHK(FPDFAction_GetDest);
@@ -154,6 +157,7 @@ int CheckPDFiumCApi() {
     CHK(FPDF_GetMetaText);
     CHK(FPDF_GetPageAAction);
     CHK(FPDF_GetPageLabel);
+    CHK(FPDF_IndexPageTree);
 
     // fpdf_edit.h
     CHK(FPDFFont_Close);
@@ -331,6 +335,7 @@ int CheckPDFiumCApi() {
     CHK(FPDF_ImportPagesByIndex);
     CHK(FPDF_NewFormObjectFromXObject);
     CHK(FPDF_NewXObjectFromPage);
+    CHK(FPDF_SetImportDeduplication);
 
     // fpdf_progressive.h
     CHK(FPDF_RenderPageBitmapWithColorScheme_Start);
@@ -339,8 +344,12 @@ int CheckPDFiumCApi() {
     CHK(FPDF_RenderPage_Continue);
 
     // fpdf_save.h
+    CHK(FPDF_FinishPageWriter);
+    CHK(FPDF_PageWriter_WritePages);
     CHK(FPDF_SaveAsCopy);
+    CHK(FPDF_SaveWithOptions);
     CHK(FPDF_SaveWithVersion);
+    CHK(FPDF_StartPageWriter);
 
     // fpdf_searchex.h
     CHK(FPDFText_GetCharIndexFromTextIndex);
@@ -400,9 +409,11 @@ int CheckPDFiumCApi() {
     CHK(FPDFLink_GetTextRange);
     CHK(FPDFLink_GetURL);
     CHK(FPDFLink_LoadWebLinks);
+    CHK(FPDFText_CloseFindPatterns);
     CHK(FPDFText_ClosePage);
     CHK(FPDFText_CountChars);
     CHK(FPDFText_CountRects);
+    CHK(FPDFText_FindAll);
     CHK(FPDFText_FindClose);
     CHK(FPDFText_FindNext);
     CHK(FPDFText_FindPrev);
@@ -411,6 +422,7 @@ int CheckPDFiumCApi() {
     CHK(FPDFText_GetCharAngle);
     CHK(FPDFText_GetCharBox);
     CHK(FPDFText_GetCharIndexAtPos);
+    CHK(FPDFText_GetCharInfoBatch);
     CHK(FPDFText_GetCharOrigin);
     CHK(FPDFText_GetFillColor);
     CHK(FPDFText_GetFontInfo);
@@ -425,7 +437,9 @@ int CheckPDFiumCApi() {
     CHK(FPDFText_GetText);
     CHK(FPDFText_GetTextRenderMode);
     CHK(FPDFText_GetUnicode);
+    CHK(FPDFText_LoadFindPatterns);
     CHK(FPDFText_LoadPage);
+    CHK(FPDFText_LoadTextOnlyPage);
 
     // fpdf_thumbnail.h
     CHK(FPDFPage_GetDecodedThumbnailData);
@@ -479,6 +493,7 @@ int CheckPDFiumCApi() {
 #endif
     CHK(FPDF_GetDocPermissions);
     CHK(FPDF_GetFileVersion);
+    CHK(FPDF_GetImageCacheStats);
     CHK(FPDF_GetLastError);
     CHK(FPDF_GetNamedDest);
     CHK(FPDF_GetNamedDestByName);
@@ -517,6 +532,7 @@ int CheckPDFiumCApi() {
 #if defined(_WIN32)
     CHK(FPDF_SetPrintMode);
 #endif
+    CHK(FPDF_SetImageCacheBudget);
     CHK(FPDF_SetSandBoxPolicy);
     CHK(FPDF_VIEWERREF_GetDuplex);
     CHK(FPDF_VIEWERREF_GetName);
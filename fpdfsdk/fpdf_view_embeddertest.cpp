@@ -1831,3 +1831,110 @@ TEST_F(FPDFViewEmbedderTest, GetTrailerEndsWhitespace) {
   ASSERT_EQ(size, FPDF_GetTrailerEnds(document(), ends.data(), size));
   EXPECT_EQ(kExpectedEnds, ends);
 }
+
+TEST_F(FPDFViewEmbedderTest, ImageCacheOffByDefault) {
+  ASSERT_TRUE(OpenDocument("embedded_images.pdf"));
+  for (int i = 0; i < 2; ++i) {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    UnloadPage(page);
+  }
+
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.entries);
+  EXPECT_EQ(0u, stats.bytes);
+}
+
+TEST_F(FPDFViewEmbedderTest, ImageCache) {
+  ASSERT_TRUE(OpenDocument("embedded_images.pdf"));
+  ASSERT_TRUE(FPDF_SetImageCacheBudget(document(), 100 * 1024 * 1024));
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_EQ(0u, stats.misses);
+  EXPECT_EQ(0u, stats.entries);
+
+  {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    UnloadPage(page);
+  }
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.hits);
+  EXPECT_GT(stats.misses, 0u);
+  EXPECT_GT(stats.entries, 0u);
+  EXPECT_GT(stats.bytes, 0u);
+
+  // A fresh load of the page has a fresh page cache, but reuses the decodes
+  // cached for the document.
+  {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    UnloadPage(page);
+  }
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_GT(stats.hits, 0u);
+
+  ASSERT_TRUE(FPDF_SetImageCacheBudget(document(), 0));
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(0u, stats.entries);
+  EXPECT_EQ(0u, stats.bytes);
+
+  EXPECT_FALSE(FPDF_SetImageCacheBudget(nullptr, 0));
+  EXPECT_FALSE(FPDF_GetImageCacheStats(nullptr, &stats));
+  EXPECT_FALSE(FPDF_GetImageCacheStats(document(), nullptr));
+}
+
+TEST_F(FPDFViewEmbedderTest, DCTImageRedecodedWhenZoomingIn) {
+  // The page is 120x120 and is covered by a 120x120 DCT image.
+  ASSERT_TRUE(OpenDocument("dct_image.pdf"));
+
+  // Drawing the page at 15x15 only needs the image at 1/8 scale. Drawing it
+  // at full size next must not reuse that decode from the page's cache.
+  std::string zoomed_in_hash;
+  {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap small_bitmap(FPDFBitmap_Create(15, 15, 0));
+    FPDFBitmap_FillRect(small_bitmap.get(), 0, 0, 15, 15, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(small_bitmap.get(), page, 0, 0, 15, 15, 0, 0);
+    ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+    zoomed_in_hash = HashBitmap(bitmap.get());
+    UnloadPage(page);
+  }
+
+  // Drawing at full size on a freshly loaded page decodes at full scale.
+  FPDF_PAGE page = LoadPage(0);
+  ASSERT_TRUE(page);
+  ScopedFPDFBitmap bitmap = RenderLoadedPage(page);
+  EXPECT_EQ(HashBitmap(bitmap.get()), zoomed_in_hash);
+  UnloadPage(page);
+}
+
+TEST_F(FPDFViewEmbedderTest, DCTImageCachedByResolutionLevel) {
+  ASSERT_TRUE(OpenDocument("dct_image.pdf"));
+  ASSERT_TRUE(FPDF_SetImageCacheBudget(document(), 1024 * 1024));
+
+  // Drawing at 14x14 decodes the image at 1/8 scale, which is 15x15.
+  for (int size : {14, 15}) {
+    FPDF_PAGE page = LoadPage(0);
+    ASSERT_TRUE(page);
+    ScopedFPDFBitmap bitmap(FPDFBitmap_Create(size, size, 0));
+    FPDFBitmap_FillRect(bitmap.get(), 0, 0, size, size, 0xFFFFFFFF);
+    FPDF_RenderPageBitmap(bitmap.get(), page, 0, 0, size, size, 0, 0);
+    UnloadPage(page);
+  }
+
+  // So drawing at 15x15 on a fresh page reuses that decode.
+  FPDF_IMAGE_CACHE_STATS stats;
+  ASSERT_TRUE(FPDF_GetImageCacheStats(document(), &stats));
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.entries);
+}
@@ -79,6 +79,12 @@ struct FPDFTextFindDeleter {
   inline void operator()(FPDF_SCHHANDLE handle) { FPDFText_FindClose(handle); }
 };
 
+struct FPDFTextFindPatternsDeleter {
+  inline void operator()(FPDF_TEXTFINDPATTERNS patterns) {
+    FPDFText_CloseFindPatterns(patterns);
+  }
+};
+
 struct FPDFTextPageDeleter {
   inline void operator()(FPDF_TEXTPAGE text) { FPDFText_ClosePage(text); }
 };
@@ -60,6 +60,10 @@ using ScopedFPDFTextFind =
     std::unique_ptr<std::remove_pointer<FPDF_SCHHANDLE>::type,
                     FPDFTextFindDeleter>;
 
+using ScopedFPDFTextFindPatterns =
+    std::unique_ptr<std::remove_pointer<FPDF_TEXTFINDPATTERNS>::type,
+                    FPDFTextFindPatternsDeleter>;
+
 using ScopedFPDFTextPage =
     std::unique_ptr<std::remove_pointer<FPDF_TEXTPAGE>::type,
                     FPDFTextPageDeleter>;
@@ -197,6 +197,59 @@ FPDF_EXPORT int FPDF_CALLCONV FPDFAvail_IsFormAvail(FPDF_AVAIL avail,
 // if the PDF is linearlized.
 FPDF_EXPORT int FPDF_CALLCONV FPDFAvail_IsLinearized(FPDF_AVAIL avail);
 
+// Experimental API.
+// Report, through |hints|, every part of the file still missing that the first
+// page needs, so that all of them can be downloaded at once, rather than one
+// after another as FPDFAvail_IsPageAvail() asks for them.
+//
+//   avail   - handle to document availability provider.
+//   max_gap - parts less than |max_gap| bytes apart are reported as one.
+//   hints   - pointer to a download hints interface, receiving the parts.
+//
+// Returns the number of parts reported, or -1 on error.
+//
+// Only the parts that can be told from the data available so far get reported.
+// For linearized documents, the first 1k of data tells where the first page
+// is. The hint tables then tell everything other pages need. Otherwise objects
+// are only found through the objects that refer to them, so call this again
+// once the parts reported are available, until it reports none. Before
+// FPDFAvail_GetDocument() succeeds, only linearized documents have any parts to
+// report, besides the first 1k.
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanFirstPageDownload(FPDF_AVAIL avail,
+                                unsigned long max_gap,
+                                FX_DOWNLOADHINTS* hints);
+
+// Experimental API.
+// Same as FPDFAvail_PlanFirstPageDownload(), for the page at |page_index|.
+// Reports nothing before FPDFAvail_GetDocument() succeeds.
+//
+//   avail      - handle to document availability provider.
+//   page_index - index number of the page. Must be 0-based.
+//   max_gap    - parts less than |max_gap| bytes apart are reported as one.
+//   hints      - pointer to a download hints interface, receiving the parts.
+//
+// Returns the number of parts reported, or -1 on error.
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanPageDownload(FPDF_AVAIL avail,
+                           int page_index,
+                           unsigned long max_gap,
+                           FX_DOWNLOADHINTS* hints);
+
+// Experimental API.
+// Same as FPDFAvail_PlanFirstPageDownload(), for the interactive form.
+// Reports nothing before FPDFAvail_GetDocument() succeeds.
+//
+//   avail   - handle to document availability provider.
+//   max_gap - parts less than |max_gap| bytes apart are reported as one.
+//   hints   - pointer to a download hints interface, receiving the parts.
+//
+// Returns the number of parts reported, or -1 on error.
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFAvail_PlanFormDownload(FPDF_AVAIL avail,
+                           unsigned long max_gap,
+                           FX_DOWNLOADHINTS* hints);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
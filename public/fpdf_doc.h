@@ -206,6 +206,17 @@ FPDFAction_GetURIPath(FPDF_DOCUMENT document,
 FPDF_EXPORT int FPDF_CALLCONV FPDFDest_GetDestPageIndex(FPDF_DOCUMENT document,
                                                         FPDF_DEST dest);
 
+// Experimental API.
+// Go through the whole page tree of |document| once, so that finding the page
+// index of a destination, bookmark or annotation does not have to search the
+// page tree afterwards. Without this, pages get found as they get used.
+//
+//   document - handle to the document.
+//
+// Returns TRUE if every page in |document| was found, FALSE otherwise, e.g.
+// when the page tree is malformed.
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_IndexPageTree(FPDF_DOCUMENT document);
+
 // Experimental API.
 // Get the view (fit type) specified by |dest|.
 //
@@ -51,6 +51,21 @@ FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV FPDF_ImportPages(FPDF_DOCUMENT dest_doc,
                                                      FPDF_BYTESTRING pagerange,
                                                      int index);
 
+// Experimental API.
+// Set whether importing pages into |dest_doc| reuses objects it already holds
+// in place of identical objects, such as the fonts and images shared by pages
+// from similar documents, rather than copying them again.
+//
+//   dest_doc - The destination document for the pages.
+//   enable   - Whether to reuse identical objects.
+//
+// Applies to FPDF_ImportPagesByIndex() and FPDF_ImportPages(). Only objects
+// imported while reuse is enabled get reused.
+//
+// Returns TRUE on success.
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SetImportDeduplication(FPDF_DOCUMENT dest_doc, FPDF_BOOL enable);
+
 // Experimental API.
 // Create a new document from |src_doc|.  The pages of |src_doc| will be
 // combined to provide |num_pages_on_x_axis x num_pages_on_y_axis| pages per
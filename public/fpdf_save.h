@@ -46,6 +46,28 @@ typedef struct FPDF_FILEWRITE_ {
 #define FPDF_NO_INCREMENTAL 2
 #define FPDF_REMOVE_SECURITY 3
 
+// Experimental. May be OR'd with the flags above for a non-incremental save.
+// Packs the objects that are not streams into compressed object streams and
+// writes a cross-reference stream instead of a cross-reference table. The
+// saved file is at least version 1.5.
+#define FPDF_OBJECT_STREAMS 0x100
+
+// Experimental. May be OR'd with FPDF_OBJECT_STREAMS to put at most |n|
+// objects, from 1 to 65535, in each object stream. Defaults to 100.
+#define FPDF_OBJECT_STREAM_SIZE(n) (((FPDF_DWORD)(n) & 0xFFFF) << 16)
+
+// Experimental. May be OR'd with the flags above for a non-incremental save.
+// Writes a linearized file, which viewers can show page by page while it
+// downloads: the first page comes first, then the other pages in order, with
+// hint tables saying where each page's objects are. Takes precedence over
+// FPDF_OBJECT_STREAMS. Documents without pages get saved as usual.
+#define FPDF_LINEARIZE 0x200
+
+// Experimental. May be OR'd with the flags above for a non-incremental save.
+// Writes one copy of each set of objects with the same contents, such as the
+// same font or image embedded again by every page of a merged document.
+#define FPDF_DEDUPLICATE 0x400
+
 // Function: FPDF_SaveAsCopy
 //          Saves the copy of specified document in custom way.
 // Parameters:
@@ -78,6 +100,112 @@ FPDF_SaveWithVersion(FPDF_DOCUMENT document,
                      FPDF_DWORD flags,
                      int fileVersion);
 
+// Experimental API.
+// Values for FPDF_SAVE_OPTIONS::compression_strategy. They match zlib's
+// strategies.
+#define FPDF_COMPRESSION_STRATEGY_DEFAULT 0
+#define FPDF_COMPRESSION_STRATEGY_FILTERED 1
+#define FPDF_COMPRESSION_STRATEGY_HUFFMAN_ONLY 2
+#define FPDF_COMPRESSION_STRATEGY_RLE 3
+
+// Experimental API.
+// Options for FPDF_SaveWithOptions().
+typedef struct FPDF_SAVE_OPTIONS_ {
+  // Version number of the interface. Currently must be 1.
+  int version;
+
+  // The PDF file version, as for FPDF_SaveWithVersion(), or 0 to keep the
+  // document's version.
+  int file_version;
+
+  // The zlib compression level for the streams the save compresses, those
+  // without filters. From 0 for no compression to 9 for the smallest file,
+  // or -1 for zlib's default.
+  int compression_level;
+
+  // One of the FPDF_COMPRESSION_STRATEGY_* values.
+  int compression_strategy;
+
+  // The number of threads to compress streams on, counting the calling
+  // thread. 0 or 1 compresses them all on the calling thread. Values above
+  // the number of processor cores are capped to it. The output is the same
+  // either way.
+  int thread_count;
+} FPDF_SAVE_OPTIONS;
+
+// Experimental API.
+// Function: FPDF_SaveWithOptions
+//          Same as FPDF_SaveAsCopy(), with more control over how the saved
+//          document gets written.
+// Parameters:
+//          document        -   Handle to document.
+//          pFileWrite      -   A pointer to a custom file write structure.
+//          flags           -   The creating flags.
+//          options         -   The save options.
+// Return value:
+//          TRUE if succeed, FALSE if failed, including when |options| is
+//          invalid.
+//
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SaveWithOptions(FPDF_DOCUMENT document,
+                     FPDF_FILEWRITE* pFileWrite,
+                     FPDF_DWORD flags,
+                     const FPDF_SAVE_OPTIONS* options);
+
+// Experimental API.
+// Function: FPDF_StartPageWriter
+//          Starts writing |document| to |pFileWrite| page by page, so
+//          documents too large to hold in memory can get written. Each
+//          FPDF_PageWriter_WritePages() call writes the pages |document| has
+//          at that point, and FPDF_FinishPageWriter() writes the rest.
+// Parameters:
+//          document        -   Handle to a document from
+//                              FPDF_CreateNewDocument().
+//          pFileWrite      -   A pointer to a custom file write structure. It
+//                              must stay valid until FPDF_FinishPageWriter().
+//          fileVersion     -   The PDF file version, as for
+//                              FPDF_SaveWithVersion(), or 0 for 1.7.
+// Return value:
+//          A handle to the writer, which FPDF_FinishPageWriter() frees, or
+//          NULL on failure, including when |document| got loaded from a file
+//          or |fileVersion| is neither 0 nor from 10 to 17.
+//
+FPDF_EXPORT FPDF_PAGEWRITER FPDF_CALLCONV
+FPDF_StartPageWriter(FPDF_DOCUMENT document,
+                     FPDF_FILEWRITE* pFileWrite,
+                     int fileVersion);
+
+// Experimental API.
+// Function: FPDF_PageWriter_WritePages
+//          Writes the pages the writer's document has, and the objects they
+//          use, then takes them out of the document, which has no pages
+//          afterwards. Pages that get added later go after them.
+//          Handles to the pages or their contents must be closed first, and
+//          page contents must have been generated with
+//          FPDFPage_GenerateContent(). Handles to the objects written with
+//          the pages, like fonts and images, may still be used on later
+//          pages, which then refer to the objects as written.
+// Parameters:
+//          writer          -   Handle to the writer.
+// Return value:
+//          TRUE if succeed, FALSE if failed.
+//
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_PageWriter_WritePages(FPDF_PAGEWRITER writer);
+
+// Experimental API.
+// Function: FPDF_FinishPageWriter
+//          Writes the pages the writer's document has, then the page tree,
+//          listing every page written, and the rest of the document. Frees
+//          |writer| either way.
+// Parameters:
+//          writer          -   Handle to the writer.
+// Return value:
+//          TRUE if succeed, FALSE if failed.
+//
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_FinishPageWriter(FPDF_PAGEWRITER writer);
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,26 @@ extern "C" {
 //
 FPDF_EXPORT FPDF_TEXTPAGE FPDF_CALLCONV FPDFText_LoadPage(FPDF_PAGE page);
 
+// Experimental API.
+// Function: FPDFText_LoadTextOnlyPage
+//          Load a page for text extraction only.
+// Parameters:
+//          document    -   Handle to the document. Returned by FPDF_LoadDocument.
+//          page_index  -   Index number of the page. 0 for the first page.
+// Return value:
+//          A handle to the loaded page, or NULL if page load fails.
+// Comments:
+//          Only text objects are created when parsing the page content. Paths,
+//          images, shadings and clipping are skipped, which makes loading much
+//          cheaper when the page is only passed to FPDFText_LoadPage.
+//          Since its page object list is incomplete, the returned page cannot
+//          be rendered, and FPDFPage_GenerateContent() fails on it. The
+//          FPDF_RenderPage*() and FPDF_FFLDraw() functions draw nothing.
+//          For documents with XFA forms, the page is loaded in full.
+//          The loaded page can be closed using FPDF_ClosePage.
+FPDF_EXPORT FPDF_PAGE FPDF_CALLCONV
+FPDFText_LoadTextOnlyPage(FPDF_DOCUMENT document, int page_index);
+
 // Function: FPDFText_ClosePage
 //          Release all resources allocated for a text page information
 //          structure.
@@ -301,6 +321,59 @@ FPDFText_GetCharOrigin(FPDF_TEXTPAGE text_page,
                        double* x,
                        double* y);
 
+// Flags for the |flags| buffer of FPDFText_GetCharInfoBatch().
+// The character was generated by PDFium, e.g. a space or line break inserted
+// between text objects. It does not come from the page content.
+#define FPDF_TEXTCHAR_GENERATED 0x1
+// The character is a hyphen at the end of a line.
+#define FPDF_TEXTCHAR_HYPHEN 0x2
+// The character code has no Unicode mapping in its font.
+#define FPDF_TEXTCHAR_UNICODE_MAP_ERROR 0x4
+
+// Experimental API.
+// Function: FPDFText_GetCharInfoBatch
+//          Get information about a range of characters in one call.
+// Parameters:
+//          text_page   -   Handle to a text page information structure.
+//                          Returned by FPDFText_LoadPage function.
+//          start_index -   Zero-based index of the first character.
+//          count       -   Number of characters to get. Each non-NULL buffer
+//                          below must have room for |count| entries.
+//          unicodes    -   Optional buffer receiving the Unicode value of each
+//                          character, as FPDFText_GetUnicode() would.
+//          boxes       -   Optional buffer receiving the bounding box of each
+//                          character, as FPDFText_GetCharBox() would.
+//          origins     -   Optional buffer receiving the origin of each
+//                          character, as FPDFText_GetCharOrigin() would.
+//          font_sizes  -   Optional buffer receiving the font size of each
+//                          character, as FPDFText_GetFontSize() would.
+//          flags       -   Optional buffer receiving a combination of the
+//                          FPDF_TEXTCHAR_* flags for each character.
+//          font_ids    -   Optional buffer receiving an id for the font of
+//                          each character, or -1 if the character has no
+//                          font. Characters share an id exactly when they
+//                          share a font. Ids are small non-negative numbers
+//                          and stay the same for the lifetime of |text_page|.
+// Return Value:
+//          The number of characters written to each buffer, which is less
+//          than |count| if the range runs past the end of the page. Returns
+//          -1 if |text_page| is invalid, or if |start_index| or |count| is
+//          negative.
+// Comments:
+//          This is much faster than calling the per-character functions for
+//          each character. All positions are measured in PDF "user space".
+//
+FPDF_EXPORT int FPDF_CALLCONV
+FPDFText_GetCharInfoBatch(FPDF_TEXTPAGE text_page,
+                          int start_index,
+                          int count,
+                          unsigned int* unicodes,
+                          FS_RECTF* boxes,
+                          FS_POINTF* origins,
+                          float* font_sizes,
+                          int* flags,
+                          int* font_ids);
+
 // Function: FPDFText_GetCharIndexAtPos
 //          Get the index of a character at or nearby a certain position on the
 //          page.
@@ -511,6 +584,72 @@ FPDF_EXPORT int FPDF_CALLCONV FPDFText_GetSchCount(FPDF_SCHHANDLE handle);
 //
 FPDF_EXPORT void FPDF_CALLCONV FPDFText_FindClose(FPDF_SCHHANDLE handle);
 
+// Experimental API.
+// Function: FPDFText_LoadFindPatterns
+//          Prepare a list of search terms for FPDFText_FindAll().
+// Parameters:
+//          patterns    -   An array of |count| unicode match patterns. None of
+//                          the entries may be NULL.
+//          count       -   The number of patterns.
+//          flags       -   Option flags, as for FPDFText_FindStart().
+// Return Value:
+//          A handle for the prepared patterns, or NULL on failure.
+//          FPDFText_CloseFindPatterns must be called to release this handle.
+// Comments:
+//          The handle is not tied to any page, and can be used to search any
+//          number of pages.
+//
+FPDF_EXPORT FPDF_TEXTFINDPATTERNS FPDF_CALLCONV
+FPDFText_LoadFindPatterns(const FPDF_WIDESTRING* patterns,
+                          int count,
+                          unsigned long flags);
+
+// Experimental API.
+// Function: FPDFText_FindAll
+//          Find all matches of all prepared patterns on a page.
+// Parameters:
+//          text_page       -   Handle to a text page information structure.
+//                              Returned by FPDFText_LoadPage function.
+//          patterns        -   Handle returned by FPDFText_LoadFindPatterns.
+//          pattern_indices -   Optional buffer receiving the index, within
+//                              the array passed to FPDFText_LoadFindPatterns,
+//                              of the pattern found by each match.
+//          start_indices   -   Optional buffer receiving the index of the
+//                              first character of each match, as
+//                              FPDFText_GetSchResultIndex() would.
+//          char_counts     -   Optional buffer receiving the number of
+//                              characters of each match, as
+//                              FPDFText_GetSchCount() would.
+//          max_matches     -   The number of entries in each non-NULL buffer.
+// Return Value:
+//          The total number of matches, which may be more than |max_matches|.
+//          Only the first |max_matches| matches are written. Returns -1 if
+//          |text_page| or |patterns| is invalid, or |max_matches| is
+//          negative.
+// Comments:
+//          All patterns are searched for in a single pass over the page text.
+//          Matches are ordered by position, then by pattern index. Spaces in
+//          patterns and the option flags are handled the way
+//          FPDFText_FindNext() handles them.
+//
+FPDF_EXPORT int FPDF_CALLCONV FPDFText_FindAll(FPDF_TEXTPAGE text_page,
+                                               FPDF_TEXTFINDPATTERNS patterns,
+                                               int* pattern_indices,
+                                               int* start_indices,
+                                               int* char_counts,
+                                               int max_matches);
+
+// Experimental API.
+// Function: FPDFText_CloseFindPatterns
+//          Release patterns prepared by FPDFText_LoadFindPatterns.
+// Parameters:
+//          patterns    -   Handle returned by FPDFText_LoadFindPatterns.
+// Return Value:
+//          None.
+//
+FPDF_EXPORT void FPDF_CALLCONV
+FPDFText_CloseFindPatterns(FPDF_TEXTFINDPATTERNS patterns);
+
 // Function: FPDFLink_LoadWebLinks
 //          Prepare information about weblinks in a page.
 // Parameters:
@@ -70,6 +70,7 @@ typedef struct fpdf_pagelink_t__* FPDF_PAGELINK;
 typedef struct fpdf_pageobject_t__* FPDF_PAGEOBJECT;  // (text, path, etc.)
 typedef struct fpdf_pageobjectmark_t__* FPDF_PAGEOBJECTMARK;
 typedef const struct fpdf_pagerange_t__* FPDF_PAGERANGE;
+typedef struct fpdf_pagewriter_t__* FPDF_PAGEWRITER;
 typedef const struct fpdf_pathsegment_t* FPDF_PATHSEGMENT;
 typedef void* FPDF_RECORDER;  // Passed into skia.
 typedef struct fpdf_schhandle_t__* FPDF_SCHHANDLE;
@@ -77,6 +78,7 @@ typedef const struct fpdf_signature_t__* FPDF_SIGNATURE;
 typedef struct fpdf_structelement_t__* FPDF_STRUCTELEMENT;
 typedef const struct fpdf_structelement_attr_t__* FPDF_STRUCTELEMENT_ATTR;
 typedef struct fpdf_structtree_t__* FPDF_STRUCTTREE;
+typedef struct fpdf_textfindpatterns_t__* FPDF_TEXTFINDPATTERNS;
 typedef struct fpdf_textpage_t__* FPDF_TEXTPAGE;
 typedef struct fpdf_widget_t__* FPDF_WIDGET;
 typedef struct fpdf_xobject_t__* FPDF_XOBJECT;
@@ -262,6 +264,28 @@ typedef struct FPDF_LIBRARY_CONFIG_ {
   // Pointer to the V8::Platform to use.
   void* m_pPlatform;
 
+  // Version 4 - Experimental.
+
+  // Maximum number of bytes of embedded font programs to keep loaded across
+  // documents. Documents that embed a font program identical to one already
+  // loaded share its data and FreeType face instead of loading their own.
+  // Set to 0 to disable sharing.
+  size_t m_EmbeddedFontCacheSize;
+
+  // Version 5 - Experimental.
+
+  // Number of threads, counting the calling thread, that decoding a JPEG 2000
+  // image may use. Values below 2 keep decoding on the calling thread. Values
+  // above the number of processor cores are capped to it.
+  int m_JpxDecodeThreadCount;
+
+  // Version 6 - Experimental.
+
+  // Maximum number of bytes of decoded JBIG2 global symbol dictionaries each
+  // document keeps, so pages sharing a dictionary decode it only once. Set to
+  // 0 to decode the dictionary for every page.
+  size_t m_JBig2SymbolDictCacheSize;
+
 } FPDF_LIBRARY_CONFIG;
 
 // Function: FPDF_InitLibraryWithConfig
@@ -620,6 +644,52 @@ FPDF_GetTrailerEnds(FPDF_DOCUMENT document,
                     unsigned int* buffer,
                     unsigned long length);
 
+// Experimental API.
+// Decoded image cache statistics for a document. Pages that draw the same
+// image share one decode of it through this cache.
+typedef struct FPDF_IMAGE_CACHE_STATS_ {
+  // Number of image loads that found a usable decode in the cache.
+  unsigned long hits;
+  // Number of image loads that had to decode the image.
+  unsigned long misses;
+  // Number of decodes dropped to stay within the budget.
+  unsigned long evictions;
+  // Number of decodes in the cache.
+  unsigned long entries;
+  // Estimated memory used by the decodes in the cache, in bytes.
+  size_t bytes;
+} FPDF_IMAGE_CACHE_STATS;
+
+// Experimental API.
+// Function: FPDF_SetImageCacheBudget
+//          Set how much memory the document's decoded image cache may use.
+// Parameters:
+//          document    -   Handle to a document. Returned by FPDF_LoadDocument.
+//          budget      -   Maximum estimated size of the cached decodes, in
+//                          bytes. 0 disables the cache. Defaults to 0.
+// Return value:
+//          TRUE on success, FALSE if |document| is invalid.
+// Comments:
+//          The cache is off until this is called with a non-zero budget.
+//          Each document has its own budget, and cached decodes live until
+//          they are evicted or the document is closed, even after the pages
+//          that drew them are closed.
+//          Lowering the budget evicts the least recently used decodes right
+//          away.
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_SetImageCacheBudget(FPDF_DOCUMENT document, size_t budget);
+
+// Experimental API.
+// Function: FPDF_GetImageCacheStats
+//          Get statistics for the document's decoded image cache.
+// Parameters:
+//          document    -   Handle to a document. Returned by FPDF_LoadDocument.
+//          stats       -   Receives the statistics.
+// Return value:
+//          TRUE on success, FALSE if |document| or |stats| is invalid.
+FPDF_EXPORT FPDF_BOOL FPDF_CALLCONV
+FPDF_GetImageCacheStats(FPDF_DOCUMENT document, FPDF_IMAGE_CACHE_STATS* stats);
+
 // Function: FPDF_GetDocPermission
 //          Get file permission flags of the document.
 // Parameters: